@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2018-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2018-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -22,8 +22,8 @@
 /* ---------------------------- Definitions --------------------------------- */
 
 #ifdef CONFIG_ESP_EVENT_LOOP_PROFILING
-// LOOP @<address, name> rx:<recieved events no.> dr:<dropped events no.>
-#define LOOP_DUMP_FORMAT              "LOOP @%p,%s rx:%" PRIu32 " dr:%" PRIu32 "\n"
+// LOOP @<address, name> rx:<recieved events no.> dr:<dropped events no.> ph:<pool hits> pm:<pool misses>
+#define LOOP_DUMP_FORMAT              "LOOP @%p,%s rx:%" PRIu32 " dr:%" PRIu32 " ph:%" PRIu32 " pm:%" PRIu32 "\n"
 // handler @<address> ev:<base, id> inv:<times invoked> time:<runtime>
 #define HANDLER_DUMP_FORMAT           "  HANDLER @%p ev:%s,%s inv:%" PRIu32 " time:%lld us\n"
 
@@ -34,6 +34,10 @@
                                         } while(0);
 #endif
 
+// Lists of id nodes and base nodes up to this length are searched linearly, longer ones get a hash table
+#define INDEX_MIN_NODES                 8
+#define INDEX_MIN_BUCKET_BITS           4
+
 /* ------------------------- Static Variables ------------------------------- */
 
 static const char* TAG = "event";
@@ -87,7 +91,7 @@ static int esp_event_dump_prepare(void)
 
     // Reserve slightly more memory than computed
     int allowance = 3;
-    int size = (((loops + allowance) * (sizeof(LOOP_DUMP_FORMAT) + 10 + 20 + 2 * 11)) +
+    int size = (((loops + allowance) * (sizeof(LOOP_DUMP_FORMAT) + 10 + 20 + 4 * 11)) +
                 ((handlers + allowance) * (sizeof(HANDLER_DUMP_FORMAT) + 10 + 2 * 20 + 11 + 20)));
 
     return size;
@@ -121,21 +125,15 @@ static void handler_execute(esp_event_loop_instance_t* loop, esp_event_handler_n
     start = esp_timer_get_time();
 #endif
     // Execute the handler
-#if CONFIG_ESP_EVENT_POST_FROM_ISR
     void* data_ptr = NULL;
 
-    if (post.data_set) {
-        if (post.data_allocated) {
-            data_ptr = post.data.ptr;
-        } else {
-            data_ptr = &post.data.val;
-        }
+    if (post.data_location == ESP_EVENT_POST_DATA_INLINE) {
+        data_ptr = &post.data;
+    } else if (post.data_location != ESP_EVENT_POST_DATA_NONE) {
+        data_ptr = post.data.ptr;
     }
 
     (*(handler->handler_ctx->handler))(handler->handler_ctx->arg, post.base, post.id, data_ptr);
-#else
-    (*(handler->handler_ctx->handler))(handler->handler_ctx->arg, post.base, post.id, post.data);
-#endif
 
 #ifdef CONFIG_ESP_EVENT_LOOP_PROFILING
     diff = esp_timer_get_time() - start;
@@ -160,6 +158,213 @@ static void handler_execute(esp_event_loop_instance_t* loop, esp_event_handler_n
 #endif
 }
 
+static inline uint32_t id_bucket(const esp_event_base_node_t* base_node, int32_t id)
+{
+    // ids are usually small consecutive numbers, so the lower bits spread them well
+    return (uint32_t) id & ((1U << base_node->id_bucket_bits) - 1);
+}
+
+static inline uint32_t base_bucket(const esp_event_loop_node_t* loop_node, esp_event_base_t base)
+{
+    // bases are pointers to strings, mix the address bits with a multiplicative hash
+    return ((uint32_t)(uintptr_t) base * 2654435761U) >> (32 - loop_node->base_bucket_bits);
+}
+
+static inline uint8_t index_bucket_bits(uint32_t node_count)
+{
+    uint8_t bits = INDEX_MIN_BUCKET_BITS;
+    while ((1U << bits) < node_count * 2) {
+        bits++;
+    }
+    return bits;
+}
+
+static void id_index_insert(esp_event_base_node_t* base_node, esp_event_id_node_t* id_node)
+{
+    esp_event_id_node_t** slot = &(base_node->id_buckets[id_bucket(base_node, id_node->id)]);
+    while (*slot) {
+        slot = &((*slot)->next_in_bucket);
+    }
+    id_node->next_in_bucket = NULL;
+    *slot = id_node;
+}
+
+static void id_index_add(esp_event_base_node_t* base_node, esp_event_id_node_t* id_node)
+{
+    base_node->id_node_count++;
+
+    uint32_t capacity = base_node->id_buckets ? (1U << base_node->id_bucket_bits) : INDEX_MIN_NODES;
+    if (base_node->id_node_count > capacity) {
+        uint8_t bits = index_bucket_bits(base_node->id_node_count);
+        esp_event_id_node_t** buckets = calloc(1U << bits, sizeof(*buckets));
+        if (buckets) {
+            free(base_node->id_buckets);
+            base_node->id_buckets = buckets;
+            base_node->id_bucket_bits = bits;
+            esp_event_id_node_t* it;
+            SLIST_FOREACH(it, &(base_node->id_nodes), next) {
+                id_index_insert(base_node, it);
+            }
+            return;
+        }
+        // Keep using the current table, or the list if there is none; lookups only get slower
+        ESP_LOGD(TAG, "alloc for id index failed");
+    }
+
+    if (base_node->id_buckets) {
+        id_index_insert(base_node, id_node);
+    }
+}
+
+static void id_index_remove(esp_event_base_node_t* base_node, esp_event_id_node_t* id_node)
+{
+    base_node->id_node_count--;
+
+    if (base_node->id_buckets) {
+        esp_event_id_node_t** slot = &(base_node->id_buckets[id_bucket(base_node, id_node->id)]);
+        while (*slot != id_node) {
+            slot = &((*slot)->next_in_bucket);
+        }
+        *slot = id_node->next_in_bucket;
+    }
+}
+
+static esp_event_id_node_t* base_node_find_id(esp_event_base_node_t* base_node, int32_t id)
+{
+    esp_event_id_node_t* it;
+
+    if (base_node->id_buckets) {
+        it = base_node->id_buckets[id_bucket(base_node, id)];
+        while (it && it->id != id) {
+            it = it->next_in_bucket;
+        }
+    } else {
+        it = SLIST_FIRST(&(base_node->id_nodes));
+        while (it && it->id != id) {
+            it = SLIST_NEXT(it, next);
+        }
+    }
+
+    return it;
+}
+
+static void base_index_insert(esp_event_loop_node_t* loop_node, esp_event_base_node_t* base_node)
+{
+    // Base nodes are only appended to the list, so appending them to the bucket keeps the list order
+    esp_event_base_node_t** slot = &(loop_node->base_buckets[base_bucket(loop_node, base_node->base)]);
+    while (*slot) {
+        slot = &((*slot)->next_in_bucket);
+    }
+    base_node->next_in_bucket = NULL;
+    *slot = base_node;
+}
+
+static void base_index_add(esp_event_loop_node_t* loop_node, esp_event_base_node_t* base_node)
+{
+    loop_node->base_node_count++;
+
+    uint32_t capacity = loop_node->base_buckets ? (1U << loop_node->base_bucket_bits) : INDEX_MIN_NODES;
+    if (loop_node->base_node_count > capacity) {
+        uint8_t bits = index_bucket_bits(loop_node->base_node_count);
+        esp_event_base_node_t** buckets = calloc(1U << bits, sizeof(*buckets));
+        if (buckets) {
+            free(loop_node->base_buckets);
+            loop_node->base_buckets = buckets;
+            loop_node->base_bucket_bits = bits;
+            esp_event_base_node_t* it;
+            SLIST_FOREACH(it, &(loop_node->base_nodes), next) {
+                base_index_insert(loop_node, it);
+            }
+            return;
+        }
+        ESP_LOGD(TAG, "alloc for base index failed");
+    }
+
+    if (loop_node->base_buckets) {
+        base_index_insert(loop_node, base_node);
+    }
+}
+
+static void base_index_remove(esp_event_loop_node_t* loop_node, esp_event_base_node_t* base_node)
+{
+    loop_node->base_node_count--;
+
+    if (loop_node->base_buckets) {
+        esp_event_base_node_t** slot = &(loop_node->base_buckets[base_bucket(loop_node, base_node->base)]);
+        while (*slot != base_node) {
+            slot = &((*slot)->next_in_bucket);
+        }
+        *slot = base_node->next_in_bucket;
+    }
+}
+
+// Returns the first base node of the loop node with the given base following after, or the first one of
+// the loop node if after is NULL. The base nodes are returned in the order of the list.
+static esp_event_base_node_t* loop_node_find_base(esp_event_loop_node_t* loop_node, esp_event_base_node_t* after, esp_event_base_t base)
+{
+    esp_event_base_node_t* it;
+
+    if (loop_node->base_buckets) {
+        it = after ? after->next_in_bucket : loop_node->base_buckets[base_bucket(loop_node, base)];
+        while (it && it->base != base) {
+            it = it->next_in_bucket;
+        }
+    } else {
+        it = after ? SLIST_NEXT(after, next) : SLIST_FIRST(&(loop_node->base_nodes));
+        while (it && it->base != base) {
+            it = SLIST_NEXT(it, next);
+        }
+    }
+
+    return it;
+}
+
+// Runs the handlers of the event, the caller holds the mutex of the loop
+static void loop_dispatch(esp_event_loop_instance_t* loop, esp_event_post_instance_t* post)
+{
+    bool exec = false;
+
+    esp_event_handler_node_t *handler, *temp_handler;
+    esp_event_loop_node_t *loop_node, *temp_node;
+    esp_event_base_node_t *base_node, *temp_base;
+    esp_event_id_node_t *id_node;
+
+    SLIST_FOREACH_SAFE(loop_node, &(loop->loop_nodes), next, temp_node) {
+        // Execute loop level handlers
+        SLIST_FOREACH_SAFE(handler, &(loop_node->handlers), next, temp_handler) {
+            handler_execute(loop, handler, *post);
+            exec |= true;
+        }
+
+        for (base_node = loop_node_find_base(loop_node, NULL, post->base); base_node; base_node = temp_base) {
+            // Look up the next matching base node before the handlers get a chance to unregister this one.
+            // A base node without id nodes is freed once its last base level handler unregisters itself.
+            temp_base = loop_node_find_base(loop_node, base_node, post->base);
+            bool has_id_nodes = !SLIST_EMPTY(&(base_node->id_nodes));
+
+            // Execute base level handlers
+            SLIST_FOREACH_SAFE(handler, &(base_node->handlers), next, temp_handler) {
+                handler_execute(loop, handler, *post);
+                exec |= true;
+            }
+
+            id_node = has_id_nodes ? base_node_find_id(base_node, post->id) : NULL;
+            if (id_node) {
+                // Execute id level handlers
+                SLIST_FOREACH_SAFE(handler, &(id_node->handlers), next, temp_handler) {
+                    handler_execute(loop, handler, *post);
+                    exec |= true;
+                }
+            }
+        }
+    }
+
+    if (!exec) {
+        // No handlers were registered, not even loop/base level handlers
+        ESP_LOGD(TAG, "no handlers have been registered for event %s:%"PRIu32" posted to loop %p", post->base, post->id, loop);
+    }
+}
+
 static esp_err_t handler_instances_add(esp_event_handler_nodes_t* handlers, esp_event_handler_t event_handler, void* event_handler_arg, esp_event_handler_instance_context_t **handler_ctx, bool legacy)
 {
     esp_event_handler_node_t *handler_instance = calloc(1, sizeof(*handler_instance));
@@ -249,6 +454,7 @@ static esp_err_t base_node_add_handler(esp_event_base_node_t* base_node,
                 } else {
                     SLIST_INSERT_AFTER(last_id_node, id_node, next);
                 }
+                id_index_add(base_node, id_node);
             } else {
                 free(id_node);
             }
@@ -305,6 +511,7 @@ static esp_err_t loop_node_add_handler(esp_event_loop_node_t* loop_node,
                 } else {
                     SLIST_INSERT_AFTER(last_base_node, base_node, next);
                 }
+                base_index_add(loop_node, base_node);
             } else {
                 free(base_node);
             }
@@ -354,6 +561,7 @@ static esp_err_t base_node_remove_handler(esp_event_base_node_t* base_node, int3
                 if (res == ESP_OK) {
                     if (SLIST_EMPTY(&(it->handlers))) {
                         SLIST_REMOVE(&(base_node->id_nodes), it, esp_event_id_node, next);
+                        id_index_remove(base_node, it);
                         free(it);
                         return ESP_OK;
                     }
@@ -378,6 +586,8 @@ static esp_err_t loop_node_remove_handler(esp_event_loop_node_t* loop_node, esp_
                 if (res == ESP_OK) {
                     if (SLIST_EMPTY(&(it->handlers)) && SLIST_EMPTY(&(it->id_nodes))) {
                         SLIST_REMOVE(&(loop_node->base_nodes), it, esp_event_base_node, next);
+                        base_index_remove(loop_node, it);
+                        free(it->id_buckets);
                         free(it);
                         return ESP_OK;
                     }
@@ -409,6 +619,10 @@ static void base_node_remove_all_handler(esp_event_base_node_t* base_node)
         SLIST_REMOVE(&(base_node->id_nodes), it, esp_event_id_node, next);
         free(it);
     }
+
+    free(base_node->id_buckets);
+    base_node->id_buckets = NULL;
+    base_node->id_node_count = 0;
 }
 
 static void loop_node_remove_all_handler(esp_event_loop_node_t* loop_node)
@@ -421,22 +635,111 @@ static void loop_node_remove_all_handler(esp_event_loop_node_t* loop_node)
         SLIST_REMOVE(&(loop_node->base_nodes), it, esp_event_base_node, next);
         free(it);
     }
+
+    free(loop_node->base_buckets);
+    loop_node->base_buckets = NULL;
+    loop_node->base_node_count = 0;
 }
 
-static void inline __attribute__((always_inline)) post_instance_delete(esp_event_post_instance_t* post)
+static esp_err_t payload_pool_create(esp_event_loop_instance_t* loop, uint32_t slot_count, uint32_t slot_size)
 {
-#if CONFIG_ESP_EVENT_POST_FROM_ISR
-    if (post->data_allocated && post->data.ptr) {
-        free(post->data.ptr);
+    // Each free slot holds the pointer to the next free one, keep the slots aligned for it
+    slot_size = (slot_size + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+
+    loop->payload_pool = calloc(slot_count, slot_size);
+    if (loop->payload_pool == NULL) {
+        return ESP_ERR_NO_MEM;
     }
-#else
-    if (post->data) {
-        free(post->data);
+
+    loop->payload_pool_slot_size = slot_size;
+    loop->payload_pool_free = NULL;
+    for (uint32_t i = slot_count; i > 0; i--) {
+        void* slot = loop->payload_pool + (i - 1) * slot_size;
+        *(void**) slot = loop->payload_pool_free;
+        loop->payload_pool_free = slot;
+    }
+
+    portMUX_INITIALIZE(&(loop->payload_pool_spinlock));
+
+    return ESP_OK;
+}
+
+static void* payload_pool_get(esp_event_loop_instance_t* loop)
+{
+    portENTER_CRITICAL(&(loop->payload_pool_spinlock));
+    void* slot = loop->payload_pool_free;
+    if (slot) {
+        loop->payload_pool_free = *(void**) slot;
+    }
+    portEXIT_CRITICAL(&(loop->payload_pool_spinlock));
+
+    return slot;
+}
+
+static void payload_pool_put(esp_event_loop_instance_t* loop, void* slot)
+{
+    portENTER_CRITICAL(&(loop->payload_pool_spinlock));
+    *(void**) slot = loop->payload_pool_free;
+    loop->payload_pool_free = slot;
+    portEXIT_CRITICAL(&(loop->payload_pool_spinlock));
+}
+
+static void inline __attribute__((always_inline)) post_instance_delete(esp_event_loop_instance_t* loop, esp_event_post_instance_t* post)
+{
+    if (post->data_location == ESP_EVENT_POST_DATA_HEAP) {
+        free(post->data.ptr);
+    } else if (post->data_location == ESP_EVENT_POST_DATA_POOL) {
+        payload_pool_put(loop, post->data.ptr);
     }
-#endif
     memset(post, 0, sizeof(*post));
 }
 
+// Prepares the post instance of an event, copying its data
+static esp_err_t post_instance_init(esp_event_loop_instance_t* loop, esp_event_base_t event_base, int32_t event_id,
+                                   const void* event_data, size_t event_data_size, esp_event_post_instance_t* post)
+{
+    memset((void*) post, 0, sizeof(*post));
+
+    if (event_data != NULL && event_data_size != 0) {
+        if (event_data_size <= sizeof(post->data)) {
+            // Small event data travels through the queue with the event
+            memcpy(&(post->data), event_data, event_data_size);
+            post->data_location = ESP_EVENT_POST_DATA_INLINE;
+        } else {
+            void* event_data_copy = NULL;
+
+            if (loop->payload_pool != NULL) {
+                if (event_data_size <= loop->payload_pool_slot_size) {
+                    event_data_copy = payload_pool_get(loop);
+                }
+#ifdef CONFIG_ESP_EVENT_LOOP_PROFILING
+                atomic_fetch_add(event_data_copy ? &loop->payload_pool_hits : &loop->payload_pool_misses, 1);
+#endif
+            }
+
+            if (event_data_copy != NULL) {
+                post->data_location = ESP_EVENT_POST_DATA_POOL;
+            } else {
+                // Make persistent copy of event data on heap.
+                event_data_copy = malloc(event_data_size);
+
+                if (event_data_copy == NULL) {
+                    return ESP_ERR_NO_MEM;
+                }
+
+                post->data_location = ESP_EVENT_POST_DATA_HEAP;
+            }
+
+            memcpy(event_data_copy, event_data, event_data_size);
+            post->data.ptr = event_data_copy;
+        }
+    }
+    post->base = event_base;
+    post->id = event_id;
+
+    return ESP_OK;
+}
+
 /* ---------------------------- Public API --------------------------------- */
 
 esp_err_t esp_event_loop_create(const esp_event_loop_args_t* event_loop_args, esp_event_loop_handle_t* event_loop)
@@ -472,6 +775,19 @@ esp_err_t esp_event_loop_create(const esp_event_loop_args_t* event_loop_args, es
         goto on_err;
     }
 
+    if (event_loop_args->payload_pool_size > 0) {
+        if (event_loop_args->payload_pool_slot_size == 0) {
+            ESP_LOGE(TAG, "payload pool slot size was 0");
+            err = ESP_ERR_INVALID_ARG;
+            goto on_err;
+        }
+
+        if (payload_pool_create(loop, event_loop_args->payload_pool_size, event_loop_args->payload_pool_slot_size) != ESP_OK) {
+            ESP_LOGE(TAG, "alloc for payload pool failed");
+            goto on_err;
+        }
+    }
+
 #ifdef CONFIG_ESP_EVENT_LOOP_PROFILING
     loop->profiling_mutex = xSemaphoreCreateMutex();
     if (loop->profiling_mutex == NULL) {
@@ -482,6 +798,8 @@ esp_err_t esp_event_loop_create(const esp_event_loop_args_t* event_loop_args, es
 
     SLIST_INIT(&(loop->loop_nodes));
 
+    loop->dispatch_batch_size = event_loop_args->dispatch_batch_size > 1 ? event_loop_args->dispatch_batch_size : 1;
+
     // Create the loop task if requested
     if (event_loop_args->task_name != NULL) {
         BaseType_t task_created = xTaskCreatePinnedToCore(esp_event_loop_run_task, event_loop_args->task_name,
@@ -525,6 +843,8 @@ on_err:
         vSemaphoreDelete(loop->mutex);
     }
 
+    free(loop->payload_pool);
+
 #ifdef CONFIG_ESP_EVENT_LOOP_PROFILING
     if (loop->profiling_mutex != NULL) {
         vSemaphoreDelete(loop->profiling_mutex);
@@ -536,12 +856,12 @@ on_err:
     return err;
 }
 
-// On event lookup performance: The library implements the event list as a linked list, which results to O(n)
-// lookup time. The test comparing this implementation to the O(lg n) performance of rbtrees
-// (https://github.com/freebsd/freebsd/blob/master/sys/sys/tree.h)
-// indicate that the difference is not that substantial, especially considering the additional
-// pointers per node of rbtrees. Code for the rbtree implementation of the event loop library is archived
-// in feature/esp_event_loop_library_rbtrees if needed.
+// On event lookup performance: The library keeps the registered handlers in linked lists, so that handlers
+// are executed in registration order (loop level, then base level, then id level handlers). Once a loop node
+// has more than INDEX_MIN_NODES base nodes, or a base node more than INDEX_MIN_NODES id nodes, the list gets
+// a hash table, which is kept up to date on registration and unregistration. Dispatching an event then only
+// visits the base nodes and id node matching the event instead of walking the lists. Short lists are still
+// searched linearly, which is faster than hashing for a handful of nodes and needs no additional memory.
 esp_err_t esp_event_loop_run(esp_event_loop_handle_t event_loop, TickType_t ticks_to_run)
 {
     assert(event_loop);
@@ -563,47 +883,15 @@ esp_err_t esp_event_loop_run(esp_event_loop_handle_t event_loop, TickType_t tick
 
         loop->running_task = xTaskGetCurrentTaskHandle();
 
-        bool exec = false;
+        // Events queued in the meantime are dispatched under the same mutex hold, up to the batch size of the loop
+        uint32_t dispatched = 0;
 
-        esp_event_handler_node_t *handler, *temp_handler;
-        esp_event_loop_node_t *loop_node, *temp_node;
-        esp_event_base_node_t *base_node, *temp_base;
-        esp_event_id_node_t *id_node, *temp_id_node;
+        do {
+            loop_dispatch(loop, &post);
 
-        SLIST_FOREACH_SAFE(loop_node, &(loop->loop_nodes), next, temp_node) {
-            // Execute loop level handlers
-            SLIST_FOREACH_SAFE(handler, &(loop_node->handlers), next, temp_handler) {
-                handler_execute(loop, handler, post);
-                exec |= true;
-            }
-
-            SLIST_FOREACH_SAFE(base_node, &(loop_node->base_nodes), next, temp_base) {
-                if (base_node->base == post.base) {
-                    // Execute base level handlers
-                    SLIST_FOREACH_SAFE(handler, &(base_node->handlers), next, temp_handler) {
-                        handler_execute(loop, handler, post);
-                        exec |= true;
-                    }
-
-                    SLIST_FOREACH_SAFE(id_node, &(base_node->id_nodes), next, temp_id_node) {
-                        if (id_node->id == post.id) {
-                            // Execute id level handlers
-                            SLIST_FOREACH_SAFE(handler, &(id_node->handlers), next, temp_handler) {
-                                handler_execute(loop, handler, post);
-                                exec |= true;
-                            }
-                            // Skip to next base node
-                            break;
-                        }
-                    }
-                }
-            }
-        }
-
-        esp_event_base_t base = post.base;
-        int32_t id = post.id;
-
-        post_instance_delete(&post);
+            post_instance_delete(loop, &post);
+            dispatched++;
+        } while (dispatched < loop->dispatch_batch_size && xQueueReceive(loop->queue, &post, 0) == pdTRUE);
 
         if (ticks_to_run != portMAX_DELAY) {
             end = xTaskGetTickCount();
@@ -620,11 +908,6 @@ esp_err_t esp_event_loop_run(esp_event_loop_handle_t event_loop, TickType_t tick
         loop->running_task = NULL;
 
         xSemaphoreGiveRecursive(loop->mutex);
-
-        if (!exec) {
-            // No handlers were registered, not even loop/base level handlers
-            ESP_LOGD(TAG, "no handlers have been registered for event %s:%"PRIu32" posted to loop %p", base, id, event_loop);
-        }
     }
 
     return ESP_OK;
@@ -666,11 +949,12 @@ esp_err_t esp_event_loop_delete(esp_event_loop_handle_t event_loop)
     // Drop existing posts on the queue
     esp_event_post_instance_t post;
     while (xQueueReceive(loop->queue, &post, 0) == pdTRUE) {
-        post_instance_delete(&post);
+        post_instance_delete(loop, &post);
     }
 
     // Cleanup loop
     vQueueDelete(loop->queue);
+    free(loop->payload_pool);
     free(loop);
     // Free loop mutex before deleting
     xSemaphoreGiveRecursive(loop_mutex);
@@ -785,6 +1069,7 @@ esp_err_t esp_event_handler_unregister_with_internal(esp_event_loop_handle_t eve
 
         if (res == ESP_OK && SLIST_EMPTY(&(it->base_nodes)) && SLIST_EMPTY(&(it->handlers))) {
             SLIST_REMOVE(&(loop->loop_nodes), it, esp_event_loop_node, next);
+            free(it->base_buckets);
             free(it);
             break;
         }
@@ -827,27 +1112,10 @@ esp_err_t esp_event_post_to(esp_event_loop_handle_t event_loop, esp_event_base_t
     esp_event_loop_instance_t* loop = (esp_event_loop_instance_t*) event_loop;
 
     esp_event_post_instance_t post;
-    memset((void*)(&post), 0, sizeof(post));
-
-    if (event_data != NULL && event_data_size != 0) {
-        // Make persistent copy of event data on heap.
-        void* event_data_copy = calloc(1, event_data_size);
-
-        if (event_data_copy == NULL) {
-            return ESP_ERR_NO_MEM;
-        }
-
-        memcpy(event_data_copy, event_data, event_data_size);
-#if CONFIG_ESP_EVENT_POST_FROM_ISR
-        post.data.ptr = event_data_copy;
-        post.data_allocated = true;
-        post.data_set = true;
-#else
-        post.data = event_data_copy;
-#endif
+    esp_err_t err = post_instance_init(loop, event_base, event_id, event_data, event_data_size, &post);
+    if (err != ESP_OK) {
+        return err;
     }
-    post.base = event_base;
-    post.id = event_id;
 
     BaseType_t result = pdFALSE;
 
@@ -876,7 +1144,7 @@ esp_err_t esp_event_post_to(esp_event_loop_handle_t event_loop, esp_event_base_t
     }
 
     if (result != pdTRUE) {
-        post_instance_delete(&post);
+        post_instance_delete(loop, &post);
 
 #ifdef CONFIG_ESP_EVENT_LOOP_PROFILING
         atomic_fetch_add(&loop->events_dropped, 1);
@@ -891,6 +1159,90 @@ esp_err_t esp_event_post_to(esp_event_loop_handle_t event_loop, esp_event_base_t
     return ESP_OK;
 }
 
+esp_err_t esp_event_post_batch_to(esp_event_loop_handle_t event_loop, const esp_event_post_batch_item_t* events,
+                                  size_t event_count, size_t* posted_count, TickType_t ticks_to_wait)
+{
+    assert(event_loop);
+
+    if (posted_count) {
+        *posted_count = 0;
+    }
+
+    if (events == NULL && event_count != 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    for (size_t i = 0; i < event_count; i++) {
+        if (events[i].event_base == ESP_EVENT_ANY_BASE || events[i].event_id == ESP_EVENT_ANY_ID) {
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+
+    esp_event_loop_instance_t* loop = (esp_event_loop_instance_t*) event_loop;
+
+    // Find out once for all events whether they are posted from the task running the loop, which must not
+    // block on a full queue. See esp_event_post_to.
+    TickType_t queue_ticks = ticks_to_wait;
+
+    if (loop->task == NULL) {
+        if (xSemaphoreTakeRecursive(loop->mutex, ticks_to_wait) != pdTRUE) {
+#ifdef CONFIG_ESP_EVENT_LOOP_PROFILING
+            atomic_fetch_add(&loop->events_dropped, 1);
+#endif
+            return ESP_ERR_TIMEOUT;
+        }
+
+        if (loop->running_task == xTaskGetCurrentTaskHandle()) {
+            queue_ticks = 0;
+        }
+
+        xSemaphoreGiveRecursive(loop->mutex);
+    } else if (loop->task == xTaskGetCurrentTaskHandle()) {
+        queue_ticks = 0;
+    }
+
+    TickType_t start = xTaskGetTickCount();
+    esp_err_t err = ESP_OK;
+    size_t posted = 0;
+
+    for (; posted < event_count; posted++) {
+        const esp_event_post_batch_item_t* event = &events[posted];
+        esp_event_post_instance_t post;
+
+        err = post_instance_init(loop, event->event_base, event->event_id, event->event_data, event->event_data_size, &post);
+        if (err != ESP_OK) {
+            break;
+        }
+
+        // ticks_to_wait limits the time for posting all events
+        TickType_t remaining_ticks = queue_ticks;
+        if (queue_ticks != 0 && queue_ticks != portMAX_DELAY) {
+            TickType_t elapsed = xTaskGetTickCount() - start;
+            remaining_ticks = elapsed < queue_ticks ? queue_ticks - elapsed : 0;
+        }
+
+        if (xQueueSendToBack(loop->queue, &post, remaining_ticks) != pdTRUE) {
+            post_instance_delete(loop, &post);
+
+#ifdef CONFIG_ESP_EVENT_LOOP_PROFILING
+            atomic_fetch_add(&loop->events_dropped, 1);
+#endif
+            err = ESP_ERR_TIMEOUT;
+            break;
+        }
+
+#ifdef CONFIG_ESP_EVENT_LOOP_PROFILING
+        atomic_fetch_add(&loop->events_recieved, 1);
+#endif
+    }
+
+    if (posted_count) {
+        *posted_count = posted;
+    }
+
+    return err;
+}
+
 #if CONFIG_ESP_EVENT_POST_FROM_ISR
 esp_err_t esp_event_isr_post_to(esp_event_loop_handle_t event_loop, esp_event_base_t event_base, int32_t event_id,
                                 const void* event_data, size_t event_data_size, BaseType_t* task_unblocked)
@@ -912,8 +1264,7 @@ esp_err_t esp_event_isr_post_to(esp_event_loop_handle_t event_loop, esp_event_ba
 
     if (event_data != NULL && event_data_size != 0) {
         memcpy((void*)(&(post.data.val)), event_data, event_data_size);
-        post.data_allocated = false;
-        post.data_set = true;
+        post.data_location = ESP_EVENT_POST_DATA_INLINE;
     }
     post.base = event_base;
     post.id = event_id;
@@ -924,7 +1275,7 @@ esp_err_t esp_event_isr_post_to(esp_event_loop_handle_t event_loop, esp_event_ba
     result = xQueueSendToBackFromISR(loop->queue, &post, task_unblocked);
 
     if (result != pdTRUE) {
-        post_instance_delete(&post);
+        post_instance_delete(loop, &post);
 
 #ifdef CONFIG_ESP_EVENT_LOOP_PROFILING
         atomic_fetch_add(&loop->events_dropped, 1);
@@ -962,13 +1313,15 @@ esp_err_t esp_event_dump(FILE* file)
     portENTER_CRITICAL(&s_event_loops_spinlock);
 
     SLIST_FOREACH(loop_it, &s_event_loops, next) {
-        uint32_t events_recieved, events_dropped;
+        uint32_t events_recieved, events_dropped, payload_pool_hits, payload_pool_misses;
 
         events_recieved = atomic_load(&loop_it->events_recieved);
         events_dropped = atomic_load(&loop_it->events_dropped);
+        payload_pool_hits = atomic_load(&loop_it->payload_pool_hits);
+        payload_pool_misses = atomic_load(&loop_it->payload_pool_misses);
 
         PRINT_DUMP_INFO(dst, sz, LOOP_DUMP_FORMAT, loop_it, loop_it->task != NULL ? loop_it->name : "none",
-                        events_recieved, events_dropped);
+                        events_recieved, events_dropped, payload_pool_hits, payload_pool_misses);
 
         int sz_bak = sz;
 
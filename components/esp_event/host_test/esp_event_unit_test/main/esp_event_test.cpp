@@ -8,15 +8,20 @@
 */
 
 #include <stdio.h>
+#include <string>
+#include <vector>
 #include "esp_event.h"
 
 #include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
 
 #include "fixtures.hpp"
 
 extern "C" {
 #include "Mocktask.h"
 #include "Mockqueue.h"
+#include "Mockportmacro.h"
 }
 
 namespace {
@@ -40,6 +45,104 @@ static esp_event_loop_args_t test_event_get_default_loop_args(void)
 
 void dummy_handler(void* event_handler_arg, esp_event_base_t event_base, int32_t event_id, void* event_data) { }
 
+ESP_EVENT_DEFINE_BASE(TEST_BASE_A);
+ESP_EVENT_DEFINE_BASE(TEST_BASE_B);
+
+// Distinct event bases for registering many of them
+const size_t MAX_TEST_BASES = 64;
+char s_test_bases[MAX_TEST_BASES][8];
+
+std::string s_order;
+
+void order_handler(void* event_handler_arg, esp_event_base_t event_base, int32_t event_id, void* event_data)
+{
+    s_order += static_cast<char>(reinterpret_cast<intptr_t>(event_handler_arg));
+}
+
+esp_event_loop_handle_t s_self_unregister_loop;
+esp_event_handler_instance_t s_self_unregister_instance;
+
+void self_unregister_handler(void* event_handler_arg, esp_event_base_t event_base, int32_t event_id, void* event_data)
+{
+    order_handler(event_handler_arg, event_base, event_id, event_data);
+    esp_event_handler_instance_unregister_with(s_self_unregister_loop, event_base, ESP_EVENT_ANY_ID, s_self_unregister_instance);
+}
+
+/**
+ * Event loop without a dedicated task, running the events posted to it in the calling task.
+ */
+struct TestLoop {
+    TestLoop(uint32_t payload_pool_size = 0, uint32_t payload_pool_slot_size = 0) : sem(CreateAnd::IGNORE)
+    {
+        xQueueTakeMutexRecursive_IgnoreAndReturn(pdTRUE);
+        xQueueGiveMutexRecursive_IgnoreAndReturn(pdTRUE);
+        xTaskGetCurrentTaskHandle_IgnoreAndReturn(nullptr);
+        xTaskGetTickCount_IgnoreAndReturn(0);
+        vPortEnterCritical_Ignore();
+        vPortExitCritical_Ignore();
+
+        for (size_t i = 0; i < MAX_TEST_BASES; i++) {
+            snprintf(s_test_bases[i], sizeof(s_test_bases[i]), "base%u", static_cast<unsigned>(i));
+        }
+
+        esp_event_loop_args_t loop_args = test_event_get_default_loop_args();
+        loop_args.task_name = nullptr;
+        loop_args.payload_pool_size = payload_pool_size;
+        loop_args.payload_pool_slot_size = payload_pool_slot_size;
+        REQUIRE(esp_event_loop_create(&loop_args, &loop) == ESP_OK);
+    }
+
+    ~TestLoop()
+    {
+        CHECK(esp_event_loop_delete(loop) == ESP_OK);
+
+        vPortExitCritical_StopIgnore();
+        vPortEnterCritical_StopIgnore();
+        xTaskGetTickCount_StopIgnore();
+        xTaskGetCurrentTaskHandle_StopIgnore();
+        xQueueGiveMutexRecursive_StopIgnore();
+        xQueueTakeMutexRecursive_StopIgnore();
+    }
+
+    std::string run(esp_event_base_t base, int32_t id)
+    {
+        s_order.clear();
+        CHECK(esp_event_post_to(loop, base, id, nullptr, 0, 0) == ESP_OK);
+        CHECK(esp_event_loop_run(loop, portMAX_DELAY) == ESP_OK);
+        return s_order;
+    }
+
+    MockEventQueue queue;
+    MockMutex sem;
+    esp_event_loop_handle_t loop;
+};
+
+void register_order_handler(esp_event_loop_handle_t loop, esp_event_base_t base, int32_t id, char name)
+{
+    REQUIRE(esp_event_handler_instance_register_with(loop, base, id, order_handler,
+                                                     reinterpret_cast<void*>(static_cast<intptr_t>(name)), nullptr) == ESP_OK);
+}
+
+void register_dummy_handlers(esp_event_loop_handle_t loop, size_t base_count, size_t id_count)
+{
+    for (size_t i = 0; i < base_count; i++) {
+        REQUIRE(esp_event_handler_register_with(loop, s_test_bases[i], 0, dummy_handler, nullptr) == ESP_OK);
+    }
+    for (size_t i = 0; i < id_count; i++) {
+        REQUIRE(esp_event_handler_register_with(loop, TEST_BASE_A, 1000 + i, dummy_handler, nullptr) == ESP_OK);
+    }
+}
+
+void unregister_dummy_handlers(esp_event_loop_handle_t loop, size_t base_count, size_t id_count)
+{
+    for (size_t i = 0; i < base_count; i++) {
+        REQUIRE(esp_event_handler_unregister_with(loop, s_test_bases[i], 0, dummy_handler) == ESP_OK);
+    }
+    for (size_t i = 0; i < id_count; i++) {
+        REQUIRE(esp_event_handler_unregister_with(loop, TEST_BASE_A, 1000 + i, dummy_handler) == ESP_OK);
+    }
+}
+
 }
 
 // TODO: IDF-2693, function definition just to satisfy linker, implement esp_common instead
@@ -149,3 +252,99 @@ TEST_CASE("registering with ANY_BASE but specific ID fails")
                                           dummy_handler,
                                           nullptr) == ESP_ERR_INVALID_ARG);
 }
+
+TEST_CASE("handlers are executed in registration order, loop level before base level before id level")
+{
+    // Registering many bases and ids makes the loop look them up by hash, few of them by walking the lists
+    const size_t filler_count = GENERATE(0, 40);
+    TestLoop test;
+
+    register_dummy_handlers(test.loop, filler_count, filler_count);
+
+    register_order_handler(test.loop, TEST_BASE_A, 5, 'a');
+    register_order_handler(test.loop, ESP_EVENT_ANY_BASE, ESP_EVENT_ANY_ID, 'L');
+    register_order_handler(test.loop, TEST_BASE_A, ESP_EVENT_ANY_ID, 'b');
+    register_order_handler(test.loop, TEST_BASE_B, 5, 'x');
+    register_order_handler(test.loop, TEST_BASE_A, 5, 'c');
+    s_self_unregister_loop = test.loop;
+    REQUIRE(esp_event_handler_instance_register_with(test.loop, TEST_BASE_A, ESP_EVENT_ANY_ID, self_unregister_handler,
+                                                     reinterpret_cast<void*>(static_cast<intptr_t>('s')), &s_self_unregister_instance) == ESP_OK);
+    register_order_handler(test.loop, ESP_EVENT_ANY_BASE, ESP_EVENT_ANY_ID, 'M');
+    register_order_handler(test.loop, TEST_BASE_A, 5, 'd');
+
+    CHECK(test.run(TEST_BASE_A, 5) == "aLbcsMd");
+    CHECK(test.run(TEST_BASE_A, 5) == "aLbcMd");
+    CHECK(test.run(TEST_BASE_A, 6) == "LbM");
+    CHECK(test.run(TEST_BASE_B, 5) == "LxM");
+    CHECK(test.run(TEST_BASE_B, 6) == "LM");
+
+    unregister_dummy_handlers(test.loop, filler_count, filler_count);
+
+    CHECK(test.run(TEST_BASE_A, 5) == "aLbcMd");
+    CHECK(test.run(TEST_BASE_B, 5) == "LxM");
+}
+
+TEST_CASE("event data is passed to the handlers from inline storage, the payload pool and heap")
+{
+    // Two pool slots of 16 bytes; the events aren't dispatched before all of them are posted
+    TestLoop test(2, 16);
+    std::vector<std::vector<uint8_t> > posted;
+    for (size_t size : {1, 4, 16, 16, 16, 17, 100}) {
+        std::vector<uint8_t> data(size);
+        for (size_t i = 0; i < size; i++) {
+            data[i] = static_cast<uint8_t>(size + i);
+        }
+        CHECK(esp_event_post_to(test.loop, TEST_BASE_A, static_cast<int32_t>(size), data.data(), data.size(), 0) == ESP_OK);
+        posted.push_back(data);
+    }
+
+    std::vector<std::vector<uint8_t> > received;
+    esp_event_handler_t check_handler = [](void* arg, esp_event_base_t base, int32_t id, void* data) {
+        const uint8_t *bytes = static_cast<const uint8_t*>(data);
+        static_cast<std::vector<std::vector<uint8_t> >*>(arg)->emplace_back(bytes, bytes + id);
+    };
+    REQUIRE(esp_event_handler_register_with(test.loop, TEST_BASE_A, ESP_EVENT_ANY_ID, check_handler, &received) == ESP_OK);
+    CHECK(esp_event_loop_run(test.loop, portMAX_DELAY) == ESP_OK);
+    CHECK(received == posted);
+
+    // The pool slots have been returned
+    received.clear();
+    CHECK(esp_event_post_to(test.loop, TEST_BASE_A, 16, posted[2].data(), 16, 0) == ESP_OK);
+    CHECK(esp_event_post_to(test.loop, TEST_BASE_A, 16, posted[3].data(), 16, 0) == ESP_OK);
+    CHECK(esp_event_loop_run(test.loop, portMAX_DELAY) == ESP_OK);
+    const std::vector<std::vector<uint8_t> > expected = {posted[2], posted[3]};
+    CHECK(received == expected);
+}
+
+TEST_CASE("creating a loop with a payload pool of slot size 0 fails")
+{
+    MockQueue queue(CreateAnd::IGNORE);
+    MockMutex sem(CreateAnd::IGNORE);
+    esp_event_loop_handle_t loop;
+
+    esp_event_loop_args_t loop_args = test_event_get_default_loop_args();
+    loop_args.task_name = nullptr;
+    loop_args.payload_pool_size = 4;
+
+    CHECK(ESP_ERR_INVALID_ARG == esp_event_loop_create(&loop_args, &loop));
+}
+
+TEST_CASE("dispatch time for varying handler counts", "[.][benchmark]")
+{
+    // The posted event has one handler, registered after the other ones to other ids and bases of the loop
+    const size_t handler_count = GENERATE(10, 100, 1000);
+    TestLoop test;
+
+    for (size_t i = 1; i < handler_count; i++) {
+        if (i % 2) {
+            REQUIRE(esp_event_handler_register_with(test.loop, TEST_BASE_B, 1000 + i, dummy_handler, nullptr) == ESP_OK);
+        } else {
+            REQUIRE(esp_event_handler_register_with(test.loop, s_test_bases[i % MAX_TEST_BASES], i, dummy_handler, nullptr) == ESP_OK);
+        }
+    }
+    register_order_handler(test.loop, TEST_BASE_B, 5, 'x');
+
+    BENCHMARK("post and dispatch, " + std::to_string(handler_count) + " handlers") {
+        return test.run(TEST_BASE_B, 5);
+    };
+}
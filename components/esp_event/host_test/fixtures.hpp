@@ -7,6 +7,9 @@
    CONDITIONS OF ANY KIND, either express or implied.
 */
 
+#include <cstring>
+#include <deque>
+#include <vector>
 #include "esp_event.h"
 
 #include <catch2/catch_test_macros.hpp>
@@ -147,3 +150,56 @@ struct MockTask : public CMockFix {
 
     TaskHandle_t task;
 };
+
+/**
+ * Queue mock which actually queues the posted events, so that an event loop without a dedicated task
+ * can dispatch them with esp_event_loop_run(). Only one instance may exist at a time.
+ */
+struct MockEventQueue : public CMockFix {
+    MockEventQueue() : queue(reinterpret_cast<QueueHandle_t>(0xdeadbeef))
+    {
+        items.clear();
+        item_size = 0;
+        xQueueGenericCreate_Stub(create);
+        xQueueGenericSend_Stub(send);
+        xQueueReceive_Stub(receive);
+        vQueueDelete_Ignore();
+    }
+
+    ~MockEventQueue()
+    {
+        xQueueGenericCreate_Stub(nullptr);
+        xQueueGenericSend_Stub(nullptr);
+        xQueueReceive_Stub(nullptr);
+        vQueueDelete_StopIgnore();
+    }
+
+    static QueueHandle_t create(UBaseType_t queue_length, UBaseType_t size, uint8_t queue_type, int num_calls)
+    {
+        item_size = size;
+        return reinterpret_cast<QueueHandle_t>(0xdeadbeef);
+    }
+
+    static BaseType_t send(QueueHandle_t queue, const void *item, TickType_t ticks, BaseType_t position, int num_calls)
+    {
+        const uint8_t *bytes = static_cast<const uint8_t*>(item);
+        items.emplace_back(bytes, bytes + item_size);
+        return pdTRUE;
+    }
+
+    static BaseType_t receive(QueueHandle_t queue, void *buffer, TickType_t ticks, int num_calls)
+    {
+        // An empty queue returns immediately instead of blocking, which ends esp_event_loop_run()
+        if (items.empty()) {
+            return pdFALSE;
+        }
+        memcpy(buffer, items.front().data(), item_size);
+        items.pop_front();
+        return pdTRUE;
+    }
+
+    QueueHandle_t queue;
+
+    static inline size_t item_size;
+    static inline std::deque<std::vector<uint8_t> > items;
+};
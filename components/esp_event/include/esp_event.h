@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2018-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2018-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -29,8 +29,27 @@ typedef struct {
     uint32_t task_stack_size;                   /**< stack size of the event loop task, ignored if task name is NULL */
     BaseType_t task_core_id;                    /**< core to which the event loop task is pinned to,
                                                         ignored if task name is NULL */
+    uint32_t payload_pool_size;                 /**< number of slots of the payload pool, which stores event data
+                                                        too large for the event queue instead of heap;
+                                                        0 (default) for no payload pool */
+    uint32_t payload_pool_slot_size;            /**< size of a slot of the payload pool, larger event data is
+                                                        allocated from heap; ignored if payload_pool_size is 0 */
+    uint32_t dispatch_batch_size;               /**< maximum number of queued events dispatched in a row without
+                                                        releasing the loop to registering and posting tasks;
+                                                        0 (default) or 1 dispatches one event at a time. The
+                                                        ticks_to_run of esp_event_loop_run are checked after
+                                                        each batch */
 } esp_event_loop_args_t;
 
+/// Event posted with esp_event_post_batch_to
+typedef struct {
+    esp_event_base_t event_base;                /**< the event base that identifies the event */
+    int32_t event_id;                           /**< the event ID that identifies the event */
+    const void *event_data;                     /**< the data, specific to the event occurrence, that gets passed
+                                                        to the handler */
+    size_t event_data_size;                     /**< the size of the event data */
+} esp_event_post_batch_item_t;
+
 /**
  * @brief Create a new event loop.
  *
@@ -39,8 +58,9 @@ typedef struct {
  *
  * @return
  *  - ESP_OK: Success
- *  - ESP_ERR_INVALID_ARG: event_loop_args or event_loop was NULL
- *  - ESP_ERR_NO_MEM: Cannot allocate memory for event loops list
+ *  - ESP_ERR_INVALID_ARG: event_loop_args or event_loop was NULL, or payload_pool_slot_size was 0
+ *                          for a loop with a payload pool
+ *  - ESP_ERR_NO_MEM: Cannot allocate memory for event loops list or the payload pool
  *  - ESP_FAIL: Failed to create task loop
  *  - Others: Fail
  */
@@ -395,6 +415,48 @@ esp_err_t esp_event_post_to(esp_event_loop_handle_t event_loop,
                             size_t event_data_size,
                             TickType_t ticks_to_wait);
 
+/**
+ * @brief Posts several events to the system default event loop.
+ *
+ * @see esp_event_post_batch_to
+ *
+ * @return
+ *  - ESP_OK: Success
+ *  - ESP_ERR_INVALID_STATE: Default event loop has not been created
+ *  - Others: see esp_event_post_batch_to
+ */
+esp_err_t esp_event_post_batch(const esp_event_post_batch_item_t *events,
+                               size_t event_count,
+                               size_t *posted_count,
+                               TickType_t ticks_to_wait);
+
+/**
+ * @brief Posts several events to an event loop in one call.
+ *
+ * The events are posted in the order of the array, as if by esp_event_post_to, but the checks which are
+ * common to all events are done only once. If an event can't be posted, the events following it aren't
+ * posted either.
+ *
+ * @param[in] event_loop the event loop to post to, must not be NULL
+ * @param[in] events the events to post
+ * @param[in] event_count the number of events
+ * @param[out] posted_count an optional parameter (can be NULL) which is set to the number of events
+ *                          posted, also if posting fails
+ * @param[in] ticks_to_wait number of ticks to block on a full event queue, for all events together
+ *
+ * @return
+ *  - ESP_OK: Success
+ *  - ESP_ERR_TIMEOUT: Time to wait for event queue to unblock expired
+ *  - ESP_ERR_INVALID_ARG: Invalid combination of event base and event ID in any of the events, nothing posted
+ *  - ESP_ERR_NO_MEM: Cannot allocate memory for event data
+ *  - Others: Fail
+ */
+esp_err_t esp_event_post_batch_to(esp_event_loop_handle_t event_loop,
+                                  const esp_event_post_batch_item_t *events,
+                                  size_t event_count,
+                                  size_t *posted_count,
+                                  TickType_t ticks_to_wait);
+
 #if CONFIG_ESP_EVENT_POST_FROM_ISR
 /**
  * @brief Special variant of esp_event_post for posting events from interrupt handlers.
@@ -473,12 +535,15 @@ esp_err_t esp_event_isr_post_to(esp_event_loop_handle_t event_loop,
   where:
 
    event loop
-       format: address,name rx:total_received dr:total_dropped
+       format: address,name rx:total_received dr:total_dropped ph:pool_hits pm:pool_misses
        where:
            address - memory address of the event loop
            name - name of the event loop, 'none' if no dedicated task
            total_received - number of successfully posted events
            total_dropped - number of events unsuccessfully posted due to queue being full
+           pool_hits - number of event data stored in the payload pool
+           pool_misses - number of event data allocated from heap although the loop has a payload pool,
+                         because the pool was full or the data larger than a pool slot
 
    handler
        format: address ev:base,id inv:total_invoked run:total_runtime
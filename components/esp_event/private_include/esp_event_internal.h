@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2018-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2018-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -41,6 +41,7 @@ typedef struct esp_event_id_node {
     esp_event_handler_nodes_t handlers;                             /**< list of handlers to be executed when
                                                                             this event is raised */
     SLIST_ENTRY(esp_event_id_node) next;                            /**< pointer to the next event node on the linked list */
+    struct esp_event_id_node* next_in_bucket;                       /**< next event node in the same bucket of id_buckets */
 } esp_event_id_node_t;
 
 typedef SLIST_HEAD(esp_event_id_nodes, esp_event_id_node) esp_event_id_nodes_t;
@@ -50,7 +51,13 @@ typedef struct esp_event_base_node {
     esp_event_handler_nodes_t handlers;                             /**< event base level handlers, handlers for
                                                                             all events with this base */
     esp_event_id_nodes_t id_nodes;                                  /**< list of event ids with this base */
+    struct esp_event_id_node** id_buckets;                          /**< hash table of id_nodes by id, NULL while
+                                                                            the list is short enough to be searched */
+    uint32_t id_node_count;                                         /**< number of nodes in id_nodes */
+    uint8_t id_bucket_bits;                                         /**< log2 of the number of buckets of id_buckets */
     SLIST_ENTRY(esp_event_base_node) next;                          /**< pointer to the next base node on the linked list */
+    struct esp_event_base_node* next_in_bucket;                     /**< next base node in the same bucket of base_buckets,
+                                                                            in the order of the linked list */
 } esp_event_base_node_t;
 
 typedef SLIST_HEAD(esp_event_base_nodes, esp_event_base_node) esp_event_base_nodes_t;
@@ -58,6 +65,10 @@ typedef SLIST_HEAD(esp_event_base_nodes, esp_event_base_node) esp_event_base_nod
 typedef struct esp_event_loop_node {
     esp_event_handler_nodes_t handlers;                             /** event loop level handlers */
     esp_event_base_nodes_t base_nodes;                              /** list of event bases registered to the loop */
+    struct esp_event_base_node** base_buckets;                      /** hash table of base_nodes by base, NULL while
+                                                                            the list is short enough to be searched */
+    uint32_t base_node_count;                                       /** number of nodes in base_nodes */
+    uint8_t base_bucket_bits;                                       /** log2 of the number of buckets of base_buckets */
     SLIST_ENTRY(esp_event_loop_node) next;                          /** pointer to the next loop node containing
                                                                             event loop level handlers and the rest of
                                                                             event bases registered to the loop */
@@ -75,29 +86,47 @@ typedef struct esp_event_loop_instance {
     SemaphoreHandle_t mutex;                                        /**< mutex for updating the events linked list */
     esp_event_loop_nodes_t loop_nodes;                              /**< set of linked lists containing the
                                                                             registered handlers for the loop */
+    uint8_t* payload_pool;                                          /**< slots for event data, NULL if the loop
+                                                                            has no payload pool */
+    void* payload_pool_free;                                        /**< first free slot of the payload pool, each
+                                                                            free slot starts with a pointer to the next one */
+    size_t payload_pool_slot_size;                                  /**< size of a slot of the payload pool */
+    portMUX_TYPE payload_pool_spinlock;                             /**< spinlock for the free slots of the payload pool */
+    uint32_t dispatch_batch_size;                                   /**< maximum number of events dispatched per hold
+                                                                            of mutex */
 #ifdef CONFIG_ESP_EVENT_LOOP_PROFILING
     atomic_uint_least32_t events_recieved;                          /**< number of events successfully posted to the loop */
     atomic_uint_least32_t events_dropped;                           /**< number of events dropped due to queue being full */
+    atomic_uint_least32_t payload_pool_hits;                        /**< number of event data stored in the payload pool */
+    atomic_uint_least32_t payload_pool_misses;                      /**< number of event data allocated from heap because
+                                                                            the payload pool was full or the data too large */
     SemaphoreHandle_t profiling_mutex;                              /**< mutex used for profiliing */
     SLIST_ENTRY(esp_event_loop_instance) next;                      /**< next event loop in the list */
 #endif
 } esp_event_loop_instance_t;
 
-#if CONFIG_ESP_EVENT_POST_FROM_ISR
+/// Size of event data stored in the event queue itself
+#define ESP_EVENT_POST_INLINE_DATA_SIZE CONFIG_ESP_EVENT_POST_INLINE_DATA_SIZE
+
+/// Storage of the data of a posted event
+typedef enum {
+    ESP_EVENT_POST_DATA_NONE = 0,                                    /**< no data */
+    ESP_EVENT_POST_DATA_INLINE,                                      /**< data is stored in esp_event_post_data_t */
+    ESP_EVENT_POST_DATA_POOL,                                        /**< data is stored in a payload pool slot of the loop */
+    ESP_EVENT_POST_DATA_HEAP,                                        /**< data is allocated from heap */
+} esp_event_post_data_location_t;
+
 typedef union esp_event_post_data {
-    uint32_t val;
-    void *ptr;
-} esp_event_post_data_t;
-#else
-typedef void* esp_event_post_data_t;
+#if CONFIG_ESP_EVENT_POST_FROM_ISR
+    uint32_t val;                                                    /**< data posted from an ISR */
 #endif
+    void *ptr;                                                       /**< data in a payload pool slot or on heap */
+    uint8_t bytes[ESP_EVENT_POST_INLINE_DATA_SIZE];                  /**< small data stored inline */
+} esp_event_post_data_t;
 
 /// Event posted to the event queue
 typedef struct esp_event_post_instance {
-#if CONFIG_ESP_EVENT_POST_FROM_ISR
-    bool data_allocated;                                             /**< indicates whether data is allocated from heap */
-    bool data_set;                                                   /**< indicates if data is null */
-#endif
+    uint8_t data_location;                                           /**< storage of data, esp_event_post_data_location_t */
     esp_event_base_t base;                                           /**< the event base */
     int32_t id;                                                      /**< the event id */
     esp_event_post_data_t data;                                      /**< data associated with the event */
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2023-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2023-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Unlicense OR CC0-1.0
  */
@@ -1532,6 +1532,160 @@ TEST_CASE("event data many bytes are copied on post", "[event][linux]")
     TEST_ASSERT_EQUAL_HEX8_ARRAY(ev_data_expected, saved_ev_data.event_data, EventData::MAX_SIZE);
 }
 
+struct EventLog {
+    constexpr static size_t MAX_EVENTS = 8;
+    size_t count;
+    int32_t ids[MAX_EVENTS];
+    uint8_t data[MAX_EVENTS];
+};
+
+static void log_event(void* handler_arg, esp_event_base_t base, int32_t id, void* event_data)
+{
+    EventLog *log = (EventLog *) handler_arg;
+    if (log->count < EventLog::MAX_EVENTS) {
+        log->ids[log->count] = id;
+        log->data[log->count] = event_data ? *(uint8_t*) event_data : 0;
+    }
+    log->count++;
+}
+
+TEST_CASE("can post batch of events", "[event][linux]")
+{
+    EV_LoopFix loop_fix;
+    EventLog log = {};
+    uint8_t data[3] = {47, 48, 49};
+    const esp_event_post_batch_item_t events[] = {
+        {s_test_base1, TEST_EVENT_BASE1_EV2, &data[0], sizeof(data[0])},
+        {s_test_base1, TEST_EVENT_BASE1_EV1, &data[1], sizeof(data[1])},
+        {s_test_base1, TEST_EVENT_BASE1_EV2, &data[2], sizeof(data[2])},
+    };
+    size_t posted_count;
+
+    TEST_ESP_OK(esp_event_handler_register_with(loop_fix.loop, s_test_base1, ESP_EVENT_ANY_ID, log_event, &log));
+
+    TEST_ESP_OK(esp_event_post_batch_to(loop_fix.loop, events, 3, &posted_count, portMAX_DELAY));
+    TEST_ASSERT_EQUAL(3, posted_count);
+    memset(data, 0, sizeof(data));
+    for (int i = 0; i < 3; i++) {
+        TEST_ESP_OK(esp_event_loop_run(loop_fix.loop, ZERO_DELAY));
+    }
+
+    TEST_ASSERT_EQUAL(3, log.count);
+    TEST_ASSERT_EQUAL(TEST_EVENT_BASE1_EV2, log.ids[0]);
+    TEST_ASSERT_EQUAL(TEST_EVENT_BASE1_EV1, log.ids[1]);
+    TEST_ASSERT_EQUAL(TEST_EVENT_BASE1_EV2, log.ids[2]);
+    TEST_ASSERT_EQUAL(47, log.data[0]);
+    TEST_ASSERT_EQUAL(48, log.data[1]);
+    TEST_ASSERT_EQUAL(49, log.data[2]);
+}
+
+TEST_CASE("posting batch with invalid event posts nothing", "[event][linux]")
+{
+    EV_LoopFix loop_fix;
+    EventLog log = {};
+    const esp_event_post_batch_item_t events[] = {
+        {s_test_base1, TEST_EVENT_BASE1_EV1, NULL, 0},
+        {s_test_base1, ESP_EVENT_ANY_ID, NULL, 0},
+    };
+    size_t posted_count;
+
+    TEST_ESP_OK(esp_event_handler_register_with(loop_fix.loop, ESP_EVENT_ANY_BASE, ESP_EVENT_ANY_ID, log_event, &log));
+
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, esp_event_post_batch_to(loop_fix.loop, events, 2, &posted_count, portMAX_DELAY));
+    TEST_ASSERT_EQUAL(0, posted_count);
+    TEST_ESP_OK(esp_event_loop_run(loop_fix.loop, ZERO_DELAY));
+
+    TEST_ASSERT_EQUAL(0, log.count);
+}
+
+TEST_CASE("posting batch to full event loop reports posted events", "[event][linux]")
+{
+    EV_LoopFix loop_fix(2);
+    const esp_event_post_batch_item_t events[] = {
+        {s_test_base1, TEST_EVENT_BASE1_EV1, NULL, 0},
+        {s_test_base1, TEST_EVENT_BASE1_EV1, NULL, 0},
+        {s_test_base1, TEST_EVENT_BASE1_EV1, NULL, 0},
+    };
+    size_t posted_count;
+
+    TEST_ASSERT_EQUAL(ESP_ERR_TIMEOUT, esp_event_post_batch_to(loop_fix.loop, events, 3, &posted_count, pdMS_TO_TICKS(10)));
+    TEST_ASSERT_EQUAL(2, posted_count);
+}
+
+TEST_CASE("loop with dispatch batch size dispatches all events in order", "[event][linux]")
+{
+    esp_event_loop_handle_t loop;
+    esp_event_loop_args_t loop_args = test_event_get_default_loop_args();
+    EventLog log = {};
+
+    loop_args.task_name = NULL;
+    loop_args.dispatch_batch_size = 4;
+    TEST_ESP_OK(esp_event_loop_create(&loop_args, &loop));
+
+    TEST_ESP_OK(esp_event_handler_register_with(loop, s_test_base1, ESP_EVENT_ANY_ID, log_event, &log));
+
+    for (uint8_t i = 0; i < 6; i++) {
+        TEST_ESP_OK(esp_event_post_to(loop, s_test_base1, i % 2, &i, sizeof(i), portMAX_DELAY));
+    }
+    // Each run dispatches at most one batch
+    TEST_ESP_OK(esp_event_loop_run(loop, ZERO_DELAY));
+    TEST_ASSERT_EQUAL(4, log.count);
+    TEST_ESP_OK(esp_event_loop_run(loop, ZERO_DELAY));
+
+    TEST_ASSERT_EQUAL(6, log.count);
+    for (uint8_t i = 0; i < 6; i++) {
+        TEST_ASSERT_EQUAL(i % 2, log.ids[i]);
+        TEST_ASSERT_EQUAL(i, log.data[i]);
+    }
+
+    TEST_ESP_OK(esp_event_loop_delete(loop));
+}
+
+static void test_event_throughput(const char *name, uint32_t dispatch_batch_size, size_t post_batch_size)
+{
+    const size_t EVENT_COUNT = 20000;
+    const size_t MAX_POST_BATCH_SIZE = 16;
+    esp_event_loop_handle_t loop;
+    esp_event_loop_args_t loop_args = test_event_get_default_loop_args();
+    esp_event_post_batch_item_t events[MAX_POST_BATCH_SIZE];
+    uint32_t data = 0;
+    int count = 0;
+
+    loop_args.queue_size = 64;
+    loop_args.dispatch_batch_size = dispatch_batch_size;
+    TEST_ESP_OK(esp_event_loop_create(&loop_args, &loop));
+    TEST_ESP_OK(esp_event_handler_register_with(loop, s_test_base1, TEST_EVENT_BASE1_EV1, test_handler_inc, &count));
+
+    for (size_t i = 0; i < post_batch_size; i++) {
+        events[i] = {s_test_base1, TEST_EVENT_BASE1_EV1, &data, sizeof(data)};
+    }
+
+    TickType_t start = xTaskGetTickCount();
+    for (size_t posted = 0; posted < EVENT_COUNT; posted += post_batch_size) {
+        if (post_batch_size == 1) {
+            TEST_ESP_OK(esp_event_post_to(loop, s_test_base1, TEST_EVENT_BASE1_EV1, &data, sizeof(data), portMAX_DELAY));
+        } else {
+            TEST_ESP_OK(esp_event_post_batch_to(loop, events, post_batch_size, NULL, portMAX_DELAY));
+        }
+    }
+    while (count < (int) EVENT_COUNT) {
+        vTaskDelay(1);
+    }
+    TickType_t ticks = xTaskGetTickCount() - start;
+
+    printf("%s: %u events/s\n", name, (unsigned) (EVENT_COUNT * configTICK_RATE_HZ / (ticks ? ticks : 1)));
+
+    TEST_ESP_OK(esp_event_loop_delete(loop));
+}
+
+TEST_CASE("event throughput with batch post and batch dispatch", "[event][linux][qemu-ignore]")
+{
+    test_event_throughput("single post, single dispatch", 1, 1);
+    test_event_throughput("single post, batch dispatch", 16, 1);
+    test_event_throughput("batch post, single dispatch", 1, 16);
+    test_event_throughput("batch post, batch dispatch", 16, 16);
+}
+
 TEST_CASE("default loop: registering fails on uninitialized default loop", "[event][default][linux]")
 {
     esp_event_handler_instance_t instance;
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2022-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Unlicense OR CC0-1.0
  */
@@ -647,6 +647,57 @@ TEST_CASE("performance test - no dedicated task", "[event][qemu-ignore]")
     performance_test(false);
 }
 
+TEST_CASE("data posted to a loop with a payload pool is correctly set internally", "[event]")
+{
+    esp_event_loop_handle_t loop;
+    esp_event_loop_args_t loop_args = test_event_get_default_loop_args();
+
+    loop_args.task_name = NULL;
+    loop_args.payload_pool_size = 2;
+    loop_args.payload_pool_slot_size = 32;
+    TEST_ESP_OK(esp_event_loop_create(&loop_args, &loop));
+
+    esp_event_post_instance_t post;
+    esp_event_loop_instance_t* loop_def = (esp_event_loop_instance_t*) loop;
+    uint8_t small[ESP_EVENT_POST_INLINE_DATA_SIZE] = { 1 };
+    uint8_t large[32] = { 2 };
+    uint8_t oversize[33] = { 3 };
+
+    TEST_ESP_OK(esp_event_post_to(loop, s_test_base1, TEST_EVENT_BASE1_EV1, small, sizeof(small), portMAX_DELAY));
+    TEST_ESP_OK(esp_event_post_to(loop, s_test_base1, TEST_EVENT_BASE1_EV1, large, sizeof(large), portMAX_DELAY));
+    TEST_ESP_OK(esp_event_post_to(loop, s_test_base1, TEST_EVENT_BASE1_EV1, large, sizeof(large), portMAX_DELAY));
+    // The pool has no free slot left
+    TEST_ESP_OK(esp_event_post_to(loop, s_test_base1, TEST_EVENT_BASE1_EV1, large, sizeof(large), portMAX_DELAY));
+    TEST_ESP_OK(esp_event_post_to(loop, s_test_base1, TEST_EVENT_BASE1_EV1, oversize, sizeof(oversize), portMAX_DELAY));
+
+    TEST_ASSERT_EQUAL(pdTRUE, xQueueReceive(loop_def->queue, &post, portMAX_DELAY));
+    TEST_ASSERT_EQUAL(ESP_EVENT_POST_DATA_INLINE, post.data_location);
+    TEST_ASSERT_EQUAL_MEMORY(small, &post.data, sizeof(small));
+
+    for (int i = 0; i < 2; i++) {
+        TEST_ASSERT_EQUAL(pdTRUE, xQueueReceive(loop_def->queue, &post, portMAX_DELAY));
+        TEST_ASSERT_EQUAL(ESP_EVENT_POST_DATA_POOL, post.data_location);
+        TEST_ASSERT_TRUE((uint8_t*) post.data.ptr >= loop_def->payload_pool);
+        TEST_ASSERT_TRUE((uint8_t*) post.data.ptr < loop_def->payload_pool + 2 * loop_def->payload_pool_slot_size);
+        TEST_ASSERT_EQUAL_MEMORY(large, post.data.ptr, sizeof(large));
+    }
+
+    TEST_ASSERT_EQUAL(pdTRUE, xQueueReceive(loop_def->queue, &post, portMAX_DELAY));
+    TEST_ASSERT_EQUAL(ESP_EVENT_POST_DATA_HEAP, post.data_location);
+    TEST_ASSERT_EQUAL_MEMORY(large, post.data.ptr, sizeof(large));
+    free(post.data.ptr);
+
+    TEST_ASSERT_EQUAL(pdTRUE, xQueueReceive(loop_def->queue, &post, portMAX_DELAY));
+    TEST_ASSERT_EQUAL(ESP_EVENT_POST_DATA_HEAP, post.data_location);
+    TEST_ASSERT_EQUAL_MEMORY(oversize, post.data.ptr, sizeof(oversize));
+    free(post.data.ptr);
+
+    // The pool slots of the received events are lost here, deleting the loop frees the whole pool
+    TEST_ESP_OK(esp_event_loop_delete(loop));
+
+    vTaskDelay(pdMS_TO_TICKS(TEST_CONFIG_TEARDOWN_WAIT));
+}
+
 #if CONFIG_ESP_EVENT_POST_FROM_ISR
 TEST_CASE("data posted normally is correctly set internally", "[event][intr]")
 {
@@ -661,8 +712,7 @@ TEST_CASE("data posted normally is correctly set internally", "[event][intr]")
 
     TEST_ESP_OK(esp_event_post_to(loop, s_test_base1, TEST_EVENT_BASE1_EV1, NULL, 0, portMAX_DELAY));
     TEST_ASSERT_EQUAL(pdTRUE, xQueueReceive(loop_def->queue, &post, portMAX_DELAY));
-    TEST_ASSERT_EQUAL(false, post.data_set);
-    TEST_ASSERT_EQUAL(false, post.data_allocated);
+    TEST_ASSERT_EQUAL(ESP_EVENT_POST_DATA_NONE, post.data_location);
     TEST_ASSERT_EQUAL(NULL, post.data.ptr);
 
     TEST_ESP_OK(esp_event_loop_delete(loop));
@@ -683,8 +733,7 @@ TEST_CASE("data posted from ISR is correctly set internally", "[event][intr]")
     int sample = 0;
     TEST_ESP_OK(esp_event_isr_post_to(loop, s_test_base1, TEST_EVENT_BASE1_EV1, &sample, sizeof(sample), NULL));
     TEST_ASSERT_EQUAL(pdTRUE, xQueueReceive(loop_def->queue, &post, portMAX_DELAY));
-    TEST_ASSERT_EQUAL(true, post.data_set);
-    TEST_ASSERT_EQUAL(false, post.data_allocated);
+    TEST_ASSERT_EQUAL(ESP_EVENT_POST_DATA_INLINE, post.data_location);
     TEST_ASSERT_EQUAL(false, post.data.val);
 
     TEST_ESP_OK(esp_event_loop_delete(loop));
@@ -0,0 +1,281 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+
+/* Throughput and latency of esp_http_server on the Linux target
+ *
+ * The load generator runs BENCH_CLIENTS threads, each of them sending GET
+ * requests over its own keep-alive connection to the server on the loopback
+ * interface, and waiting for the response before sending the next request.
+ * Every URI is measured with the requests processed by the server task, and
+ * with several numbers of worker tasks.
+ */
+
+#include <assert.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/param.h>
+#include <sys/socket.h>
+#include "esp_err.h"
+#include "esp_http_server.h"
+
+#define BENCH_CLIENTS       8
+#define BENCH_DURATION_MS   2000
+#define BENCH_MAX_SAMPLES   (256 * 1024)
+#define BENCH_PORT          8002
+
+static const uint8_t s_worker_counts[] = { 0, 1, 2, 4 };
+
+typedef struct {
+    const char *uri;
+    const char *description;
+} bench_uri_t;
+
+static const bench_uri_t s_uris[] = {
+    { "/fast", "short response" },
+    { "/io", "handler waits 1 ms" },
+    { "/cpu", "handler computes ~200 us" },
+};
+
+typedef struct {
+    uint16_t port;
+    const char *uri;
+    int64_t deadline_us;
+    uint32_t *samples;      // latencies in microseconds
+    size_t count;
+    size_t errors;
+} bench_client_t;
+
+static int64_t now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static esp_err_t fast_handler(httpd_req_t *req)
+{
+    return httpd_resp_sendstr(req, "Hello World!");
+}
+
+static esp_err_t io_handler(httpd_req_t *req)
+{
+    usleep(1000);
+    return httpd_resp_sendstr(req, "Hello World!");
+}
+
+static esp_err_t cpu_handler(httpd_req_t *req)
+{
+    volatile uint32_t hash = 2166136261u;
+    int64_t end = now_us() + 200;
+    while (now_us() < end) {
+        for (int i = 0; i < 64; i++) {
+            hash = (hash ^ i) * 16777619u;
+        }
+    }
+    return httpd_resp_sendstr(req, "Hello World!");
+}
+
+static const httpd_uri_t s_handlers[] = {
+    { .uri = "/fast", .method = HTTP_GET, .handler = fast_handler },
+    { .uri = "/io", .method = HTTP_GET, .handler = io_handler },
+    { .uri = "/cpu", .method = HTTP_GET, .handler = cpu_handler },
+};
+
+/* The server sends the headers and the body of a response separately, disable
+ * Nagle's algorithm so that the body isn't delayed until the client ACKs the headers */
+static esp_err_t session_open(httpd_handle_t hd, int sockfd)
+{
+    int enable = 1;
+    setsockopt(sockfd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+    return ESP_OK;
+}
+
+static int client_connect(uint16_t port)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(port),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    int enable = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/* Sends a request and receives the whole response, returns false on error */
+static bool client_request(int fd, const char *request, size_t request_len)
+{
+    char buf[512];
+    size_t len = 0;
+    if (send(fd, request, request_len, 0) != (ssize_t)request_len) {
+        return false;
+    }
+
+    char *body = NULL;
+    while (!body) {
+        ssize_t n = recv(fd, buf + len, sizeof(buf) - 1 - len, 0);
+        if (n <= 0) {
+            return false;
+        }
+        len += n;
+        buf[len] = '\0';
+        body = strstr(buf, "\r\n\r\n");
+        if (!body && len == sizeof(buf) - 1) {
+            return false;
+        }
+    }
+    body += 4;
+
+    const char *content_length = strstr(buf, "Content-Length: ");
+    if (!content_length || content_length > body) {
+        return false;
+    }
+    size_t remaining = body + atoi(content_length + 16) - (buf + len);
+    while (remaining > 0) {
+        ssize_t n = recv(fd, buf, MIN(remaining, sizeof(buf)), 0);
+        if (n <= 0) {
+            return false;
+        }
+        remaining -= n;
+    }
+    return true;
+}
+
+static void *client_thread(void *arg)
+{
+    bench_client_t *client = (bench_client_t *)arg;
+    char request[64];
+    int request_len = snprintf(request, sizeof(request), "GET %s HTTP/1.1\r\nHost: localhost\r\n\r\n", client->uri);
+
+    int fd = client_connect(client->port);
+    if (fd < 0) {
+        client->errors++;
+        return NULL;
+    }
+    while (now_us() < client->deadline_us && client->count < BENCH_MAX_SAMPLES) {
+        int64_t start = now_us();
+        if (!client_request(fd, request, request_len)) {
+            client->errors++;
+            break;
+        }
+        client->samples[client->count++] = now_us() - start;
+    }
+    close(fd);
+    return NULL;
+}
+
+static int compare_samples(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static uint32_t percentile(const uint32_t *sorted, size_t count, unsigned pct)
+{
+    return sorted[(count - 1) * pct / 100];
+}
+
+/* Returns the number of the failed clients */
+static size_t run_benchmark(uint8_t worker_count, const bench_uri_t *uri, uint16_t port)
+{
+    httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+    config.server_port = port;
+    config.max_open_sockets = BENCH_CLIENTS;
+    config.stack_size = 16384;
+    config.worker_count = worker_count;
+    config.open_fn = session_open;
+
+    httpd_handle_t server;
+    esp_err_t err = httpd_start(&server, &config);
+    if (err != ESP_OK) {
+        printf("Failed to start the server: 0x%x\n", err);
+        return BENCH_CLIENTS;
+    }
+    for (size_t i = 0; i < sizeof(s_handlers) / sizeof(s_handlers[0]); i++) {
+        httpd_register_uri_handler(server, &s_handlers[i]);
+    }
+
+    static bench_client_t clients[BENCH_CLIENTS];
+    pthread_t threads[BENCH_CLIENTS];
+    int64_t start = now_us();
+    for (int i = 0; i < BENCH_CLIENTS; i++) {
+        clients[i] = (bench_client_t) {
+            .port = port,
+            .uri = uri->uri,
+            .deadline_us = start + BENCH_DURATION_MS * 1000,
+            .samples = malloc(BENCH_MAX_SAMPLES * sizeof(uint32_t)),
+        };
+        assert(clients[i].samples);
+        pthread_create(&threads[i], NULL, client_thread, &clients[i]);
+    }
+
+    size_t total = 0;
+    size_t errors = 0;
+    for (int i = 0; i < BENCH_CLIENTS; i++) {
+        pthread_join(threads[i], NULL);
+        total += clients[i].count;
+        errors += clients[i].errors;
+    }
+    int64_t elapsed = now_us() - start;
+    httpd_stop(server);
+
+    uint32_t *all = malloc(MAX(total, 1) * sizeof(uint32_t));
+    assert(all);
+    size_t n = 0;
+    for (int i = 0; i < BENCH_CLIENTS; i++) {
+        memcpy(all + n, clients[i].samples, clients[i].count * sizeof(uint32_t));
+        n += clients[i].count;
+        free(clients[i].samples);
+    }
+    qsort(all, total, sizeof(uint32_t), compare_samples);
+
+    if (total) {
+        printf("%-7u %-26s %9.0f %8"PRIu32" %8"PRIu32" %8"PRIu32" %8"PRIu32" %6zu\n",
+               worker_count, uri->description, total * 1e6 / elapsed,
+               percentile(all, total, 50), percentile(all, total, 90),
+               percentile(all, total, 99), all[total - 1], errors);
+    } else {
+        printf("%-7u %-26s no responses, %zu errors\n", worker_count, uri->description, errors);
+    }
+    free(all);
+    return errors;
+}
+
+void app_main(void)
+{
+    printf("%d clients, keep-alive connections, %d ms per run, latencies in us\n",
+           BENCH_CLIENTS, BENCH_DURATION_MS);
+    printf("%-7s %-26s %9s %8s %8s %8s %8s %6s\n",
+           "workers", "request", "req/s", "p50", "p90", "p99", "max", "errors");
+
+    uint16_t port = BENCH_PORT;
+    size_t errors = 0;
+    for (size_t u = 0; u < sizeof(s_uris) / sizeof(s_uris[0]); u++) {
+        for (size_t w = 0; w < sizeof(s_worker_counts); w++) {
+            errors += run_benchmark(s_worker_counts[w], &s_uris[u], port++);
+        }
+    }
+    printf("Benchmark done, %zu errors\n", errors);
+}
@@ -0,0 +1,11 @@
+# SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+# SPDX-License-Identifier: Unlicense OR CC0-1.0
+import pytest
+from pytest_embedded import Dut
+
+
+@pytest.mark.linux
+@pytest.mark.host_test
+def test_http_server_benchmark_linux(dut: Dut) -> None:
+    res = dut.expect(r'Benchmark done, (\d+) errors', timeout=120)
+    assert int(res.group(1)) == 0
@@ -0,0 +1,388 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+
+/* Request processing by the worker tasks of esp_http_server on the Linux target
+ *
+ * The clients are plain sockets on the loopback interface, driven by the test
+ * cases themselves. The handlers run in the worker tasks, where the Unity
+ * assertions can't be used, so they report what they saw in their responses.
+ */
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include "esp_err.h"
+#include "esp_http_server.h"
+#include "unity.h"
+#include "unity_fixture.h"
+
+#define TEST_PORT_BASE          8100
+#define TEST_WORKER_COUNT       2
+#define TEST_TIMEOUT_S          2
+#define TEST_SEQ_CLIENTS        2
+#define TEST_SEQ_REQUESTS       16
+
+/* Every server of the test cases listens on a new port, so that the connections
+ * left in TIME_WAIT by the previous ones don't get in the way */
+static uint16_t s_port = TEST_PORT_BASE;
+static httpd_handle_t s_server;
+
+/* Shared by the handlers and the test cases, protected by s_lock */
+static pthread_mutex_t s_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t s_cond = PTHREAD_COND_INITIALIZER;
+static int s_meet_count;        // handlers of /meet which have started
+static int s_block_count;       // handlers of /block which have started
+static int s_block_fd;          // socket of the last handler of /block
+static int s_block_release;     // set to 1 to let the handlers of /block respond
+static int s_seq_log[TEST_SEQ_CLIENTS * TEST_SEQ_REQUESTS];
+static int s_seq_log_len;
+
+/* Waits until *value reaches target, returns false on timeout. Must be called with s_lock taken. */
+static bool wait_value_locked(const int *value, int target)
+{
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += TEST_TIMEOUT_S;
+    while (*value < target) {
+        if (pthread_cond_timedwait(&s_cond, &s_lock, &deadline) == ETIMEDOUT) {
+            return *value >= target;
+        }
+    }
+    return true;
+}
+
+static void increment_and_notify(int *value)
+{
+    pthread_mutex_lock(&s_lock);
+    (*value)++;
+    pthread_cond_broadcast(&s_cond);
+    pthread_mutex_unlock(&s_lock);
+}
+
+static esp_err_t hello_handler(httpd_req_t *req)
+{
+    return httpd_resp_sendstr(req, "hello");
+}
+
+/* Responds only when two requests are processed at the same time */
+static esp_err_t meet_handler(httpd_req_t *req)
+{
+    pthread_mutex_lock(&s_lock);
+    s_meet_count++;
+    pthread_cond_broadcast(&s_cond);
+    bool met = wait_value_locked(&s_meet_count, 2);
+    pthread_mutex_unlock(&s_lock);
+    return httpd_resp_sendstr(req, met ? "met" : "alone");
+}
+
+/* Keeps the session in the worker until the test case releases it */
+static esp_err_t block_handler(httpd_req_t *req)
+{
+    pthread_mutex_lock(&s_lock);
+    s_block_fd = httpd_req_to_sockfd(req);
+    s_block_count++;
+    pthread_cond_broadcast(&s_cond);
+    bool released = wait_value_locked(&s_block_release, 1);
+    pthread_mutex_unlock(&s_lock);
+    return httpd_resp_sendstr(req, released ? "released" : "timeout");
+}
+
+/* Logs the number n of the query, and responds with it after a delay depending on n */
+static esp_err_t seq_handler(httpd_req_t *req)
+{
+    char query[16];
+    char value[8];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) != ESP_OK ||
+            httpd_query_key_value(query, "n", value, sizeof(value)) != ESP_OK) {
+        return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, NULL);
+    }
+    int n = atoi(value);
+    usleep((n % 4) * 500);
+
+    pthread_mutex_lock(&s_lock);
+    if (s_seq_log_len < TEST_SEQ_CLIENTS * TEST_SEQ_REQUESTS) {
+        s_seq_log[s_seq_log_len++] = n;
+    }
+    pthread_mutex_unlock(&s_lock);
+    return httpd_resp_sendstr(req, value);
+}
+
+/* Counts the requests of the session in the session context */
+static esp_err_t ctx_handler(httpd_req_t *req)
+{
+    int fd = httpd_req_to_sockfd(req);
+    int *count = httpd_sess_get_ctx(req->handle, fd);
+    if (!count) {
+        count = calloc(1, sizeof(int));
+        if (!count) {
+            return ESP_ERR_NO_MEM;
+        }
+        httpd_sess_set_ctx(req->handle, fd, count, free);
+    }
+    if (req->sess_ctx != count || httpd_sess_get_ctx(req->handle, fd) != count) {
+        return httpd_resp_sendstr(req, "mismatch");
+    }
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%d", ++(*count));
+    return httpd_resp_sendstr(req, buf);
+}
+
+static const httpd_uri_t s_handlers[] = {
+    { .uri = "/hello", .method = HTTP_GET, .handler = hello_handler },
+    { .uri = "/meet", .method = HTTP_GET, .handler = meet_handler },
+    { .uri = "/block", .method = HTTP_GET, .handler = block_handler },
+    { .uri = "/seq", .method = HTTP_GET, .handler = seq_handler },
+    { .uri = "/ctx", .method = HTTP_GET, .handler = ctx_handler },
+};
+
+static void start_server(httpd_config_t *config)
+{
+    config->server_port = s_port++;
+    config->worker_count = TEST_WORKER_COUNT;
+    /* The sanitizers need much more stack than the default */
+    config->stack_size = 32 * 1024;
+    TEST_ESP_OK(httpd_start(&s_server, config));
+    for (size_t i = 0; i < sizeof(s_handlers) / sizeof(s_handlers[0]); i++) {
+        TEST_ESP_OK(httpd_register_uri_handler(s_server, &s_handlers[i]));
+    }
+}
+
+static int client_connect(void)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, fd);
+    struct timeval timeout = { .tv_sec = 2 * TEST_TIMEOUT_S };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(s_port - 1),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    TEST_ASSERT_EQUAL(0, connect(fd, (struct sockaddr *)&addr, sizeof(addr)));
+    return fd;
+}
+
+static void client_send(int fd, const char *uri)
+{
+    char request[64];
+    int len = snprintf(request, sizeof(request), "GET %s HTTP/1.1\r\nHost: localhost\r\n\r\n", uri);
+    TEST_ASSERT_EQUAL(len, send(fd, request, len, 0));
+}
+
+/* Receives one response into body, returns false if the connection was closed instead */
+static bool client_receive(int fd, char *body, size_t body_size)
+{
+    char headers[512];
+    size_t len = 0;
+    while (len < 4 || memcmp(headers + len - 4, "\r\n\r\n", 4) != 0) {
+        ssize_t n = recv(fd, headers + len, 1, 0);
+        if (n == 0 || (n < 0 && errno == ECONNRESET)) {
+            return false;
+        }
+        /* Fails on the receive timeout too */
+        TEST_ASSERT_EQUAL(1, n);
+        len++;
+        TEST_ASSERT_LESS_THAN(sizeof(headers), len);
+    }
+    headers[len] = '\0';
+
+    const char *content_length = strstr(headers, "Content-Length: ");
+    TEST_ASSERT_NOT_NULL(content_length);
+    size_t body_len = atoi(content_length + 16);
+    TEST_ASSERT_LESS_THAN(body_size, body_len);
+    for (size_t received = 0; received < body_len;) {
+        ssize_t n = recv(fd, body + received, body_len - received, 0);
+        TEST_ASSERT_GREATER_THAN(0, n);
+        received += n;
+    }
+    body[body_len] = '\0';
+    return true;
+}
+
+static void client_get(int fd, const char *uri, const char *expected_body)
+{
+    char body[32];
+    client_send(fd, uri);
+    TEST_ASSERT_TRUE(client_receive(fd, body, sizeof(body)));
+    TEST_ASSERT_EQUAL_STRING(expected_body, body);
+}
+
+static void wait_blocked(int count)
+{
+    pthread_mutex_lock(&s_lock);
+    bool blocked = wait_value_locked(&s_block_count, count);
+    pthread_mutex_unlock(&s_lock);
+    TEST_ASSERT_TRUE(blocked);
+}
+
+TEST_GROUP(http_server_workers);
+
+TEST_SETUP(http_server_workers)
+{
+    s_server = NULL;
+    s_meet_count = 0;
+    s_block_count = 0;
+    s_block_fd = -1;
+    s_block_release = 0;
+    s_seq_log_len = 0;
+}
+
+TEST_TEAR_DOWN(http_server_workers)
+{
+    /* Don't leave a worker waiting after a failed test case */
+    increment_and_notify(&s_block_release);
+    if (s_server) {
+        TEST_ESP_OK(httpd_stop(s_server));
+    }
+}
+
+TEST(http_server_workers, test_sessions_processed_in_parallel)
+{
+    httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+    start_server(&config);
+
+    /* The first two sessions take the first two slots, so they are processed by different workers */
+    int fds[2] = { client_connect(), client_connect() };
+    client_send(fds[0], "/meet");
+    client_send(fds[1], "/meet");
+    char body[32];
+    for (int i = 0; i < 2; i++) {
+        TEST_ASSERT_TRUE(client_receive(fds[i], body, sizeof(body)));
+        TEST_ASSERT_EQUAL_STRING("met", body);
+    }
+    close(fds[0]);
+    close(fds[1]);
+}
+
+TEST(http_server_workers, test_requests_of_session_in_order)
+{
+    httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+    start_server(&config);
+
+    /* All the requests of a client are sent at once, so that they are pending together */
+    int fds[TEST_SEQ_CLIENTS];
+    for (int c = 0; c < TEST_SEQ_CLIENTS; c++) {
+        fds[c] = client_connect();
+        char requests[TEST_SEQ_REQUESTS * 48];
+        int len = 0;
+        for (int i = 0; i < TEST_SEQ_REQUESTS; i++) {
+            len += snprintf(requests + len, sizeof(requests) - len,
+                            "GET /seq?n=%d HTTP/1.1\r\nHost: localhost\r\n\r\n", c * 100 + i);
+        }
+        TEST_ASSERT_LESS_THAN(sizeof(requests), len);
+        TEST_ASSERT_EQUAL(len, send(fds[c], requests, len, 0));
+    }
+
+    char body[32];
+    for (int c = 0; c < TEST_SEQ_CLIENTS; c++) {
+        for (int i = 0; i < TEST_SEQ_REQUESTS; i++) {
+            TEST_ASSERT_TRUE(client_receive(fds[c], body, sizeof(body)));
+            TEST_ASSERT_EQUAL(c * 100 + i, atoi(body));
+        }
+        close(fds[c]);
+    }
+
+    /* The handlers of each session ran in the order of its requests */
+    TEST_ASSERT_EQUAL(TEST_SEQ_CLIENTS * TEST_SEQ_REQUESTS, s_seq_log_len);
+    int next[TEST_SEQ_CLIENTS] = { 0 };
+    for (int i = 0; i < s_seq_log_len; i++) {
+        int c = s_seq_log[i] / 100;
+        TEST_ASSERT_EQUAL(c * 100 + next[c]++, s_seq_log[i]);
+    }
+}
+
+TEST(http_server_workers, test_trigger_close_of_session_in_worker)
+{
+    httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+    start_server(&config);
+
+    int fd = client_connect();
+    client_send(fd, "/block");
+    wait_blocked(1);
+
+    /* The session is closed only once the worker is done with the request */
+    TEST_ESP_OK(httpd_sess_trigger_close(s_server, s_block_fd));
+    usleep(100 * 1000);
+    increment_and_notify(&s_block_release);
+    char body[32];
+    TEST_ASSERT_TRUE(client_receive(fd, body, sizeof(body)));
+    TEST_ASSERT_EQUAL_STRING("released", body);
+    TEST_ASSERT_FALSE(client_receive(fd, body, sizeof(body)));
+    close(fd);
+
+    /* The slot can be used again */
+    fd = client_connect();
+    client_get(fd, "/hello", "hello");
+    close(fd);
+}
+
+TEST(http_server_workers, test_lru_purge_skips_session_in_worker)
+{
+    httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+    config.max_open_sockets = 2;
+    config.lru_purge_enable = true;
+    start_server(&config);
+
+    /* The least recently used session is held by a worker */
+    int busy_fd = client_connect();
+    client_send(busy_fd, "/block");
+    wait_blocked(1);
+    int idle_fd = client_connect();
+    client_get(idle_fd, "/hello", "hello");
+
+    /* A new connection purges the idle session instead */
+    int new_fd = client_connect();
+    client_get(new_fd, "/hello", "hello");
+    char body[32];
+    TEST_ASSERT_FALSE(client_receive(idle_fd, body, sizeof(body)));
+
+    increment_and_notify(&s_block_release);
+    TEST_ASSERT_TRUE(client_receive(busy_fd, body, sizeof(body)));
+    TEST_ASSERT_EQUAL_STRING("released", body);
+    client_get(busy_fd, "/hello", "hello");
+
+    close(busy_fd);
+    close(idle_fd);
+    close(new_fd);
+}
+
+TEST(http_server_workers, test_session_ctx_in_worker)
+{
+    httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+    start_server(&config);
+
+    int fds[2] = { client_connect(), client_connect() };
+    client_get(fds[0], "/ctx", "1");
+    client_get(fds[0], "/ctx", "2");
+    client_get(fds[1], "/ctx", "1");
+    client_get(fds[0], "/ctx", "3");
+    client_get(fds[1], "/ctx", "2");
+    close(fds[0]);
+    close(fds[1]);
+}
+
+TEST_GROUP_RUNNER(http_server_workers)
+{
+    RUN_TEST_CASE(http_server_workers, test_sessions_processed_in_parallel);
+    RUN_TEST_CASE(http_server_workers, test_requests_of_session_in_order);
+    RUN_TEST_CASE(http_server_workers, test_trigger_close_of_session_in_worker);
+    RUN_TEST_CASE(http_server_workers, test_lru_purge_skips_session_in_worker);
+    RUN_TEST_CASE(http_server_workers, test_session_ctx_in_worker);
+}
+
+void app_main(void)
+{
+    UNITY_MAIN(http_server_workers);
+}
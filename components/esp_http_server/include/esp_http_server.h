@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2018-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2018-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -55,6 +55,8 @@ initializer that should be kept in sync
         .stack_size         = 4096,                     \
         .core_id            = tskNO_AFFINITY,           \
         .task_caps          = (MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT),       \
+        .worker_count       = 0,                        \
+        .worker_pin_cores   = false,                    \
         .server_port        = 80,                       \
         .ctrl_port          = ESP_HTTPD_DEF_CTRL_PORT,  \
         .max_open_sockets   = 7,                        \
@@ -173,6 +175,36 @@ typedef struct httpd_config {
     BaseType_t  core_id;            /*!< The core the HTTP server task will run on */
     uint32_t    task_caps;          /*!< The memory capabilities to use when allocating the HTTP server task's stack */
 
+    /**
+     * Number of worker tasks which run the URI handlers.
+     *
+     * If 0, the server task receives the requests and runs the URI handlers
+     * itself, so a slow handler delays the requests of all the other clients.
+     *
+     * Otherwise the server task only waits for the sockets and accepts the
+     * connections, and hands each session with a pending request over to a
+     * worker task. A session is always processed by the same worker, so its
+     * requests are handled in order, while the requests of sessions assigned
+     * to different workers are handled in parallel. The workers are created
+     * with the same priority, stack size and memory capabilities as the server
+     * task. Besides its stack, each worker allocates its own request data:
+     * a struct httpd_req with the URI buffer of CONFIG_HTTPD_MAX_URI_LEN + 1
+     * bytes, the internal request data with a scratch buffer of
+     * MAX(CONFIG_HTTPD_MAX_REQ_HDR_LEN, CONFIG_HTTPD_MAX_URI_LEN) + 1 bytes,
+     * max_resp_headers response header entries of two pointers each, and a
+     * queue of max_open_sockets + 1 session pointers. That is about 1.3 kB
+     * per worker with the default configuration on the ESP chips.
+     *
+     * @note Functions queued by httpd_queue_work() run in the server task and
+     *       may run concurrently with the URI handlers.
+     */
+    uint8_t     worker_count;
+
+    /**
+     * Pin the worker i to the core (i % number of cores), instead of core_id
+     */
+    bool        worker_pin_cores;
+
     /**
      * TCP Port number for receiving and transmitting HTTP traffic
      */
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2018-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2018-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -9,6 +9,7 @@
 #define _HTTPD_PRIV_H_
 
 #include <stdbool.h>
+#include <stdatomic.h>
 #include <sys/socket.h>
 #include <sys/param.h>
 #include <netinet/in.h>
@@ -46,12 +47,21 @@ extern "C" {
  */
 struct thread_data {
     othread_t handle;   /*!< Handle to thread/task */
-    enum {
+    _Atomic enum {
         THREAD_IDLE = 0,
         THREAD_RUNNING,
         THREAD_STOPPING,
         THREAD_STOPPED,
-    } status;           /*!< State of the thread */
+    } status;           /*!< State of the thread, polled by the other threads */
+};
+
+/**
+ * @brief States of a session with respect to the worker tasks
+ */
+enum httpd_sess_worker_state {
+    HTTPD_SESS_IDLE = 0,    /*!< Waited for and processed by the HTTPD thread */
+    HTTPD_SESS_QUEUED,      /*!< Handed over to a worker, which processes a request of it */
+    HTTPD_SESS_DONE,        /*!< The worker is done with the request, the HTTPD thread has to take the session back */
 };
 
 /**
@@ -73,6 +83,9 @@ struct sock_db {
     char pending_data[PARSER_BLOCK_SIZE];   /*!< Buffer for pending data to be received */
     size_t pending_len;                     /*!< Length of pending data to be received */
     bool for_async_req;                     /*!< If true, the socket will not be LRU purged */
+    atomic_int worker_state;                /*!< One of httpd_sess_worker_state */
+    esp_err_t worker_ret;                   /*!< Result of processing the request by the worker */
+    bool close_after_work;                  /*!< Close the session when the worker is done with it */
 #ifdef CONFIG_HTTPD_WS_SUPPORT
     bool ws_handshake_done;                 /*!< True if it has done WebSocket handshake (if this socket is a valid WS) */
     bool ws_close;                          /*!< Set to true to close the socket later (when WS Close frame received) */
@@ -108,6 +121,21 @@ struct httpd_req_aux {
 #endif
 };
 
+/**
+ * @brief   Worker task which processes the requests of a subset of the sessions
+ */
+struct httpd_worker {
+    struct httpd_data *hd;                  /*!< Server instance */
+    struct thread_data td;                  /*!< Information for the worker thread */
+    osem_t queue_sem;                       /*!< Counts the sessions in the queue */
+    struct sock_db **queue;                 /*!< Ring buffer of the sessions to process, NULL stops the worker */
+    size_t queue_len;                       /*!< Number of entries in the queue */
+    size_t head;                            /*!< Next entry to be taken by the worker */
+    size_t tail;                            /*!< Next entry to be filled by the HTTPD thread */
+    struct httpd_req req;                   /*!< The current request of the worker */
+    struct httpd_req_aux req_aux;           /*!< Additional data about the request kept unexposed */
+};
+
 /**
  * @brief   Server data for each instance. This is exposed publicly as
  *          httpd_handle_t but internal structure/members are kept private.
@@ -127,6 +155,9 @@ struct httpd_data {
     struct httpd_req hd_req;                /*!< The current HTTPD request */
     struct httpd_req_aux hd_req_aux;        /*!< Additional data about the HTTPD request kept unexposed */
     uint64_t lru_counter;                   /*!< LRU counter */
+    struct httpd_worker *hd_workers;        /*!< Worker tasks, NULL if the HTTPD thread processes the requests */
+    int hd_sd_dispatched_count;             /*!< The number of the sessions handed over to the workers */
+    atomic_bool hd_workers_done;            /*!< A worker has queued taking back the processed sessions */
 
     /* Array of registered error handler functions */
     httpd_err_handler_func_t *err_handler_fns;
@@ -210,6 +241,34 @@ esp_err_t httpd_sess_new(struct httpd_data *hd, int newfd);
  */
 esp_err_t httpd_sess_process(struct httpd_data *hd, struct sock_db *session);
 
+/**
+ * @brief   Processes an incoming HTTP request using the given request
+ *          structures, without updating the LRU counter of the session
+ *
+ * @param[in] hd      Server instance data
+ * @param[in] session Session
+ * @param[in] r       Request to be filled
+ * @param[in] ra      Auxiliary data of the request to be filled
+ *
+ * @return
+ *  - ESP_OK    : on successfully receiving, parsing and responding to a request
+ *  - ESP_FAIL  : in case of failure in any of the stages of processing
+ */
+esp_err_t httpd_sess_process_req(struct httpd_data *hd, struct sock_db *session,
+                                 httpd_req_t *r, struct httpd_req_aux *ra);
+
+/**
+ * @brief   Checks if the session is handed over to a worker
+ *
+ * @param[in] session Session
+ *
+ * @return True if the HTTPD thread must not wait for or process the session
+ */
+static inline bool httpd_sess_in_worker(struct sock_db *session)
+{
+    return atomic_load(&session->worker_state) != HTTPD_SESS_IDLE;
+}
+
 /**
  * @brief   Remove client descriptor from the session / socket database
  *          and close the connection for this client.
@@ -296,6 +355,75 @@ void httpd_sess_close_all(struct httpd_data *hd);
  * @}
  */
 
+/****************** Group : Workers ********************/
+/** @name Workers
+ * Methods for processing the requests in worker tasks
+ * @{
+ */
+
+/**
+ * @brief   Creates the worker tasks if config.worker_count is not 0
+ *
+ * @param[in] hd  Server instance data
+ *
+ * @return
+ *  - ESP_OK                  : if the workers were started or none is configured
+ *  - ESP_ERR_HTTPD_ALLOC_MEM : if out of memory
+ *  - ESP_ERR_HTTPD_TASK      : if failed to create a task
+ */
+esp_err_t httpd_workers_start(struct httpd_data *hd);
+
+/**
+ * @brief   Stops the worker tasks after they finish their current requests,
+ *          and frees their resources
+ *
+ * @param[in] hd  Server instance data
+ */
+void httpd_workers_stop(struct httpd_data *hd);
+
+/**
+ * @brief   Hands over a session with pending request to its worker
+ *
+ * The sessions are assigned to the workers by their slot in the socket
+ * database, so the requests of a session are processed in order.
+ *
+ * @param[in] hd      Server instance data
+ * @param[in] session Session which is not in a worker
+ */
+void httpd_worker_dispatch(struct httpd_data *hd, struct sock_db *session);
+
+/**
+ * @brief   Takes back the sessions whose requests were processed by the
+ *          workers. Closes the sessions which failed or were requested
+ *          to be closed meanwhile. To be called by the HTTPD thread.
+ *
+ * @param[in] hd  Server instance data
+ */
+void httpd_workers_collect(struct httpd_data *hd);
+
+/**
+ * @brief   Checks if the calling task is a worker of the server
+ *
+ * @param[in] hd  Server instance data
+ *
+ * @return True if called from a worker
+ */
+bool httpd_worker_is_current(struct httpd_data *hd);
+
+/**
+ * @brief   Returns the request of the session being processed by a worker
+ *
+ * @param[in] hd      Server instance data
+ * @param[in] session Session
+ *
+ * @return Request, or NULL if no worker processes a request of the session
+ */
+httpd_req_t *httpd_worker_get_req(struct httpd_data *hd, struct sock_db *session);
+
+/** End of Group : Workers
+ * @}
+ */
+
 /****************** Group : URI Handling ********************/
 /** @name URI Handling
  * Methods for accessing URI handlers
@@ -306,13 +434,13 @@ void httpd_sess_close_all(struct httpd_data *hd);
  * @brief   For an HTTP request, searches through all the registered URI handlers
  *          and invokes the appropriate one if found
  *
- * @param[in] hd  Server instance data for which handler needs to be invoked
+ * @param[in] req Parsed request for which handler needs to be invoked
  *
  * @return
  *  - ESP_OK    : if handler found and executed successfully
  *  - ESP_FAIL  : otherwise
  */
-esp_err_t httpd_uri(struct httpd_data *hd);
+esp_err_t httpd_uri(httpd_req_t *req);
 
 /**
  * @brief   Unregister all URI handlers
@@ -361,25 +489,27 @@ bool httpd_validate_req_ptr(httpd_req_t *r);
  * http_recv() after this reads the body of the request.
  *
  * @param[in] hd  Server instance data
+ * @param[in] r   Request to be filled
+ * @param[in] ra  Auxiliary data of the request to be filled
  * @param[in] sd  Pointer to socket which is needed for receiving TCP packets.
  *
  * @return
  *  - ESP_OK    : if request packet is valid
  *  - ESP_FAIL  : otherwise
  */
-esp_err_t httpd_req_new(struct httpd_data *hd, struct sock_db *sd);
+esp_err_t httpd_req_new(struct httpd_data *hd, httpd_req_t *r, struct httpd_req_aux *ra, struct sock_db *sd);
 
 /**
  * @brief   For an HTTP request, resets the resources allocated for it and
  *          purges any data left to be received
  *
- * @param[in] hd  Server instance data
+ * @param[in] r   Request to be reset
  *
  * @return
  *  - ESP_OK    : if request packet deleted and resources cleaned.
  *  - ESP_FAIL  : otherwise.
  */
-esp_err_t httpd_req_delete(struct httpd_data *hd);
+esp_err_t httpd_req_delete(httpd_req_t *r);
 
 /**
  * @brief   For handling HTTP errors by invoking registered
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2018-2023 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2018-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -254,8 +254,8 @@ static int httpd_process_session(struct sock_db *session, void *context)
         return 1;
     }
 
-    // session is busy in an async task, do not process here.
-    if (session->for_async_req) {
+    // session is busy in an async task or in a worker, do not process here.
+    if (session->for_async_req || httpd_sess_in_worker(session)) {
         return 1;
     }
 
@@ -263,6 +263,10 @@ static int httpd_process_session(struct sock_db *session, void *context)
     int fd = session->fd;
 
     if (FD_ISSET(fd, ctx->fdset) || httpd_sess_pending(ctx->hd, session)) {
+        if (ctx->hd->hd_workers) {
+            httpd_worker_dispatch(ctx->hd, session);
+            return 1;
+        }
         ESP_LOGD(TAG, LOG_FMT("processing socket %d"), fd);
         if (httpd_sess_process(ctx->hd, session) != ESP_OK) {
             httpd_sess_delete(ctx->hd, session); // Delete session
@@ -276,10 +280,11 @@ static esp_err_t httpd_server(struct httpd_data *hd)
 {
     fd_set read_set;
     FD_ZERO(&read_set);
-    if (hd->config.lru_purge_enable || httpd_is_sess_available(hd)) {
+    if (httpd_is_sess_available(hd) ||
+            (hd->config.lru_purge_enable && hd->hd_sd_dispatched_count < hd->hd_sd_active_count)) {
         /* Only listen for new connections if server has capacity to
          * handle more (or when LRU purge is enabled, in which case
-         * older connections will be closed) */
+         * older connections not busy in workers will be closed) */
         FD_SET(hd->listen_fd, &read_set);
     }
     FD_SET(hd->ctrl_fd, &read_set);
@@ -343,6 +348,7 @@ static void httpd_thread(void *arg)
     }
 
     ESP_LOGD(TAG, LOG_FMT("web server exiting"));
+    httpd_workers_stop(hd);
     close(hd->msg_fd);
     cs_free_ctrl_sock(hd->ctrl_fd);
     httpd_sess_close_all(hd);
@@ -527,6 +533,11 @@ esp_err_t httpd_start(httpd_handle_t *handle, const httpd_config_t *config)
     }
 
     httpd_sess_init(hd);
+    esp_err_t err = httpd_workers_start(hd);
+    if (err != ESP_OK) {
+        httpd_delete(hd);
+        return err;
+    }
     if (httpd_os_thread_create(&hd->hd_td.handle, "httpd",
                                hd->config.stack_size,
                                hd->config.task_priority,
@@ -534,6 +545,7 @@ esp_err_t httpd_start(httpd_handle_t *handle, const httpd_config_t *config)
                                hd->config.core_id,
                                hd->config.task_caps) != ESP_OK) {
         /* Failed to launch task */
+        httpd_workers_stop(hd);
         httpd_delete(hd);
         return ESP_ERR_HTTPD_TASK;
     }
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2018-2021 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2018-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -73,6 +73,8 @@ static int enum_function(struct sock_db *session, void *context)
         session->fd = -1;
         session->ctx = NULL;
         session->for_async_req = false;
+        atomic_store(&session->worker_state, HTTPD_SESS_IDLE);
+        session->close_after_work = false;
         break;
     // Get active session
     case HTTPD_TASK_GET_ACTIVE:
@@ -88,7 +90,7 @@ static int enum_function(struct sock_db *session, void *context)
         break;
     // Set descriptor
     case HTTPD_TASK_SET_DESCRIPTOR:
-        if (session->fd != -1 && !session->for_async_req) {
+        if (session->fd != -1 && !session->for_async_req && !httpd_sess_in_worker(session)) {
             FD_SET(session->fd, ctx->fdset);
             if (session->fd > ctx->max_fd) {
                 ctx->max_fd = session->fd;
@@ -97,7 +99,8 @@ static int enum_function(struct sock_db *session, void *context)
         break;
     // Delete invalid session
     case HTTPD_TASK_DELETE_INVALID:
-        if (!fd_is_valid(session->fd)) {
+        // Sessions in workers are not waited for, and can't be deleted here
+        if (!httpd_sess_in_worker(session) && !fd_is_valid(session->fd)) {
             ESP_LOGW(TAG, LOG_FMT("Closing invalid socket %d"), session->fd);
             httpd_sess_delete(ctx->hd, session);
         }
@@ -109,7 +112,7 @@ static int enum_function(struct sock_db *session, void *context)
             return 0;
         }
         // Only close sockets that are not in use
-        if (session->for_async_req == false) {
+        if (session->for_async_req == false && !httpd_sess_in_worker(session)) {
             // Check/update lowest lru
             if (session->lru_counter < ctx->lru_counter) {
                 ctx->lru_counter = session->lru_counter;
@@ -140,6 +143,12 @@ static void httpd_sess_close(void *arg)
         return;
     }
 
+    // A worker is processing a request of the session, it's closed once the worker is done
+    if (httpd_sess_in_worker(sock_db)) {
+        sock_db->close_after_work = true;
+        return;
+    }
+
     if (!sock_db->lru_counter && !sock_db->lru_socket) {
         ESP_LOGD(TAG, "Skipping session close for %d as it seems to be a race condition", sock_db->fd);
         return;
@@ -149,6 +158,16 @@ static void httpd_sess_close(void *arg)
     httpd_sess_delete(hd, sock_db);
 }
 
+// Returns the request being processed for the session, if any.
+// This is the case if called from inside a request handler.
+static httpd_req_t *httpd_sess_get_req(struct httpd_data *hd, struct sock_db *session)
+{
+    if (hd->hd_req_aux.sd == session) {
+        return &hd->hd_req;
+    }
+    return httpd_worker_get_req(hd, session);
+}
+
 struct sock_db *httpd_sess_get_free(struct httpd_data *hd)
 {
     if ((!hd) || (hd->hd_sd_active_count == hd->config.max_open_sockets)) {
@@ -268,9 +287,9 @@ void *httpd_sess_get_ctx(httpd_handle_t handle, int sockfd)
     // Check if the function has been called from inside a
     // request handler, in which case fetch the context from
     // the httpd_req_t structure
-    struct httpd_data *hd = (struct httpd_data *) handle;
-    if (hd->hd_req_aux.sd == session) {
-        return hd->hd_req.sess_ctx;
+    httpd_req_t *r = httpd_sess_get_req((struct httpd_data *) handle, session);
+    if (r) {
+        return r->sess_ctx;
     }
     return session->ctx;
 }
@@ -285,17 +304,17 @@ void httpd_sess_set_ctx(httpd_handle_t handle, int sockfd, void *ctx, httpd_free
     // Check if the function has been called from inside a
     // request handler, in which case set the context inside
     // the httpd_req_t structure
-    struct httpd_data *hd = (struct httpd_data *) handle;
-    if (hd->hd_req_aux.sd == session) {
-        if (hd->hd_req.sess_ctx != ctx) {
+    httpd_req_t *r = httpd_sess_get_req((struct httpd_data *) handle, session);
+    if (r) {
+        if (r->sess_ctx != ctx) {
             // Don't free previous context if it is in sockdb
             // as it will be freed inside httpd_req_cleanup()
-            if (session->ctx != hd->hd_req.sess_ctx) {
-                httpd_sess_free_ctx(&hd->hd_req.sess_ctx, hd->hd_req.free_ctx); // Free previous context
+            if (session->ctx != r->sess_ctx) {
+                httpd_sess_free_ctx(&r->sess_ctx, r->free_ctx); // Free previous context
             }
-            hd->hd_req.sess_ctx = ctx;
+            r->sess_ctx = ctx;
         }
-        hd->hd_req.free_ctx = free_fn;
+        r->free_ctx = free_fn;
         return;
     }
 
@@ -417,21 +436,30 @@ bool httpd_sess_pending(struct httpd_data *hd, struct sock_db *session)
  * value is returned, everything related to this socket will be
  * cleaned up and the socket will be closed.
  */
-esp_err_t httpd_sess_process(struct httpd_data *hd, struct sock_db *session)
+esp_err_t httpd_sess_process_req(struct httpd_data *hd, struct sock_db *session,
+                                 httpd_req_t *r, struct httpd_req_aux *ra)
 {
-    if ((!hd) || (!session)) {
-        return ESP_FAIL;
-    }
-
     ESP_LOGD(TAG, LOG_FMT("httpd_req_new"));
-    if (httpd_req_new(hd, session) != ESP_OK) {
+    if (httpd_req_new(hd, r, ra, session) != ESP_OK) {
         return ESP_FAIL;
     }
     ESP_LOGD(TAG, LOG_FMT("httpd_req_delete"));
-    if (httpd_req_delete(hd) != ESP_OK) {
+    if (httpd_req_delete(r) != ESP_OK) {
         return ESP_FAIL;
     }
     ESP_LOGD(TAG, LOG_FMT("success"));
+    return ESP_OK;
+}
+
+esp_err_t httpd_sess_process(struct httpd_data *hd, struct sock_db *session)
+{
+    if ((!hd) || (!session)) {
+        return ESP_FAIL;
+    }
+
+    if (httpd_sess_process_req(hd, session, &hd->hd_req, &hd->hd_req_aux) != ESP_OK) {
+        return ESP_FAIL;
+    }
     session->lru_counter = ++hd->lru_counter;
     return ESP_OK;
 }
@@ -0,0 +1,226 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <esp_log.h>
+#include <esp_err.h>
+
+#include <esp_http_server.h>
+#include "esp_httpd_priv.h"
+
+static const char *TAG = "httpd_worker";
+
+/* The sessions are handed over to the workers by the HTTPD thread only, and each
+ * queue is emptied by its worker only, so the queue indices need no locking. The
+ * semaphore orders the accesses to the queue entries.
+ *
+ * A worker hands the session back by setting its worker_state to HTTPD_SESS_DONE,
+ * and wakes the HTTPD thread by queuing httpd_workers_collect_fn(). The
+ * hd_workers_done flag makes sure that only one such work is queued at a time.
+ */
+
+static struct httpd_worker *httpd_worker_of(struct httpd_data *hd, struct sock_db *session)
+{
+    return &hd->hd_workers[(session - hd->hd_sd) % hd->config.worker_count];
+}
+
+static void httpd_workers_collect_fn(void *arg)
+{
+    httpd_workers_collect((struct httpd_data *) arg);
+}
+
+static void httpd_worker_notify(struct httpd_data *hd)
+{
+    if (atomic_exchange(&hd->hd_workers_done, true)) {
+        /* Collection is already queued, and it will see this session too */
+        return;
+    }
+    while (httpd_queue_work(hd, httpd_workers_collect_fn, hd) != ESP_OK) {
+        if (hd->hd_td.status != THREAD_RUNNING) {
+            /* Server is stopping, the sessions will be closed anyway */
+            return;
+        }
+        /* Control socket is full, the session can't be lost */
+        httpd_os_thread_sleep(10);
+    }
+}
+
+static void httpd_worker_thread(void *arg)
+{
+    struct httpd_worker *worker = (struct httpd_worker *) arg;
+    struct httpd_data *hd = worker->hd;
+
+    ESP_LOGD(TAG, LOG_FMT("worker %d started"), (int)(worker - hd->hd_workers));
+    while (1) {
+        httpd_os_sem_take(worker->queue_sem);
+        struct sock_db *session = worker->queue[worker->head];
+        worker->head = (worker->head + 1) % worker->queue_len;
+        if (!session) {
+            break;
+        }
+
+        ESP_LOGD(TAG, LOG_FMT("processing socket %d"), session->fd);
+        session->worker_ret = httpd_sess_process_req(hd, session, &worker->req, &worker->req_aux);
+        atomic_store(&session->worker_state, HTTPD_SESS_DONE);
+        httpd_worker_notify(hd);
+    }
+
+    ESP_LOGD(TAG, LOG_FMT("worker %d exiting"), (int)(worker - hd->hd_workers));
+    worker->td.status = THREAD_STOPPED;
+    httpd_os_thread_delete();
+}
+
+static void httpd_worker_free(struct httpd_worker *worker)
+{
+    if (worker->queue_sem) {
+        httpd_os_sem_delete(worker->queue_sem);
+    }
+    free(worker->queue);
+    free(worker->req_aux.resp_hdrs);
+}
+
+esp_err_t httpd_workers_start(struct httpd_data *hd)
+{
+    if (!hd->config.worker_count) {
+        return ESP_OK;
+    }
+
+    hd->hd_workers = calloc(hd->config.worker_count, sizeof(struct httpd_worker));
+    if (!hd->hd_workers) {
+        ESP_LOGE(TAG, LOG_FMT("Failed to allocate memory for HTTP workers"));
+        return ESP_ERR_HTTPD_ALLOC_MEM;
+    }
+    atomic_store(&hd->hd_workers_done, false);
+
+    for (int i = 0; i < hd->config.worker_count; i++) {
+        struct httpd_worker *worker = &hd->hd_workers[i];
+        worker->hd = hd;
+        /* Each session is queued at most once, plus the entry which stops the worker */
+        worker->queue_len = hd->config.max_open_sockets + 1;
+        worker->queue = calloc(worker->queue_len, sizeof(struct sock_db *));
+        worker->req_aux.resp_hdrs = calloc(hd->config.max_resp_headers, sizeof(struct resp_hdr));
+        if (!worker->queue || !worker->req_aux.resp_hdrs ||
+                httpd_os_sem_create(&worker->queue_sem, worker->queue_len) != OS_SUCCESS) {
+            ESP_LOGE(TAG, LOG_FMT("Failed to allocate memory for HTTP worker"));
+            httpd_worker_free(worker);
+            httpd_workers_stop(hd);
+            return ESP_ERR_HTTPD_ALLOC_MEM;
+        }
+
+        BaseType_t core_id = hd->config.core_id;
+        if (hd->config.worker_pin_cores) {
+            core_id = i % portNUM_PROCESSORS;
+        }
+        worker->td.status = THREAD_RUNNING;
+        if (httpd_os_thread_create(&worker->td.handle, "httpd_worker",
+                                   hd->config.stack_size,
+                                   hd->config.task_priority,
+                                   httpd_worker_thread, worker,
+                                   core_id,
+                                   hd->config.task_caps) != OS_SUCCESS) {
+            ESP_LOGE(TAG, LOG_FMT("Failed to launch HTTP worker"));
+            worker->td.status = THREAD_IDLE;
+            httpd_worker_free(worker);
+            httpd_workers_stop(hd);
+            return ESP_ERR_HTTPD_TASK;
+        }
+    }
+    return ESP_OK;
+}
+
+void httpd_workers_stop(struct httpd_data *hd)
+{
+    if (!hd->hd_workers) {
+        return;
+    }
+
+    for (int i = 0; i < hd->config.worker_count; i++) {
+        struct httpd_worker *worker = &hd->hd_workers[i];
+        if (worker->td.status == THREAD_IDLE) {
+            continue;
+        }
+        worker->queue[worker->tail] = NULL;
+        worker->tail = (worker->tail + 1) % worker->queue_len;
+        httpd_os_sem_give(worker->queue_sem);
+    }
+    for (int i = 0; i < hd->config.worker_count; i++) {
+        struct httpd_worker *worker = &hd->hd_workers[i];
+        if (worker->td.status == THREAD_IDLE) {
+            continue;
+        }
+        /* Wait for the worker to finish its current request */
+        while (worker->td.status != THREAD_STOPPED) {
+            httpd_os_thread_sleep(10);
+        }
+        httpd_worker_free(worker);
+    }
+    free(hd->hd_workers);
+    hd->hd_workers = NULL;
+}
+
+void httpd_worker_dispatch(struct httpd_data *hd, struct sock_db *session)
+{
+    struct httpd_worker *worker = httpd_worker_of(hd, session);
+
+    ESP_LOGD(TAG, LOG_FMT("handing socket %d over to worker %d"), session->fd, (int)(worker - hd->hd_workers));
+    atomic_store(&session->worker_state, HTTPD_SESS_QUEUED);
+    hd->hd_sd_dispatched_count++;
+    worker->queue[worker->tail] = session;
+    worker->tail = (worker->tail + 1) % worker->queue_len;
+    httpd_os_sem_give(worker->queue_sem);
+}
+
+void httpd_workers_collect(struct httpd_data *hd)
+{
+    if (!hd->hd_workers) {
+        return;
+    }
+
+    /* Clear the flag before looking at the sessions, so that a session which
+     * is done after it was checked queues another collection */
+    atomic_store(&hd->hd_workers_done, false);
+    for (int i = 0; i < hd->config.max_open_sockets; i++) {
+        struct sock_db *session = &hd->hd_sd[i];
+        if (atomic_load(&session->worker_state) != HTTPD_SESS_DONE) {
+            continue;
+        }
+        atomic_store(&session->worker_state, HTTPD_SESS_IDLE);
+        hd->hd_sd_dispatched_count--;
+
+        if (session->worker_ret != ESP_OK || session->close_after_work) {
+            ESP_LOGD(TAG, LOG_FMT("closing socket %d"), session->fd);
+            session->close_after_work = false;
+            httpd_sess_delete(hd, session);
+        } else {
+            session->lru_counter = ++hd->lru_counter;
+        }
+    }
+}
+
+bool httpd_worker_is_current(struct httpd_data *hd)
+{
+    if (!hd->hd_workers) {
+        return false;
+    }
+
+    othread_t current = httpd_os_thread_handle();
+    for (int i = 0; i < hd->config.worker_count; i++) {
+        if (hd->hd_workers[i].td.handle == current) {
+            return true;
+        }
+    }
+    return false;
+}
+
+httpd_req_t *httpd_worker_get_req(struct httpd_data *hd, struct sock_db *session)
+{
+    if (!hd->hd_workers) {
+        return NULL;
+    }
+
+    struct httpd_worker *worker = httpd_worker_of(hd, session);
+    return (worker->req_aux.sd == session) ? &worker->req : NULL;
+}
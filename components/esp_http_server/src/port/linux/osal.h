@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2023 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2023-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -8,6 +8,9 @@
 #include <unistd.h>
 #include <stdint.h>
 #include <pthread.h>
+#include <semaphore.h>
+#include <stdlib.h>
+#include <errno.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -17,6 +20,7 @@ extern "C" {
 #define OS_FAIL    ESP_FAIL
 
 typedef TaskHandle_t othread_t;
+typedef sem_t *osem_t;
 
 static inline int httpd_os_thread_create(othread_t *thread,
                                  const char *name, uint16_t stacksize, int prio,
@@ -26,6 +30,8 @@ static inline int httpd_os_thread_create(othread_t *thread,
     pthread_attr_t thread_attr;
     pthread_attr_init(&thread_attr);
     pthread_attr_setstacksize(&thread_attr, stacksize);
+    /* The threads delete themselves, nobody joins them */
+    pthread_attr_setdetachstate(&thread_attr, PTHREAD_CREATE_DETACHED);
     int ret = pthread_create((pthread_t *)thread, &thread_attr, (void*)thread_routine, arg);
     if (ret == 0) {
         return OS_SUCCESS;
@@ -50,6 +56,33 @@ static inline othread_t httpd_os_thread_handle(void)
     return (othread_t)pthread_self();
 }
 
+static inline int httpd_os_sem_create(osem_t *sem, unsigned max_count)
+{
+    *sem = malloc(sizeof(sem_t));
+    if (*sem && sem_init(*sem, 0, 0) == 0) {
+        return OS_SUCCESS;
+    }
+    free(*sem);
+    return OS_FAIL;
+}
+
+static inline void httpd_os_sem_delete(osem_t sem)
+{
+    sem_destroy(sem);
+    free(sem);
+}
+
+static inline void httpd_os_sem_give(osem_t sem)
+{
+    sem_post(sem);
+}
+
+static inline void httpd_os_sem_take(osem_t sem)
+{
+    while (sem_wait(sem) != 0 && errno == EINTR) {
+    }
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2021-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2021-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  *
@@ -659,6 +659,80 @@ TEST(partition_api, test_partition_stats)
     free(test_data_ptr);
 }
 
+TEST(partition_api, test_partition_timing)
+{
+    const esp_partition_t *partition_data = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, "storage");
+    TEST_ASSERT_NOT_NULL(partition_data);
+
+    esp_partition_timing_t saved_timing = *esp_partition_get_timing();
+    TEST_ASSERT_NOT_NULL(esp_partition_get_timing_preset(ESP_PARTITION_TIMING_DIO_80M));
+    TEST_ASSERT_NULL(esp_partition_get_timing_preset(ESP_PARTITION_TIMING_MAX));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, esp_partition_set_timing(NULL));
+
+    esp_partition_timing_t timing = {
+        .op_overhead_ns = 1000, .read_byte_ns = 100, .write_byte_ns = 200,
+        .page_program_setup_us = 30, .page_program_byte_ns = 2000,
+        .sector_erase_us = 40000, .block_erase_us = 100000,
+        .suspend_us = 0, .suspend_interval_us = 0,
+    };
+    TEST_ESP_OK(esp_partition_set_timing(&timing));
+    TEST_ASSERT_EQUAL(0, memcmp(&timing, esp_partition_get_timing(), sizeof(timing)));
+
+    uint8_t buf[512];
+    esp_partition_clear_stats();
+
+    // 1 us + 512 * 100 ns
+    TEST_ESP_OK(esp_partition_read(partition_data, 0, buf, sizeof(buf)));
+    size_t read_time = esp_partition_get_total_time();
+    TEST_ASSERT_EQUAL(52, read_time);
+
+    // the storage partition is 64 kB aligned: 1 us + one block and one sector erased
+    TEST_ESP_OK(esp_partition_erase_range(partition_data, 0, 0x11000));
+    size_t erase_time = esp_partition_get_total_time() - read_time;
+    TEST_ASSERT_EQUAL(140001, erase_time);
+
+    // 1 us + 512 * 200 ns + pages of 128, 256 and 128 bytes programmed, each 30 us + 2 us per byte after the first
+    memset(buf, 0x55, sizeof(buf));
+    TEST_ESP_OK(esp_partition_write(partition_data, 128, buf, sizeof(buf)));
+    size_t write_time = esp_partition_get_total_time() - read_time - erase_time;
+    TEST_ASSERT_EQUAL(1 + 102 + 3 * 30 + (127 + 255 + 127) * 2, write_time);
+
+    size_t hist[ESP_PARTITION_LATENCY_BUCKETS];
+    TEST_ESP_OK(esp_partition_get_latency_histogram(ESP_PARTITION_OP_READ, hist, ESP_PARTITION_LATENCY_BUCKETS));
+    TEST_ASSERT_EQUAL(1, hist[5]);      // 32 - 63 us
+    TEST_ESP_OK(esp_partition_get_latency_histogram(ESP_PARTITION_OP_ERASE, hist, ESP_PARTITION_LATENCY_BUCKETS));
+    TEST_ASSERT_EQUAL(1, hist[17]);     // 131072 - 262143 us
+    TEST_ESP_OK(esp_partition_get_latency_histogram(ESP_PARTITION_OP_WRITE, hist, ESP_PARTITION_LATENCY_BUCKETS));
+    TEST_ASSERT_EQUAL(1, hist[10]);     // 1024 - 2047 us
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, esp_partition_get_latency_histogram(ESP_PARTITION_OP_MAX, hist, ESP_PARTITION_LATENCY_BUCKETS));
+
+    // a sector erase suspended every millisecond
+    timing.suspend_us = 20;
+    timing.suspend_interval_us = 1000;
+    TEST_ESP_OK(esp_partition_set_timing(&timing));
+    esp_partition_clear_stats();
+    TEST_ESP_OK(esp_partition_erase_range(partition_data, 0x20000, ESP_PARTITION_EMULATED_SECTOR_SIZE));
+    TEST_ASSERT_EQUAL(1 + 40000 + 40 * 20, esp_partition_get_total_time());
+
+    // the auto suspend preset differs by 450 suspends of 50 us in a 45 ms sector erase
+    TEST_ESP_OK(esp_partition_set_timing(esp_partition_get_timing_preset(ESP_PARTITION_TIMING_DIO_80M)));
+    esp_partition_clear_stats();
+    TEST_ESP_OK(esp_partition_erase_range(partition_data, 0x20000, ESP_PARTITION_EMULATED_SECTOR_SIZE));
+    TEST_ASSERT_EQUAL(13 + 45000, esp_partition_get_total_time());
+    TEST_ESP_OK(esp_partition_set_timing(esp_partition_get_timing_preset(ESP_PARTITION_TIMING_DIO_80M_AUTO_SUSPEND)));
+    esp_partition_clear_stats();
+    TEST_ESP_OK(esp_partition_erase_range(partition_data, 0x20000, ESP_PARTITION_EMULATED_SECTOR_SIZE));
+    TEST_ASSERT_EQUAL(13 + 45000 + 450 * 50, esp_partition_get_total_time());
+
+    esp_partition_clear_stats();
+    TEST_ESP_OK(esp_partition_get_latency_histogram(ESP_PARTITION_OP_ERASE, hist, ESP_PARTITION_LATENCY_BUCKETS));
+    for (size_t i = 0; i < ESP_PARTITION_LATENCY_BUCKETS; i++) {
+        TEST_ASSERT_EQUAL(0, hist[i]);
+    }
+
+    TEST_ESP_OK(esp_partition_set_timing(&saved_timing));
+}
+
 TEST(partition_api, test_partition_power_off_emulation)
 {
     const esp_partition_t *partition_data = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, "storage");
@@ -782,6 +856,7 @@ TEST_GROUP_RUNNER(partition_api)
     RUN_TEST_CASE(partition_api, test_partition_mmap_pfile_nf);
     RUN_TEST_CASE(partition_api, test_partition_mmap_size_too_small);
     RUN_TEST_CASE(partition_api, test_partition_stats);
+    RUN_TEST_CASE(partition_api, test_partition_timing);
     RUN_TEST_CASE(partition_api, test_partition_power_off_emulation);
     RUN_TEST_CASE(partition_api, test_partition_copy);
     RUN_TEST_CASE(partition_api, test_partition_register_external);
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2021-2022 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2021-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -167,10 +167,102 @@ size_t esp_partition_get_write_bytes(void);
  * esp_partition_write and esp_partition_erase_range operations.
  *
  * @return
- *      - estimated total time spent in read/write/erase operations in milliseconds
+ *      - estimated total time spent in read/write/erase operations in microseconds
  */
 size_t esp_partition_get_total_time(void);
 
+/**
+ * @brief Timing profile of the emulated SPI flash, used to estimate the time of the partition operations
+ *
+ * An operation costs op_overhead_ns plus the transfer of its data. Writes are split at the 256-byte program pages
+ * and each page program costs page_program_setup_us plus page_program_byte_ns per byte. Erases use 64 kB block
+ * erases for aligned blocks and sector erases for the rest. If suspend_interval_us is not zero, page programs and
+ * erases are suspended that often (as with the automatic suspend serving cache misses), each suspend and resume
+ * adding suspend_us.
+ */
+typedef struct {
+    uint32_t op_overhead_ns;            /*!< driver overhead of one read, write or erase call */
+    uint32_t read_byte_ns;              /*!< time to read one byte */
+    uint32_t write_byte_ns;             /*!< time to transfer one byte to be programmed */
+    uint32_t page_program_setup_us;     /*!< time to program the first byte of a page */
+    uint32_t page_program_byte_ns;      /*!< time to program each further byte of a page */
+    uint32_t sector_erase_us;           /*!< time to erase a 4 kB sector */
+    uint32_t block_erase_us;            /*!< time to erase a 64 kB block */
+    uint32_t suspend_us;                /*!< time lost by one suspend and resume of a program or erase */
+    uint32_t suspend_interval_us;       /*!< busy time between suspends, 0 if the operations are not suspended */
+} esp_partition_timing_t;
+
+/** @brief preset timing profiles */
+typedef enum {
+    ESP_PARTITION_TIMING_ESP32,                     /*!< ESP32, flash in DIO mode at 40 MHz */
+    ESP_PARTITION_TIMING_DIO_80M,                   /*!< ESP32-S3, ESP32-C3, ESP32-C6 and others, flash in DIO mode at 80 MHz */
+    ESP_PARTITION_TIMING_DIO_80M_AUTO_SUSPEND,      /*!< as ESP_PARTITION_TIMING_DIO_80M, with CONFIG_SPI_FLASH_AUTO_SUSPEND
+                                                         and a cache miss whenever the flash allows a suspend */
+    ESP_PARTITION_TIMING_MAX,
+} esp_partition_timing_chip_t;
+
+/**
+ * @brief Returns a preset timing profile
+ *
+ * The presets use the default flash mode and frequency of the chips and typical values of the 4 MB SPI NOR flash
+ * chips of the modules. A copy can be modified and set by esp_partition_set_timing().
+ *
+ * @param[in] chip Preset to return
+ *
+ * @return
+ *      - pointer to the preset timing profile, NULL if chip is not valid
+ */
+const esp_partition_timing_t *esp_partition_get_timing_preset(esp_partition_timing_chip_t chip);
+
+/**
+ * @brief Sets the timing profile used to estimate the time of the following partition operations
+ *
+ * The profile is copied. The initial profile is selected by CONFIG_ESP_PARTITION_STATS_TIMING.
+ *
+ * @param[in] timing Timing profile
+ *
+ * @return
+ *      - ESP_OK: Profile set
+ *      - ESP_ERR_INVALID_ARG: timing is NULL
+ */
+esp_err_t esp_partition_set_timing(const esp_partition_timing_t *timing);
+
+/**
+ * @brief Returns the timing profile currently used
+ *
+ * @return
+ *      - pointer to the timing profile
+ */
+const esp_partition_timing_t *esp_partition_get_timing(void);
+
+/** @brief number of buckets of the latency histograms, bucket i counts latencies from 2^i to 2^(i+1)-1 microseconds */
+#define ESP_PARTITION_LATENCY_BUCKETS 24
+
+/** @brief operation types of the latency histograms */
+typedef enum {
+    ESP_PARTITION_OP_READ,
+    ESP_PARTITION_OP_WRITE,
+    ESP_PARTITION_OP_ERASE,
+    ESP_PARTITION_OP_MAX,
+} esp_partition_op_t;
+
+/**
+ * @brief Returns the histogram of the estimated latencies of one operation type
+ *
+ * Each call of esp_partition_read, esp_partition_write or esp_partition_erase_range since recent
+ * esp_partition_clear_stats is counted in the bucket of its estimated time. Bucket 0 also counts latencies
+ * below 1 microsecond and the last bucket counts all longer latencies.
+ *
+ * @param[in] op Operation type
+ * @param[out] buckets Array receiving the counts
+ * @param[in] bucket_count Size of the array, at most ESP_PARTITION_LATENCY_BUCKETS buckets are filled
+ *
+ * @return
+ *      - ESP_OK: Histogram copied
+ *      - ESP_ERR_INVALID_ARG: op is not valid or buckets is NULL
+ */
+esp_err_t esp_partition_get_latency_histogram(esp_partition_op_t op, size_t *buckets, size_t bucket_count);
+
 /**
  * @brief Initializes emulation of lost power failure in write/erase operations
  *
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2021-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2021-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -39,7 +39,6 @@ static size_t s_esp_partition_stat_write_ops = 0;
 static size_t s_esp_partition_stat_read_bytes = 0;
 static size_t s_esp_partition_stat_write_bytes = 0;
 static size_t s_esp_partition_stat_erase_ops = 0;
-static size_t s_esp_partition_stat_total_time = 0;
 static size_t s_esp_partition_emulated_power_off_counter = SIZE_MAX;
 static uint8_t s_esp_partition_emulated_power_off_mode = 0;
 
@@ -568,24 +567,110 @@ uint32_t esp_partition_get_main_flash_sector_size(void)
 }
 
 #ifdef CONFIG_ESP_PARTITION_ENABLE_STATS
-// timing data for ESP8266, 160MHz CPU frequency, 80MHz flash frequency
-// all values in microseconds
-// values are for block sizes starting at 4 bytes and going up to 4096 bytes
-static size_t s_esp_partition_stat_read_times[] = {7, 5, 6, 7, 11, 18, 32, 60, 118, 231, 459};
-static size_t s_esp_partition_stat_write_times[] = {19, 23, 35, 57, 106, 205, 417, 814, 1622, 3200, 6367};
-static size_t s_esp_partition_stat_block_erase_time = 37142;
-
-static size_t esp_partition_stat_time_interpolate(uint32_t bytes, size_t *lut)
-{
-    const int lut_size = sizeof(s_esp_partition_stat_read_times) / sizeof(s_esp_partition_stat_read_times[0]);
-    int lz = __builtin_clz(bytes / 4);
-    int log_size = 32 - lz;
-    size_t x2 = 1 << (log_size + 2);
-    size_t upper_index = (log_size < lut_size - 1) ? log_size : lut_size - 1;
-    size_t y2 = lut[upper_index];
-    size_t x1 = 1 << (log_size + 1);
-    size_t y1 = lut[log_size - 1];
-    return (bytes - x1) * (y2 - y1) / (x2 - x1) + y1;
+// Timing of the emulated flash. The ESP32 preset assumes its default flash mode DIO 40 MHz, the others DIO 80 MHz,
+// the default of the later chips. The program and erase times are typical values of the flash chips. With
+// CONFIG_SPI_FLASH_AUTO_SUSPEND, the worst case is a cache miss as soon as the flash allows the next suspend: a suspend
+// every 100 us (the typical resume to suspend time tRS), each one costing the default tSUS of 50 us.
+// Per-byte times and the call overhead are in nanoseconds, the rest in microseconds.
+static const esp_partition_timing_t s_esp_partition_timing_presets[ESP_PARTITION_TIMING_MAX] = {
+    [ESP_PARTITION_TIMING_ESP32] = {
+        .op_overhead_ns = 20000, .read_byte_ns = 110, .write_byte_ns = 210,
+        .page_program_setup_us = 30, .page_program_byte_ns = 2500,
+        .sector_erase_us = 45000, .block_erase_us = 150000,
+        .suspend_us = 0, .suspend_interval_us = 0,
+    },
+    [ESP_PARTITION_TIMING_DIO_80M] = {
+        .op_overhead_ns = 13000, .read_byte_ns = 60, .write_byte_ns = 110,
+        .page_program_setup_us = 30, .page_program_byte_ns = 2500,
+        .sector_erase_us = 45000, .block_erase_us = 150000,
+        .suspend_us = 0, .suspend_interval_us = 0,
+    },
+    [ESP_PARTITION_TIMING_DIO_80M_AUTO_SUSPEND] = {
+        .op_overhead_ns = 13000, .read_byte_ns = 60, .write_byte_ns = 110,
+        .page_program_setup_us = 30, .page_program_byte_ns = 2500,
+        .sector_erase_us = 45000, .block_erase_us = 150000,
+        .suspend_us = 50, .suspend_interval_us = 100,
+    },
+};
+
+#if CONFIG_ESP_PARTITION_STATS_TIMING_DIO_80M
+#define ESP_PARTITION_DEFAULT_TIMING ESP_PARTITION_TIMING_DIO_80M
+#elif CONFIG_ESP_PARTITION_STATS_TIMING_DIO_80M_AUTO_SUSPEND
+#define ESP_PARTITION_DEFAULT_TIMING ESP_PARTITION_TIMING_DIO_80M_AUTO_SUSPEND
+#else
+#define ESP_PARTITION_DEFAULT_TIMING ESP_PARTITION_TIMING_ESP32
+#endif
+
+#define ESP_PARTITION_EMULATED_PAGE_SIZE 256
+#define ESP_PARTITION_EMULATED_BLOCK_SIZE 0x10000
+
+static esp_partition_timing_t s_esp_partition_timing_custom;
+static const esp_partition_timing_t *s_esp_partition_timing = &s_esp_partition_timing_presets[ESP_PARTITION_DEFAULT_TIMING];
+static uint64_t s_esp_partition_stat_total_time_ns = 0;
+static size_t s_esp_partition_stat_latency_hist[ESP_PARTITION_OP_MAX][ESP_PARTITION_LATENCY_BUCKETS];
+
+// Adds the time lost by suspending a program or erase operation taking busy_ns
+static uint64_t esp_partition_stat_suspend_time(uint64_t busy_ns)
+{
+    if (s_esp_partition_timing->suspend_interval_us == 0) {
+        return busy_ns;
+    }
+    uint64_t suspends = busy_ns / (s_esp_partition_timing->suspend_interval_us * 1000ULL);
+    return busy_ns + suspends * s_esp_partition_timing->suspend_us * 1000ULL;
+}
+
+// Accumulates the estimated time of an operation and counts it in the latency histogram
+static void esp_partition_stat_add_time(esp_partition_op_t op, uint64_t time_ns)
+{
+    s_esp_partition_stat_total_time_ns += time_ns;
+
+    uint64_t time_us = time_ns / 1000;
+    int bucket = (time_us == 0) ? 0 : 63 - __builtin_clzll(time_us);
+    if (bucket >= ESP_PARTITION_LATENCY_BUCKETS) {
+        bucket = ESP_PARTITION_LATENCY_BUCKETS - 1;
+    }
+    s_esp_partition_stat_latency_hist[op][bucket]++;
+}
+
+// Estimated time of reading size bytes
+static uint64_t esp_partition_stat_read_time(size_t size)
+{
+    return s_esp_partition_timing->op_overhead_ns + (uint64_t) size * s_esp_partition_timing->read_byte_ns;
+}
+
+// Estimated time of writing size bytes at offset from the flash beginning, programming each touched page separately
+static uint64_t esp_partition_stat_write_time(size_t offset, size_t size)
+{
+    uint64_t busy_ns = 0;
+    while (size > 0) {
+        size_t chunk = ESP_PARTITION_EMULATED_PAGE_SIZE - offset % ESP_PARTITION_EMULATED_PAGE_SIZE;
+        if (chunk > size) {
+            chunk = size;
+        }
+        busy_ns += s_esp_partition_timing->page_program_setup_us * 1000ULL
+                   + (uint64_t) (chunk - 1) * s_esp_partition_timing->page_program_byte_ns;
+        offset += chunk;
+        size -= chunk;
+    }
+    return esp_partition_stat_suspend_time(busy_ns);
+}
+
+// Estimated time of erasing sector_count sectors from first_sector, using block erases for aligned blocks
+static uint64_t esp_partition_stat_erase_time(size_t first_sector, size_t sector_count)
+{
+    const size_t sectors_per_block = ESP_PARTITION_EMULATED_BLOCK_SIZE / ESP_PARTITION_EMULATED_SECTOR_SIZE;
+    uint64_t busy_ns = 0;
+    size_t sector = first_sector;
+    while (sector < first_sector + sector_count) {
+        if (sector % sectors_per_block == 0 && first_sector + sector_count - sector >= sectors_per_block) {
+            busy_ns += s_esp_partition_timing->block_erase_us * 1000ULL;
+            sector += sectors_per_block;
+        } else {
+            busy_ns += s_esp_partition_timing->sector_erase_us * 1000ULL;
+            sector++;
+        }
+    }
+    return s_esp_partition_timing->op_overhead_ns + esp_partition_stat_suspend_time(busy_ns);
 }
 
 // Registers read access statistics of emulated SPI FLASH device (Linux host)
@@ -598,7 +683,7 @@ static void esp_partition_hook_read(const void *srcAddr, const size_t size)
     // stats
     ++s_esp_partition_stat_read_ops;
     s_esp_partition_stat_read_bytes += size;
-    s_esp_partition_stat_total_time += esp_partition_stat_time_interpolate((uint32_t) size, s_esp_partition_stat_read_times);
+    esp_partition_stat_add_time(ESP_PARTITION_OP_READ, esp_partition_stat_read_time(size));
 }
 
 // Registers write access statistics of emulated SPI FLASH device (Linux host)
@@ -641,7 +726,10 @@ static bool esp_partition_hook_write(const void *dstAddr, size_t *size)
         // stats
         ++s_esp_partition_stat_write_ops;
         s_esp_partition_stat_write_bytes += write_cycles * 4;
-        s_esp_partition_stat_total_time += esp_partition_stat_time_interpolate((uint32_t) (*size), s_esp_partition_stat_write_times);
+        ptrdiff_t offset = dstAddr - s_spiflash_mem_file_buf;
+        esp_partition_stat_add_time(ESP_PARTITION_OP_WRITE, s_esp_partition_timing->op_overhead_ns
+                                    + (uint64_t) (*size) * s_esp_partition_timing->write_byte_ns
+                                    + esp_partition_stat_write_time(offset, *size));
     }
 
     return ret_val;
@@ -694,8 +782,8 @@ static bool esp_partition_hook_erase(const void *dstAddr, size_t *size)
     for (size_t sector_index = first_sector_idx; sector_index < first_sector_idx + sector_count; sector_index++) {
         ++s_esp_partition_stat_erase_ops;
         s_esp_partition_stat_sector_erase_count[sector_index]++;
-        s_esp_partition_stat_total_time += s_esp_partition_stat_block_erase_time;
     }
+    esp_partition_stat_add_time(ESP_PARTITION_OP_ERASE, esp_partition_stat_erase_time(first_sector_idx, sector_count));
 
     return ret_val;
 }
@@ -707,7 +795,8 @@ void esp_partition_clear_stats(void)
     s_esp_partition_stat_erase_ops = 0;
     s_esp_partition_stat_read_ops = 0;
     s_esp_partition_stat_write_ops = 0;
-    s_esp_partition_stat_total_time = 0;
+    s_esp_partition_stat_total_time_ns = 0;
+    memset(s_esp_partition_stat_latency_hist, 0, sizeof(s_esp_partition_stat_latency_hist));
 
     memset(s_esp_partition_stat_sector_erase_count, 0, sizeof(size_t) * s_esp_partition_file_mmap_ctrl_act.flash_file_size / ESP_PARTITION_EMULATED_SECTOR_SIZE);
 }
@@ -739,7 +828,42 @@ size_t esp_partition_get_write_bytes(void)
 
 size_t esp_partition_get_total_time(void)
 {
-    return s_esp_partition_stat_total_time;
+    return s_esp_partition_stat_total_time_ns / 1000;
+}
+
+const esp_partition_timing_t *esp_partition_get_timing_preset(esp_partition_timing_chip_t chip)
+{
+    if (chip < 0 || chip >= ESP_PARTITION_TIMING_MAX) {
+        return NULL;
+    }
+    return &s_esp_partition_timing_presets[chip];
+}
+
+esp_err_t esp_partition_set_timing(const esp_partition_timing_t *timing)
+{
+    if (timing == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    s_esp_partition_timing_custom = *timing;
+    s_esp_partition_timing = &s_esp_partition_timing_custom;
+    return ESP_OK;
+}
+
+const esp_partition_timing_t *esp_partition_get_timing(void)
+{
+    return s_esp_partition_timing;
+}
+
+esp_err_t esp_partition_get_latency_histogram(esp_partition_op_t op, size_t *buckets, size_t bucket_count)
+{
+    if (op < 0 || op >= ESP_PARTITION_OP_MAX || buckets == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (bucket_count > ESP_PARTITION_LATENCY_BUCKETS) {
+        bucket_count = ESP_PARTITION_LATENCY_BUCKETS;
+    }
+    memcpy(buckets, s_esp_partition_stat_latency_hist[op], bucket_count * sizeof(size_t));
+    return ESP_OK;
 }
 
 void esp_partition_fail_after(size_t count, uint8_t mode)
@@ -1,11 +1,12 @@
 /*
- * SPDX-FileCopyrightText: 2023 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2023-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
 
 #pragma once
 
+#include <sys/uio.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/queue.h"
 
@@ -41,6 +42,15 @@ typedef enum {
      * time.
      */
     RINGBUF_TYPE_BYTEBUF,
+    /**
+     * Single-producer single-consumer byte buffers behave like byte buffers,
+     * but sending and receiving don't take the ring buffer's spinlock unless
+     * the sender or the receiver has to block or wake the other side. All data
+     * must be sent by a single task or ISR and received and returned by a
+     * single task or ISR. One byte of the storage is kept unused, thus the
+     * maximum item size is one less than the buffer size.
+     */
+    RINGBUF_TYPE_BYTEBUF_SPSC,
     RINGBUF_TYPE_MAX,
 } RingbufferType_t;
 
@@ -139,6 +149,31 @@ BaseType_t xRingbufferSend(RingbufHandle_t xRingbuffer,
                            size_t xItemSize,
                            TickType_t xTicksToWait);
 
+/**
+ * @brief       Insert an item gathered from several segments into the ring buffer
+ *
+ * Same as xRingbufferSend(), but the data of the item is given as a list of
+ * segments, e.g. a header and a payload. The segments are copied directly into
+ * the ring buffer one after another and form a single item of the total size of
+ * all segments, without assembling the item in a temporary buffer first.
+ *
+ * @param[in]   xRingbuffer     Ring buffer to insert the item into
+ * @param[in]   pxIOV           Segments of the item. NULL is allowed if xIOVCount is 0.
+ *                              The base of a segment may be NULL if its length is 0.
+ * @param[in]   xIOVCount       Number of segments
+ * @param[in]   xTicksToWait    Ticks to wait for room in the ring buffer.
+ *
+ * @note    The notes of xRingbufferSend() apply to the total size of all segments.
+ *
+ * @return
+ *      - pdTRUE if succeeded
+ *      - pdFALSE on time-out or when the data is larger than the maximum permissible size of the buffer
+ */
+BaseType_t xRingbufferSendv(RingbufHandle_t xRingbuffer,
+                            const struct iovec *pxIOV,
+                            size_t xIOVCount,
+                            TickType_t xTicksToWait);
+
 /**
  * @brief       Insert an item into the ring buffer in an ISR
  *
@@ -362,6 +397,38 @@ void *xRingbufferReceiveUpTo(RingbufHandle_t xRingbuffer,
  */
 void *xRingbufferReceiveUpToFromISR(RingbufHandle_t xRingbuffer, size_t *pxItemSize, size_t xMaxSize);
 
+/**
+ * @brief   Retrieve an item from the ring buffer as a pair of segments
+ *
+ * Works alike for all types of ring buffers. An item that wraps around the end of
+ * the ring buffer is retrieved in two segments: pxIOV[0] holds the part up to the
+ * end of the ring buffer and pxIOV[1] the part at the start of the ring buffer.
+ * If the item doesn't wrap around, pxIOV[1] has a NULL base and a length of 0.
+ *
+ * - No-split buffers never wrap items around, so pxIOV[1] is always empty.
+ * - For allow-split buffers, the segments are the parts of a split item, like
+ *   with xRingbufferReceiveSplit().
+ * - For byte buffers, all data up to xMaxSize bytes is retrieved at once, where
+ *   xRingbufferReceiveUpTo() would require two calls if the data wraps around.
+ *
+ * @param[in]   xRingbuffer     Ring buffer to retrieve the item from
+ * @param[out]  pxIOV           Array of two segments to which the retrieved item will be written
+ * @param[in]   xTicksToWait    Ticks to wait for items in the ring buffer.
+ * @param[in]   xMaxSize        Maximum number of bytes to retrieve from byte buffers, 0 for no limit.
+ *                              Must be 0 for no-split/allow-split buffers.
+ *
+ * @note    A call to vRingbufferReturnItemv() is required after this to free up the item retrieved.
+ * @note    Byte buffers do not allow multiple retrievals before returning an item
+ *
+ * @return
+ *      - pdTRUE if an item was retrieved
+ *      - pdFALSE on timeout, pxIOV is untouched in that case.
+ */
+BaseType_t xRingbufferReceivev(RingbufHandle_t xRingbuffer,
+                               struct iovec *pxIOV,
+                               TickType_t xTicksToWait,
+                               size_t xMaxSize);
+
 /**
  * @brief   Return a previously-retrieved item to the ring buffer
  *
@@ -372,6 +439,14 @@ void *xRingbufferReceiveUpToFromISR(RingbufHandle_t xRingbuffer, size_t *pxItemS
  */
 void vRingbufferReturnItem(RingbufHandle_t xRingbuffer, void *pvItem);
 
+/**
+ * @brief   Return an item retrieved with xRingbufferReceivev() to the ring buffer
+ *
+ * @param[in]   xRingbuffer Ring buffer the item was retrieved from
+ * @param[in]   pxIOV       Array of two segments filled by xRingbufferReceivev()
+ */
+void vRingbufferReturnItemv(RingbufHandle_t xRingbuffer, const struct iovec *pxIOV);
+
 /**
  * @brief   Return a previously-retrieved item to the ring buffer from an ISR
  *
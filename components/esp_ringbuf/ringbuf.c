@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2023-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2023-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -27,6 +27,17 @@
 #define rbBUFFER_FULL_FLAG          ( ( UBaseType_t ) 4 )   //The ring buffer is currently full (write pointer == free pointer)
 #define rbBUFFER_STATIC_FLAG        ( ( UBaseType_t ) 8 )   //The ring buffer is statically allocated
 #define rbUSING_QUEUE_SET           ( ( UBaseType_t ) 16 )  //The ring buffer has been added to a queue set
+#define rbSPSC_FLAG                 ( ( UBaseType_t ) 32 )  //The ring buffer is a single-producer single-consumer byte buffer
+#define rbSENDER_WAITING_FLAG       ( ( UBaseType_t ) 64 )  //The producer of a SPSC byte buffer is about to block or blocked
+#define rbRECEIVER_WAITING_FLAG     ( ( UBaseType_t ) 128 ) //The consumer of a SPSC byte buffer is about to block or blocked
+
+/*
+SPSC byte buffers are accessed without the spinlock except to block and wake. The producer owns pucAcquire
+and pucWrite, the consumer owns pucRead and pucFree. Each side publishes its positions with release stores
+and reads the other side's positions with acquire loads.
+*/
+#define rbLOAD_ACQUIRE( pucPos )            __atomic_load_n( &( pucPos ), __ATOMIC_ACQUIRE )
+#define rbSTORE_RELEASE( pucPos, pucVal )   __atomic_store_n( &( pucPos ), ( pucVal ), __ATOMIC_RELEASE )
 
 //Item flags
 #define rbITEM_FREE_FLAG            ( ( UBaseType_t ) 1 )   //Item has been retrieved and returned by application, free to overwrite
@@ -43,7 +54,7 @@ typedef struct {
 #define rbHEADER_SIZE     sizeof(ItemHeader_t)
 typedef struct RingbufferDefinition Ringbuffer_t;
 typedef BaseType_t (*CheckItemFitsFunction_t)(Ringbuffer_t *pxRingbuffer, size_t xItemSize);
-typedef void (*CopyItemFunction_t)(Ringbuffer_t *pxRingbuffer, const uint8_t *pcItem, size_t xItemSize);
+typedef void (*CopyItemFunction_t)(Ringbuffer_t *pxRingbuffer, const struct iovec *pxIOV, size_t xItemSize);
 typedef BaseType_t (*CheckItemAvailFunction_t)(Ringbuffer_t *pxRingbuffer);
 typedef void *(*GetItemFunction_t)(Ringbuffer_t *pxRingbuffer, BaseType_t *pxIsSplit, size_t xMaxSize, size_t *pxItemSize);
 typedef void (*ReturnItemFunction_t)(Ringbuffer_t *pxRingbuffer, uint8_t *pvItem);
@@ -104,6 +115,14 @@ static BaseType_t prvCheckItemFitsDefault(Ringbuffer_t *pxRingbuffer, size_t xIt
 static BaseType_t prvCheckItemFitsByteBuffer(Ringbuffer_t *pxRingbuffer, size_t xItemSize);
 
 /*
+Copies xLen bytes of an item from its segments to pucDest. *ppxIOV and *pxIOVOffset point to the first byte to
+copy and are advanced past the copied bytes, so that an item can be copied in several parts.
+*/
+static void prvGatherItem(uint8_t *pucDest, const struct iovec **ppxIOV, size_t *pxIOVOffset, size_t xLen);
+
+/*
+The following functions copy an item, given as the segments of pxIOV of xItemSize bytes in total, to the ring buffer.
+
 Copies an item to a no-split ring buffer
 Entry:
     - Must have already guaranteed there is sufficient space for item by calling prvCheckItemFitsDefault()
@@ -112,7 +131,7 @@ Exit:
     - pucAcquire and pucWrite updated.
     - Dummy item added if necessary
 */
-static void prvCopyItemNoSplit(Ringbuffer_t *pxRingbuffer, const uint8_t *pucItem, size_t xItemSize);
+static void prvCopyItemNoSplit(Ringbuffer_t *pxRingbuffer, const struct iovec *pxIOV, size_t xItemSize);
 
 /*
 Copies an item to a allow-split ring buffer
@@ -123,10 +142,10 @@ Exit:
     - pucAcquire and pucWrite updated
     - Item may be split
 */
-static void prvCopyItemAllowSplit(Ringbuffer_t *pxRingbuffer, const uint8_t *pucItem, size_t xItemSize);
+static void prvCopyItemAllowSplit(Ringbuffer_t *pxRingbuffer, const struct iovec *pxIOV, size_t xItemSize);
 
 //Copies an item to a byte buffer. Only call this function  after calling prvCheckItemFitsByteBuffer()
-static void prvCopyItemByteBuf(Ringbuffer_t *pxRingbuffer, const uint8_t *pucItem, size_t xItemSize);
+static void prvCopyItemByteBuf(Ringbuffer_t *pxRingbuffer, const struct iovec *pxIOV, size_t xItemSize);
 
 //Retrieve item from no-split/allow-split ring buffer. *pxIsSplit is set to pdTRUE if the retrieved item is split
 /*
@@ -149,6 +168,16 @@ static void *prvGetItemByteBuf(Ringbuffer_t *pxRingbuffer,
                                size_t xMaxSize,
                                size_t *pxItemSize);
 
+/*
+Retrieve the data that wrapped around to the head of a byte buffer or SPSC byte buffer, right after prvGetItemByteBuf()
+or prvGetItemSPSC() retrieved data up to the tail. xMaxSize limits the total size of both retrievals, 0 means no limit.
+Returns NULL if there is no such data. Both retrievals are freed at once when the first one is returned.
+*/
+static void *prvGetWrappedItemByteBuf(Ringbuffer_t *pxRingbuffer,
+                                      size_t xMaxSize,
+                                      size_t xRetrievedSize,
+                                      size_t *pxItemSize);
+
 /*
 Return an item to a split/no-split ring buffer
 Exit:
@@ -169,13 +198,63 @@ static size_t prvGetCurMaxSizeAllowSplit(Ringbuffer_t *pxRingbuffer);
 //Get the maximum size an item that can currently have if sent to a byte buffer
 static size_t prvGetCurMaxSizeByteBuf(Ringbuffer_t *pxRingbuffer);
 
+/*
+The following functions implement SPSC byte buffers. Unlike the functions above, they are called without
+the spinlock. Functions of the producer side must only be called by the producer, functions of the consumer
+side only by the consumer.
+*/
+
+//Checks if an item will currently fit in a SPSC byte buffer (producer side)
+static BaseType_t prvCheckItemFitsSPSC(Ringbuffer_t *pxRingbuffer, size_t xItemSize);
+
+//Copies an item to a SPSC byte buffer and publishes it. Only call this function after calling prvCheckItemFitsSPSC() (producer side)
+static void prvCopyItemSPSC(Ringbuffer_t *pxRingbuffer, const struct iovec *pxIOV, size_t xItemSize);
+
+//Retrieve data from a SPSC byte buffer. If xMaxSize is 0, all continuous data is retrieved (consumer side)
+static void *prvGetItemSPSC(Ringbuffer_t *pxRingbuffer,
+                            BaseType_t *pxUnusedParam,
+                            size_t xMaxSize,
+                            size_t *pxItemSize);
+
+//Return data to a SPSC byte buffer (consumer side)
+static void prvReturnItemSPSC(Ringbuffer_t *pxRingbuffer, uint8_t *pucItem);
+
+//Get the maximum size an item that can currently have if sent to a SPSC byte buffer
+static size_t prvGetCurMaxSizeSPSC(Ringbuffer_t *pxRingbuffer);
+
+/*
+Wakes the task blocked on the other side of a SPSC byte buffer after this side has published its positions.
+uxWaitingFlag and pxTasksWaiting select the other side. The spinlock is only taken if that side has announced
+that it is about to block.
+*/
+static void prvWakeWaitingTaskSPSC(Ringbuffer_t *pxRingbuffer,
+                                   UBaseType_t uxWaitingFlag,
+                                   List_t *pxTasksWaiting,
+                                   BaseType_t xFromISR,
+                                   BaseType_t *pxHigherPriorityTaskWoken);
+
+//Send function of SPSC byte buffers, see prvSendAcquireGeneric()
+static BaseType_t prvSendSPSC(Ringbuffer_t *pxRingbuffer,
+                              const struct iovec *pxIOV,
+                              size_t xItemSize,
+                              TickType_t xTicksToWait);
+
+//Receive function of SPSC byte buffers, see prvReceiveGeneric()
+static BaseType_t prvReceiveSPSC(Ringbuffer_t *pxRingbuffer,
+                                 void **pvItem1,
+                                 void **pvItem2,
+                                 size_t *xItemSize1,
+                                 size_t *xItemSize2,
+                                 size_t xMaxSize,
+                                 TickType_t xTicksToWait);
+
 /*
 Generic function used to send or acquire an item/buffer.
-- If sending, set ppvItem to NULL. pvItem remains unchanged on failure.
-- If acquiring, set pvItem to NULL. ppvItem remains unchanged on failure.
+- If sending, set ppvItem to NULL. pxIOV holds the segments of the item, xItemSize bytes in total.
+- If acquiring, set pxIOV to NULL. ppvItem remains unchanged on failure.
 */
 static BaseType_t prvSendAcquireGeneric(Ringbuffer_t *pxRingbuffer,
-                                        const void *pvItem,
+                                        const struct iovec *pxIOV,
                                         void **ppvItem,
                                         size_t xItemSize,
                                         TickType_t xTicksToWait);
@@ -183,8 +262,10 @@ static BaseType_t prvSendAcquireGeneric(Ringbuffer_t *pxRingbuffer,
 /*
 Generic function used to retrieve an item/data from ring buffers. If called on
 an allow-split buffer, and pvItem2 and xItemSize2 are not NULL, both parts of
-a split item will be retrieved. xMaxSize will only take effect if called on
-byte buffers. xItemSize must remain unchanged if no item is retrieved.
+a split item will be retrieved. If called on a byte buffer with pvItem2 and
+xItemSize2 not NULL, the data that wraps around to the head of the buffer is
+retrieved as the second part, or pvItem2 is set to NULL if there is none.
+xMaxSize will only take effect if called on byte buffers. xItemSize must remain unchanged if no item is retrieved.
 */
 static BaseType_t prvReceiveGeneric(Ringbuffer_t *pxRingbuffer,
                                     void **pvItem1,
@@ -241,6 +322,15 @@ static void prvInitializeNewRingbuffer(size_t xBufferSize,
         //Worst case an item is split into two, incurring two headers of overhead
         pxNewRingbuffer->xMaxItemSize = pxNewRingbuffer->xSize - (sizeof(ItemHeader_t) * 2);
         pxNewRingbuffer->xGetCurMaxSize = prvGetCurMaxSizeAllowSplit;
+    } else if (xBufferType == RINGBUF_TYPE_BYTEBUF_SPSC) {
+        pxNewRingbuffer->uxRingbufferFlags |= rbBYTE_BUFFER_FLAG | rbSPSC_FLAG;
+        pxNewRingbuffer->xCheckItemFits = prvCheckItemFitsSPSC;
+        pxNewRingbuffer->vCopyItem = prvCopyItemSPSC;
+        pxNewRingbuffer->pvGetItem = prvGetItemSPSC;
+        pxNewRingbuffer->vReturnItem = prvReturnItemSPSC;
+        //One byte is left unused to distinguish a full buffer from an empty one without a shared full flag
+        pxNewRingbuffer->xMaxItemSize = pxNewRingbuffer->xSize - 1;
+        pxNewRingbuffer->xGetCurMaxSize = prvGetCurMaxSizeSPSC;
     } else { //Byte Buffer
         pxNewRingbuffer->uxRingbufferFlags |= rbBYTE_BUFFER_FLAG;
         pxNewRingbuffer->xCheckItemFits = prvCheckItemFitsByteBuffer;
@@ -262,7 +352,9 @@ static void prvInitializeNewRingbuffer(size_t xBufferSize,
 static size_t prvGetFreeSize(Ringbuffer_t *pxRingbuffer)
 {
     size_t xReturn;
-    if (pxRingbuffer->uxRingbufferFlags & rbBUFFER_FULL_FLAG) {
+    if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+        xReturn = prvGetCurMaxSizeSPSC(pxRingbuffer);
+    } else if (pxRingbuffer->uxRingbufferFlags & rbBUFFER_FULL_FLAG) {
         xReturn =  0;
     } else {
         BaseType_t xFreeSize = pxRingbuffer->pucFree - pxRingbuffer->pucAcquire;
@@ -321,6 +413,27 @@ static BaseType_t prvCheckItemFitsByteBuffer(Ringbuffer_t *pxRingbuffer, size_t
     return (xItemSize <= pxRingbuffer->xSize - (pxRingbuffer->pucAcquire - pxRingbuffer->pucFree)) ? pdTRUE : pdFALSE;
 }
 
+static void prvGatherItem(uint8_t *pucDest, const struct iovec **ppxIOV, size_t *pxIOVOffset, size_t xLen)
+{
+    while (xLen > 0) {
+        //Copy as much as possible from the current segment, then move on to the next one
+        size_t xCopyLen = (*ppxIOV)->iov_len - *pxIOVOffset;
+        if (xCopyLen > xLen) {
+            xCopyLen = xLen;
+        }
+        if (xCopyLen > 0) {
+            memcpy(pucDest, (const uint8_t *)(*ppxIOV)->iov_base + *pxIOVOffset, xCopyLen);
+            pucDest += xCopyLen;
+            xLen -= xCopyLen;
+            *pxIOVOffset += xCopyLen;
+        }
+        if (*pxIOVOffset == (*ppxIOV)->iov_len) {
+            (*ppxIOV)++;
+            *pxIOVOffset = 0;
+        }
+    }
+}
+
 static uint8_t* prvAcquireItemNoSplit(Ringbuffer_t *pxRingbuffer, size_t xItemSize)
 {
     //Check arguments and buffer state
@@ -405,16 +518,18 @@ static void prvSendItemDoneNoSplit(Ringbuffer_t *pxRingbuffer, uint8_t* pucItem)
     }
 }
 
-static void prvCopyItemNoSplit(Ringbuffer_t *pxRingbuffer, const uint8_t *pucItem, size_t xItemSize)
+static void prvCopyItemNoSplit(Ringbuffer_t *pxRingbuffer, const struct iovec *pxIOV, size_t xItemSize)
 {
+    size_t xIOVOffset = 0;
     uint8_t* item_addr = prvAcquireItemNoSplit(pxRingbuffer, xItemSize);
-    memcpy(item_addr, pucItem, xItemSize);
+    prvGatherItem(item_addr, &pxIOV, &xIOVOffset, xItemSize);
     prvSendItemDoneNoSplit(pxRingbuffer, item_addr);
 }
 
-static void prvCopyItemAllowSplit(Ringbuffer_t *pxRingbuffer, const uint8_t *pucItem, size_t xItemSize)
+static void prvCopyItemAllowSplit(Ringbuffer_t *pxRingbuffer, const struct iovec *pxIOV, size_t xItemSize)
 {
     //Check arguments and buffer state
+    size_t xIOVOffset = 0;
     size_t xAlignedItemSize = rbALIGN_SIZE(xItemSize);                  //Rounded up aligned item size
     size_t xRemLen = pxRingbuffer->pucTail - pxRingbuffer->pucAcquire;    //Length from pucAcquire until end of buffer
     configASSERT(rbCHECK_ALIGNED(pxRingbuffer->pucAcquire));              //pucAcquire is always aligned in split ring buffers
@@ -430,10 +545,9 @@ static void prvCopyItemAllowSplit(Ringbuffer_t *pxRingbuffer, const uint8_t *puc
         pxRingbuffer->pucAcquire += rbHEADER_SIZE;            //Advance pucAcquire past header
         xRemLen -= rbHEADER_SIZE;
         if (xRemLen > 0) {
-            memcpy(pxRingbuffer->pucAcquire, pucItem, xRemLen);
+            prvGatherItem(pxRingbuffer->pucAcquire, &pxIOV, &xIOVOffset, xRemLen);
             pxRingbuffer->xItemsWaiting++;
             //Update item arguments to account for data already copied
-            pucItem += xRemLen;
             xItemSize -= xRemLen;
             xAlignedItemSize -= xRemLen;
             pxFirstHeader->uxItemFlags |= rbITEM_SPLIT_FLAG;        //There must be more data
@@ -449,7 +563,7 @@ static void prvCopyItemAllowSplit(Ringbuffer_t *pxRingbuffer, const uint8_t *puc
     pxSecondHeader->xItemLen = xItemSize;
     pxSecondHeader->uxItemFlags = 0;
     pxRingbuffer->pucAcquire += rbHEADER_SIZE;     //Advance acquire pointer past header
-    memcpy(pxRingbuffer->pucAcquire, pucItem, xItemSize);
+    prvGatherItem(pxRingbuffer->pucAcquire, &pxIOV, &xIOVOffset, xItemSize);
     pxRingbuffer->xItemsWaiting++;
     pxRingbuffer->pucAcquire += xAlignedItemSize;  //Advance pucAcquire past item to next aligned address
 
@@ -467,23 +581,23 @@ static void prvCopyItemAllowSplit(Ringbuffer_t *pxRingbuffer, const uint8_t *puc
     pxRingbuffer->pucWrite = pxRingbuffer->pucAcquire;
 }
 
-static void prvCopyItemByteBuf(Ringbuffer_t *pxRingbuffer, const uint8_t *pucItem, size_t xItemSize)
+static void prvCopyItemByteBuf(Ringbuffer_t *pxRingbuffer, const struct iovec *pxIOV, size_t xItemSize)
 {
+    size_t xIOVOffset = 0;
     //Check arguments and buffer state
     configASSERT(pxRingbuffer->pucAcquire >= pxRingbuffer->pucHead && pxRingbuffer->pucAcquire < pxRingbuffer->pucTail);    //Check acquire pointer is within bounds
 
     size_t xRemLen = pxRingbuffer->pucTail - pxRingbuffer->pucAcquire;    //Length from pucAcquire until end of buffer
     if (xRemLen < xItemSize) {
         //Copy as much as possible into remaining length
-        memcpy(pxRingbuffer->pucAcquire, pucItem, xRemLen);
+        prvGatherItem(pxRingbuffer->pucAcquire, &pxIOV, &xIOVOffset, xRemLen);
         pxRingbuffer->xItemsWaiting += xRemLen;
         //Update item arguments to account for data already written
-        pucItem += xRemLen;
         xItemSize -= xRemLen;
         pxRingbuffer->pucAcquire = pxRingbuffer->pucHead;     //Reset acquire pointer to start of buffer
     }
     //Copy all or remaining portion of the item
-    memcpy(pxRingbuffer->pucAcquire, pucItem, xItemSize);
+    prvGatherItem(pxRingbuffer->pucAcquire, &pxIOV, &xIOVOffset, xItemSize);
     pxRingbuffer->xItemsWaiting += xItemSize;
     pxRingbuffer->pucAcquire += xItemSize;
 
@@ -505,6 +619,10 @@ static BaseType_t prvCheckItemAvail(Ringbuffer_t *pxRingbuffer)
     if ((pxRingbuffer->uxRingbufferFlags & rbBYTE_BUFFER_FLAG) && pxRingbuffer->pucRead != pxRingbuffer->pucFree) {
         return pdFALSE;     //Byte buffers do not allow multiple retrievals before return
     }
+    if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+        //xItemsWaiting is not maintained, the read pointer only equals the published write pointer if there is no data
+        return (pxRingbuffer->pucRead != rbLOAD_ACQUIRE(pxRingbuffer->pucWrite)) ? pdTRUE : pdFALSE;
+    }
     if ((pxRingbuffer->xItemsWaiting > 0) && ((pxRingbuffer->pucRead != pxRingbuffer->pucWrite) || (pxRingbuffer->uxRingbufferFlags & rbBUFFER_FULL_FLAG))) {
         // If the ring buffer is a no-split buffer, the read pointer must point to an item that has been written to.
         if ((pxRingbuffer->uxRingbufferFlags & (rbBYTE_BUFFER_FLAG | rbALLOW_SPLIT_FLAG)) == 0) {
@@ -601,6 +719,42 @@ static void *prvGetItemByteBuf(Ringbuffer_t *pxRingbuffer,
     return (void *)ret;
 }
 
+static void *prvGetWrappedItemByteBuf(Ringbuffer_t *pxRingbuffer,
+                                      size_t xMaxSize,
+                                      size_t xRetrievedSize,
+                                      size_t *pxItemSize)
+{
+    //Data only wraps around if the previous retrieval started after the head and ended at the tail
+    if (pxRingbuffer->pucRead != pxRingbuffer->pucHead || pxRingbuffer->pucFree == pxRingbuffer->pucHead) {
+        return NULL;
+    }
+    if (xMaxSize != 0 && xRetrievedSize >= xMaxSize) {
+        return NULL;
+    }
+
+    //All remaining data is contiguous from the head of the buffer
+    size_t xItemSize;
+    if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+        xItemSize = rbLOAD_ACQUIRE(pxRingbuffer->pucWrite) - pxRingbuffer->pucHead;
+    } else {
+        xItemSize = pxRingbuffer->xItemsWaiting;
+    }
+    if (xItemSize == 0) {
+        return NULL;
+    }
+    if (xMaxSize != 0 && xItemSize > xMaxSize - xRetrievedSize) {
+        xItemSize = xMaxSize - xRetrievedSize;
+    }
+    configASSERT(pxRingbuffer->pucHead + xItemSize <= pxRingbuffer->pucFree);    //Check data doesn't overlap the first retrieval
+
+    *pxItemSize = xItemSize;
+    if ((pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) == 0) {
+        pxRingbuffer->xItemsWaiting -= xItemSize;
+    }
+    pxRingbuffer->pucRead += xItemSize;     //Advance read pointer past retrieved data
+    return (void *)pxRingbuffer->pucHead;
+}
+
 static void prvReturnItemDefault(Ringbuffer_t *pxRingbuffer, uint8_t *pucItem)
 {
     //Check arguments and buffer state
@@ -749,8 +903,228 @@ static size_t prvGetCurMaxSizeByteBuf(Ringbuffer_t *pxRingbuffer)
     return xFreeSize;
 }
 
+static BaseType_t prvCheckItemFitsSPSC(Ringbuffer_t *pxRingbuffer, size_t xItemSize)
+{
+    return (xItemSize <= prvGetCurMaxSizeSPSC(pxRingbuffer)) ? pdTRUE : pdFALSE;
+}
+
+static void prvCopyItemSPSC(Ringbuffer_t *pxRingbuffer, const struct iovec *pxIOV, size_t xItemSize)
+{
+    size_t xIOVOffset = 0;
+    uint8_t *pucWrite = pxRingbuffer->pucAcquire;
+    //Check arguments and buffer state
+    configASSERT(pucWrite >= pxRingbuffer->pucHead && pucWrite < pxRingbuffer->pucTail);    //Check write pointer is within bounds
+
+    size_t xRemLen = pxRingbuffer->pucTail - pucWrite;    //Length from write pointer until end of buffer
+    if (xRemLen <= xItemSize) {
+        //Copy as much as possible into remaining length, then wrap around
+        prvGatherItem(pucWrite, &pxIOV, &xIOVOffset, xRemLen);
+        xItemSize -= xRemLen;
+        pucWrite = pxRingbuffer->pucHead;
+    }
+    //Copy all or remaining portion of the item
+    prvGatherItem(pucWrite, &pxIOV, &xIOVOffset, xItemSize);
+    pucWrite += xItemSize;
+
+    //Acquiring memory is not supported in byte mode. Publish the data by advancing the write pointer.
+    pxRingbuffer->pucAcquire = pucWrite;
+    rbSTORE_RELEASE(pxRingbuffer->pucWrite, pucWrite);
+}
+
+static void *prvGetItemSPSC(Ringbuffer_t *pxRingbuffer,
+                            BaseType_t *pxUnusedParam,
+                            size_t xMaxSize,
+                            size_t *pxItemSize)
+{
+    uint8_t *pucWrite = rbLOAD_ACQUIRE(pxRingbuffer->pucWrite);
+    uint8_t *ret = pxRingbuffer->pucRead;
+    //Check arguments and buffer state
+    configASSERT(ret != pucWrite);      //Check there is data to be read
+    configASSERT(ret >= pxRingbuffer->pucHead && ret < pxRingbuffer->pucTail);    //Check read pointer is within bounds
+    configASSERT(ret == pxRingbuffer->pucFree);
+
+    //Return contiguous piece from read pointer until write pointer or buffer tail, limited to xMaxSize
+    size_t xItemSize = ((pucWrite > ret) ? pucWrite : pxRingbuffer->pucTail) - ret;
+    if (xMaxSize != 0 && xItemSize > xMaxSize) {
+        xItemSize = xMaxSize;
+    }
+    *pxItemSize = xItemSize;
+
+    pxRingbuffer->pucRead += xItemSize;     //Advance read pointer past retrieved data
+    if (pxRingbuffer->pucRead == pxRingbuffer->pucTail) {
+        pxRingbuffer->pucRead = pxRingbuffer->pucHead;  //Wrap around read pointer
+    }
+    return (void *)ret;
+}
+
+static void prvReturnItemSPSC(Ringbuffer_t *pxRingbuffer, uint8_t *pucItem)
+{
+    //Check pointer points to address inside buffer
+    configASSERT((uint8_t *)pucItem >= pxRingbuffer->pucHead);
+    configASSERT((uint8_t *)pucItem < pxRingbuffer->pucTail);
+    //Free the read memory by publishing the free pointer to the producer
+    rbSTORE_RELEASE(pxRingbuffer->pucFree, pxRingbuffer->pucRead);
+}
+
+static size_t prvGetCurMaxSizeSPSC(Ringbuffer_t *pxRingbuffer)
+{
+    //Free space is from the write pointer up to the byte before the free pointer
+    BaseType_t xFreeSize = rbLOAD_ACQUIRE(pxRingbuffer->pucFree) - rbLOAD_ACQUIRE(pxRingbuffer->pucWrite);
+    if (xFreeSize <= 0) {
+        xFreeSize += pxRingbuffer->xSize;
+    }
+    return xFreeSize - 1;
+}
+
+static void prvWakeWaitingTaskSPSC(Ringbuffer_t *pxRingbuffer,
+                                   UBaseType_t uxWaitingFlag,
+                                   List_t *pxTasksWaiting,
+                                   BaseType_t xFromISR,
+                                   BaseType_t *pxHigherPriorityTaskWoken)
+{
+    /*
+     * Pairs with the fence of the other side between setting its waiting flag and checking the buffer again:
+     * either the other side sees the positions just published, or this side sees its waiting flag.
+     */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if ((__atomic_load_n(&pxRingbuffer->uxRingbufferFlags, __ATOMIC_RELAXED) & uxWaitingFlag) == 0) {
+        return;
+    }
+
+    if (xFromISR) {
+        portENTER_CRITICAL_ISR(&pxRingbuffer->mux);
+    } else {
+        portENTER_CRITICAL(&pxRingbuffer->mux);
+    }
+    __atomic_fetch_and(&pxRingbuffer->uxRingbufferFlags, ~uxWaitingFlag, __ATOMIC_RELAXED);
+    //If the other side is blocked, unblock it immediately.
+    if (listLIST_IS_EMPTY(pxTasksWaiting) == pdFALSE) {
+        if (xTaskRemoveFromEventList(pxTasksWaiting) == pdTRUE) {
+            //The unblocked task will preempt us
+            if (!xFromISR) {
+                portYIELD_WITHIN_API();
+            } else if (pxHigherPriorityTaskWoken != NULL) {
+                *pxHigherPriorityTaskWoken = pdTRUE;
+            }
+        }
+    }
+    if (xFromISR) {
+        portEXIT_CRITICAL_ISR(&pxRingbuffer->mux);
+    } else {
+        portEXIT_CRITICAL(&pxRingbuffer->mux);
+    }
+}
+
+static BaseType_t prvSendSPSC(Ringbuffer_t *pxRingbuffer,
+                              const struct iovec *pxIOV,
+                              size_t xItemSize,
+                              TickType_t xTicksToWait)
+{
+    BaseType_t xReturn = pdFALSE;
+    BaseType_t xExitLoop = pdFALSE;
+    BaseType_t xEntryTimeSet = pdFALSE;
+    TimeOut_t xTimeOut;
+
+    while (xExitLoop == pdFALSE) {
+        if (prvCheckItemFitsSPSC(pxRingbuffer, xItemSize) == pdTRUE) {
+            //xItemSize will fit. Copy the item immediately, without taking the spinlock
+            prvCopyItemSPSC(pxRingbuffer, pxIOV, xItemSize);
+            if (pxRingbuffer->xQueueSet) {
+                //If ring buffer was added to a queue set, notify the queue set
+                xQueueSend((QueueHandle_t)pxRingbuffer->xQueueSet, (QueueSetMemberHandle_t *)&pxRingbuffer, 0);
+            } else {
+                //If the consumer is waiting for data to arrive on the ring buffer, unblock it.
+                prvWakeWaitingTaskSPSC(pxRingbuffer, rbRECEIVER_WAITING_FLAG, &pxRingbuffer->xTasksWaitingToReceive, pdFALSE, NULL);
+            }
+            xReturn = pdTRUE;
+            break;
+        } else if (xTicksToWait == (TickType_t) 0) {
+            //No block time. Return immediately.
+            break;
+        }
+
+        portENTER_CRITICAL(&pxRingbuffer->mux);
+        if (xEntryTimeSet == pdFALSE) {
+            //This is our first block. Set entry time
+            vTaskInternalSetTimeOutState(&xTimeOut);
+            xEntryTimeSet = pdTRUE;
+        }
+        //Announce that we are about to block, then check again whether the consumer has freed space meanwhile
+        __atomic_fetch_or(&pxRingbuffer->uxRingbufferFlags, rbSENDER_WAITING_FLAG, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if (prvCheckItemFitsSPSC(pxRingbuffer, xItemSize) == pdTRUE) {
+            __atomic_fetch_and(&pxRingbuffer->uxRingbufferFlags, ~rbSENDER_WAITING_FLAG, __ATOMIC_RELAXED);
+        } else if (xTaskCheckForTimeOut(&xTimeOut, &xTicksToWait) == pdFALSE) {
+            //Not timed out yet. Block the current task
+            vTaskPlaceOnEventList(&pxRingbuffer->xTasksWaitingToSend, xTicksToWait);
+            portYIELD_WITHIN_API();
+        } else {
+            //We have timed out
+            __atomic_fetch_and(&pxRingbuffer->uxRingbufferFlags, ~rbSENDER_WAITING_FLAG, __ATOMIC_RELAXED);
+            xExitLoop = pdTRUE;
+        }
+        portEXIT_CRITICAL(&pxRingbuffer->mux);
+    }
+
+    return xReturn;
+}
+
+static BaseType_t prvReceiveSPSC(Ringbuffer_t *pxRingbuffer,
+                                 void **pvItem1,
+                                 void **pvItem2,
+                                 size_t *xItemSize1,
+                                 size_t *xItemSize2,
+                                 size_t xMaxSize,
+                                 TickType_t xTicksToWait)
+{
+    BaseType_t xReturn = pdFALSE;
+    BaseType_t xExitLoop = pdFALSE;
+    BaseType_t xEntryTimeSet = pdFALSE;
+    TimeOut_t xTimeOut;
+
+    while (xExitLoop == pdFALSE) {
+        if (prvCheckItemAvail(pxRingbuffer) == pdTRUE) {
+            //Data is available for retrieval. Read up to xMaxSize bytes without taking the spinlock
+            *pvItem1 = prvGetItemSPSC(pxRingbuffer, NULL, xMaxSize, xItemSize1);
+            if (pvItem2 != NULL && xItemSize2 != NULL) {
+                //Also read the data that wraps around to the head of the buffer
+                *pvItem2 = prvGetWrappedItemByteBuf(pxRingbuffer, xMaxSize, *xItemSize1, xItemSize2);
+            }
+            xReturn = pdTRUE;
+            break;
+        } else if (xTicksToWait == (TickType_t) 0) {
+            //No block time. Return immediately.
+            break;
+        }
+
+        portENTER_CRITICAL(&pxRingbuffer->mux);
+        if (xEntryTimeSet == pdFALSE) {
+            //This is our first block. Set entry time
+            vTaskInternalSetTimeOutState(&xTimeOut);
+            xEntryTimeSet = pdTRUE;
+        }
+        //Announce that we are about to block, then check again whether the producer has sent data meanwhile
+        __atomic_fetch_or(&pxRingbuffer->uxRingbufferFlags, rbRECEIVER_WAITING_FLAG, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if (prvCheckItemAvail(pxRingbuffer) == pdTRUE) {
+            __atomic_fetch_and(&pxRingbuffer->uxRingbufferFlags, ~rbRECEIVER_WAITING_FLAG, __ATOMIC_RELAXED);
+        } else if (xTaskCheckForTimeOut(&xTimeOut, &xTicksToWait) == pdFALSE) {
+            //Not timed out yet. Block the current task
+            vTaskPlaceOnEventList(&pxRingbuffer->xTasksWaitingToReceive, xTicksToWait);
+            portYIELD_WITHIN_API();
+        } else {
+            //We have timed out.
+            __atomic_fetch_and(&pxRingbuffer->uxRingbufferFlags, ~rbRECEIVER_WAITING_FLAG, __ATOMIC_RELAXED);
+            xExitLoop = pdTRUE;
+        }
+        portEXIT_CRITICAL(&pxRingbuffer->mux);
+    }
+
+    return xReturn;
+}
+
 static BaseType_t prvSendAcquireGeneric(Ringbuffer_t *pxRingbuffer,
-                                        const void *pvItem,
+                                        const struct iovec *pxIOV,
                                         void **ppvItem,
                                         size_t xItemSize,
                                         TickType_t xTicksToWait)
@@ -761,6 +1135,11 @@ static BaseType_t prvSendAcquireGeneric(Ringbuffer_t *pxRingbuffer,
     BaseType_t xNotifyQueueSet = pdFALSE;
     TimeOut_t xTimeOut;
 
+    if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+        configASSERT(ppvItem == NULL);
+        return prvSendSPSC(pxRingbuffer, pxIOV, xItemSize, xTicksToWait);
+    }
+
     while (xExitLoop == pdFALSE) {
         portENTER_CRITICAL(&pxRingbuffer->mux);
         if (pxRingbuffer->xCheckItemFits(pxRingbuffer, xItemSize) == pdTRUE) {
@@ -770,7 +1149,7 @@ static BaseType_t prvSendAcquireGeneric(Ringbuffer_t *pxRingbuffer,
                 *ppvItem = prvAcquireItemNoSplit(pxRingbuffer, xItemSize);
             } else {
                 //Copy item into buffer
-                pxRingbuffer->vCopyItem(pxRingbuffer, pvItem, xItemSize);
+                pxRingbuffer->vCopyItem(pxRingbuffer, pxIOV, xItemSize);
                 if (pxRingbuffer->xQueueSet) {
                     //If ring buffer was added to a queue set, notify the queue set
                     xNotifyQueueSet = pdTRUE;
@@ -831,6 +1210,10 @@ static BaseType_t prvReceiveGeneric(Ringbuffer_t *pxRingbuffer,
 
     ESP_STATIC_ANALYZER_CHECK(!pvItem1 || !xItemSize1, pdFALSE);
 
+    if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+        return prvReceiveSPSC(pxRingbuffer, pvItem1, pvItem2, xItemSize1, xItemSize2, xMaxSize, xTicksToWait);
+    }
+
     while (xExitLoop == pdFALSE) {
         portENTER_CRITICAL(&pxRingbuffer->mux);
         if (prvCheckItemAvail(pxRingbuffer) == pdTRUE) {
@@ -839,6 +1222,10 @@ static BaseType_t prvReceiveGeneric(Ringbuffer_t *pxRingbuffer,
             if (pxRingbuffer->uxRingbufferFlags & rbBYTE_BUFFER_FLAG) {
                 //Read up to xMaxSize bytes from byte buffer
                 *pvItem1 = pxRingbuffer->pvGetItem(pxRingbuffer, NULL, xMaxSize, xItemSize1);
+                if (pvItem2 != NULL && xItemSize2 != NULL) {
+                    //Also read the data that wraps around to the head of the buffer
+                    *pvItem2 = prvGetWrappedItemByteBuf(pxRingbuffer, xMaxSize, *xItemSize1, xItemSize2);
+                }
             } else {
                 //Get (first) item from no-split/allow-split buffers
                 *pvItem1 = pxRingbuffer->pvGetItem(pxRingbuffer, &xIsSplit, 0, xItemSize1);
@@ -893,6 +1280,14 @@ static BaseType_t prvReceiveGenericFromISR(Ringbuffer_t *pxRingbuffer,
 
     ESP_STATIC_ANALYZER_CHECK(!pvItem1 || !xItemSize1, pdFALSE);
 
+    if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+        if (prvCheckItemAvail(pxRingbuffer) == pdTRUE) {
+            *pvItem1 = prvGetItemSPSC(pxRingbuffer, NULL, xMaxSize, xItemSize1);
+            xReturn = pdTRUE;
+        }
+        return xReturn;
+    }
+
     portENTER_CRITICAL_ISR(&pxRingbuffer->mux);
     if (prvCheckItemAvail(pxRingbuffer) == pdTRUE) {
         BaseType_t xIsSplit = pdFALSE;
@@ -931,7 +1326,7 @@ RingbufHandle_t xRingbufferCreate(size_t xBufferSize, RingbufferType_t xBufferTy
     configASSERT(xBufferType < RINGBUF_TYPE_MAX);
 
     //Allocate memory
-    if (xBufferType != RINGBUF_TYPE_BYTEBUF) {
+    if (xBufferType != RINGBUF_TYPE_BYTEBUF && xBufferType != RINGBUF_TYPE_BYTEBUF_SPSC) {
         xBufferSize = rbALIGN_SIZE(xBufferSize);    //xBufferSize is rounded up for no-split/allow-split buffers
     }
     Ringbuffer_t *pxNewRingbuffer = calloc(1, sizeof(Ringbuffer_t));
@@ -964,7 +1359,7 @@ RingbufHandle_t xRingbufferCreateStatic(size_t xBufferSize,
     configASSERT(xBufferSize > 0);
     configASSERT(xBufferType < RINGBUF_TYPE_MAX);
     configASSERT(pucRingbufferStorage != NULL && pxStaticRingbuffer != NULL);
-    if (xBufferType != RINGBUF_TYPE_BYTEBUF) {
+    if (xBufferType != RINGBUF_TYPE_BYTEBUF && xBufferType != RINGBUF_TYPE_BYTEBUF_SPSC) {
         //No-split/allow-split buffer sizes must be 32-bit aligned
         configASSERT(rbCHECK_ALIGNED(xBufferSize));
     }
@@ -1028,12 +1423,29 @@ BaseType_t xRingbufferSend(RingbufHandle_t xRingbuffer,
                            const void *pvItem,
                            size_t xItemSize,
                            TickType_t xTicksToWait)
+{
+    struct iovec xIOV = {
+        .iov_base = (void *)pvItem,
+        .iov_len = xItemSize,
+    };
+    return xRingbufferSendv(xRingbuffer, &xIOV, 1, xTicksToWait);
+}
+
+BaseType_t xRingbufferSendv(RingbufHandle_t xRingbuffer,
+                            const struct iovec *pxIOV,
+                            size_t xIOVCount,
+                            TickType_t xTicksToWait)
 {
     Ringbuffer_t *pxRingbuffer = (Ringbuffer_t *)xRingbuffer;
+    size_t xItemSize = 0;
 
     //Check arguments
     configASSERT(pxRingbuffer);
-    configASSERT(pvItem != NULL || xItemSize == 0);
+    configASSERT(pxIOV != NULL || xIOVCount == 0);
+    for (size_t i = 0; i < xIOVCount; i++) {
+        configASSERT(pxIOV[i].iov_base != NULL || pxIOV[i].iov_len == 0);
+        xItemSize += pxIOV[i].iov_len;
+    }
     if (xItemSize > pxRingbuffer->xMaxItemSize) {
         return pdFALSE;     //Data will never ever fit in the queue.
     }
@@ -1041,7 +1453,7 @@ BaseType_t xRingbufferSend(RingbufHandle_t xRingbuffer,
         return pdTRUE;      //Sending 0 bytes to byte buffer has no effect
     }
 
-    return prvSendAcquireGeneric(pxRingbuffer, pvItem, NULL, xItemSize, xTicksToWait);
+    return prvSendAcquireGeneric(pxRingbuffer, pxIOV, NULL, xItemSize, xTicksToWait);
 }
 
 BaseType_t xRingbufferSendFromISR(RingbufHandle_t xRingbuffer,
@@ -1052,6 +1464,10 @@ BaseType_t xRingbufferSendFromISR(RingbufHandle_t xRingbuffer,
     Ringbuffer_t *pxRingbuffer = (Ringbuffer_t *)xRingbuffer;
     BaseType_t xNotifyQueueSet = pdFALSE;
     BaseType_t xReturn;
+    struct iovec xIOV = {
+        .iov_base = (void *)pvItem,
+        .iov_len = xItemSize,
+    };
 
     //Check arguments
     configASSERT(pxRingbuffer);
@@ -1063,9 +1479,23 @@ BaseType_t xRingbufferSendFromISR(RingbufHandle_t xRingbuffer,
         return pdTRUE;      //Sending 0 bytes to byte buffer has no effect
     }
 
+    if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+        if (prvCheckItemFitsSPSC(pxRingbuffer, xItemSize) == pdFALSE) {
+            return pdFALSE;
+        }
+        prvCopyItemSPSC(pxRingbuffer, &xIOV, xItemSize);
+        if (pxRingbuffer->xQueueSet) {
+            //If ring buffer was added to a queue set, notify the queue set
+            xQueueSendFromISR((QueueHandle_t)pxRingbuffer->xQueueSet, (QueueSetMemberHandle_t *)&pxRingbuffer, pxHigherPriorityTaskWoken);
+        } else {
+            prvWakeWaitingTaskSPSC(pxRingbuffer, rbRECEIVER_WAITING_FLAG, &pxRingbuffer->xTasksWaitingToReceive, pdTRUE, pxHigherPriorityTaskWoken);
+        }
+        return pdTRUE;
+    }
+
     portENTER_CRITICAL_ISR(&pxRingbuffer->mux);
     if (pxRingbuffer->xCheckItemFits(xRingbuffer, xItemSize) == pdTRUE) {
-        pxRingbuffer->vCopyItem(xRingbuffer, pvItem, xItemSize);
+        pxRingbuffer->vCopyItem(xRingbuffer, &xIOV, xItemSize);
         if (pxRingbuffer->xQueueSet) {
             //If ring buffer was added to a queue set, notify the queue set
             xNotifyQueueSet = pdTRUE;
@@ -1198,12 +1628,45 @@ void *xRingbufferReceiveUpToFromISR(RingbufHandle_t xRingbuffer, size_t *pxItemS
     }
 }
 
+BaseType_t xRingbufferReceivev(RingbufHandle_t xRingbuffer,
+                               struct iovec *pxIOV,
+                               TickType_t xTicksToWait,
+                               size_t xMaxSize)
+{
+    Ringbuffer_t *pxRingbuffer = (Ringbuffer_t *)xRingbuffer;
+    void *pvHeadItem;
+    void *pvTailItem = NULL;
+    size_t xHeadItemSize;
+    size_t xTailItemSize = 0;
+
+    //Check arguments
+    configASSERT(pxRingbuffer && pxIOV);
+    configASSERT(xMaxSize == 0 || (pxRingbuffer->uxRingbufferFlags & rbBYTE_BUFFER_FLAG));    //xMaxSize only applies to byte buffers
+
+    //Attempt to retrieve an item, or up to xMaxSize bytes from byte buffers
+    if (prvReceiveGeneric(pxRingbuffer, &pvHeadItem, &pvTailItem, &xHeadItemSize, &xTailItemSize, xMaxSize, xTicksToWait) == pdFALSE) {
+        return pdFALSE;
+    }
+    pxIOV[0].iov_base = pvHeadItem;
+    pxIOV[0].iov_len = xHeadItemSize;
+    pxIOV[1].iov_base = pvTailItem;
+    pxIOV[1].iov_len = (pvTailItem != NULL) ? xTailItemSize : 0;
+    return pdTRUE;
+}
+
 void vRingbufferReturnItem(RingbufHandle_t xRingbuffer, void *pvItem)
 {
     Ringbuffer_t *pxRingbuffer = (Ringbuffer_t *)xRingbuffer;
     configASSERT(pxRingbuffer);
     configASSERT(pvItem != NULL);
 
+    if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+        prvReturnItemSPSC(pxRingbuffer, (uint8_t *)pvItem);
+        //If the producer is waiting for space to send, unblock it.
+        prvWakeWaitingTaskSPSC(pxRingbuffer, rbSENDER_WAITING_FLAG, &pxRingbuffer->xTasksWaitingToSend, pdFALSE, NULL);
+        return;
+    }
+
     portENTER_CRITICAL(&pxRingbuffer->mux);
     pxRingbuffer->vReturnItem(pxRingbuffer, (uint8_t *)pvItem);
     //If a task was waiting for space to send, unblock it immediately.
@@ -1216,12 +1679,31 @@ void vRingbufferReturnItem(RingbufHandle_t xRingbuffer, void *pvItem)
     portEXIT_CRITICAL(&pxRingbuffer->mux);
 }
 
+void vRingbufferReturnItemv(RingbufHandle_t xRingbuffer, const struct iovec *pxIOV)
+{
+    Ringbuffer_t *pxRingbuffer = (Ringbuffer_t *)xRingbuffer;
+    configASSERT(pxRingbuffer && pxIOV);
+
+    vRingbufferReturnItem(xRingbuffer, pxIOV[0].iov_base);
+    //Byte buffers free both parts at once, the second part of a split item is a separate item
+    if ((pxRingbuffer->uxRingbufferFlags & rbALLOW_SPLIT_FLAG) && pxIOV[1].iov_base != NULL) {
+        vRingbufferReturnItem(xRingbuffer, pxIOV[1].iov_base);
+    }
+}
+
 void vRingbufferReturnItemFromISR(RingbufHandle_t xRingbuffer, void *pvItem, BaseType_t *pxHigherPriorityTaskWoken)
 {
     Ringbuffer_t *pxRingbuffer = (Ringbuffer_t *)xRingbuffer;
     configASSERT(pxRingbuffer);
     configASSERT(pvItem != NULL);
 
+    if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+        prvReturnItemSPSC(pxRingbuffer, (uint8_t *)pvItem);
+        //If the producer is waiting for space to send, unblock it.
+        prvWakeWaitingTaskSPSC(pxRingbuffer, rbSENDER_WAITING_FLAG, &pxRingbuffer->xTasksWaitingToSend, pdTRUE, pxHigherPriorityTaskWoken);
+        return;
+    }
+
     portENTER_CRITICAL_ISR(&pxRingbuffer->mux);
     pxRingbuffer->vReturnItem(pxRingbuffer, (uint8_t *)pvItem);
     //If a task was waiting for space to send, unblock it immediately.
@@ -1339,7 +1821,16 @@ void vRingbufferGetInfo(RingbufHandle_t xRingbuffer,
         *uxAcquire = (UBaseType_t)(pxRingbuffer->pucAcquire - pxRingbuffer->pucHead);
     }
     if (uxItemsWaiting != NULL) {
-        *uxItemsWaiting = (UBaseType_t)(pxRingbuffer->xItemsWaiting);
+        if (pxRingbuffer->uxRingbufferFlags & rbSPSC_FLAG) {
+            //SPSC byte buffers don't count the bytes waiting, they are between the read and the write pointer
+            BaseType_t xBytesWaiting = rbLOAD_ACQUIRE(pxRingbuffer->pucWrite) - pxRingbuffer->pucRead;
+            if (xBytesWaiting < 0) {
+                xBytesWaiting += pxRingbuffer->xSize;
+            }
+            *uxItemsWaiting = (UBaseType_t)xBytesWaiting;
+        } else {
+            *uxItemsWaiting = (UBaseType_t)(pxRingbuffer->xItemsWaiting);
+        }
     }
     portEXIT_CRITICAL(&pxRingbuffer->mux);
 }
@@ -1381,7 +1872,7 @@ RingbufHandle_t xRingbufferCreateWithCaps(size_t xBufferSize, RingbufferType_t x
     uint8_t *pucRingbufferStorage;
 
     //Allocate memory
-    if (xBufferType != RINGBUF_TYPE_BYTEBUF) {
+    if (xBufferType != RINGBUF_TYPE_BYTEBUF && xBufferType != RINGBUF_TYPE_BYTEBUF_SPSC) {
         xBufferSize = rbALIGN_SIZE(xBufferSize);    //xBufferSize is rounded up for no-split/allow-split buffers
     }
 
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -12,6 +12,7 @@
 #include "sdkconfig.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/queue.h"
@@ -617,6 +618,352 @@ TEST_CASE("TC#3: Byte buffer", "[esp_ringbuf][linux]")
     vRingbufferDelete(buffer_handle);
 }
 
+TEST_CASE("TC#1: SPSC byte buffer", "[esp_ringbuf][linux]")
+{
+    //Create buffer
+    RingbufHandle_t buffer_handle = xRingbufferCreate(BUFFER_SIZE, RINGBUF_TYPE_BYTEBUF_SPSC);
+    TEST_ASSERT_MESSAGE(buffer_handle != NULL, "Failed to create ring buffer");
+
+    //Check buffer free size and max item size upon buffer creation. One byte is kept unused.
+    TEST_ASSERT_MESSAGE(xRingbufferGetCurFreeSize(buffer_handle) == BUFFER_SIZE - 1, "Incorrect buffer free size received");
+    TEST_ASSERT_MESSAGE(xRingbufferGetMaxItemSize(buffer_handle) == BUFFER_SIZE - 1, "Incorrect max item size received");
+
+    //Calculate number of items to send. Aim to almost fill buffer to setup for wrap around
+    int no_of_items = (BUFFER_SIZE - SMALL_ITEM_SIZE) / SMALL_ITEM_SIZE;
+
+    //Test sending items
+    for (int i = 0; i < no_of_items; i++) {
+        send_item_and_check(buffer_handle, small_item, SMALL_ITEM_SIZE, TIMEOUT_TICKS, false);
+    }
+
+    //Verify items waiting matches with the number of items sent
+    UBaseType_t items_waiting;
+    vRingbufferGetInfo(buffer_handle, NULL, NULL, NULL, NULL, &items_waiting);
+    TEST_ASSERT_MESSAGE(items_waiting == no_of_items * SMALL_ITEM_SIZE, "Incorrect number of bytes waiting");
+
+    //Test receiving items
+    for (int i = 0; i < no_of_items; i++) {
+        receive_check_and_return_item_byte_buffer(buffer_handle, small_item, SMALL_ITEM_SIZE, TIMEOUT_TICKS, false);
+    }
+
+    //Verify that no items are waiting
+    vRingbufferGetInfo(buffer_handle, NULL, NULL, NULL, NULL, &items_waiting);
+    TEST_ASSERT_MESSAGE(items_waiting == 0, "Incorrect number of bytes waiting");
+
+    //Write pointer should be near the end, test wrap around
+    UBaseType_t write_pos_before, write_pos_after;
+    vRingbufferGetInfo(buffer_handle, NULL, NULL, &write_pos_before, NULL, NULL);
+    //Send large item that causes wrap around
+    send_item_and_check(buffer_handle, large_item, LARGE_ITEM_SIZE, TIMEOUT_TICKS, false);
+    //Receive wrapped item
+    receive_check_and_return_item_byte_buffer(buffer_handle, large_item, LARGE_ITEM_SIZE, TIMEOUT_TICKS, false);
+    vRingbufferGetInfo(buffer_handle, NULL, NULL, &write_pos_after, NULL, NULL);
+    TEST_ASSERT_MESSAGE(write_pos_after < write_pos_before, "Failed to wrap around");
+
+    //Cleanup
+    vRingbufferDelete(buffer_handle);
+}
+
+TEST_CASE("TC#2: SPSC byte buffer", "[esp_ringbuf][linux]")
+{
+    //Create buffer
+    RingbufHandle_t buffer_handle = xRingbufferCreate(BUFFER_SIZE + 1, RINGBUF_TYPE_BYTEBUF_SPSC);
+    TEST_ASSERT_MESSAGE(buffer_handle != NULL, "Failed to create ring buffer");
+
+    //Calculate number of items to send. Aim to fill the buffer
+    int no_of_items = BUFFER_SIZE / SMALL_ITEM_SIZE;
+
+    //Test sending items
+    for (int i = 0; i < no_of_items; i++) {
+        send_item_and_check(buffer_handle, small_item, SMALL_ITEM_SIZE, TIMEOUT_TICKS, false);
+    }
+
+    //At this point, the buffer should be full.
+    TEST_ASSERT_MESSAGE(xRingbufferGetCurFreeSize(buffer_handle) == 0, "Buffer full not achieved");
+
+    //Send an item. The item should not be sent to a full buffer.
+    send_item_and_check_failure(buffer_handle, small_item, SMALL_ITEM_SIZE, TIMEOUT_TICKS, false);
+
+    //Receive one item
+    receive_check_and_return_item_byte_buffer(buffer_handle, small_item, SMALL_ITEM_SIZE, TIMEOUT_TICKS, false);
+
+    //At this point, the space of the item should be free again
+    TEST_ASSERT_MESSAGE(xRingbufferGetCurFreeSize(buffer_handle) == SMALL_ITEM_SIZE, "Buffer should have free space");
+
+    //Test receiving remaining items
+    for (int i = 0; i < no_of_items - 1; i++) {
+        receive_check_and_return_item_byte_buffer(buffer_handle, small_item, SMALL_ITEM_SIZE, TIMEOUT_TICKS, false);
+    }
+
+    //Verify that no items are waiting and receiving times out
+    UBaseType_t items_waiting;
+    size_t item_size;
+    vRingbufferGetInfo(buffer_handle, NULL, NULL, NULL, NULL, &items_waiting);
+    TEST_ASSERT_MESSAGE(items_waiting == 0, "Incorrect items waiting");
+    TEST_ASSERT_NULL(xRingbufferReceiveUpTo(buffer_handle, &item_size, TIMEOUT_TICKS, SMALL_ITEM_SIZE));
+
+    //Cleanup
+    vRingbufferDelete(buffer_handle);
+}
+
+/* ------------------------ Ring buffer throughput test ------------------------
+ * The following test case streams data from a sending task to the receiving test
+ * task through a byte buffer and a SPSC byte buffer, blocking on both sides
+ * whenever the buffer is full or empty. The data is sent in chunks of random
+ * sizes up to a maximum and received in items of up to the same maximum. The
+ * throughput of each buffer type is printed for each maximum chunk size.
+ */
+
+#define THROUGHPUT_TEST_BYTES       (1024 * 1024)
+#define THROUGHPUT_MAX_CHUNK_SIZE   256
+#define THROUGHPUT_BUFFER_SIZE      1024
+
+typedef struct {
+    RingbufHandle_t buffer;
+    size_t max_chunk_size;
+} throughput_args_t;
+
+static void throughput_send_task(void *args)
+{
+    throughput_args_t *throughput_args = (throughput_args_t *)args;
+    uint8_t chunk[THROUGHPUT_MAX_CHUNK_SIZE];
+    unsigned int seed = throughput_args->max_chunk_size;    //Same chunk sizes for both buffer types
+
+    size_t bytes_sent = 0;
+    while (bytes_sent < THROUGHPUT_TEST_BYTES) {
+        size_t chunk_size = 1 + rand_r(&seed) % throughput_args->max_chunk_size;
+        if (chunk_size > THROUGHPUT_TEST_BYTES - bytes_sent) {
+            chunk_size = THROUGHPUT_TEST_BYTES - bytes_sent;
+        }
+        for (int i = 0; i < chunk_size; i++) {
+            chunk[i] = (uint8_t)(bytes_sent + i);
+        }
+        TEST_ASSERT_MESSAGE(xRingbufferSend(throughput_args->buffer, chunk, chunk_size, portMAX_DELAY) == pdTRUE, "Failed to send an item");
+        bytes_sent += chunk_size;
+    }
+    xSemaphoreGive(tx_done);
+    vTaskDelete(NULL);
+}
+
+static void throughput_test(RingbufferType_t buf_type, const char *name, size_t max_chunk_size)
+{
+    throughput_args_t task_args;
+    task_args.buffer = xRingbufferCreate(THROUGHPUT_BUFFER_SIZE, buf_type);
+    task_args.max_chunk_size = max_chunk_size;
+    TEST_ASSERT_MESSAGE(task_args.buffer != NULL, "Failed to create ring buffer");
+
+    TickType_t start = xTaskGetTickCount();
+    xTaskCreatePinnedToCore(throughput_send_task, "send tsk", 2048, (void *)&task_args, uxTaskPriorityGet(NULL), NULL, 0);
+
+    size_t bytes_rec = 0;
+    while (bytes_rec < THROUGHPUT_TEST_BYTES) {
+        size_t item_size;
+        uint8_t *item = (uint8_t *)xRingbufferReceiveUpTo(task_args.buffer, &item_size, portMAX_DELAY, max_chunk_size);
+        TEST_ASSERT_MESSAGE(item != NULL, "Failed to receive an item");
+        for (int i = 0; i < item_size; i++) {
+            TEST_ASSERT_MESSAGE(item[i] == (uint8_t)(bytes_rec + i), "Received data is corrupted");
+        }
+        bytes_rec += item_size;
+        vRingbufferReturnItem(task_args.buffer, item);
+    }
+    TickType_t ticks = xTaskGetTickCount() - start;
+
+    xSemaphoreTake(tx_done, portMAX_DELAY);
+    int centi_mbps = (int)((uint64_t)THROUGHPUT_TEST_BYTES * configTICK_RATE_HZ * 100 / (1024 * 1024) / (ticks ? ticks : 1));
+    esp_rom_printf("%s, chunks of up to %d bytes: %d.%02d MB/s\n", name, (int)max_chunk_size, centi_mbps / 100, centi_mbps % 100);
+
+    vRingbufferDelete(task_args.buffer);
+}
+
+TEST_CASE("Test byte buffer throughput", "[esp_ringbuf][linux]")
+{
+    tx_done = xSemaphoreCreateBinary();
+    const size_t max_chunk_sizes[] = {16, 64, THROUGHPUT_MAX_CHUNK_SIZE};
+    for (int i = 0; i < sizeof(max_chunk_sizes) / sizeof(max_chunk_sizes[0]); i++) {
+        throughput_test(RINGBUF_TYPE_BYTEBUF, "Byte buffer", max_chunk_sizes[i]);
+        throughput_test(RINGBUF_TYPE_BYTEBUF_SPSC, "SPSC byte buffer", max_chunk_sizes[i]);
+    }
+    vSemaphoreDelete(tx_done);
+    vTaskDelay(5);  //Allow idle to clean up
+}
+
+/* ------------------------ Ring buffer scatter-gather test ------------------------
+ * The following test case sends items made of a header and a payload of varying
+ * size with xRingbufferSendv() and receives them with xRingbufferReceivev() from
+ * each type of ring buffer, so that items are stored at every offset of the buffer
+ * and wrap around its end. Byte buffers are received in two steps with xMaxSize
+ * to check that the limit applies to both segments.
+ */
+
+#define SG_HEADER_SIZE              4
+#define SG_ITERATIONS               64
+
+//Receives an item with xRingbufferReceivev(), copies both segments to data and returns the item
+static size_t receivev_and_return_item(RingbufHandle_t handle, uint8_t *data, size_t max_size, bool *wrapped)
+{
+    struct iovec iov[2];
+    TEST_ASSERT_EQUAL(pdTRUE, xRingbufferReceivev(handle, iov, TIMEOUT_TICKS, max_size));
+    TEST_ASSERT_NOT_NULL(iov[0].iov_base);
+    TEST_ASSERT(max_size == 0 || iov[0].iov_len + iov[1].iov_len <= max_size);
+    memcpy(data, iov[0].iov_base, iov[0].iov_len);
+    if (iov[1].iov_base != NULL) {
+        TEST_ASSERT_NOT_EQUAL(0, iov[1].iov_len);
+        memcpy(data + iov[0].iov_len, iov[1].iov_base, iov[1].iov_len);
+        *wrapped = true;
+    } else {
+        TEST_ASSERT_EQUAL(0, iov[1].iov_len);
+    }
+    vRingbufferReturnItemv(handle, iov);
+    return iov[0].iov_len + iov[1].iov_len;
+}
+
+static void scatter_gather_test(RingbufferType_t buf_type)
+{
+    RingbufHandle_t buffer_handle = xRingbufferCreate(BUFFER_SIZE, buf_type);
+    TEST_ASSERT_MESSAGE(buffer_handle != NULL, "Failed to create ring buffer");
+    bool byte_buffer = (buf_type == RINGBUF_TYPE_BYTEBUF || buf_type == RINGBUF_TYPE_BYTEBUF_SPSC);
+    bool wrapped = false;
+
+    for (int i = 0; i < SG_ITERATIONS; i++) {
+        uint8_t header[SG_HEADER_SIZE] = { i, i + 1, i + 2, i + 3 };
+        size_t payload_size = i % (LARGE_ITEM_SIZE + 1);
+        size_t item_size = SG_HEADER_SIZE + payload_size;
+        //Empty segments are allowed anywhere
+        struct iovec iov[] = {
+            { .iov_base = header, .iov_len = SG_HEADER_SIZE },
+            { .iov_base = NULL, .iov_len = 0 },
+            { .iov_base = (void *)large_item, .iov_len = payload_size },
+        };
+        TEST_ASSERT_EQUAL(pdTRUE, xRingbufferSendv(buffer_handle, iov, sizeof(iov) / sizeof(iov[0]), TIMEOUT_TICKS));
+
+        uint8_t expected[SG_HEADER_SIZE + LARGE_ITEM_SIZE];
+        uint8_t received[SG_HEADER_SIZE + LARGE_ITEM_SIZE];
+        memcpy(expected, header, SG_HEADER_SIZE);
+        memcpy(expected + SG_HEADER_SIZE, large_item, payload_size);
+        size_t received_size;
+        if (byte_buffer) {
+            size_t first_size = 1 + i % item_size;
+            received_size = receivev_and_return_item(buffer_handle, received, first_size, &wrapped);
+            TEST_ASSERT_EQUAL(first_size, received_size);
+            if (received_size < item_size) {
+                received_size += receivev_and_return_item(buffer_handle, received + received_size, 0, &wrapped);
+            }
+        } else {
+            received_size = receivev_and_return_item(buffer_handle, received, 0, &wrapped);
+        }
+        TEST_ASSERT_EQUAL(item_size, received_size);
+        TEST_ASSERT_MESSAGE(memcmp(expected, received, item_size) == 0, "Received data is corrupted");
+    }
+
+    //No-split buffers never wrap items around, all other types must have done so
+    TEST_ASSERT_EQUAL(buf_type != RINGBUF_TYPE_NOSPLIT, wrapped);
+    UBaseType_t items_waiting;
+    vRingbufferGetInfo(buffer_handle, NULL, NULL, NULL, NULL, &items_waiting);
+    TEST_ASSERT_MESSAGE(items_waiting == 0, "Incorrect items waiting");
+
+    vRingbufferDelete(buffer_handle);
+}
+
+TEST_CASE("Test scatter-gather send and receive", "[esp_ringbuf][linux]")
+{
+    for (RingbufferType_t buf_type = 0; buf_type < RINGBUF_TYPE_MAX; buf_type++) {
+        scatter_gather_test(buf_type);
+    }
+}
+
+/* ------------------------ Ring buffer framing benchmark ------------------------
+ * The following test case sends frames of a header and a payload through an
+ * allow-split ring buffer and sums up the received payloads, once by assembling
+ * each frame in a temporary buffer and joining split items after receiving them,
+ * and once with xRingbufferSendv() and xRingbufferReceivev() without any
+ * intermediate copies. It prints the bytes copied outside of the ring buffer and
+ * the frame rate of each.
+ */
+
+#define FRAMING_TEST_FRAMES         20000
+#define FRAMING_HEADER_SIZE         8
+#define FRAMING_PAYLOAD_SIZE        120
+#define FRAMING_BUFFER_SIZE         1000    //Not a multiple of the frame size, so that frames are split
+
+static uint32_t sum_bytes(const uint8_t *data, size_t size)
+{
+    uint32_t sum = 0;
+    for (size_t i = 0; i < size; i++) {
+        sum += data[i];
+    }
+    return sum;
+}
+
+static void framing_test(bool use_iov)
+{
+    RingbufHandle_t buffer_handle = xRingbufferCreate(FRAMING_BUFFER_SIZE, RINGBUF_TYPE_ALLOWSPLIT);
+    TEST_ASSERT_MESSAGE(buffer_handle != NULL, "Failed to create ring buffer");
+    uint8_t header[FRAMING_HEADER_SIZE] = { 0 };
+    uint8_t payload[FRAMING_PAYLOAD_SIZE];
+    uint8_t frame[FRAMING_HEADER_SIZE + FRAMING_PAYLOAD_SIZE];
+    for (int i = 0; i < FRAMING_PAYLOAD_SIZE; i++) {
+        payload[i] = (uint8_t)i;
+    }
+    uint32_t expected_sum = sum_bytes(payload, FRAMING_PAYLOAD_SIZE);
+    size_t bytes_copied = 0;
+
+    TickType_t start = xTaskGetTickCount();
+    for (int i = 0; i < FRAMING_TEST_FRAMES; i++) {
+        uint32_t sum;
+        if (use_iov) {
+            struct iovec iov[2] = {
+                { .iov_base = header, .iov_len = FRAMING_HEADER_SIZE },
+                { .iov_base = payload, .iov_len = FRAMING_PAYLOAD_SIZE },
+            };
+            TEST_ASSERT_EQUAL(pdTRUE, xRingbufferSendv(buffer_handle, iov, 2, 0));
+
+            TEST_ASSERT_EQUAL(pdTRUE, xRingbufferReceivev(buffer_handle, iov, 0, 0));
+            //Skip the header, which may itself be split
+            size_t header_len = (iov[0].iov_len < FRAMING_HEADER_SIZE) ? iov[0].iov_len : FRAMING_HEADER_SIZE;
+            sum = sum_bytes((uint8_t *)iov[0].iov_base + header_len, iov[0].iov_len - header_len);
+            if (iov[1].iov_base != NULL) {
+                sum += sum_bytes((uint8_t *)iov[1].iov_base + (FRAMING_HEADER_SIZE - header_len), iov[1].iov_len - (FRAMING_HEADER_SIZE - header_len));
+            }
+            vRingbufferReturnItemv(buffer_handle, iov);
+        } else {
+            memcpy(frame, header, FRAMING_HEADER_SIZE);
+            memcpy(frame + FRAMING_HEADER_SIZE, payload, FRAMING_PAYLOAD_SIZE);
+            bytes_copied += sizeof(frame);
+            TEST_ASSERT_EQUAL(pdTRUE, xRingbufferSend(buffer_handle, frame, sizeof(frame), 0));
+
+            void *head;
+            void *tail;
+            size_t head_size;
+            size_t tail_size;
+            TEST_ASSERT_EQUAL(pdTRUE, xRingbufferReceiveSplit(buffer_handle, &head, &tail, &head_size, &tail_size, 0));
+            const uint8_t *rec_frame = head;
+            if (tail != NULL) {
+                //Join the parts of a split frame
+                memcpy(frame, head, head_size);
+                memcpy(frame + head_size, tail, tail_size);
+                bytes_copied += head_size + tail_size;
+                rec_frame = frame;
+                vRingbufferReturnItem(buffer_handle, tail);
+            }
+            sum = sum_bytes(rec_frame + FRAMING_HEADER_SIZE, FRAMING_PAYLOAD_SIZE);
+            vRingbufferReturnItem(buffer_handle, head);
+        }
+        TEST_ASSERT_MESSAGE(sum == expected_sum, "Received data is corrupted");
+    }
+    TickType_t ticks = xTaskGetTickCount() - start;
+
+    esp_rom_printf("%s: %d bytes copied per frame, %d frames/s\n", use_iov ? "Scatter-gather" : "Temporary buffer",
+                   (int)(bytes_copied / FRAMING_TEST_FRAMES), (int)((uint64_t)FRAMING_TEST_FRAMES * configTICK_RATE_HZ / (ticks ? ticks : 1)));
+
+    vRingbufferDelete(buffer_handle);
+}
+
+TEST_CASE("Test framing with and without scatter-gather", "[esp_ringbuf][linux]")
+{
+    framing_test(false);
+    framing_test(true);
+}
+
 /* ----------------------- Ring buffer queue sets test ------------------------
  * The following test case will test receiving from ring buffers that have been
  * added to a queue set. The test case will do the following...
@@ -9,15 +9,318 @@
 /*-----------------------------------------------------------------------*/
 
 #include <string.h>
+#include <stdbool.h>
 #include <time.h>
 #include <stdlib.h>
 #include <sys/time.h>
+#include <sys/lock.h>
 #include "diskio_impl.h"
 #include "ffconf.h"
 #include "ff.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+
+#ifndef CONFIG_FATFS_DISKIO_CACHE_SECTORS
+#define CONFIG_FATFS_DISKIO_CACHE_SECTORS 0
+#endif
+#ifndef CONFIG_FATFS_DISKIO_CACHE_READAHEAD
+#define CONFIG_FATFS_DISKIO_CACHE_READAHEAD 0
+#endif
+
+static const char* TAG = "ff_diskio";
 
 static ff_diskio_impl_t * s_impls[FF_VOLUMES] = { NULL };
 
+/* FatFs calls the disk functions of a drive under the volume lock, except for the direct transfers of
+ * f_pread() and f_pwrite(), which can run in several tasks at a time. The calls are serialized by a lock
+ * of the drive, unless the driver is registered as concurrent and the drive has no cache.
+ */
+static _lock_t s_locks[FF_VOLUMES];
+
+/* Write-back sector cache between FatFs and the disk I/O driver of each drive.
+ * Entries are evicted in LRU order. It is only used under the lock of the drive.
+ * It is only resized while no volume is mounted on the drive, and it is written back
+ * under the volume lock if the drive is unregistered while mounted.
+ * The volumes of ESP-IDF use the logical drive with the number of the physical drive.
+ */
+typedef struct {
+    LBA_t sector;
+    uint32_t used;      /* value of the access counter at the last use, 0 if the entry is free */
+    bool dirty;
+} ff_diskio_cache_entry_t;
+
+typedef struct {
+    UINT size;          /* configured number of entries, 0 if the cache is disabled */
+    UINT readahead;
+    UINT sector_size;
+    LBA_t sector_count;
+    bool alloc_failed;
+    BYTE* data;         /* size * sector_size bytes, NULL until the first access */
+    ff_diskio_cache_entry_t* entries;
+    uint32_t clock;
+    ff_diskio_cache_stats_t stats;
+} ff_diskio_cache_t;
+
+static ff_diskio_cache_t s_caches[FF_VOLUMES];
+
+static bool cache_setup(BYTE pdrv)
+{
+    ff_diskio_cache_t* c = &s_caches[pdrv];
+    if (c->data) {
+        return true;
+    }
+    if (c->size == 0 || c->alloc_failed) {
+        return false;
+    }
+    WORD sector_size = FF_MIN_SS;
+#if FF_MAX_SS != FF_MIN_SS
+    if (s_impls[pdrv]->ioctl(pdrv, GET_SECTOR_SIZE, &sector_size) != RES_OK) {
+        return false;
+    }
+#endif
+    DWORD sector_count = 0;
+    if (s_impls[pdrv]->ioctl(pdrv, GET_SECTOR_COUNT, &sector_count) != RES_OK) {
+        sector_count = 0;
+    }
+    c->data = ff_memalloc(c->size * sector_size);
+    c->entries = calloc(c->size, sizeof(ff_diskio_cache_entry_t));
+    if (!c->data || !c->entries) {
+        ESP_LOGW(TAG, "not enough memory for the cache of drive %d, disabled", pdrv);
+        ff_memfree(c->data);
+        free(c->entries);
+        c->data = NULL;
+        c->entries = NULL;
+        c->alloc_failed = true;
+        return false;
+    }
+    c->sector_size = sector_size;
+    c->sector_count = sector_count;
+    c->clock = 0;
+    return true;
+}
+
+static int cache_find(ff_diskio_cache_t* c, LBA_t sector)
+{
+    for (UINT i = 0; i < c->size; i++) {
+        if (c->entries[i].used && c->entries[i].sector == sector) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static inline uint32_t cache_tick(ff_diskio_cache_t* c)
+{
+    // 0 marks free entries, skip it when the counter wraps around
+    if (++c->clock == 0) {
+        c->clock = 1;
+    }
+    return c->clock;
+}
+
+static inline BYTE* cache_data(ff_diskio_cache_t* c, int entry)
+{
+    return c->data + (size_t) entry * c->sector_size;
+}
+
+/* Write the dirty entries back in the order of their sectors. Entries holding consecutive
+ * sectors in consecutive slots, as left by sequential writes, are written by one disk operation.
+ */
+static DRESULT cache_flush(BYTE pdrv)
+{
+    ff_diskio_cache_t* c = &s_caches[pdrv];
+    if (!c->data) {
+        return RES_OK;
+    }
+    while (true) {
+        int first = -1;
+        for (UINT i = 0; i < c->size; i++) {
+            if (c->entries[i].dirty && (first < 0 || c->entries[i].sector < c->entries[first].sector)) {
+                first = i;
+            }
+        }
+        if (first < 0) {
+            return RES_OK;
+        }
+        UINT count = 1;
+        while (first + count < c->size && c->entries[first + count].dirty
+                && c->entries[first + count].sector == c->entries[first].sector + count) {
+            count++;
+        }
+        DRESULT res = s_impls[pdrv]->write(pdrv, cache_data(c, first), c->entries[first].sector, count);
+        if (res != RES_OK) {
+            return res;
+        }
+        for (UINT i = 0; i < count; i++) {
+            c->entries[first + i].dirty = false;
+        }
+        c->stats.writebacks += count;
+    }
+}
+
+static void cache_free(BYTE pdrv)
+{
+    ff_diskio_cache_t* c = &s_caches[pdrv];
+    ff_memfree(c->data);
+    free(c->entries);
+    c->data = NULL;
+    c->entries = NULL;
+    c->alloc_failed = false;
+}
+
+/* Free 'count' consecutive entries, choosing the slots whose most recent use is the oldest.
+ * Returns the index of the first entry, or -1 if dirty entries could not be written back.
+ */
+static int cache_evict(BYTE pdrv, UINT count)
+{
+    ff_diskio_cache_t* c = &s_caches[pdrv];
+    int best = 0;
+    uint32_t best_used = UINT32_MAX;
+    for (UINT i = 0; i + count <= c->size; i++) {
+        uint32_t used = 0;
+        for (UINT j = i; j < i + count; j++) {
+            used = MAX(used, c->entries[j].used);
+        }
+        if (used < best_used) {
+            best = i;
+            best_used = used;
+        }
+    }
+    for (UINT j = best; j < best + count; j++) {
+        if (c->entries[j].dirty) {
+            // write all dirty sectors at once rather than one at a time as they are evicted
+            if (cache_flush(pdrv) != RES_OK) {
+                return -1;
+            }
+            break;
+        }
+    }
+    for (UINT j = best; j < best + count; j++) {
+        c->entries[j].used = 0;
+    }
+    return best;
+}
+
+/* Read a sector which is not cached, and the following ones if the access is sequential */
+static int cache_fill(BYTE pdrv, LBA_t sector)
+{
+    ff_diskio_cache_t* c = &s_caches[pdrv];
+    UINT count = 1;
+    if (sector > 0 && cache_find(c, sector - 1) >= 0) {
+        count += MIN(c->readahead, c->size - 1);
+        if (sector + count > c->sector_count) {
+            count = c->sector_count > sector ? c->sector_count - sector : 1;
+        }
+        for (UINT i = 1; i < count; i++) {
+            if (cache_find(c, sector + i) >= 0) {
+                count = i;
+                break;
+            }
+        }
+    }
+    int first = cache_evict(pdrv, count);
+    if (first < 0) {
+        return -1;
+    }
+    if (s_impls[pdrv]->read(pdrv, cache_data(c, first), sector, count) != RES_OK) {
+        return -1;
+    }
+    for (UINT i = 0; i < count; i++) {
+        c->entries[first + i].sector = sector + i;
+        c->entries[first + i].used = cache_tick(c);
+        c->entries[first + i].dirty = false;
+    }
+    c->stats.readahead += count - 1;
+    return first;
+}
+
+static DRESULT cache_read(BYTE pdrv, BYTE* buff, LBA_t sector, UINT count)
+{
+    ff_diskio_cache_t* c = &s_caches[pdrv];
+    if (count >= c->size) {
+        DRESULT res = s_impls[pdrv]->read(pdrv, buff, sector, count);
+        if (res != RES_OK) {
+            return res;
+        }
+        // sectors modified in the cache are newer than the disk
+        for (UINT i = 0; i < c->size; i++) {
+            if (c->entries[i].dirty && c->entries[i].sector - sector < count) {
+                memcpy(buff + (size_t)(c->entries[i].sector - sector) * c->sector_size, cache_data(c, i), c->sector_size);
+            }
+        }
+        c->stats.misses += count;
+        return RES_OK;
+    }
+    for (UINT i = 0; i < count; i++) {
+        int entry = cache_find(c, sector + i);
+        if (entry >= 0) {
+            c->stats.hits++;
+        } else {
+            c->stats.misses++;
+            entry = cache_fill(pdrv, sector + i);
+            if (entry < 0) {
+                return RES_ERROR;
+            }
+        }
+        c->entries[entry].used = cache_tick(c);
+        memcpy(buff + (size_t) i * c->sector_size, cache_data(c, entry), c->sector_size);
+    }
+    return RES_OK;
+}
+
+static DRESULT cache_write(BYTE pdrv, const BYTE* buff, LBA_t sector, UINT count)
+{
+    ff_diskio_cache_t* c = &s_caches[pdrv];
+    if (count >= c->size) {
+        DRESULT res = s_impls[pdrv]->write(pdrv, buff, sector, count);
+        if (res != RES_OK) {
+            return res;
+        }
+        // the cached copies are replaced by the data just written
+        for (UINT i = 0; i < c->size; i++) {
+            if (c->entries[i].used && c->entries[i].sector - sector < count) {
+                memcpy(cache_data(c, i), buff + (size_t)(c->entries[i].sector - sector) * c->sector_size, c->sector_size);
+                c->entries[i].dirty = false;
+            }
+        }
+        c->stats.misses += count;
+        return RES_OK;
+    }
+    for (UINT i = 0; i < count; i++) {
+        int entry = cache_find(c, sector + i);
+        if (entry >= 0) {
+            c->stats.hits++;
+        } else {
+            c->stats.misses++;
+            entry = cache_evict(pdrv, 1);
+            if (entry < 0) {
+                return RES_ERROR;
+            }
+            c->entries[entry].sector = sector + i;
+        }
+        c->entries[entry].used = cache_tick(c);
+        c->entries[entry].dirty = true;
+        memcpy(cache_data(c, entry), buff + (size_t) i * c->sector_size, c->sector_size);
+    }
+    return RES_OK;
+}
+
+#if FF_USE_TRIM
+static void cache_discard(BYTE pdrv, LBA_t start, LBA_t end)
+{
+    ff_diskio_cache_t* c = &s_caches[pdrv];
+    if (!c->data) {
+        return;
+    }
+    for (UINT i = 0; i < c->size; i++) {
+        if (c->entries[i].used && c->entries[i].sector >= start && c->entries[i].sector <= end) {
+            c->entries[i].used = 0;
+            c->entries[i].dirty = false;
+        }
+    }
+}
+#endif
+
 #if FF_MULTI_PARTITION		/* Multiple partition configuration */
 const PARTITION VolToPart[FF_VOLUMES] = {
     {0, 0},    /* Logical drive 0 ==> Physical drive 0, auto detection */
@@ -68,9 +371,20 @@ void ff_diskio_register(BYTE pdrv, const ff_diskio_impl_t* discio_impl)
     assert(pdrv < FF_VOLUMES);
 
     if (s_impls[pdrv]) {
+        // a volume which failed to mount can still be registered in FatFs
+        bool locked = f_mounted(pdrv) && ff_mutex_take(pdrv);
+        _lock_acquire(&s_locks[pdrv]);
+        if (cache_flush(pdrv) != RES_OK) {
+            ESP_LOGE(TAG, "failed to write back the cache of drive %d", pdrv);
+        }
+        cache_free(pdrv);
         ff_diskio_impl_t* im = s_impls[pdrv];
         s_impls[pdrv] = NULL;
         free(im);
+        _lock_release(&s_locks[pdrv]);
+        if (locked) {
+            ff_mutex_give(pdrv);
+        }
     }
 
     if (!discio_impl) {
@@ -81,27 +395,117 @@ void ff_diskio_register(BYTE pdrv, const ff_diskio_impl_t* discio_impl)
     assert(impl != NULL);
     memcpy(impl, discio_impl, sizeof(ff_diskio_impl_t));
     s_impls[pdrv] = impl;
+
+    ff_diskio_cache_t* c = &s_caches[pdrv];
+    memset(c, 0, sizeof(ff_diskio_cache_t));
+    c->size = CONFIG_FATFS_DISKIO_CACHE_SECTORS;
+    c->readahead = CONFIG_FATFS_DISKIO_CACHE_READAHEAD;
+}
+
+esp_err_t ff_diskio_set_cache(BYTE pdrv, UINT sectors, UINT readahead)
+{
+    if (pdrv >= FF_VOLUMES) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_impls[pdrv] || f_mounted(pdrv)) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (cache_flush(pdrv) != RES_OK) {
+        return ESP_FAIL;
+    }
+    cache_free(pdrv);
+    s_caches[pdrv].size = sectors;
+    s_caches[pdrv].readahead = readahead;
+    return ESP_OK;
+}
+
+esp_err_t ff_diskio_get_cache_stats(BYTE pdrv, ff_diskio_cache_stats_t* stats)
+{
+    if (pdrv >= FF_VOLUMES || !stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *stats = s_caches[pdrv].stats;
+    return ESP_OK;
+}
+
+void ff_diskio_clear_cache_stats(BYTE pdrv)
+{
+    assert(pdrv < FF_VOLUMES);
+    memset(&s_caches[pdrv].stats, 0, sizeof(ff_diskio_cache_stats_t));
+}
+
+static inline bool disk_lock(BYTE pdrv)
+{
+    if (s_impls[pdrv]->concurrent && s_caches[pdrv].size == 0) {
+        return false;
+    }
+    _lock_acquire(&s_locks[pdrv]);
+    return true;
+}
+
+static inline void disk_unlock(BYTE pdrv, bool locked)
+{
+    if (locked) {
+        _lock_release(&s_locks[pdrv]);
+    }
 }
 
 DSTATUS ff_disk_initialize (BYTE pdrv)
 {
-    return s_impls[pdrv]->init(pdrv);
+    bool locked = disk_lock(pdrv);
+    DSTATUS res = s_impls[pdrv]->init(pdrv);
+    disk_unlock(pdrv, locked);
+    return res;
 }
 DSTATUS ff_disk_status (BYTE pdrv)
 {
-    return s_impls[pdrv]->status(pdrv);
+    bool locked = disk_lock(pdrv);
+    DSTATUS res = s_impls[pdrv]->status(pdrv);
+    disk_unlock(pdrv, locked);
+    return res;
 }
 DRESULT ff_disk_read (BYTE pdrv, BYTE* buff, LBA_t sector, UINT count)
 {
-    return s_impls[pdrv]->read(pdrv, buff, sector, count);
+    bool locked = disk_lock(pdrv);
+    DRESULT res;
+    if (cache_setup(pdrv)) {
+        res = cache_read(pdrv, buff, sector, count);
+    } else {
+        res = s_impls[pdrv]->read(pdrv, buff, sector, count);
+    }
+    disk_unlock(pdrv, locked);
+    return res;
 }
 DRESULT ff_disk_write (BYTE pdrv, const BYTE* buff, LBA_t sector, UINT count)
 {
-    return s_impls[pdrv]->write(pdrv, buff, sector, count);
+    bool locked = disk_lock(pdrv);
+    DRESULT res;
+    if (cache_setup(pdrv)) {
+        res = cache_write(pdrv, buff, sector, count);
+    } else {
+        res = s_impls[pdrv]->write(pdrv, buff, sector, count);
+    }
+    disk_unlock(pdrv, locked);
+    return res;
 }
 DRESULT ff_disk_ioctl (BYTE pdrv, BYTE cmd, void* buff)
 {
-    return s_impls[pdrv]->ioctl(pdrv, cmd, buff);
+    bool locked = disk_lock(pdrv);
+    DRESULT res = RES_OK;
+    if (cmd == CTRL_SYNC) {
+        res = cache_flush(pdrv);
+    }
+#if FF_USE_TRIM
+    if (cmd == CTRL_TRIM) {
+        // trimmed sectors have undefined content, their cached data can be dropped
+        cache_discard(pdrv, ((LBA_t*) buff)[0], ((LBA_t*) buff)[1]);
+    }
+#endif
+    if (res == RES_OK) {
+        res = s_impls[pdrv]->ioctl(pdrv, cmd, buff);
+    }
+    disk_unlock(pdrv, locked);
+    return res;
 }
 
 DWORD get_fattime(void)
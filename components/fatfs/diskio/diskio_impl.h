@@ -19,6 +19,7 @@ extern "C" {
 #endif
 
 #include <stdint.h>
+#include <stdbool.h>
 typedef unsigned int UINT;
 typedef unsigned char BYTE;
 typedef uint32_t DWORD;
@@ -31,7 +32,11 @@ typedef uint32_t DWORD;
 /**
  * Structure of pointers to disk IO driver functions.
  *
- * See FatFs documentation for details about these functions
+ * See FatFs documentation for details about these functions.
+ *
+ * The functions of a drive are called from one task at a time, unless concurrent is set
+ * and the sector cache of the drive is disabled (see ff_diskio_set_cache). pread() and
+ * pwrite() then transfer the data of different files from several tasks at the same time.
  */
 typedef struct {
     DSTATUS (*init) (unsigned char pdrv);    /*!< disk initialization function */
@@ -39,6 +44,7 @@ typedef struct {
     DRESULT (*read) (unsigned char pdrv, unsigned char* buff, uint32_t sector, unsigned count);  /*!< sector read function */
     DRESULT (*write) (unsigned char pdrv, const unsigned char* buff, uint32_t sector, unsigned count);   /*!< sector write function */
     DRESULT (*ioctl) (unsigned char pdrv, unsigned char cmd, void* buff); /*!< function to get info about disk and do some misc operations */
+    bool concurrent;    /*!< the functions can be called from several tasks at the same time */
 } ff_diskio_impl_t;
 
 /**
@@ -66,6 +72,57 @@ void ff_diskio_register(BYTE pdrv, const ff_diskio_impl_t* discio_impl);
  */
 esp_err_t ff_diskio_get_drive(BYTE* out_pdrv);
 
+/**
+ * Statistics of the sector cache of a drive
+ */
+typedef struct {
+    uint32_t hits;          /*!< number of sectors read or written in the cache */
+    uint32_t misses;        /*!< number of sectors which were not in the cache */
+    uint32_t readahead;     /*!< number of sectors read ahead of sequential reads */
+    uint32_t writebacks;    /*!< number of dirty sectors written back to the disk */
+} ff_diskio_cache_stats_t;
+
+/**
+ * Configure the sector cache of a drive
+ *
+ * The cache keeps recently used sectors in RAM and writes modified sectors back to the disk
+ * when they are evicted, on CTRL_SYNC (f_sync(), f_close()) and when the drive is unregistered.
+ * Sequential reads of sectors which are not cached read the following sectors ahead.
+ * Transfers of at least as many sectors as the cache holds bypass the cache.
+ *
+ * Drives are registered with the sizes set by CONFIG_FATFS_DISKIO_CACHE_SECTORS and
+ * CONFIG_FATFS_DISKIO_CACHE_READAHEAD. The memory of the cache is allocated on the first access.
+ * The cache can only be changed while no volume is mounted on the drive.
+ *
+ * @param pdrv      drive number, the driver must be registered and the volume unmounted
+ * @param sectors   number of sectors in the cache, 0 disables the cache
+ * @param readahead number of sectors to read ahead, at most sectors - 1 are used
+ *
+ * @return  ESP_OK                  on success
+ *          ESP_ERR_INVALID_ARG     if the drive number is invalid
+ *          ESP_ERR_INVALID_STATE   if no driver is registered for the drive or a volume is mounted on it
+ *          ESP_FAIL                if the cached sectors could not be written back
+ */
+esp_err_t ff_diskio_set_cache(BYTE pdrv, UINT sectors, UINT readahead);
+
+/**
+ * Get the statistics of the sector cache of a drive
+ *
+ * @param pdrv  drive number
+ * @param stats pointer to the structure which receives the statistics
+ *
+ * @return  ESP_OK                  on success
+ *          ESP_ERR_INVALID_ARG     if the drive number is invalid or stats is NULL
+ */
+esp_err_t ff_diskio_get_cache_stats(BYTE pdrv, ff_diskio_cache_stats_t* stats);
+
+/**
+ * Reset the statistics of the sector cache of a drive
+ *
+ * @param pdrv  drive number
+ */
+void ff_diskio_clear_cache_stats(BYTE pdrv);
+
 
 #ifdef __cplusplus
 }
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2015-2022 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2015-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -120,7 +120,8 @@ esp_err_t ff_diskio_register_raw_partition(BYTE pdrv, const esp_partition_t* par
         .status = &ff_raw_status,
         .read = &ff_raw_read,
         .write = &ff_raw_write,
-        .ioctl = &ff_raw_ioctl
+        .ioctl = &ff_raw_ioctl,
+        .concurrent = true,     // the partition functions can be called from several tasks
     };
     ff_diskio_register(pdrv, &raw_impl);
     s_ff_raw_handles[pdrv] = part_handle;
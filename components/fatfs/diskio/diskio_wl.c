@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2015-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2015-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -91,7 +91,8 @@ esp_err_t ff_diskio_register_wl_partition(BYTE pdrv, wl_handle_t flash_handle)
         .status = &ff_wl_status,
         .read = &ff_wl_read,
         .write = &ff_wl_write,
-        .ioctl = &ff_wl_ioctl
+        .ioctl = &ff_wl_ioctl,
+        .concurrent = true,     // wear levelling serializes the accesses to the partition
     };
     ff_wl_handles[pdrv] = flash_handle;
     ff_diskio_register(pdrv, &wl_impl);
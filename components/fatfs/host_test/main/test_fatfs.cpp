@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2023-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2023-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -11,6 +11,7 @@
 #include "wear_levelling.h"
 #include "diskio_impl.h"
 #include "diskio_wl.h"
+#include "esp_private/partition_linux.h"
 
 #include <catch2/catch_test_macros.hpp>
 
@@ -285,3 +286,231 @@ TEST_CASE("Test mounting 2 volumes, writing data and formatting the 2nd one, rea
     esp_result = wl_unmount(wl_handle1);
     REQUIRE(esp_result == ESP_OK);
 }
+
+TEST_CASE("Positional read and write don't move the file pointer and read fewer sectors", "[fatfs]")
+{
+    FRESULT fr_result;
+    esp_err_t esp_result;
+    const esp_partition_t *partition;
+    wl_handle_t wl_handle;
+    BYTE pdrv;
+    FATFS fs;
+    FIL file;
+    UINT bw;
+
+    prepare_fatfs("storage3", &partition, &wl_handle, &pdrv);
+    char drv[3] = {(char)('0' + pdrv), ':', 0};
+    fr_result = f_mount(&fs, drv, 0);
+    REQUIRE(fr_result == FR_OK);
+
+    char path[16];
+    snprintf(path, sizeof(path), "%s/pio.bin", drv);
+    fr_result = f_open(&file, path, FA_CREATE_ALWAYS | FA_READ | FA_WRITE);
+    REQUIRE(fr_result == FR_OK);
+
+    const uint32_t data_size = 256 * 1024;
+    uint32_t *data = (uint32_t*) malloc(data_size);
+    REQUIRE(data != NULL);
+    for (uint32_t i = 0; i < data_size / sizeof(uint32_t); i++) {
+        data[i] = i;
+    }
+    fr_result = f_write(&file, data, data_size, &bw);
+    REQUIRE(fr_result == FR_OK);
+    REQUIRE(bw == data_size);
+
+    // Overwrite a range crossing sector boundaries, and extend the file, without moving the file pointer
+    fr_result = f_lseek(&file, 1000);
+    REQUIRE(fr_result == FR_OK);
+    uint32_t patch[1500];
+    for (uint32_t i = 0; i < 1500; i++) {
+        patch[i] = 0xA5A50000 + i;
+    }
+    fr_result = f_pwrite(&file, patch, sizeof(patch), 10002 * sizeof(uint32_t), &bw);
+    REQUIRE(fr_result == FR_OK);
+    REQUIRE(bw == sizeof(patch));
+    memcpy(&data[10002], patch, sizeof(patch));
+    fr_result = f_pwrite(&file, patch, 100, data_size, &bw);
+    REQUIRE(fr_result == FR_OK);
+    REQUIRE(bw == 100);
+    REQUIRE(f_size(&file) == data_size + 100);
+    REQUIRE(f_tell(&file) == 1000);
+
+    // The file pointer still reads at its position
+    uint32_t value;
+    fr_result = f_read(&file, &value, sizeof(value), &bw);
+    REQUIRE(fr_result == FR_OK);
+    REQUIRE(value == 250);
+
+    const int read_count = 500;
+    const UINT read_size = 512;
+    uint8_t buf[read_size];
+    uint32_t offsets[read_count];
+    srand(1);
+    for (int i = 0; i < read_count; i++) {
+        offsets[i] = rand() % (data_size - read_size);
+    }
+
+    // Positional read emulated by seeking to the offset and back
+    esp_partition_clear_stats();
+    for (int i = 0; i < read_count; i++) {
+        FSIZE_t pos = f_tell(&file);
+        REQUIRE(f_lseek(&file, offsets[i]) == FR_OK);
+        REQUIRE(f_read(&file, buf, read_size, &bw) == FR_OK);
+        REQUIRE(f_lseek(&file, pos) == FR_OK);
+    }
+    size_t seek_read_ops = esp_partition_get_read_ops();
+    size_t seek_time = esp_partition_get_total_time();
+
+    esp_partition_clear_stats();
+    for (int i = 0; i < read_count; i++) {
+        fr_result = f_pread(&file, buf, read_size, offsets[i], &bw);
+        REQUIRE(fr_result == FR_OK);
+        REQUIRE(bw == read_size);
+        REQUIRE(memcmp(buf, (uint8_t*) data + offsets[i], read_size) == 0);
+    }
+    size_t pread_ops = esp_partition_get_read_ops();
+    size_t pread_time = esp_partition_get_total_time();
+    printf("%d random reads of %u bytes: seek and read %zu flash reads (%zu us), f_pread %zu flash reads (%zu us)\n",
+           read_count, read_size, seek_read_ops, seek_time, pread_ops, pread_time);
+    CHECK(pread_ops < seek_read_ops);
+    REQUIRE(f_tell(&file) == 1004);
+
+    // Reading at the end of the file returns only the remaining bytes
+    fr_result = f_pread(&file, buf, read_size, data_size + 50, &bw);
+    REQUIRE(fr_result == FR_OK);
+    REQUIRE(bw == 50);
+
+    fr_result = f_close(&file);
+    REQUIRE(fr_result == FR_OK);
+    fr_result = f_mount(0, drv, 0);
+    REQUIRE(fr_result == FR_OK);
+
+    free(data);
+    ff_diskio_unregister(pdrv);
+    ff_diskio_clear_pdrv_wl(wl_handle);
+    esp_result = wl_unmount(wl_handle);
+    REQUIRE(esp_result == ESP_OK);
+}
+
+static void write_and_read_sequentially(const char* path, size_t* write_ops, size_t* read_ops, size_t* time_us)
+{
+    FIL file;
+    UINT bw;
+    char buf[100];
+
+    esp_partition_clear_stats();
+    REQUIRE(f_open(&file, path, FA_CREATE_ALWAYS | FA_WRITE) == FR_OK);
+    for (int i = 0; i < 1000; i++) {
+        memset(buf, i, sizeof(buf));
+        REQUIRE(f_write(&file, buf, sizeof(buf), &bw) == FR_OK);
+        REQUIRE(bw == sizeof(buf));
+    }
+    REQUIRE(f_close(&file) == FR_OK);
+
+    REQUIRE(f_open(&file, path, FA_READ) == FR_OK);
+    for (int i = 0; i < 1000; i++) {
+        REQUIRE(f_read(&file, buf, sizeof(buf), &bw) == FR_OK);
+        REQUIRE(bw == sizeof(buf));
+        REQUIRE(buf[0] == (char) i);
+        REQUIRE(buf[sizeof(buf) - 1] == (char) i);
+    }
+    REQUIRE(f_close(&file) == FR_OK);
+    *write_ops = esp_partition_get_write_ops();
+    *read_ops = esp_partition_get_read_ops();
+    *time_us = esp_partition_get_total_time();
+}
+
+// Rewrites 100 bytes in each of the first 4 sectors of the file in turn, returns the number of flash writes
+static size_t rewrite_sectors(const char* path, size_t sector_size)
+{
+    FIL file;
+    UINT bw;
+    char buf[100];
+
+    esp_partition_clear_stats();
+    REQUIRE(f_open(&file, path, FA_OPEN_EXISTING | FA_WRITE) == FR_OK);
+    for (int i = 0; i < 200; i++) {
+        memset(buf, i, sizeof(buf));
+        REQUIRE(f_lseek(&file, (i % 4) * sector_size + 10) == FR_OK);
+        REQUIRE(f_write(&file, buf, sizeof(buf), &bw) == FR_OK);
+        REQUIRE(bw == sizeof(buf));
+    }
+    REQUIRE(f_close(&file) == FR_OK);
+    return esp_partition_get_write_ops();
+}
+
+TEST_CASE("Disk I/O cache merges sequential accesses", "[fatfs]")
+{
+    FRESULT fr_result;
+    esp_err_t esp_result;
+    const esp_partition_t *partition;
+    wl_handle_t wl_handle;
+    BYTE pdrv;
+    FATFS fs;
+
+    prepare_fatfs("storage3", &partition, &wl_handle, &pdrv);
+    char drv[3] = {(char)('0' + pdrv), ':', 0};
+    char path[16];
+    snprintf(path, sizeof(path), "%s/seq.bin", drv);
+
+    const size_t sector_size = wl_sector_size(wl_handle);
+
+    REQUIRE(ff_diskio_set_cache(pdrv, 0, 0) == ESP_OK);
+    fr_result = f_mount(&fs, drv, 1);
+    REQUIRE(fr_result == FR_OK);
+    size_t write_ops, read_ops, time_us;
+    write_and_read_sequentially(path, &write_ops, &read_ops, &time_us);
+    printf("Without cache: %zu flash writes, %zu flash reads, %zu us\n", write_ops, read_ops, time_us);
+    size_t rewrite_ops = rewrite_sectors(path, sector_size);
+    printf("Without cache: %zu flash writes to rewrite 4 sectors\n", rewrite_ops);
+
+    // The cache can't be changed while the volume is mounted
+    REQUIRE(ff_diskio_set_cache(pdrv, 8, 4) == ESP_ERR_INVALID_STATE);
+    fr_result = f_mount(0, drv, 0);
+    REQUIRE(fr_result == FR_OK);
+    REQUIRE(ff_diskio_set_cache(pdrv, 8, 4) == ESP_OK);
+    fr_result = f_mount(&fs, drv, 1);
+    REQUIRE(fr_result == FR_OK);
+
+    ff_diskio_clear_cache_stats(pdrv);
+    size_t cached_write_ops, cached_read_ops, cached_time_us;
+    write_and_read_sequentially(path, &cached_write_ops, &cached_read_ops, &cached_time_us);
+    printf("With cache: %zu flash writes, %zu flash reads, %zu us\n", cached_write_ops, cached_read_ops, cached_time_us);
+    CHECK(cached_read_ops < read_ops);
+    // FatFs buffers a sector per file, so sequential writes reach the flash once per sector with or
+    // without the cache. Sectors written back by FatFs while they are still cached reach it once.
+    size_t cached_rewrite_ops = rewrite_sectors(path, sector_size);
+    printf("With cache: %zu flash writes to rewrite 4 sectors\n", cached_rewrite_ops);
+    CHECK(cached_rewrite_ops * 4 < rewrite_ops);
+
+    ff_diskio_cache_stats_t stats;
+    REQUIRE(ff_diskio_get_cache_stats(pdrv, &stats) == ESP_OK);
+    CHECK(stats.hits > 0);
+    CHECK(stats.readahead > 0);
+    CHECK(stats.writebacks > 0);
+
+    // f_sync() writes the cached sectors to the flash, read the sector of the file from the flash before and after
+    FIL file;
+    UINT bw;
+    char buf[6];
+    fr_result = f_open(&file, path, FA_OPEN_EXISTING | FA_WRITE);
+    REQUIRE(fr_result == FR_OK);
+    fr_result = f_write(&file, "cached", 6, &bw);
+    REQUIRE(fr_result == FR_OK);
+    const LBA_t sector = file.sect;     // sector of the file buffer, holding the written data
+    REQUIRE(wl_read(wl_handle, sector * sector_size, buf, sizeof(buf)) == ESP_OK);
+    CHECK(memcmp(buf, "cached", 6) != 0);
+    fr_result = f_sync(&file);
+    REQUIRE(fr_result == FR_OK);
+    REQUIRE(wl_read(wl_handle, sector * sector_size, buf, sizeof(buf)) == ESP_OK);
+    REQUIRE(memcmp(buf, "cached", 6) == 0);
+    fr_result = f_close(&file);
+    REQUIRE(fr_result == FR_OK);
+
+    fr_result = f_mount(0, drv, 0);
+    REQUIRE(fr_result == FR_OK);
+    ff_diskio_unregister(pdrv);
+    ff_diskio_clear_pdrv_wl(wl_handle);
+    esp_result = wl_unmount(wl_handle);
+    REQUIRE(esp_result == ESP_OK);
+}
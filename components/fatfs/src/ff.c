@@ -1654,6 +1654,92 @@ static DWORD clmt_clust (	/* <2:Error, >=2:Cluster number */
 
 
 
+#if !FF_FS_TINY
+/*-----------------------------------------------------------------------*/
+/* File handling - Load a sector into the sector cache of the file       */
+/*-----------------------------------------------------------------------*/
+
+static FRESULT load_sect (	/* FR_OK or FR_DISK_ERR */
+	FIL* fp,		/* Pointer to the file object */
+	LBA_t sect,		/* Sector to make appearance in the fp->buf[] */
+	int fill		/* 0:Do not read the sector (it is beyond the end of the file) */
+)
+{
+	FATFS *fs = fp->obj.fs;
+
+
+	if (fp->sect != sect) {
+#if !FF_FS_READONLY
+		if (fp->flag & FA_DIRTY) {		/* Write-back dirty sector cache */
+			if (disk_write(fs->pdrv, fp->buf, fp->sect, 1) != RES_OK) return FR_DISK_ERR;
+			fp->flag &= (BYTE)~FA_DIRTY;
+		}
+#endif
+		if (fill && disk_read(fs->pdrv, fp->buf, sect, 1) != RES_OK) return FR_DISK_ERR;	/* Fill sector cache */
+		fp->sect = sect;
+	}
+	return FR_OK;
+}
+
+#endif	/* !FF_FS_TINY */
+
+
+
+#if FF_FS_MINIMIZE <= 2
+/*-----------------------------------------------------------------------*/
+/* FAT handling - Convert offset into cluster for positional access      */
+/*-----------------------------------------------------------------------*/
+
+static DWORD pos_clust (	/* 0:Disk full (stretch), 1:Internal error, 0xFFFFFFFF:Disk error, >=2:Cluster number */
+	FIL* fp,		/* Pointer to the file object */
+	FSIZE_t ofs,	/* File offset to be converted to cluster# */
+	int stretch		/* 0:Follow the chain, 1:Stretch the chain if needed */
+)
+{
+	DWORD bcs, cidx, idx, clst;
+	FATFS *fs = fp->obj.fs;
+
+
+#if FF_USE_FASTSEEK
+	if (fp->cltbl) return clmt_clust(fp, ofs);	/* Get cluster# from the CLMT */
+#endif
+	bcs = (DWORD)fs->csize * SS(fs);	/* Cluster size in byte */
+	cidx = (DWORD)(ofs / bcs);			/* Cluster order from top of the file */
+	idx = 0; clst = fp->obj.sclust;		/* Follow the chain from the nearest known cluster: the origin, */
+	if (fp->fptr > 0 && (DWORD)((fp->fptr - 1) / bcs) <= cidx) {	/* the current cluster of the file pointer */
+		idx = (DWORD)((fp->fptr - 1) / bcs); clst = fp->clust;
+	}
+	if (fp->pclust >= 2 && fp->pcidx <= cidx && fp->pcidx >= idx) {	/* or the cluster of the last positional access */
+		idx = fp->pcidx; clst = fp->pclust;
+	}
+#if !FF_FS_READONLY
+	if (clst == 0 && stretch) {			/* If no cluster is allocated, create a new cluster chain */
+		clst = create_chain(&fp->obj, 0);
+		if (clst < 2 || clst == 0xFFFFFFFF) return clst;
+		fp->obj.sclust = clst;
+	}
+#endif
+	for ( ; idx < cidx; idx++) {
+#if !FF_FS_READONLY
+		if (stretch) {
+			clst = create_chain(&fp->obj, clst);	/* Follow or stretch cluster chain on the FAT */
+			if (clst < 2 || clst == 0xFFFFFFFF) return clst;
+			continue;
+		}
+#endif
+		clst = get_fat(&fp->obj, clst);		/* Follow cluster chain on the FAT */
+		if (clst == 0xFFFFFFFF) return clst;
+		if (clst < 2 || clst >= fs->n_fatent) return 1;
+	}
+	if (clst < 2) return 1;
+	fp->pcidx = cidx; fp->pclust = clst;	/* Remember the cluster for the next positional access */
+	return clst;
+}
+
+#endif	/* FF_FS_MINIMIZE <= 2 */
+
+
+
 
 /*-----------------------------------------------------------------------*/
 /* Directory handling - Fill a cluster with zeros                        */
@@ -3723,6 +3809,22 @@ FRESULT f_mount (
 
 
 
+/*-----------------------------------------------------------------------*/
+/* Check if a Filesystem Object is Registered on a Logical Drive         */
+/*-----------------------------------------------------------------------*/
+/* While it is registered, the volume mutex exists and the disk functions
+/  of the drive are called under it. */
+
+int f_mounted (
+	BYTE vol		/* Logical drive number */
+)
+{
+	return (int)(vol < FF_VOLUMES && FatFs[vol] != 0);
+}
+
+
+
+
 /*-----------------------------------------------------------------------*/
 /* Open or Create a File                                                 */
 /*-----------------------------------------------------------------------*/
@@ -3877,6 +3979,7 @@ FRESULT f_open (
 			fp->err = 0;		/* Clear error flag */
 			fp->sect = 0;		/* Invalidate current data sector */
 			fp->fptr = 0;		/* Set file pointer top of the file */
+			fp->pclust = 0;		/* Invalidate cluster of the last positional access */
 #if !FF_FS_READONLY
 #if !FF_FS_TINY
 #if FF_USE_DYN_BUFFER
@@ -4027,6 +4130,13 @@ FRESULT f_read (
 #endif
 			fp->sect = sect;
 		}
+#if !FF_FS_TINY && FF_FS_MINIMIZE <= 2
+		else {									/* The sector cache may have been taken by f_pread() or f_pwrite() */
+			sect = clst2sect(fs, fp->clust);
+			if (sect == 0) ABORT(fs, FR_INT_ERR);
+			if (load_sect(fp, sect + (UINT)(fp->fptr / SS(fs) & (fs->csize - 1)), 1) != FR_OK) ABORT(fs, FR_DISK_ERR);
+		}
+#endif
 		rcnt = SS(fs) - (UINT)fp->fptr % SS(fs);	/* Number of bytes remains in the sector */
 		if (rcnt > btr) rcnt = btr;					/* Clip it by btr if needed */
 #if FF_FS_TINY
@@ -4145,6 +4255,13 @@ FRESULT f_write (
 #endif
 			fp->sect = sect;
 		}
+#if !FF_FS_TINY && FF_FS_MINIMIZE <= 2
+		else {								/* The sector cache may have been taken by f_pread() or f_pwrite() */
+			sect = clst2sect(fs, fp->clust);
+			if (sect == 0) ABORT(fs, FR_INT_ERR);
+			if (load_sect(fp, sect + (UINT)(fp->fptr / SS(fs) & (fs->csize - 1)), 1) != FR_OK) ABORT(fs, FR_DISK_ERR);
+		}
+#endif
 		wcnt = SS(fs) - (UINT)fp->fptr % SS(fs);	/* Number of bytes remains in the sector */
 		if (wcnt > btw) wcnt = btw;					/* Clip it by btw if needed */
 #if FF_FS_TINY
@@ -4630,6 +4747,220 @@ FRESULT f_lseek (
 
 
 
+
+/*-----------------------------------------------------------------------*/
+/* Read File at Offset                                                   */
+/*-----------------------------------------------------------------------*/
+/* The file read/write pointer is not moved. Partial sectors are read through the sector cache of the
+/  file, f_read() and f_write() reload it when the file pointer is in the middle of another sector.
+/  With FF_FS_REENTRANT, the volume is unlocked while whole sectors are read directly, so the disk
+/  functions can be called from several tasks at a time. The file object is only used under the lock,
+/  but the caller must keep the file from being closed or truncated until the function returns. */
+
+FRESULT f_pread (
+	FIL* fp, 	/* Open file to be read */
+	void* buff,	/* Data buffer to store the read data */
+	UINT btr,	/* Number of bytes to read */
+	FSIZE_t ofs,	/* File offset to read from */
+	UINT* br	/* Number of bytes read */
+)
+{
+	FRESULT res;
+	FATFS *fs;
+	DWORD clst = 0;
+	LBA_t sect;
+	FSIZE_t remain;
+	UINT rcnt, cc, csect;
+	BYTE *rbuff = (BYTE*)buff;
+#if FF_FS_REENTRANT && !FF_FS_TINY
+	DRESULT dr;
+#endif
+
+
+	*br = 0;	/* Clear read byte counter */
+	res = validate(&fp->obj, &fs);				/* Check validity of the file object */
+	if (res != FR_OK || (res = (FRESULT)fp->err) != FR_OK) LEAVE_FF(fs, res);	/* Check validity */
+	if (!(fp->flag & FA_READ)) LEAVE_FF(fs, FR_DENIED); /* Check access mode */
+#if FF_FS_EXFAT && !FF_FS_READONLY
+	if (fs->fs_type == FS_EXFAT) {
+		res = fill_last_frag(&fp->obj, fp->clust, 0xFFFFFFFF);	/* Fill last fragment on the FAT if needed */
+		if (res != FR_OK) ABORT(fs, res);
+	}
+#endif
+	if (ofs >= fp->obj.objsize) LEAVE_FF(fs, FR_OK);	/* Nothing to read beyond the end of the file */
+	remain = fp->obj.objsize - ofs;
+	if (btr > remain) btr = (UINT)remain;		/* Truncate btr by remaining bytes */
+
+	for ( ; btr > 0; btr -= rcnt, *br += rcnt, rbuff += rcnt, ofs += rcnt) {	/* Repeat until btr bytes read */
+		csect = (UINT)(ofs / SS(fs) & (fs->csize - 1));	/* Sector offset in the cluster */
+		if (clst == 0 || (csect == 0 && ofs % SS(fs) == 0)) {	/* First access or on the cluster boundary? */
+			clst = pos_clust(fp, ofs, 0);
+			if (clst == 0xFFFFFFFF) ABORT(fs, FR_DISK_ERR);
+			if (clst < 2) ABORT(fs, FR_INT_ERR);
+		}
+		sect = clst2sect(fs, clst);				/* Get current sector */
+		if (sect == 0) ABORT(fs, FR_INT_ERR);
+		sect += csect;
+		cc = btr / SS(fs);						/* When remaining bytes >= sector size, */
+		if (ofs % SS(fs) == 0 && cc > 0) {		/* Read maximum contiguous sectors directly */
+			if (csect + cc > fs->csize) {		/* Clip at cluster boundary */
+				cc = fs->csize - csect;
+			}
+#if FF_FS_REENTRANT && !FF_FS_TINY	/* Let other files of the volume be accessed during the transfer */
+			unlock_volume(fs, FR_OK);
+			dr = disk_read(fs->pdrv, rbuff, sect, cc);
+			res = validate(&fp->obj, &fs);		/* Take the volume back, it may have been unmounted */
+			if (res != FR_OK) LEAVE_FF(fs, res);
+			if (dr != RES_OK) ABORT(fs, FR_DISK_ERR);
+#else
+			if (disk_read(fs->pdrv, rbuff, sect, cc) != RES_OK) ABORT(fs, FR_DISK_ERR);
+#endif
+#if !FF_FS_READONLY		/* Replace one of the read sectors with cached data if it contains a dirty sector */
+#if FF_FS_TINY
+			if (fs->wflag && fs->winsect - sect < cc) {
+				memcpy(rbuff + ((fs->winsect - sect) * SS(fs)), fs->win, SS(fs));
+			}
+#else
+			if ((fp->flag & FA_DIRTY) && fp->sect - sect < cc) {
+				memcpy(rbuff + ((fp->sect - sect) * SS(fs)), fp->buf, SS(fs));
+			}
+#endif
+#endif
+			rcnt = SS(fs) * cc;					/* Number of bytes transferred */
+			continue;
+		}
+		rcnt = SS(fs) - (UINT)(ofs % SS(fs));	/* Number of bytes remains in the sector */
+		if (rcnt > btr) rcnt = btr;				/* Clip it by btr if needed */
+#if FF_FS_TINY
+		if (move_window(fs, sect) != FR_OK) ABORT(fs, FR_DISK_ERR);	/* Move sector window */
+		memcpy(rbuff, fs->win + ofs % SS(fs), rcnt);	/* Extract partial sector */
+#else
+		if (load_sect(fp, sect, 1) != FR_OK) ABORT(fs, FR_DISK_ERR);	/* Load data sector if not in cache */
+		memcpy(rbuff, fp->buf + ofs % SS(fs), rcnt);	/* Extract partial sector */
+#endif
+	}
+
+	LEAVE_FF(fs, FR_OK);
+}
+
+
+
+
+#if !FF_FS_READONLY
+/*-----------------------------------------------------------------------*/
+/* Write File at Offset                                                  */
+/*-----------------------------------------------------------------------*/
+/* The file read/write pointer is not moved. The file is stretched if the offset is beyond its end, the
+/  content of the gap is undefined as with f_lseek(). The volume is unlocked while whole sectors are
+/  written directly, as in f_pread(). */
+
+FRESULT f_pwrite (
+	FIL* fp,			/* Open file to be written */
+	const void* buff,	/* Data to be written */
+	UINT btw,			/* Number of bytes to write */
+	FSIZE_t ofs,		/* File offset to write to */
+	UINT* bw			/* Number of bytes written */
+)
+{
+	FRESULT res;
+	FATFS *fs;
+	DWORD clst = 0;
+	LBA_t sect;
+	UINT wcnt, cc, csect;
+	const BYTE *wbuff = (const BYTE*)buff;
+#if FF_FS_REENTRANT && !FF_FS_TINY
+	DRESULT dr;
+#endif
+
+
+	*bw = 0;	/* Clear write byte counter */
+	res = validate(&fp->obj, &fs);			/* Check validity of the file object */
+	if (res != FR_OK || (res = (FRESULT)fp->err) != FR_OK) LEAVE_FF(fs, res);	/* Check validity */
+	if (!(fp->flag & FA_WRITE)) LEAVE_FF(fs, FR_DENIED);	/* Check access mode */
+#if FF_FS_EXFAT
+	if (fs->fs_type != FS_EXFAT && ofs >= 0x100000000) LEAVE_FF(fs, FR_INVALID_PARAMETER);	/* Beyond 4 GiB - 1 at FATxx */
+	if (fs->fs_type == FS_EXFAT) {
+		res = fill_last_frag(&fp->obj, fp->clust, 0xFFFFFFFF);	/* Fill last fragment on the FAT if needed */
+		if (res != FR_OK) ABORT(fs, res);
+	}
+#endif
+
+	/* Check offset wrap-around (file size cannot reach 4 GiB at FAT volume) */
+	if ((!FF_FS_EXFAT || fs->fs_type != FS_EXFAT) && (DWORD)(ofs + btw) < (DWORD)ofs) {
+		btw = (UINT)(0xFFFFFFFF - (DWORD)ofs);
+	}
+
+	for ( ; btw > 0; btw -= wcnt, *bw += wcnt, wbuff += wcnt, ofs += wcnt, fp->obj.objsize = (ofs > fp->obj.objsize) ? ofs : fp->obj.objsize) {	/* Repeat until all data written */
+		csect = (UINT)(ofs / SS(fs)) & (fs->csize - 1);	/* Sector offset in the cluster */
+		if (clst == 0 || (csect == 0 && ofs % SS(fs) == 0)) {	/* First access or on the cluster boundary? */
+			clst = pos_clust(fp, ofs, 1);
+			if (clst == 0) break;			/* Could not allocate a new cluster (disk full) */
+			if (clst == 1) ABORT(fs, FR_INT_ERR);
+			if (clst == 0xFFFFFFFF) ABORT(fs, FR_DISK_ERR);
+		}
+		sect = clst2sect(fs, clst);			/* Get current sector */
+		if (sect == 0) ABORT(fs, FR_INT_ERR);
+		sect += csect;
+		cc = btw / SS(fs);					/* When remaining bytes >= sector size, */
+		if (ofs % SS(fs) == 0 && cc > 0) {	/* Write maximum contiguous sectors directly */
+			if (csect + cc > fs->csize) {	/* Clip at cluster boundary */
+				cc = fs->csize - csect;
+			}
+#if FF_FS_REENTRANT && !FF_FS_TINY	/* Let other files of the volume be accessed during the transfer */
+			unlock_volume(fs, FR_OK);
+			dr = disk_write(fs->pdrv, wbuff, sect, cc);
+			res = validate(&fp->obj, &fs);		/* Take the volume back, it may have been unmounted */
+			if (res != FR_OK) LEAVE_FF(fs, res);
+			if (dr != RES_OK) ABORT(fs, FR_DISK_ERR);
+#else
+			if (disk_write(fs->pdrv, wbuff, sect, cc) != RES_OK) ABORT(fs, FR_DISK_ERR);
+#endif
+#if FF_FS_TINY
+			if (fs->winsect - sect < cc) {	/* Refill sector cache if it gets invalidated by the direct write */
+				memcpy(fs->win, wbuff + ((fs->winsect - sect) * SS(fs)), SS(fs));
+				fs->wflag = 0;
+			}
+#else
+			if (fp->sect - sect < cc) { /* Refill sector cache if it gets invalidated by the direct write */
+				memcpy(fp->buf, wbuff + ((fp->sect - sect) * SS(fs)), SS(fs));
+				fp->flag &= (BYTE)~FA_DIRTY;
+			}
+#endif
+			wcnt = SS(fs) * cc;		/* Number of bytes transferred */
+			continue;
+		}
+		wcnt = SS(fs) - (UINT)(ofs % SS(fs));	/* Number of bytes remains in the sector */
+		if (wcnt > btw) wcnt = btw;				/* Clip it by btw if needed */
+#if FF_FS_TINY
+		if (ofs - ofs % SS(fs) >= fp->obj.objsize) {	/* Avoid silly cache filling on the growing edge */
+			if (sync_window(fs) != FR_OK) ABORT(fs, FR_DISK_ERR);
+			fs->winsect = sect;
+		}
+		if (move_window(fs, sect) != FR_OK) ABORT(fs, FR_DISK_ERR);	/* Move sector window */
+		memcpy(fs->win + ofs % SS(fs), wbuff, wcnt);	/* Fit data to the sector */
+		fs->wflag = 1;
+#else
+		if (load_sect(fp, sect, ofs - ofs % SS(fs) < fp->obj.objsize) != FR_OK) ABORT(fs, FR_DISK_ERR);	/* Fill sector cache with file data */
+		memcpy(fp->buf + ofs % SS(fs), wbuff, wcnt);	/* Fit data to the sector */
+		fp->flag |= FA_DIRTY;
+#endif
+	}
+#if FF_FS_EXFAT
+	if (fs->fs_type == FS_EXFAT) {
+		res = fill_last_frag(&fp->obj, fp->pclust, 0xFFFFFFFF);	/* Terminate the chain stretched here, as fp->clust may not be its last cluster */
+		if (res != FR_OK) ABORT(fs, res);
+	}
+#endif
+
+	fp->flag |= FA_MODIFIED;				/* Set file change flag */
+
+	LEAVE_FF(fs, FR_OK);
+}
+
+#endif /* !FF_FS_READONLY */
+
+
+
 #if FF_FS_MINIMIZE <= 1
 /*-----------------------------------------------------------------------*/
 /* Create a Directory Object                                             */
@@ -4978,6 +5309,7 @@ FRESULT f_truncate (
 		}
 		fp->obj.objsize = fp->fptr;	/* Set file size to current read/write point */
 		fp->flag |= FA_MODIFIED;
+		fp->pclust = 0;				/* The cluster of the last positional access may be removed */
 #if !FF_FS_TINY
 		if (res == FR_OK && (fp->flag & FA_DIRTY)) {
 			if (disk_write(fs->pdrv, fp->buf, fp->sect, 1) != RES_OK) {
@@ -0,0 +1,217 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sys/time.h>
+#include <sys/unistd.h>
+#include "unity.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_vfs_fat.h"
+#include "diskio_impl.h"
+#include "ff.h"
+
+#if !FF_FS_TINY
+
+/* RAM disk whose reads block for a while, as a driver waiting for a DMA transfer.
+ * The driver is concurrent, so FatFs can overlap the reads of several tasks. */
+#define RAM_DISK_SECTOR_SIZE    512
+#define RAM_DISK_SECTOR_COUNT   128
+#define RAM_DISK_READ_TICKS     2
+
+static BYTE* s_ram_disk;
+
+static DSTATUS ram_disk_init(BYTE pdrv)
+{
+    return 0;
+}
+
+static DSTATUS ram_disk_status(BYTE pdrv)
+{
+    return 0;
+}
+
+static DRESULT ram_disk_read(BYTE pdrv, BYTE* buff, DWORD sector, UINT count)
+{
+    vTaskDelay(RAM_DISK_READ_TICKS);
+    memcpy(buff, s_ram_disk + sector * RAM_DISK_SECTOR_SIZE, count * RAM_DISK_SECTOR_SIZE);
+    return RES_OK;
+}
+
+static DRESULT ram_disk_write(BYTE pdrv, const BYTE* buff, DWORD sector, UINT count)
+{
+    memcpy(s_ram_disk + sector * RAM_DISK_SECTOR_SIZE, buff, count * RAM_DISK_SECTOR_SIZE);
+    return RES_OK;
+}
+
+static DRESULT ram_disk_ioctl(BYTE pdrv, BYTE cmd, void* buff)
+{
+    switch (cmd) {
+        case CTRL_SYNC:
+            return RES_OK;
+        case GET_SECTOR_COUNT:
+            *((DWORD*) buff) = RAM_DISK_SECTOR_COUNT;
+            return RES_OK;
+        case GET_SECTOR_SIZE:
+            *((WORD*) buff) = RAM_DISK_SECTOR_SIZE;
+            return RES_OK;
+        case GET_BLOCK_SIZE:
+            *((DWORD*) buff) = 1;
+            return RES_OK;
+    }
+    return RES_ERROR;
+}
+
+#define PREAD_FILE_SIZE     (16 * 1024)
+#define PREAD_BLOCK_SIZE    4096
+#define PREAD_PASSES        4
+
+typedef struct {
+    const char* filename;
+    esp_err_t result;
+    SemaphoreHandle_t done;
+} pread_test_arg_t;
+
+// Value of each word of the test files, different in each file
+static uint32_t pread_test_word(const char* filename, size_t index)
+{
+    return (uint32_t) (filename[strlen(filename) - 1] << 24) + index;
+}
+
+static void pread_task(void* param)
+{
+    pread_test_arg_t* args = (pread_test_arg_t*) param;
+    const size_t block_count = PREAD_FILE_SIZE / PREAD_BLOCK_SIZE;
+    const size_t block_words = PREAD_BLOCK_SIZE / sizeof(uint32_t);
+    uint32_t* buf = malloc(PREAD_BLOCK_SIZE);
+    int fd = open(args->filename, O_RDONLY);
+    args->result = ESP_OK;
+    if (buf == NULL || fd < 0) {
+        args->result = ESP_ERR_NO_MEM;
+        goto done;
+    }
+
+    for (size_t i = 0; i < PREAD_PASSES * block_count; ++i) {
+        size_t block = (i * 3) % block_count;
+        memset(buf, 0, PREAD_BLOCK_SIZE);
+        if (pread(fd, buf, PREAD_BLOCK_SIZE, block * PREAD_BLOCK_SIZE) != PREAD_BLOCK_SIZE) {
+            printf("E(pread): %s block %d\n", args->filename, block);
+            args->result = ESP_FAIL;
+            goto done;
+        }
+        for (size_t j = 0; j < block_words; ++j) {
+            if (buf[j] != pread_test_word(args->filename, block * block_words + j)) {
+                printf("E(data): %s block %d word %d\n", args->filename, block, j);
+                args->result = ESP_FAIL;
+                goto done;
+            }
+        }
+    }
+
+done:
+    if (fd >= 0) {
+        close(fd);
+    }
+    free(buf);
+    xSemaphoreGive(args->done);
+    vTaskDelete(NULL);
+}
+
+static int64_t run_pread_tasks(pread_test_arg_t* args, size_t count)
+{
+    struct timeval tv_start;
+    gettimeofday(&tv_start, NULL);
+    for (size_t i = 0; i < count; ++i) {
+        TEST_ASSERT_EQUAL(pdPASS, xTaskCreate(&pread_task, "pread", 4096, &args[i], 5, NULL));
+    }
+    for (size_t i = 0; i < count; ++i) {
+        xSemaphoreTake(args[i].done, portMAX_DELAY);
+    }
+    struct timeval tv_end;
+    gettimeofday(&tv_end, NULL);
+    for (size_t i = 0; i < count; ++i) {
+        TEST_ASSERT_EQUAL(ESP_OK, args[i].result);
+    }
+    return (tv_end.tv_sec - tv_start.tv_sec) * 1000000LL + (tv_end.tv_usec - tv_start.tv_usec);
+}
+
+TEST_CASE("(RAM disk) pread of two files by two tasks overlaps the disk reads", "[fatfs][timeout=60]")
+{
+    static const ff_diskio_impl_t ram_disk_impl = {
+        .init = &ram_disk_init,
+        .status = &ram_disk_status,
+        .read = &ram_disk_read,
+        .write = &ram_disk_write,
+        .ioctl = &ram_disk_ioctl,
+        .concurrent = true,
+    };
+    s_ram_disk = calloc(RAM_DISK_SECTOR_COUNT, RAM_DISK_SECTOR_SIZE);
+    TEST_ASSERT_NOT_NULL(s_ram_disk);
+    BYTE pdrv;
+    TEST_ESP_OK(ff_diskio_get_drive(&pdrv));
+    ff_diskio_register(pdrv, &ram_disk_impl);
+    // the sector cache serializes the disk functions of the drive
+    TEST_ESP_OK(ff_diskio_set_cache(pdrv, 0, 0));
+
+    char drv[3] = {(char)('0' + pdrv), ':', 0};
+    const esp_vfs_fat_conf_t conf = {
+        .base_path = "/ramdisk",
+        .fat_drive = drv,
+        .max_files = 4,
+    };
+    FATFS* fs;
+    TEST_ESP_OK(esp_vfs_fat_register_cfg(&conf, &fs));
+    const MKFS_PARM opt = {(BYTE)(FM_ANY | FM_SFD), 1, 0, 16, PREAD_BLOCK_SIZE};
+    void* workbuf = malloc(FF_MAX_SS);
+    TEST_ASSERT_NOT_NULL(workbuf);
+    TEST_ASSERT_EQUAL(FR_OK, f_mkfs(drv, &opt, workbuf, FF_MAX_SS));
+    free(workbuf);
+    TEST_ASSERT_EQUAL(FR_OK, f_mount(fs, drv, 1));
+
+    const char* names[2] = {"/ramdisk/pr1", "/ramdisk/pr2"};
+    pread_test_arg_t args[2];
+    uint32_t* buf = malloc(PREAD_BLOCK_SIZE);
+    TEST_ASSERT_NOT_NULL(buf);
+    const size_t block_words = PREAD_BLOCK_SIZE / sizeof(uint32_t);
+    for (size_t i = 0; i < 2; ++i) {
+        FILE* f = fopen(names[i], "wb");
+        TEST_ASSERT_NOT_NULL(f);
+        for (size_t block = 0; block < PREAD_FILE_SIZE / PREAD_BLOCK_SIZE; ++block) {
+            for (size_t j = 0; j < block_words; ++j) {
+                buf[j] = pread_test_word(names[i], block * block_words + j);
+            }
+            TEST_ASSERT_EQUAL(1, fwrite(buf, PREAD_BLOCK_SIZE, 1, f));
+        }
+        TEST_ASSERT_EQUAL(0, fclose(f));
+        args[i] = (pread_test_arg_t) {
+            .filename = names[i],
+            .done = xSemaphoreCreateBinary(),
+        };
+        TEST_ASSERT_NOT_NULL(args[i].done);
+    }
+    free(buf);
+
+    // The volume is unlocked during the disk reads, so two tasks take about as long as one,
+    // rather than twice as long if the reads of both files were serialized.
+    int64_t t_one = run_pread_tasks(args, 1);
+    int64_t t_two = run_pread_tasks(args, 2);
+    printf("pread of 1 file by 1 task: %lld us, of 2 files by 2 tasks: %lld us\n", t_one, t_two);
+    TEST_ASSERT_LESS_THAN(t_one * 3 / 2, t_two);
+
+    for (size_t i = 0; i < 2; ++i) {
+        vSemaphoreDelete(args[i].done);
+    }
+    TEST_ASSERT_EQUAL(FR_OK, f_mount(NULL, drv, 0));
+    TEST_ESP_OK(esp_vfs_fat_unregister_path("/ramdisk"));
+    ff_diskio_unregister(pdrv);
+    free(s_ram_disk);
+}
+
+#endif // !FF_FS_TINY
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2015-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2015-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -44,6 +44,7 @@ typedef struct {
     char tmp_path_buf[FILENAME_MAX+3];  /* temporary buffer used to prepend drive name to the path */
     char tmp_path_buf2[FILENAME_MAX+3]; /* as above; used in functions which take two path arguments */
     uint32_t *flags; /* file descriptor flags, array of max_files size */
+    _lock_t *file_locks; /* held by the calls which unlock the volume while using the file, array of max_files size */
 #ifdef CONFIG_VFS_SUPPORT_DIR
     char dir_path[FILENAME_MAX]; /* variable to store path of opened directory*/
     struct cached_data cached_fileinfo;
@@ -211,18 +212,28 @@ esp_err_t esp_vfs_fat_register_cfg(const esp_vfs_fat_conf_t* conf, FATFS** out_f
         return ESP_ERR_NO_MEM;
     }
     memset(fat_ctx->flags, 0, max_files * sizeof(*fat_ctx->flags));
+    fat_ctx->file_locks = ff_memalloc(max_files * sizeof(*fat_ctx->file_locks));
+    if (fat_ctx->file_locks == NULL) {
+        free(fat_ctx->flags);
+        free(fat_ctx);
+        return ESP_ERR_NO_MEM;
+    }
     fat_ctx->max_files = max_files;
     strlcpy(fat_ctx->fat_drive, conf->fat_drive, sizeof(fat_ctx->fat_drive) - 1);
     strlcpy(fat_ctx->base_path, conf->base_path, sizeof(fat_ctx->base_path) - 1);
 
     esp_err_t err = esp_vfs_register_fs(conf->base_path, &s_vfs_fat, ESP_VFS_FLAG_CONTEXT_PTR | ESP_VFS_FLAG_STATIC, fat_ctx);
     if (err != ESP_OK) {
+        free(fat_ctx->file_locks);
         free(fat_ctx->flags);
         free(fat_ctx);
         return err;
     }
 
     _lock_init(&fat_ctx->lock);
+    for (size_t i = 0; i < max_files; i++) {
+        _lock_init(&fat_ctx->file_locks[i]);
+    }
     s_fat_ctxs[ctx] = fat_ctx;
 
     //compatibility
@@ -245,6 +256,10 @@ esp_err_t esp_vfs_fat_unregister_path(const char* base_path)
         return err;
     }
     _lock_close(&fat_ctx->lock);
+    for (size_t i = 0; i < fat_ctx->max_files; i++) {
+        _lock_close(&fat_ctx->file_locks[i]);
+    }
+    free(fat_ctx->file_locks);
     free(fat_ctx->flags);
     free(fat_ctx);
     s_fat_ctxs[ctx] = NULL;
@@ -501,98 +516,56 @@ static ssize_t vfs_fat_read(void* ctx, int fd, void * dst, size_t size)
 
 static ssize_t vfs_fat_pread(void *ctx, int fd, void *dst, size_t size, off_t offset)
 {
-    ssize_t ret = -1;
     vfs_fat_ctx_t *fat_ctx = (vfs_fat_ctx_t *) ctx;
-    _lock_acquire(&fat_ctx->lock);
     FIL *file = &fat_ctx->files[fd];
-    const off_t prev_pos = f_tell(file);
-
-    FRESULT f_res = f_lseek(file, offset);
-
-    if (f_res != FR_OK) {
-        ESP_LOGD(TAG, "%s: fresult=%d", __func__, f_res);
-        errno = fresult_to_errno(f_res);
-        goto pread_release;
-    }
-
     unsigned read = 0;
-    f_res = f_read(file, dst, size, &read);
-    if (f_res == FR_OK) {
-        ret = read;
-    } else {
-        ESP_LOGD(TAG, "%s: fresult=%d", __func__, f_res);
-        errno = fresult_to_errno(f_res);
-        // No return yet - need to restore previous position
-    }
-
-    f_res = f_lseek(file, prev_pos);
+    // f_pread doesn't move the file pointer, so the context lock isn't needed. It only updates the file under
+    // the FatFs volume lock, but unlocks the volume while it reads whole sectors, letting other tasks access
+    // other files. The file lock keeps the file from being closed or truncated in the meantime.
+    _lock_acquire(&fat_ctx->file_locks[fd]);
+    FRESULT f_res = f_pread(file, dst, size, offset, &read);
+    _lock_release(&fat_ctx->file_locks[fd]);
     if (f_res != FR_OK) {
         ESP_LOGD(TAG, "%s: fresult=%d", __func__, f_res);
-        if (ret >= 0) {
-            errno = fresult_to_errno(f_res);
-        } // else f_read failed so errno shouldn't be overwritten
-        ret = -1; // in case the read was successful but the seek wasn't
+        errno = fresult_to_errno(f_res);
+        return -1;
     }
-
-pread_release:
-    _lock_release(&fat_ctx->lock);
-    return ret;
+    return read;
 }
 
 static ssize_t vfs_fat_pwrite(void *ctx, int fd, const void *src, size_t size, off_t offset)
 {
-    ssize_t ret = -1;
     vfs_fat_ctx_t *fat_ctx = (vfs_fat_ctx_t *) ctx;
-    _lock_acquire(&fat_ctx->lock);
     FIL *file = &fat_ctx->files[fd];
-    const off_t prev_pos = f_tell(file);
-
-    FRESULT f_res = f_lseek(file, offset);
-
-    if (f_res != FR_OK) {
-        ESP_LOGD(TAG, "%s: fresult=%d", __func__, f_res);
-        errno = fresult_to_errno(f_res);
-        goto pwrite_release;
-    }
-
     unsigned wr = 0;
-    f_res = f_write(file, src, size, &wr);
-    if (((wr == 0) && (size != 0)) && (f_res == 0)) {
+    // as in vfs_fat_pread, the volume is unlocked while whole sectors are written
+    _lock_acquire(&fat_ctx->file_locks[fd]);
+    FRESULT f_res = f_pwrite(file, src, size, offset, &wr);
+    if (((wr == 0) && (size != 0)) && (f_res == FR_OK)) {
+        _lock_release(&fat_ctx->file_locks[fd]);
         errno = ENOSPC;
         return -1;
     }
-    if (f_res == FR_OK) {
-        ret = wr;
-    } else {
-        ESP_LOGD(TAG, "%s: fresult=%d", __func__, f_res);
-        errno = fresult_to_errno(f_res);
-        // No return yet - need to restore previous position
-    }
-
-    f_res = f_lseek(file, prev_pos);
     if (f_res != FR_OK) {
+        _lock_release(&fat_ctx->file_locks[fd]);
         ESP_LOGD(TAG, "%s: fresult=%d", __func__, f_res);
-        if (ret >= 0) {
-            errno = fresult_to_errno(f_res);
-        } // else f_write failed so errno shouldn't be overwritten
-        ret = -1; // in case the write was successful but the seek wasn't
+        errno = fresult_to_errno(f_res);
+        return -1;
     }
 
 #if CONFIG_FATFS_IMMEDIATE_FSYNC
     if (wr > 0) {
-        FRESULT f_res2 = f_sync(file); // We need new result to check whether we can overwrite errno
-        if (f_res2 != FR_OK) {
-            ESP_LOGD(TAG, "%s: fresult=%d", __func__, f_res2);
-            if (f_res == FR_OK)
-                errno = fresult_to_errno(f_res2);
-            ret = -1;
+        f_res = f_sync(file);
+        if (f_res != FR_OK) {
+            _lock_release(&fat_ctx->file_locks[fd]);
+            ESP_LOGD(TAG, "%s: fresult=%d", __func__, f_res);
+            errno = fresult_to_errno(f_res);
+            return -1;
         }
     }
 #endif
-
-pwrite_release:
-    _lock_release(&fat_ctx->lock);
-    return ret;
+    _lock_release(&fat_ctx->file_locks[fd]);
+    return wr;
 }
 
 static int vfs_fat_fsync(void* ctx, int fd)
@@ -613,6 +586,7 @@ static int vfs_fat_close(void* ctx, int fd)
 {
     vfs_fat_ctx_t* fat_ctx = (vfs_fat_ctx_t*) ctx;
     _lock_acquire(&fat_ctx->lock);
+    _lock_acquire(&fat_ctx->file_locks[fd]);
     FIL* file = &fat_ctx->files[fd];
 
 #ifdef CONFIG_FATFS_USE_FASTSEEK
@@ -622,6 +596,7 @@ static int vfs_fat_close(void* ctx, int fd)
 
     FRESULT res = f_close(file);
     file_cleanup(fat_ctx, fd);
+    _lock_release(&fat_ctx->file_locks[fd]);
     _lock_release(&fat_ctx->lock);
     int rc = 0;
     if (res != FR_OK) {
@@ -1263,6 +1238,7 @@ static int vfs_fat_ftruncate(void* ctx, int fd, off_t length)
     }
 
     _lock_acquire(&fat_ctx->lock);
+    _lock_acquire(&fat_ctx->file_locks[fd]);
     file = &fat_ctx->files[fd];
     if (file == NULL) {
         ESP_LOGD(TAG, "ftruncate NULL file pointer");
@@ -1327,6 +1303,7 @@ static int vfs_fat_ftruncate(void* ctx, int fd, off_t length)
 #endif
 
 out:
+    _lock_release(&fat_ctx->file_locks[fd]);
     _lock_release(&fat_ctx->lock);
     return ret;
 
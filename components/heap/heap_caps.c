@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2015-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2015-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -276,6 +276,7 @@ size_t heap_caps_get_total_size(uint32_t caps)
 
 size_t heap_caps_get_free_size( uint32_t caps )
 {
+    heap_caps_cache_flush();
     size_t ret = 0;
     heap_t *heap;
     SLIST_FOREACH(heap, &registered_heaps, next) {
@@ -366,6 +367,7 @@ esp_err_t heap_caps_monitor_local_minimum_free_size_stop(void)
 
 void heap_caps_get_info( multi_heap_info_t *info, uint32_t caps )
 {
+    heap_caps_cache_flush();
     memset(info, 0, sizeof(multi_heap_info_t));
 
     heap_t *heap;
@@ -391,6 +393,7 @@ void heap_caps_get_info( multi_heap_info_t *info, uint32_t caps )
 void heap_caps_print_heap_info( uint32_t caps )
 {
     multi_heap_info_t info;
+    heap_caps_cache_flush();
     printf("Heap summary for capabilities 0x%08"PRIX32":\n", caps);
     heap_t *heap;
     SLIST_FOREACH(heap, &registered_heaps, next) {
@@ -442,6 +445,7 @@ bool heap_caps_check_integrity_addr(intptr_t addr, bool print_errors)
 
 void heap_caps_dump(uint32_t caps)
 {
+    heap_caps_cache_flush();
     bool all_heaps = caps & MALLOC_CAP_INVALID;
     heap_t *heap;
     SLIST_FOREACH(heap, &registered_heaps, next) {
@@ -457,6 +461,13 @@ void heap_caps_dump_all(void)
     heap_caps_dump(MALLOC_CAP_INVALID);
 }
 
+void heap_caps_cache_flush(void)
+{
+#if CONFIG_HEAP_PER_CORE_CACHE
+    heap_caps_cache_release();
+#endif
+}
+
 size_t heap_caps_get_allocated_size( void *ptr )
 {
     // add the block owner bytes back to ptr before handing over
@@ -587,6 +598,7 @@ __attribute__((noinline)) static bool heap_caps_walker(void* block_ptr, size_t b
 void heap_caps_walk(uint32_t caps, heap_caps_walker_cb_t walker_func, void *user_data)
 {
     assert(walker_func != NULL);
+    heap_caps_cache_flush();
 
     bool all_heaps = caps & MALLOC_CAP_INVALID;
     heap_t *heap;
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2015-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2015-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -72,7 +72,16 @@ HEAP_IRAM_ATTR void heap_caps_free( void *ptr)
     void *block_owner_ptr = MULTI_HEAP_REMOVE_BLOCK_OWNER_OFFSET(ptr);
     heap_t *heap = find_containing_heap(block_owner_ptr);
     assert(heap != NULL && "free() target pointer is outside heap areas");
+#if CONFIG_HEAP_TASK_TRACKING
+    heap_caps_task_stats_free(heap->heap, block_owner_ptr);
+#endif
+#if CONFIG_HEAP_PER_CORE_CACHE
+    if (!heap_caps_cache_free(heap, block_owner_ptr)) {
+        multi_heap_free(heap->heap, block_owner_ptr);
+    }
+#else
     multi_heap_free(heap->heap, block_owner_ptr);
+#endif
 
     CALL_HOOK(esp_heap_trace_free_hook, ptr);
 }
@@ -123,6 +132,10 @@ HEAP_IRAM_ATTR NOINLINE_ATTR void *heap_caps_aligned_alloc_base(size_t alignment
         size = (size + 3) & (~3); // int overflow checked above
     }
 
+#if CONFIG_HEAP_PER_CORE_CACHE
+    bool cache_released = false;
+retry:
+#endif
     for (int prio = 0; prio < SOC_MEMORY_TYPE_NO_PRIOS; prio++) {
         //Iterate over heaps and check capabilities at this priority
         heap_t *heap;
@@ -146,6 +159,9 @@ HEAP_IRAM_ATTR NOINLINE_ATTR void *heap_caps_aligned_alloc_base(size_t alignment
                                                         alignment, MULTI_HEAP_BLOCK_OWNER_SIZE());  // int overflow checked above
                         if (ret != NULL) {
                             MULTI_HEAP_SET_BLOCK_OWNER(ret);
+#if CONFIG_HEAP_TASK_TRACKING
+                            heap_caps_task_stats_alloc(heap->heap, ret);
+#endif
                             ret = MULTI_HEAP_ADD_BLOCK_OWNER_OFFSET(ret);
                             uint32_t *iptr = dram_alloc_to_iram_addr(ret, size + 4);  // int overflow checked above
                             CALL_HOOK(esp_heap_trace_alloc_hook, iptr, size, caps);
@@ -157,6 +173,9 @@ HEAP_IRAM_ATTR NOINLINE_ATTR void *heap_caps_aligned_alloc_base(size_t alignment
                                                         alignment, MULTI_HEAP_BLOCK_OWNER_SIZE());
                         if (ret != NULL) {
                             MULTI_HEAP_SET_BLOCK_OWNER(ret);
+#if CONFIG_HEAP_TASK_TRACKING
+                            heap_caps_task_stats_alloc(heap->heap, ret);
+#endif
                             ret = MULTI_HEAP_ADD_BLOCK_OWNER_OFFSET(ret);
                             CALL_HOOK(esp_heap_trace_alloc_hook, ret, size, caps);
                             return ret;
@@ -167,12 +186,31 @@ HEAP_IRAM_ATTR NOINLINE_ATTR void *heap_caps_aligned_alloc_base(size_t alignment
         }
     }
 
+#if CONFIG_HEAP_PER_CORE_CACHE
+    //The memory may be held by the per-core caches, return it to the heaps and try again.
+    if (!cache_released) {
+        cache_released = true;
+        if (heap_caps_cache_release() > 0) {
+            goto retry;
+        }
+    }
+#endif
+
     //Nothing usable found.
     return NULL;
 }
 
 //Wrapper for heap_caps_aligned_alloc_base as that can also do unaligned allocs.
 HEAP_IRAM_ATTR NOINLINE_ATTR void *heap_caps_malloc_base( size_t size, uint32_t caps) {
+#if CONFIG_HEAP_PER_CORE_CACHE
+    void *ret = heap_caps_cache_alloc(size, caps);
+    if (ret != NULL) {
+        MULTI_HEAP_SET_BLOCK_OWNER(ret);
+        ret = MULTI_HEAP_ADD_BLOCK_OWNER_OFFSET(ret);
+        CALL_HOOK(esp_heap_trace_alloc_hook, ret, size, caps);
+        return ret;
+    }
+#endif
     return heap_caps_aligned_alloc_base(UNALIGNED_MEM_ALIGNMENT_BYTES, size, caps);
 }
 
@@ -240,13 +278,23 @@ HEAP_IRAM_ATTR NOINLINE_ATTR void *heap_caps_realloc_base( void *ptr, size_t siz
     if (compatible_caps && !ptr_in_diram_case && alignment<=UNALIGNED_MEM_ALIGNMENT_BYTES) {
         // try to reallocate this memory within the same heap
         // (which will resize the block if it can)
+#if CONFIG_HEAP_TASK_TRACKING
+        // the block may change its size and owner
+        heap_caps_task_stats_free(heap->heap, ptr);
+#endif
         void *r = multi_heap_realloc(heap->heap, ptr, MULTI_HEAP_ADD_BLOCK_OWNER_SIZE(size));
         if (r != NULL) {
             MULTI_HEAP_SET_BLOCK_OWNER(r);
+#if CONFIG_HEAP_TASK_TRACKING
+            heap_caps_task_stats_alloc(heap->heap, r);
+#endif
             r = MULTI_HEAP_ADD_BLOCK_OWNER_OFFSET(r);
             CALL_HOOK(esp_heap_trace_alloc_hook, r, size, caps);
             return r;
         }
+#if CONFIG_HEAP_TASK_TRACKING
+        heap_caps_task_stats_alloc(heap->heap, ptr);
+#endif
     }
 
     // if we couldn't do that, try to see if we can reallocate
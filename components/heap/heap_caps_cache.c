@@ -0,0 +1,104 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdbool.h>
+#include <stddef.h>
+#include <assert.h>
+#include "esp_attr.h"
+#include "esp_cpu.h"
+#include "esp_heap_caps.h"
+#include "multi_heap.h"
+#include "heap_private.h"
+#include "sdkconfig.h"
+
+/*
+This file implements per-core caches of small free blocks in front of the heaps (CONFIG_HEAP_PER_CORE_CACHE).
+
+Each core has an array of size classes, each class is a stack of up to CONFIG_HEAP_PER_CORE_CACHE_DEPTH blocks
+with the usable size in the range [class * CACHE_GRANULE, (class + 1) * CACHE_GRANULE). A freed small block is
+pushed to the cache of the current core instead of being returned to its heap, and an allocation of a matching
+size pops it again. This avoids both the search through the registered heaps and taking the heap lock, which is
+shared by all cores.
+
+Only blocks of the heaps having all of CACHE_CAPS are cached, and only allocations asking for a subset of
+CACHE_CAPS are served from the caches, so any cached block can be returned for any such allocation.
+
+Each cache has its own lock, as a task can be preempted and moved to the other core between reading the core ID
+and using the cache, and heap_caps_cache_release() empties the caches of all cores. The locks are taken by one
+core almost always, so they do not contend. The lock of a cache is taken before the lock of a heap, never after.
+*/
+
+#define CACHE_CAPS (MALLOC_CAP_8BIT | MALLOC_CAP_32BIT | MALLOC_CAP_INTERNAL | MALLOC_CAP_DEFAULT)
+#define CACHE_GRANULE 8
+#define CACHE_CLASSES (CONFIG_HEAP_PER_CORE_CACHE_MAX_SIZE / CACHE_GRANULE)
+#define CACHE_DEPTH CONFIG_HEAP_PER_CORE_CACHE_DEPTH
+
+typedef struct {
+    multi_heap_lock_t lock;
+    uint8_t count[CACHE_CLASSES];
+    void *blocks[CACHE_CLASSES][CACHE_DEPTH];
+} heap_cache_t;
+
+static heap_cache_t s_caches[CONFIG_FREERTOS_NUMBER_OF_CORES] = {
+    [0 ... (CONFIG_FREERTOS_NUMBER_OF_CORES - 1)] = {
+        .lock = MULTI_HEAP_LOCK_STATIC_INITIALIZER,
+    }
+};
+
+HEAP_IRAM_ATTR void *heap_caps_cache_alloc(size_t size, uint32_t caps)
+{
+    size_t class = (size + CACHE_GRANULE - 1) / CACHE_GRANULE;
+    if (class == 0 || class > CACHE_CLASSES || (caps & ~CACHE_CAPS) != 0) {
+        return NULL;
+    }
+    heap_cache_t *cache = &s_caches[esp_cpu_get_core_id()];
+    void *block = NULL;
+    MULTI_HEAP_LOCK(&cache->lock);
+    if (cache->count[class - 1] > 0) {
+        block = cache->blocks[class - 1][--cache->count[class - 1]];
+    }
+    MULTI_HEAP_UNLOCK(&cache->lock);
+    return block;
+}
+
+HEAP_IRAM_ATTR bool heap_caps_cache_free(heap_t *heap, void *block)
+{
+    if ((get_all_caps(heap) & CACHE_CAPS) != CACHE_CAPS) {
+        return false;
+    }
+    size_t class = multi_heap_get_allocated_size(heap->heap, block) / CACHE_GRANULE;
+    if (class == 0 || class > CACHE_CLASSES) {
+        return false;
+    }
+    heap_cache_t *cache = &s_caches[esp_cpu_get_core_id()];
+    bool cached = false;
+    MULTI_HEAP_LOCK(&cache->lock);
+    if (cache->count[class - 1] < CACHE_DEPTH) {
+        cache->blocks[class - 1][cache->count[class - 1]++] = block;
+        cached = true;
+    }
+    MULTI_HEAP_UNLOCK(&cache->lock);
+    return cached;
+}
+
+HEAP_IRAM_ATTR size_t heap_caps_cache_release(void)
+{
+    size_t released = 0;
+    for (int core = 0; core < CONFIG_FREERTOS_NUMBER_OF_CORES; core++) {
+        heap_cache_t *cache = &s_caches[core];
+        MULTI_HEAP_LOCK(&cache->lock);
+        for (int class = 0; class < CACHE_CLASSES; class++) {
+            while (cache->count[class] > 0) {
+                void *block = cache->blocks[class][--cache->count[class]];
+                heap_t *heap = find_containing_heap(block);
+                assert(heap != NULL);
+                multi_heap_free(heap->heap, block);
+                released++;
+            }
+        }
+        MULTI_HEAP_UNLOCK(&cache->lock);
+    }
+    return released;
+}
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2015-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2015-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -168,6 +168,7 @@ void heap_caps_init(void)
     assert(SLIST_EMPTY(&registered_heaps));
 
     heap_t *heaps_array = NULL;
+    size_t heaps_array_heap = 0;
     for (size_t i = 0; i < num_heaps; i++) {
         if (heap_caps_match(&temp_heaps[i], MALLOC_CAP_8BIT|MALLOC_CAP_INTERNAL)) {
             /* use the first DRAM heap which can fit the data.
@@ -176,12 +177,18 @@ void heap_caps_init(void)
              * after successful allocation. Allocate extra 4 bytes for that purpose. */
             heaps_array = multi_heap_malloc(temp_heaps[i].heap, MULTI_HEAP_ADD_BLOCK_OWNER_SIZE(sizeof(heap_t) * num_heaps));
             if (heaps_array != NULL) {
+                heaps_array_heap = i;
                 break;
             }
         }
     }
     assert(heaps_array != NULL); /* if NULL, there's not enough free startup heap space */
     MULTI_HEAP_SET_BLOCK_OWNER(heaps_array);
+#if CONFIG_HEAP_TASK_TRACKING
+    heap_caps_task_stats_alloc(temp_heaps[heaps_array_heap].heap, heaps_array);
+#else
+    (void) heaps_array_heap;
+#endif
     heaps_array = (heap_t *)MULTI_HEAP_ADD_BLOCK_OWNER_OFFSET(heaps_array);
 
     memcpy(heaps_array, temp_heaps, sizeof(heap_t)*num_heaps);
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2015-2022 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2015-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -200,6 +200,11 @@ size_t heap_caps_get_allocated_size( void *ptr )
     return 0;
 }
 
+void heap_caps_cache_flush(void)
+{
+    // No per-core caches on linux
+}
+
 void *heap_caps_aligned_alloc(size_t alignment, size_t size, uint32_t caps)
 {
     void *ptr = aligned_alloc(alignment, size);
@@ -0,0 +1,259 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <stdatomic.h>
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+#include "esp_heap_caps_pool.h"
+#include "multi_heap_platform.h"
+#include "sdkconfig.h"
+
+/*
+This file implements pools of fixed-size objects. The objects of a pool are allocated in one block with the
+requested capabilities, and the free objects form a singly linked list through their first word.
+
+With CONFIG_HEAP_POOL_LOCK_FREE, the list is a lock-free stack. Its head holds the index of the first free object
+in the lower 16 bits and a counter in the upper 16 bits, which is incremented by each change of the head. Popping
+an object whose link was changed meanwhile (it was allocated and freed again) then fails the compare-and-swap even
+if the same object is at the head again. Otherwise, the list is protected by a spinlock.
+*/
+
+#define POOL_ALIGNMENT sizeof(void *)
+
+#if CONFIG_HEAP_POOL_LOCK_FREE
+#define POOL_INDEX_BITS 16
+#define POOL_INDEX_NONE ((1 << POOL_INDEX_BITS) - 1)
+#define POOL_INDEX_MASK ((uint32_t) POOL_INDEX_NONE)
+#define POOL_MAX_COUNT (POOL_INDEX_NONE)
+#else
+#define POOL_MAX_COUNT (SIZE_MAX)
+#endif
+
+struct heap_caps_pool {
+    uint8_t *objects;
+    size_t obj_size;
+    size_t count;
+#if CONFIG_HEAP_POOL_LOCK_FREE
+    _Atomic uint32_t head;          // counter << POOL_INDEX_BITS | index of the first free object
+    atomic_size_t free_count;
+    atomic_size_t min_free_count;
+#else
+    multi_heap_lock_t lock;
+    void *head;                     // first free object
+    size_t free_count;
+    size_t min_free_count;
+#endif
+};
+
+heap_caps_pool_handle_t heap_caps_pool_create(size_t obj_size, size_t count, uint32_t caps)
+{
+    if (obj_size == 0 || count == 0 || count > POOL_MAX_COUNT) {
+        return NULL;
+    }
+    obj_size = (obj_size + POOL_ALIGNMENT - 1) & ~(POOL_ALIGNMENT - 1);
+    size_t objects_size;
+    if (__builtin_mul_overflow(obj_size, count, &objects_size)
+            || objects_size > SIZE_MAX - sizeof(struct heap_caps_pool)) {
+        return NULL;
+    }
+    heap_caps_pool_handle_t pool = heap_caps_malloc(sizeof(struct heap_caps_pool) + objects_size, caps);
+    if (pool == NULL) {
+        return NULL;
+    }
+    pool->objects = (uint8_t *)(pool + 1);
+    pool->obj_size = obj_size;
+    pool->count = count;
+
+    // link the objects in the order of their addresses
+#if CONFIG_HEAP_POOL_LOCK_FREE
+    for (size_t i = 0; i < count; i++) {
+        *(uint32_t *)(pool->objects + i * obj_size) = (i + 1 < count) ? i + 1 : POOL_INDEX_NONE;
+    }
+    atomic_init(&pool->head, 0);
+    atomic_init(&pool->free_count, count);
+    atomic_init(&pool->min_free_count, count);
+#else
+    for (size_t i = 0; i < count; i++) {
+        *(void **)(pool->objects + i * obj_size) = (i + 1 < count) ? pool->objects + (i + 1) * obj_size : NULL;
+    }
+    MULTI_HEAP_LOCK_INIT(&pool->lock);
+    pool->head = pool->objects;
+    pool->free_count = count;
+    pool->min_free_count = count;
+#endif
+    return pool;
+}
+
+void heap_caps_pool_delete(heap_caps_pool_handle_t pool)
+{
+    heap_caps_free(pool);
+}
+
+#if CONFIG_HEAP_POOL_LOCK_FREE
+
+HEAP_IRAM_ATTR void *heap_caps_pool_alloc(heap_caps_pool_handle_t pool)
+{
+    uint32_t head = atomic_load_explicit(&pool->head, memory_order_acquire);
+    uint32_t index;
+    uint32_t new_head;
+    do {
+        index = head & POOL_INDEX_MASK;
+        if (index == POOL_INDEX_NONE) {
+            return NULL;
+        }
+        // The object may be allocated by another core meanwhile and its link overwritten,
+        // but then the head has changed too and the exchange below fails.
+        uint32_t next = *(volatile uint32_t *)(pool->objects + index * pool->obj_size);
+        new_head = ((head + (1 << POOL_INDEX_BITS)) & ~POOL_INDEX_MASK) | (next & POOL_INDEX_MASK);
+    } while (!atomic_compare_exchange_weak_explicit(&pool->head, &head, new_head,
+                                                    memory_order_acquire, memory_order_acquire));
+
+    size_t free_count = atomic_fetch_sub_explicit(&pool->free_count, 1, memory_order_relaxed) - 1;
+    size_t min_free_count = atomic_load_explicit(&pool->min_free_count, memory_order_relaxed);
+    while (free_count < min_free_count
+            && !atomic_compare_exchange_weak_explicit(&pool->min_free_count, &min_free_count, free_count,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+    }
+    return pool->objects + index * pool->obj_size;
+}
+
+HEAP_IRAM_ATTR void heap_caps_pool_free(heap_caps_pool_handle_t pool, void *ptr)
+{
+    if (ptr == NULL) {
+        return;
+    }
+    size_t offset = (uint8_t *)ptr - pool->objects;
+    assert(offset < pool->count * pool->obj_size && offset % pool->obj_size == 0 && "pointer is not from the pool");
+    uint32_t index = offset / pool->obj_size;
+
+    atomic_fetch_add_explicit(&pool->free_count, 1, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&pool->head, memory_order_relaxed);
+    uint32_t new_head;
+    do {
+        *(volatile uint32_t *)ptr = head & POOL_INDEX_MASK;
+        new_head = ((head + (1 << POOL_INDEX_BITS)) & ~POOL_INDEX_MASK) | index;
+    } while (!atomic_compare_exchange_weak_explicit(&pool->head, &head, new_head,
+                                                    memory_order_release, memory_order_relaxed));
+}
+
+static void *pool_first_free(heap_caps_pool_handle_t pool)
+{
+    uint32_t index = atomic_load_explicit(&pool->head, memory_order_acquire) & POOL_INDEX_MASK;
+    return (index == POOL_INDEX_NONE) ? NULL : pool->objects + index * pool->obj_size;
+}
+
+static void *pool_next_free(heap_caps_pool_handle_t pool, void *obj)
+{
+    uint32_t index = *(volatile uint32_t *)obj & POOL_INDEX_MASK;
+    return (index >= pool->count) ? NULL : pool->objects + index * pool->obj_size;
+}
+
+#define POOL_LOCK(pool)
+#define POOL_UNLOCK(pool)
+
+#else // CONFIG_HEAP_POOL_LOCK_FREE
+
+HEAP_IRAM_ATTR void *heap_caps_pool_alloc(heap_caps_pool_handle_t pool)
+{
+    MULTI_HEAP_LOCK(&pool->lock);
+    void *obj = pool->head;
+    if (obj != NULL) {
+        pool->head = *(void **)obj;
+        pool->free_count--;
+        if (pool->free_count < pool->min_free_count) {
+            pool->min_free_count = pool->free_count;
+        }
+    }
+    MULTI_HEAP_UNLOCK(&pool->lock);
+    return obj;
+}
+
+HEAP_IRAM_ATTR void heap_caps_pool_free(heap_caps_pool_handle_t pool, void *ptr)
+{
+    if (ptr == NULL) {
+        return;
+    }
+    size_t offset = (uint8_t *)ptr - pool->objects;
+    assert(offset < pool->count * pool->obj_size && offset % pool->obj_size == 0 && "pointer is not from the pool");
+    (void) offset;
+
+    MULTI_HEAP_LOCK(&pool->lock);
+    *(void **)ptr = pool->head;
+    pool->head = ptr;
+    pool->free_count++;
+    MULTI_HEAP_UNLOCK(&pool->lock);
+}
+
+static void *pool_first_free(heap_caps_pool_handle_t pool)
+{
+    return pool->head;
+}
+
+static void *pool_next_free(heap_caps_pool_handle_t pool, void *obj)
+{
+    return *(void **)obj;
+}
+
+#define POOL_LOCK(pool) MULTI_HEAP_LOCK(&(pool)->lock)
+#define POOL_UNLOCK(pool) MULTI_HEAP_UNLOCK(&(pool)->lock)
+
+#endif // CONFIG_HEAP_POOL_LOCK_FREE
+
+void heap_caps_pool_get_info(heap_caps_pool_handle_t pool, multi_heap_info_t *info)
+{
+    memset(info, 0, sizeof(multi_heap_info_t));
+    POOL_LOCK(pool);
+    size_t free_count = pool->free_count;
+    size_t min_free_count = pool->min_free_count;
+    POOL_UNLOCK(pool);
+
+    info->total_free_bytes = free_count * pool->obj_size;
+    info->total_allocated_bytes = (pool->count - free_count) * pool->obj_size;
+    info->largest_free_block = free_count ? pool->obj_size : 0;
+    info->minimum_free_bytes = min_free_count * pool->obj_size;
+    info->allocated_blocks = pool->count - free_count;
+    info->free_blocks = free_count;
+    info->total_blocks = pool->count;
+}
+
+void heap_caps_pool_walk(heap_caps_pool_handle_t pool, heap_caps_walker_cb_t walker_func, void *user_data)
+{
+    assert(walker_func != NULL);
+
+    // mark the free objects first, so the callback is not called with the lock taken
+    uint32_t *free_map = heap_caps_calloc((pool->count + 31) / 32, sizeof(uint32_t), MALLOC_CAP_DEFAULT);
+    if (free_map == NULL) {
+        return;
+    }
+    POOL_LOCK(pool);
+    void *obj = pool_first_free(pool);
+    // the list can only be inconsistent if it is being changed in the lock-free mode
+    for (size_t n = 0; obj != NULL && n < pool->count; n++) {
+        size_t index = ((uint8_t *)obj - pool->objects) / pool->obj_size;
+        free_map[index / 32] |= 1u << (index % 32);
+        obj = pool_next_free(pool, obj);
+    }
+    POOL_UNLOCK(pool);
+
+    walker_heap_into_t heap_info = {
+        (intptr_t)pool->objects,
+        (intptr_t)(pool->objects + pool->count * pool->obj_size)
+    };
+    for (size_t i = 0; i < pool->count; i++) {
+        walker_block_info_t block_info = {
+            pool->objects + i * pool->obj_size,
+            pool->obj_size,
+            !(free_map[i / 32] & (1u << (i % 32)))
+        };
+        if (!walker_func(heap_info, block_info, user_data)) {
+            break;
+        }
+    }
+    heap_caps_free(free_map);
+}
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2015-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2015-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -12,6 +12,7 @@
 #include "multi_heap_platform.h"
 #include "sys/queue.h"
 #include "esp_attr.h"
+#include "sdkconfig.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -87,6 +88,29 @@ void *heap_caps_calloc_base(size_t n, size_t size, uint32_t caps);
 void *heap_caps_malloc_base(size_t size, uint32_t caps);
 void *heap_caps_aligned_alloc_base(size_t alignment, size_t size, uint32_t caps);
 
+#if CONFIG_HEAP_PER_CORE_CACHE
+/* Per-core caches of small free blocks, see heap_caps_cache.c */
+
+/* Returns a cached block for the allocation, or NULL if there is none */
+void *heap_caps_cache_alloc(size_t size, uint32_t caps);
+
+/* Keeps the block of the heap in the cache, returns false if it has to be freed to the heap */
+bool heap_caps_cache_free(heap_t *heap, void *block);
+
+/* Frees all cached blocks to their heaps, returns the number of blocks */
+size_t heap_caps_cache_release(void);
+#endif
+
+#if CONFIG_HEAP_TASK_TRACKING
+/* Per-task totals, see heap_task_info.c. The block includes the block owner. */
+
+/* Adds the allocated block to the totals of its owner */
+void heap_caps_task_stats_alloc(multi_heap_handle_t heap, void *block);
+
+/* Subtracts the block from the totals of its owner, before it is freed */
+void heap_caps_task_stats_free(multi_heap_handle_t heap, void *block);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
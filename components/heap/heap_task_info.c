@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2018-2022 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2018-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -7,12 +7,146 @@
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 #include <multi_heap.h>
+#include "esp_heap_caps.h"
 #include "multi_heap_internal.h"
 #include "heap_private.h"
 #include "esp_heap_task_info.h"
 
 #ifdef CONFIG_HEAP_TASK_TRACKING
 
+/*
+ * Per-task totals maintained on each allocation and free, so they can be read
+ * without walking the heaps.
+ *
+ * The totals are kept in an open addressing hash table keyed by the task handle,
+ * with twice as many slots as CONFIG_HEAP_TASK_TRACKING_MAX_TASKS. A task stays in
+ * the table after it has freed all its blocks, until the table is full and the
+ * tasks without blocks are removed. The blocks of the tasks which do not fit, and
+ * the blocks allocated before the scheduler is started, are added to s_other_stats.
+ * A block of a task added to s_other_stats is tagged in its block owner, so it is
+ * subtracted from s_other_stats even if the task has been added to the table since.
+ */
+
+#define TASK_STATS_MAX_COUNT CONFIG_HEAP_TASK_TRACKING_MAX_TASKS
+#define TASK_STATS_SLOTS (2 * TASK_STATS_MAX_COUNT)
+
+_Static_assert((TASK_STATS_MAX_COUNT & (TASK_STATS_MAX_COUNT - 1)) == 0, "CONFIG_HEAP_TASK_TRACKING_MAX_TASKS must be a power of two");
+
+static multi_heap_lock_t s_task_stats_lock = MULTI_HEAP_LOCK_STATIC_INITIALIZER;
+static heap_task_stat_t s_task_stats[TASK_STATS_SLOTS];  // task is NULL if the slot is empty
+static heap_task_stat_t s_other_stats;
+static size_t s_task_stats_count;
+
+static inline HEAP_IRAM_ATTR size_t task_stats_hash(TaskHandle_t task)
+{
+    return (((uint32_t)(intptr_t)task * 2654435769u) >> 16) & (TASK_STATS_SLOTS - 1);
+}
+
+static HEAP_IRAM_ATTR void task_stats_remove(size_t i)
+{
+    // move the following tasks back, unless they are before their home slot then
+    for (size_t j = (i + 1) & (TASK_STATS_SLOTS - 1); s_task_stats[j].task != NULL; j = (j + 1) & (TASK_STATS_SLOTS - 1)) {
+        size_t k = task_stats_hash(s_task_stats[j].task);
+        bool stays = (i <= j) ? (i < k && k <= j) : (i < k || k <= j);
+        if (!stays) {
+            s_task_stats[i] = s_task_stats[j];
+            i = j;
+        }
+    }
+    s_task_stats[i].task = NULL;
+    s_task_stats_count--;
+}
+
+/* Remove the tasks without allocated blocks */
+static HEAP_IRAM_ATTR void task_stats_purge(void)
+{
+    for (size_t i = 0; i < TASK_STATS_SLOTS; i++) {
+        // removing a task can move the next one to this slot
+        while (s_task_stats[i].task != NULL && s_task_stats[i].count == 0) {
+            task_stats_remove(i);
+        }
+    }
+}
+
+static HEAP_IRAM_ATTR heap_task_stat_t *task_stats_find(TaskHandle_t task, bool add)
+{
+    if (task == NULL) {
+        return &s_other_stats;
+    }
+    size_t i = task_stats_hash(task);
+    while (s_task_stats[i].task != task) {
+        if (s_task_stats[i].task == NULL) {
+            if (!add) {
+                return &s_other_stats;
+            }
+            if (s_task_stats_count == TASK_STATS_MAX_COUNT) {
+                task_stats_purge();
+                if (s_task_stats_count == TASK_STATS_MAX_COUNT) {
+                    return &s_other_stats;
+                }
+                return task_stats_find(task, add);
+            }
+            s_task_stats[i] = (heap_task_stat_t) {
+                .task = task,
+            };
+            s_task_stats_count++;
+            break;
+        }
+        i = (i + 1) & (TASK_STATS_SLOTS - 1);
+    }
+    return &s_task_stats[i];
+}
+
+HEAP_IRAM_ATTR void heap_caps_task_stats_alloc(multi_heap_handle_t heap, void *block)
+{
+    TaskHandle_t task = MULTI_HEAP_GET_BLOCK_OWNER(block);
+    size_t size = multi_heap_get_allocated_size(heap, block);
+
+    MULTI_HEAP_LOCK(&s_task_stats_lock);
+    heap_task_stat_t *stats = task_stats_find(task, true);
+    if (stats == &s_other_stats && task != NULL) {
+        *(uintptr_t *)block |= MULTI_HEAP_BLOCK_OWNER_TAG;
+    } else {
+        *(uintptr_t *)block &= ~MULTI_HEAP_BLOCK_OWNER_TAG;
+    }
+    stats->size += size;
+    stats->count++;
+    if (stats->size > stats->peak_size) {
+        stats->peak_size = stats->size;
+    }
+    MULTI_HEAP_UNLOCK(&s_task_stats_lock);
+}
+
+HEAP_IRAM_ATTR void heap_caps_task_stats_free(multi_heap_handle_t heap, void *block)
+{
+    TaskHandle_t task = MULTI_HEAP_GET_BLOCK_OWNER(block);
+    size_t size = multi_heap_get_allocated_size(heap, block);
+
+    bool other = (*(uintptr_t *)block & MULTI_HEAP_BLOCK_OWNER_TAG) != 0;
+
+    MULTI_HEAP_LOCK(&s_task_stats_lock);
+    heap_task_stat_t *stats = other ? &s_other_stats : task_stats_find(task, false);
+    stats->size -= size;
+    stats->count--;
+    MULTI_HEAP_UNLOCK(&s_task_stats_lock);
+}
+
+size_t heap_caps_get_task_stats(heap_task_stat_t *stats, size_t max_stats)
+{
+    size_t count = 0;
+    MULTI_HEAP_LOCK(&s_task_stats_lock);
+    if (count < max_stats && s_other_stats.peak_size != 0) {
+        stats[count++] = s_other_stats;
+    }
+    for (size_t i = 0; i < TASK_STATS_SLOTS && count < max_stats; i++) {
+        if (s_task_stats[i].task != NULL) {
+            stats[count++] = s_task_stats[i];
+        }
+    }
+    MULTI_HEAP_UNLOCK(&s_task_stats_lock);
+    return count;
+}
+
 /*
  * Return per-task heap allocation totals and lists of blocks.
  *
@@ -0,0 +1,372 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <string.h>
+#include <sdkconfig.h>
+#include <inttypes.h>
+
+#define HEAP_TRACE_SRCFILE /* don't warn on inclusion here */
+#include "esp_heap_trace.h"
+#undef HEAP_TRACE_SRCFILE
+#include "esp_heap_caps.h"
+#include "esp_attr.h"
+#include "esp_cpu.h"
+#include "esp_random.h"
+#include "esp_rom_sys.h"
+#include "freertos/FreeRTOS.h"
+#include "esp_memory_utils.h"
+
+#define STACK_DEPTH CONFIG_HEAP_TRACING_STACK_DEPTH
+
+#if CONFIG_HEAP_TRACING_SAMPLING
+
+/*
+This file implements the sampling heap profiler (CONFIG_HEAP_TRACING_SAMPLING).
+
+The allocated bytes are sampled as a Poisson process: each core counts down the bytes until its next sample point,
+whose distance is drawn from an exponential distribution with the mean of the sample interval. The allocation
+crossing the sample point is sampled, so an allocation of size S is sampled with the probability
+1 - exp(-S / interval). Only the call stack of a sampled allocation is read, the others just decrease the counter.
+
+The sampled allocations are aggregated by their call stack in the callsite table. The addresses of the sampled
+allocations which are not freed yet are kept in the table of live samples, so their frees can be subtracted from
+the memory in use of their call stack. To avoid taking the lock on each free, a counter per slot of that table
+holds the number of live samples whose address hashes to the slot. It can be read without the lock, because the
+sample of an allocation is recorded before the allocation is returned, and so before it can be freed.
+*/
+
+#define CALLSITE_SLOTS CONFIG_HEAP_TRACE_SAMPLING_CALLSITES
+#define CALLSITE_MAX_COUNT (CALLSITE_SLOTS / 4 * 3)
+#define LIVE_MAX_COUNT CONFIG_HEAP_TRACE_SAMPLING_LIVE_SAMPLES
+#define LIVE_SLOTS (2 * LIVE_MAX_COUNT)
+
+_Static_assert((CALLSITE_SLOTS & (CALLSITE_SLOTS - 1)) == 0, "CONFIG_HEAP_TRACE_SAMPLING_CALLSITES must be a power of two");
+_Static_assert((LIVE_MAX_COUNT & (LIVE_MAX_COUNT - 1)) == 0, "CONFIG_HEAP_TRACE_SAMPLING_LIVE_SAMPLES must be a power of two");
+
+typedef struct {
+    heap_trace_callsite_t stats;    // unused if alloc_count is 0
+    uint32_t hash;
+} callsite_t;
+
+typedef struct {
+    void *address;                  // NULL if the slot is empty
+    uint32_t size;
+    uint16_t callsite;
+} live_sample_t;
+
+static portMUX_TYPE trace_mux = portMUX_INITIALIZER_UNLOCKED;
+static volatile bool s_sampling;
+static size_t s_sample_interval;
+
+// accessed by their own core only, without the lock
+static size_t s_bytes_until_sample[CONFIG_FREERTOS_NUMBER_OF_CORES];
+static uint32_t s_random_state[CONFIG_FREERTOS_NUMBER_OF_CORES];
+
+static callsite_t s_callsites[CALLSITE_SLOTS];
+static size_t s_callsite_count;
+static live_sample_t s_live[LIVE_SLOTS];
+static volatile uint16_t s_live_filter[LIVE_SLOTS];
+static size_t s_live_count;
+
+static size_t s_total_samples;
+static size_t s_dropped_samples;
+static size_t s_untracked_samples;
+
+/* Return the number of bytes until the next sample point, drawn from an exponential distribution */
+static HEAP_IRAM_ATTR size_t next_sample_distance(int core)
+{
+    // xorshift32, the state is never 0
+    uint32_t x = s_random_state[core];
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    s_random_state[core] = x;
+
+    // -log2(x / 2^32) in 16.16 fixed point, the fraction of the logarithm is approximated by
+    // log2(1 + f) ~= f * (1.3466 - 0.3466 * f), which is precise enough for sampling and avoids libm
+    int msb = 31 - __builtin_clz(x);
+    uint64_t f = ((x << (31 - msb)) >> 15) & 0xffff;
+    uint32_t log2_frac = (f * (88251 - ((22715 * f) >> 16))) >> 16;
+    uint32_t neg_log2 = (32 << 16) - ((msb << 16) + log2_frac);
+
+    // -ln(x / 2^32) * interval, with ln(2) = 45426 / 2^16
+    uint64_t distance = ((((uint64_t)neg_log2 * 45426) >> 16) * s_sample_interval) >> 16;
+    return distance ? distance : 1;
+}
+
+/* Decide whether an allocation is sampled. This is called for every allocation, so it does not take the lock. */
+static HEAP_IRAM_ATTR bool sample_allocation(size_t size)
+{
+    if (!s_sampling) {
+        return false;
+    }
+    int core = esp_cpu_get_core_id();
+    if (size < s_bytes_until_sample[core]) {
+        s_bytes_until_sample[core] -= size;
+        return false;
+    }
+    s_bytes_until_sample[core] = next_sample_distance(core);
+    return true;
+}
+
+static inline HEAP_IRAM_ATTR size_t live_hash(const void *p)
+{
+    return (((uint32_t)(intptr_t)p * 2654435769u) >> 16) & (LIVE_SLOTS - 1);
+}
+
+/* Check whether a freed block may be a live sample, this is called for every free */
+static HEAP_IRAM_ATTR bool sample_free(void *p)
+{
+    return s_sampling && p != NULL && s_live_filter[live_hash(p)] != 0;
+}
+
+#define TRACE_WANT_ALLOCATION(size) sample_allocation(size)
+#define TRACE_WANT_FREE(p) sample_free(p)
+
+static HEAP_IRAM_ATTR uint32_t callsite_hash(void * const *callers)
+{
+    uint32_t hash = 2166136261u;
+    for (int i = 0; i < STACK_DEPTH; i++) {
+        hash = (hash ^ (uint32_t)(intptr_t)callers[i]) * 16777619u;
+    }
+    return hash ^ (hash >> 16);
+}
+
+static HEAP_IRAM_ATTR bool callsite_equal(const callsite_t *callsite, void * const *callers)
+{
+    for (int i = 0; i < STACK_DEPTH; i++) {
+        if (callsite->stats.callers[i] != callers[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Return the index of the callsite of the call stack, adding it if needed, or -1 if the table is full */
+static HEAP_IRAM_ATTR int callsite_find_or_add(void * const *callers)
+{
+    uint32_t hash = callsite_hash(callers);
+    for (size_t i = hash & (CALLSITE_SLOTS - 1); ; i = (i + 1) & (CALLSITE_SLOTS - 1)) {
+        callsite_t *callsite = &s_callsites[i];
+        if (callsite->stats.alloc_count == 0) {
+            if (s_callsite_count == CALLSITE_MAX_COUNT) {
+                return -1;
+            }
+            s_callsite_count++;
+            callsite->hash = hash;
+            memcpy(callsite->stats.callers, callers, sizeof(void *) * STACK_DEPTH);
+            return i;
+        }
+        if (callsite->hash == hash && callsite_equal(callsite, callers)) {
+            return i;
+        }
+    }
+}
+
+static HEAP_IRAM_ATTR bool live_add(void *p, size_t size, int callsite)
+{
+    if (s_live_count == LIVE_MAX_COUNT) {
+        return false;
+    }
+    size_t home = live_hash(p);
+    size_t i = home;
+    while (s_live[i].address != NULL) {
+        i = (i + 1) & (LIVE_SLOTS - 1);
+    }
+    s_live[i] = (live_sample_t) {
+        .address = p,
+        .size = size,
+        .callsite = callsite,
+    };
+    s_live_filter[home]++;
+    s_live_count++;
+    return true;
+}
+
+static HEAP_IRAM_ATTR bool live_find_and_remove(void *p, live_sample_t *r_out)
+{
+    size_t home = live_hash(p);
+    size_t i = home;
+    while (s_live[i].address != p) {
+        if (s_live[i].address == NULL) {
+            return false;
+        }
+        i = (i + 1) & (LIVE_SLOTS - 1);
+    }
+    *r_out = s_live[i];
+    s_live_filter[home]--;
+    s_live_count--;
+
+    // move the following samples back, unless they are before their home slot then
+    for (size_t j = (i + 1) & (LIVE_SLOTS - 1); s_live[j].address != NULL; j = (j + 1) & (LIVE_SLOTS - 1)) {
+        size_t k = live_hash(s_live[j].address);
+        bool stays = (i <= j) ? (i < k && k <= j) : (i < k || k <= j);
+        if (!stays) {
+            s_live[i] = s_live[j];
+            i = j;
+        }
+    }
+    s_live[i].address = NULL;
+    return true;
+}
+
+esp_err_t heap_trace_sampling_start(size_t sample_interval)
+{
+    if (sample_interval == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    uint32_t seeds[CONFIG_FREERTOS_NUMBER_OF_CORES];
+    for (int core = 0; core < CONFIG_FREERTOS_NUMBER_OF_CORES; core++) {
+        seeds[core] = esp_random() | 1;
+    }
+
+    portENTER_CRITICAL(&trace_mux);
+    s_sampling = false;
+    s_sample_interval = sample_interval;
+    for (int core = 0; core < CONFIG_FREERTOS_NUMBER_OF_CORES; core++) {
+        s_random_state[core] = seeds[core];
+        s_bytes_until_sample[core] = next_sample_distance(core);
+    }
+    memset(s_callsites, 0, sizeof(s_callsites));
+    memset(s_live, 0, sizeof(s_live));
+    memset((void *)s_live_filter, 0, sizeof(s_live_filter));
+    s_callsite_count = 0;
+    s_live_count = 0;
+    s_total_samples = 0;
+    s_dropped_samples = 0;
+    s_untracked_samples = 0;
+    s_sampling = true;
+    portEXIT_CRITICAL(&trace_mux);
+    return ESP_OK;
+}
+
+esp_err_t heap_trace_sampling_stop(void)
+{
+    esp_err_t ret_val = ESP_ERR_INVALID_STATE;
+    portENTER_CRITICAL(&trace_mux);
+    if (s_sampling) {
+        s_sampling = false;
+        ret_val = ESP_OK;
+    }
+    portEXIT_CRITICAL(&trace_mux);
+    return ret_val;
+}
+
+size_t heap_trace_sampling_get_count(void)
+{
+    return s_callsite_count;
+}
+
+esp_err_t heap_trace_sampling_get(size_t index, heap_trace_callsite_t *callsite)
+{
+    if (callsite == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_err_t ret_val = ESP_ERR_INVALID_ARG;
+    portENTER_CRITICAL(&trace_mux);
+    for (size_t i = 0; i < CALLSITE_SLOTS; i++) {
+        if (s_callsites[i].stats.alloc_count != 0 && index-- == 0) {
+            *callsite = s_callsites[i].stats;
+            ret_val = ESP_OK;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&trace_mux);
+    return ret_val;
+}
+
+esp_err_t heap_trace_sampling_summary(heap_trace_sampling_summary_t *summary)
+{
+    if (summary == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    portENTER_CRITICAL(&trace_mux);
+    summary->sample_interval = s_sample_interval;
+    summary->total_samples = s_total_samples;
+    summary->dropped_samples = s_dropped_samples;
+    summary->untracked_samples = s_untracked_samples;
+    summary->callsite_count = s_callsite_count;
+    summary->callsite_capacity = CALLSITE_MAX_COUNT;
+    portEXIT_CRITICAL(&trace_mux);
+    return ESP_OK;
+}
+
+void heap_trace_sampling_dump(void)
+{
+    heap_trace_callsite_t total = { 0 };
+    portENTER_CRITICAL(&trace_mux);
+    for (size_t i = 0; i < CALLSITE_SLOTS; i++) {
+        total.inuse_count += s_callsites[i].stats.inuse_count;
+        total.inuse_bytes += s_callsites[i].stats.inuse_bytes;
+        total.alloc_count += s_callsites[i].stats.alloc_count;
+        total.alloc_bytes += s_callsites[i].stats.alloc_bytes;
+    }
+    size_t sample_interval = s_sample_interval;
+    portEXIT_CRITICAL(&trace_mux);
+
+    // the legacy heap profile format of gperftools, read by pprof which also scales the samples up
+    esp_rom_printf("heap profile: %d: %d [%d: %d] @ heap_v2/%d\n", total.inuse_count, total.inuse_bytes,
+                   total.alloc_count, total.alloc_bytes, sample_interval);
+    for (size_t i = 0; i < CALLSITE_SLOTS; i++) {
+        // print one callsite at a time, so the lock is not held while printing
+        portENTER_CRITICAL(&trace_mux);
+        heap_trace_callsite_t callsite = s_callsites[i].stats;
+        portEXIT_CRITICAL(&trace_mux);
+        if (callsite.alloc_count == 0) {
+            continue;
+        }
+        esp_rom_printf("%d: %d [%d: %d] @", callsite.inuse_count, callsite.inuse_bytes,
+                       callsite.alloc_count, callsite.alloc_bytes);
+        for (int j = 0; j < STACK_DEPTH && callsite.callers[j] != NULL; j++) {
+            esp_rom_printf(" 0x%08x", (uint32_t)(intptr_t)callsite.callers[j]);
+        }
+        esp_rom_printf("\n");
+    }
+}
+
+/* Add a sampled allocation to its callsite */
+static HEAP_IRAM_ATTR void record_allocation(const heap_trace_record_t *r_allocation)
+{
+    if (r_allocation->address == NULL) {
+        return;
+    }
+    portENTER_CRITICAL(&trace_mux);
+    if (s_sampling) {
+        s_total_samples++;
+        int index = callsite_find_or_add(r_allocation->alloced_by);
+        if (index < 0) {
+            s_dropped_samples++;
+        } else {
+            heap_trace_callsite_t *callsite = &s_callsites[index].stats;
+            callsite->alloc_count++;
+            callsite->alloc_bytes += r_allocation->size;
+            if (live_add(r_allocation->address, r_allocation->size, index)) {
+                callsite->inuse_count++;
+                callsite->inuse_bytes += r_allocation->size;
+            } else {
+                s_untracked_samples++;
+            }
+        }
+    }
+    portEXIT_CRITICAL(&trace_mux);
+}
+
+/* Subtract a freed live sample from the memory in use of its callsite */
+static HEAP_IRAM_ATTR void record_free(void *p, void **callers)
+{
+    (void)callers;
+    portENTER_CRITICAL(&trace_mux);
+    live_sample_t sample;
+    if (s_sampling && live_find_and_remove(p, &sample)) {
+        heap_trace_callsite_t *callsite = &s_callsites[sample.callsite].stats;
+        callsite->inuse_count--;
+        callsite->inuse_bytes -= sample.size;
+    }
+    portEXIT_CRITICAL(&trace_mux);
+}
+
+#include "heap_trace.inc"
+
+#endif // CONFIG_HEAP_TRACING_SAMPLING
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2019-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2019-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -447,6 +447,18 @@ void heap_caps_dump_all(void);
  */
 size_t heap_caps_get_allocated_size( void *ptr );
 
+/**
+ * @brief Return the blocks kept in the per-core caches to their heaps.
+ *
+ * With CONFIG_HEAP_PER_CORE_CACHE enabled, small freed blocks are kept in per-core caches for
+ * the next allocations. The functions reporting free heap memory (heap_caps_get_info,
+ * heap_caps_get_free_size, heap_caps_walk, ...) and failed allocations flush the caches already,
+ * this function can be used before other inspections of the heaps.
+ *
+ * Does nothing if CONFIG_HEAP_PER_CORE_CACHE is disabled.
+ */
+void heap_caps_cache_flush(void);
+
 /**
  * @brief Structure used to store heap related data passed to
  * the walker callback function
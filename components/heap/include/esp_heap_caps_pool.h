@@ -0,0 +1,93 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_heap_caps.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Handle of a pool of fixed-size objects
+ */
+typedef struct heap_caps_pool *heap_caps_pool_handle_t;
+
+/**
+ * @brief Create a pool of fixed-size objects
+ *
+ * The memory of all objects is allocated at once with the given capabilities. Objects are then allocated from
+ * and freed to the pool in constant time, without searching the heaps and without fragmenting them.
+ *
+ * With CONFIG_HEAP_POOL_LOCK_FREE, the list of free objects is lock-free, otherwise it is protected by a spinlock.
+ *
+ * @param obj_size Size of each object in bytes. It is rounded up to a multiple of the pointer size.
+ * @param count Number of objects in the pool. With CONFIG_HEAP_POOL_LOCK_FREE it can be 65535 at most.
+ * @param caps Bitwise OR of MALLOC_CAP_* flags indicating the type of memory to allocate the pool from
+ *
+ * @return Handle of the pool, or NULL if the arguments are invalid or there is not enough memory
+ */
+heap_caps_pool_handle_t heap_caps_pool_create(size_t obj_size, size_t count, uint32_t caps);
+
+/**
+ * @brief Delete a pool and free its memory
+ *
+ * The objects allocated from the pool must not be used after this call.
+ *
+ * @param pool Pool to delete, can be NULL
+ */
+void heap_caps_pool_delete(heap_caps_pool_handle_t pool);
+
+/**
+ * @brief Allocate an object from a pool
+ *
+ * The content of the object is not initialized. This function can be called from an ISR.
+ *
+ * @param pool Pool to allocate from
+ *
+ * @return Pointer to the object, or NULL if all objects of the pool are allocated
+ */
+void *heap_caps_pool_alloc(heap_caps_pool_handle_t pool);
+
+/**
+ * @brief Return an object to its pool
+ *
+ * This function can be called from an ISR.
+ *
+ * @param pool Pool the object was allocated from
+ * @param ptr Pointer returned by heap_caps_pool_alloc(), can be NULL
+ */
+void heap_caps_pool_free(heap_caps_pool_handle_t pool, void *ptr);
+
+/**
+ * @brief Get information about a pool
+ *
+ * The fields of the structure have the same meaning as for heap_caps_get_info(), with the objects being the blocks.
+ * The memory of the pool itself is reported by heap_caps_get_info() as a single allocated block.
+ *
+ * @param pool Pool to get the information about
+ * @param info Pointer to a structure which will be filled with the information
+ */
+void heap_caps_pool_get_info(heap_caps_pool_handle_t pool, multi_heap_info_t *info);
+
+/**
+ * @brief Walk through the objects of a pool
+ *
+ * The callback is called for each object of the pool, with the range of the pool objects as the heap
+ * information. The callback must not allocate from or free to the pool. If objects are allocated or freed
+ * by other tasks during the walk, the reported state of the objects may not be accurate.
+ *
+ * @param pool Pool to walk through
+ * @param walker_func Callback called for each object of the pool
+ * @param user_data Opaque pointer to user defined data
+ */
+void heap_caps_pool_walk(heap_caps_pool_handle_t pool, heap_caps_walker_cb_t walker_func, void *user_data);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2018-2022 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2018-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -74,6 +74,14 @@ typedef struct {
     size_t max_blocks;                ///< Capacity of array of task block info structs
 } heap_task_info_params_t;
 
+/** @brief Structure providing the current heap usage of a task */
+typedef struct {
+    TaskHandle_t task;                ///< Task which allocated the blocks
+    size_t size;                      ///< Total size of the blocks allocated by the task and not freed yet
+    size_t count;                     ///< Number of blocks allocated by the task and not freed yet
+    size_t peak_size;                 ///< Maximum of size since the task was added to the totals
+} heap_task_stat_t;
+
 /**
  * @brief Return per-task heap allocation totals and lists of blocks.
  *
@@ -89,6 +97,26 @@ typedef struct {
  */
 extern size_t heap_caps_get_per_task_info(heap_task_info_params_t *params);
 
+/**
+ * @brief Return the current heap usage of the tasks.
+ *
+ * The per-task totals are updated on each allocation and free, so unlike
+ * heap_caps_get_per_task_info() this function does not walk the heaps and
+ * its time only depends on the number of tasks. The totals include the blocks
+ * of all heaps, and the block sizes include the block owner like
+ * in heap_caps_get_per_task_info().
+ *
+ * Up to CONFIG_HEAP_TASK_TRACKING_MAX_TASKS tasks are tracked. A task is kept
+ * after it has freed all its blocks, until room is needed for another task.
+ * The blocks allocated before the scheduler is started, and the blocks of the
+ * tasks which are not tracked, are reported together with the task NULL.
+ *
+ * @param stats Array of structs where the usage of the tasks is returned
+ * @param max_stats Capacity of the stats array
+ * @return Number of structs returned in the stats array
+ */
+size_t heap_caps_get_task_stats(heap_task_stat_t *stats, size_t max_stats);
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2015-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2015-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -63,6 +63,29 @@ typedef struct {
 #endif
 } heap_trace_summary_t;
 
+/**
+ * @brief Allocations made from one call stack, as sampled by the sampling heap profiler.
+ */
+typedef struct {
+    void *callers[CONFIG_HEAP_TRACING_STACK_DEPTH]; ///< Call stack of the allocations
+    size_t alloc_count;              ///< Number of sampled allocations
+    size_t alloc_bytes;              ///< Total size of the sampled allocations
+    size_t inuse_count;              ///< Number of sampled allocations which are not freed yet
+    size_t inuse_bytes;              ///< Total size of the sampled allocations which are not freed yet
+} heap_trace_callsite_t;
+
+/**
+ * @brief Stores information about the state of the sampling heap profiler.
+ */
+typedef struct {
+    size_t sample_interval;          ///< Mean number of allocated bytes between two samples
+    size_t total_samples;            ///< The total number of sampled allocations
+    size_t dropped_samples;          ///< The number of samples lost because the callsite table was full
+    size_t untracked_samples;        ///< The number of samples whose free is not tracked because too many samples were live
+    size_t callsite_count;           ///< The number of call stacks in the callsite table
+    size_t callsite_capacity;        ///< The maximum number of call stacks in the callsite table
+} heap_trace_sampling_summary_t;
+
 /**
  * @brief Initialise heap tracing in standalone mode.
  *
@@ -199,6 +222,78 @@ void heap_trace_dump_caps(const uint32_t caps);
  */
 esp_err_t heap_trace_summary(heap_trace_summary_t *summary);
 
+/**
+ * @brief Start the sampling heap profiler.
+ *
+ * Allocations are sampled as a Poisson process over the allocated bytes, so an allocation of
+ * size S is sampled with the probability 1 - exp(-S / sample_interval). The sampled allocations are
+ * aggregated by their call stack. Allocations which are not sampled only decrement a counter, so the
+ * profiler can be kept running in production.
+ *
+ * @note Calling this function while sampling is running clears the callsite table and continues sampling.
+ *
+ * @param sample_interval Mean number of allocated bytes between two samples
+ * @return
+ * - ESP_ERR_INVALID_ARG sample_interval is 0.
+ * - ESP_OK Sampling is started.
+ */
+esp_err_t heap_trace_sampling_start(size_t sample_interval);
+
+/**
+ * @brief Stop the sampling heap profiler.
+ *
+ * The callsite table is kept until sampling is started again. Frees made after this call
+ * are not subtracted from the memory in use.
+ *
+ * @return
+ * - ESP_ERR_INVALID_STATE Sampling was not running.
+ * - ESP_OK Sampling stopped.
+ */
+esp_err_t heap_trace_sampling_stop(void);
+
+/**
+ * @brief Return the number of call stacks in the callsite table of the sampling heap profiler
+ *
+ * It is safe to call this function while sampling is running.
+ */
+size_t heap_trace_sampling_get_count(void);
+
+/**
+ * @brief Return the sampled allocations of a call stack
+ *
+ * @note It is safe to call this function while sampling is running, however the
+ * indexes of the call stacks may change if a new call stack is added meanwhile.
+ *
+ * @param index Index (zero-based) of the call stack to return.
+ * @param[out] callsite Where the sampled allocations will be copied.
+ * @return
+ * - ESP_ERR_INVALID_ARG Index is out of bounds for the current count of call stacks, or callsite is NULL.
+ * - ESP_OK Call stack returned successfully.
+ */
+esp_err_t heap_trace_sampling_get(size_t index, heap_trace_callsite_t *callsite);
+
+/**
+ * @brief Get summary information about the sampling heap profiler
+ *
+ * @note It is safe to call this function while sampling is running.
+ *
+ * @param[out] summary Where the summary will be copied.
+ * @return
+ * - ESP_ERR_INVALID_ARG summary is NULL.
+ * - ESP_OK Summary returned successfully.
+ */
+esp_err_t heap_trace_sampling_summary(heap_trace_sampling_summary_t *summary);
+
+/**
+ * @brief Dump the sampled allocations to stdout as a heap profile readable by pprof
+ *
+ * The output uses the legacy heap profile text format of gperftools (``heap_v2``). pprof scales the
+ * sampled counts and sizes up to estimates of all allocations, using the sample interval in the header.
+ *
+ * @note It is safe to call this function while sampling is running.
+ */
+void heap_trace_sampling_dump(void);
+
 #ifdef __cplusplus
 }
 #endif
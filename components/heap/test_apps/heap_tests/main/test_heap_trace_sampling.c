@@ -0,0 +1,117 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+/*
+ Tests of the sampling heap profiler
+
+ Only compiled in if CONFIG_HEAP_TRACING_SAMPLING is set
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sdkconfig.h"
+#include "unity.h"
+#include "esp_heap_caps.h"
+
+#ifdef CONFIG_HEAP_TRACING_SAMPLING
+
+#include "esp_heap_trace.h"
+
+static void __attribute__((noinline)) alloc_from_a(void **p, int count)
+{
+    for (int i = 0; i < count; i++) {
+        p[i] = malloc(64);
+    }
+}
+
+static void __attribute__((noinline)) alloc_from_b(void **p, int count)
+{
+    for (int i = 0; i < count; i++) {
+        p[i] = malloc(128);
+    }
+}
+
+TEST_CASE("heap trace sampling aggregates callsites", "[heap-trace-sampling]")
+{
+    void *a[10];
+    void *b[5];
+
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, heap_trace_sampling_start(0));
+    // with an interval of 1 byte, all the allocations below are sampled
+    TEST_ESP_OK(heap_trace_sampling_start(1));
+    alloc_from_a(a, 10);
+    alloc_from_b(b, 5);
+    for (int i = 0; i < 5; i++) {
+        free(a[i]);
+    }
+    TEST_ESP_OK(heap_trace_sampling_stop());
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, heap_trace_sampling_stop());
+
+    heap_trace_sampling_summary_t summary;
+    TEST_ESP_OK(heap_trace_sampling_summary(&summary));
+    TEST_ASSERT_EQUAL(1, summary.sample_interval);
+    TEST_ASSERT_EQUAL(0, summary.dropped_samples);
+    TEST_ASSERT_EQUAL(summary.callsite_count, heap_trace_sampling_get_count());
+
+    heap_trace_callsite_t callsite;
+    size_t found = 0;
+    for (size_t i = 0; i < heap_trace_sampling_get_count(); i++) {
+        TEST_ESP_OK(heap_trace_sampling_get(i, &callsite));
+        if (callsite.alloc_bytes == 10 * 64 && callsite.alloc_count == 10) {
+            TEST_ASSERT_EQUAL(5, callsite.inuse_count);
+            TEST_ASSERT_EQUAL(5 * 64, callsite.inuse_bytes);
+            found++;
+        } else if (callsite.alloc_bytes == 5 * 128 && callsite.alloc_count == 5) {
+            TEST_ASSERT_EQUAL(5, callsite.inuse_count);
+            TEST_ASSERT_EQUAL(5 * 128, callsite.inuse_bytes);
+            found++;
+        }
+    }
+    TEST_ASSERT_EQUAL(2, found);
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, heap_trace_sampling_get(heap_trace_sampling_get_count(), &callsite));
+
+    heap_trace_sampling_dump();
+
+    for (int i = 5; i < 10; i++) {
+        free(a[i]);
+    }
+    for (int i = 0; i < 5; i++) {
+        free(b[i]);
+    }
+}
+
+TEST_CASE("heap trace sampling follows the sample interval", "[heap-trace-sampling]")
+{
+    const int COUNT = 2000;
+    const size_t SIZE = 64;
+    const size_t INTERVAL = 4096;
+
+    TEST_ESP_OK(heap_trace_sampling_start(INTERVAL));
+    for (int i = 0; i < COUNT; i++) {
+        free(malloc(SIZE));
+    }
+    TEST_ESP_OK(heap_trace_sampling_stop());
+
+    heap_trace_sampling_summary_t summary;
+    TEST_ESP_OK(heap_trace_sampling_summary(&summary));
+    // about 31 samples are expected, as each allocation is sampled with the probability 1 - exp(-64 / 4096)
+    printf("%d samples\n", summary.total_samples);
+    TEST_ASSERT_GREATER_OR_EQUAL(10, summary.total_samples);
+    TEST_ASSERT_LESS_OR_EQUAL(60, summary.total_samples);
+
+    // the samples of the loop above were all freed, other tasks may have allocated meanwhile
+    heap_trace_callsite_t callsite;
+    heap_trace_callsite_t most_sampled = { 0 };
+    for (size_t i = 0; i < heap_trace_sampling_get_count(); i++) {
+        TEST_ESP_OK(heap_trace_sampling_get(i, &callsite));
+        if (callsite.alloc_count > most_sampled.alloc_count) {
+            most_sampled = callsite;
+        }
+    }
+    TEST_ASSERT_EQUAL(most_sampled.alloc_count * SIZE, most_sampled.alloc_bytes);
+    TEST_ASSERT_EQUAL(0, most_sampled.inuse_count);
+}
+
+#endif // CONFIG_HEAP_TRACING_SAMPLING
@@ -0,0 +1,159 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+/*
+ Tests of the per-core caches of small blocks (CONFIG_HEAP_PER_CORE_CACHE),
+ and a benchmark of small allocations on all cores which runs with and without them.
+*/
+#include <stdio.h>
+#include <inttypes.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "unity.h"
+#include "esp_cpu.h"
+#include "esp_heap_caps.h"
+#include "sdkconfig.h"
+
+#if CONFIG_HEAP_PER_CORE_CACHE
+typedef struct {
+    SemaphoreHandle_t done;
+    void *freed;
+    void *reused;
+    void *dma;
+} reuse_task_arg_t;
+
+static void reuse_task(void *arg)
+{
+    reuse_task_arg_t *task_arg = (reuse_task_arg_t *)arg;
+    heap_caps_cache_flush();
+    task_arg->freed = heap_caps_malloc(40, MALLOC_CAP_DEFAULT);
+    heap_caps_free(task_arg->freed);
+    task_arg->reused = heap_caps_malloc(36, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    // DMA capable memory is not taken from the caches
+    task_arg->dma = heap_caps_malloc(40, MALLOC_CAP_DMA);
+    xSemaphoreGive(task_arg->done);
+    vTaskDelete(NULL);
+}
+
+TEST_CASE("per-core cache reuses small blocks", "[heap][per-core-cache]")
+{
+    // The block is only reused if it is allocated on the core it was freed on
+    reuse_task_arg_t arg = { .done = xSemaphoreCreateBinary() };
+    TEST_ASSERT_NOT_NULL(arg.done);
+    TEST_ASSERT(xTaskCreatePinnedToCore(reuse_task, "reuse", 3072, &arg, uxTaskPriorityGet(NULL), NULL, 0) == pdPASS);
+    xSemaphoreTake(arg.done, portMAX_DELAY);
+    vSemaphoreDelete(arg.done);
+
+    TEST_ASSERT_NOT_NULL(arg.freed);
+    TEST_ASSERT_EQUAL_PTR(arg.freed, arg.reused);
+    memset(arg.reused, 0xA5, 36);
+    TEST_ASSERT(heap_caps_get_allocated_size(arg.reused) >= 36);
+    heap_caps_free(arg.reused);
+
+    TEST_ASSERT_NOT_NULL(arg.dma);
+    TEST_ASSERT(arg.dma != arg.freed);
+    heap_caps_free(arg.dma);
+    heap_caps_cache_flush();
+}
+
+TEST_CASE("per-core cache is flushed for heap info", "[heap][per-core-cache]")
+{
+    const int COUNT = 16;
+    void *p[COUNT];
+    heap_caps_cache_flush();
+    size_t free_before = heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+    for (int i = 0; i < COUNT; i++) {
+        p[i] = heap_caps_malloc(24 + 8 * (i % 4), MALLOC_CAP_DEFAULT);
+        TEST_ASSERT_NOT_NULL(p[i]);
+    }
+    for (int i = 0; i < COUNT; i++) {
+        heap_caps_free(p[i]);
+    }
+    TEST_ASSERT_EQUAL(free_before, heap_caps_get_free_size(MALLOC_CAP_DEFAULT));
+
+    multi_heap_info_t info_before, info_after;
+    heap_caps_get_info(&info_before, MALLOC_CAP_DEFAULT);
+    for (int i = 0; i < COUNT; i++) {
+        p[i] = heap_caps_malloc(64, MALLOC_CAP_DEFAULT);
+        TEST_ASSERT_NOT_NULL(p[i]);
+    }
+    for (int i = 0; i < COUNT; i++) {
+        heap_caps_free(p[i]);
+    }
+    heap_caps_get_info(&info_after, MALLOC_CAP_DEFAULT);
+    TEST_ASSERT_EQUAL(info_before.total_free_bytes, info_after.total_free_bytes);
+    TEST_ASSERT_EQUAL(info_before.allocated_blocks, info_after.allocated_blocks);
+}
+
+TEST_CASE("per-core cache is released when an allocation fails", "[heap][per-core-cache]")
+{
+    size_t largest = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL);
+    // fill the caches with blocks of all sizes, they may be taken from the largest free block
+    void *p[CONFIG_HEAP_PER_CORE_CACHE_DEPTH];
+    for (int size = 8; size <= CONFIG_HEAP_PER_CORE_CACHE_MAX_SIZE; size += 8) {
+        for (int i = 0; i < CONFIG_HEAP_PER_CORE_CACHE_DEPTH; i++) {
+            p[i] = heap_caps_malloc(size, MALLOC_CAP_DEFAULT);
+        }
+        for (int i = 0; i < CONFIG_HEAP_PER_CORE_CACHE_DEPTH; i++) {
+            heap_caps_free(p[i]);
+        }
+    }
+    void *big = heap_caps_malloc(largest, MALLOC_CAP_INTERNAL);
+    TEST_ASSERT_NOT_NULL(big);
+    heap_caps_free(big);
+}
+#endif // CONFIG_HEAP_PER_CORE_CACHE
+
+#define BENCH_ITERATIONS 20000
+#define BENCH_POINTERS 16
+
+typedef struct {
+    SemaphoreHandle_t done;
+    uint32_t cycles;
+    int failed;
+} bench_task_arg_t;
+
+static void bench_task(void *arg)
+{
+    bench_task_arg_t *task_arg = (bench_task_arg_t *)arg;
+    void *p[BENCH_POINTERS] = { 0 };
+    uint32_t start = esp_cpu_get_cycle_count();
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        int n = i % BENCH_POINTERS;
+        heap_caps_free(p[n]);
+        p[n] = heap_caps_malloc(16 + (i % 7) * 12, MALLOC_CAP_DEFAULT);
+        task_arg->failed += (p[n] == NULL);
+    }
+    task_arg->cycles = esp_cpu_get_cycle_count() - start;
+    for (int n = 0; n < BENCH_POINTERS; n++) {
+        heap_caps_free(p[n]);
+    }
+    xSemaphoreGive(task_arg->done);
+    vTaskDelete(NULL);
+}
+
+TEST_CASE("small allocations on all cores timings", "[heap]")
+{
+    bench_task_arg_t args[CONFIG_FREERTOS_NUMBER_OF_CORES];
+    SemaphoreHandle_t done = xSemaphoreCreateCounting(CONFIG_FREERTOS_NUMBER_OF_CORES, 0);
+    TEST_ASSERT_NOT_NULL(done);
+
+    for (int core = 0; core < CONFIG_FREERTOS_NUMBER_OF_CORES; core++) {
+        args[core].done = done;
+        args[core].failed = 0;
+        TEST_ASSERT(xTaskCreatePinnedToCore(bench_task, "bench", 3072, &args[core],
+                                            uxTaskPriorityGet(NULL) + 1, NULL, core) == pdPASS);
+    }
+    for (int core = 0; core < CONFIG_FREERTOS_NUMBER_OF_CORES; core++) {
+        xSemaphoreTake(done, portMAX_DELAY);
+    }
+    for (int core = 0; core < CONFIG_FREERTOS_NUMBER_OF_CORES; core++) {
+        TEST_ASSERT_EQUAL(0, args[core].failed);
+        printf("core %d: %"PRIu32" cycles per malloc + free\n", core, args[core].cycles / BENCH_ITERATIONS);
+    }
+    vSemaphoreDelete(done);
+}
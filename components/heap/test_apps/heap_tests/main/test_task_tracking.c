@@ -1,15 +1,17 @@
 /*
- * SPDX-FileCopyrightText: 2022-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Unlicense OR CC0-1.0
  */
 #include "unity.h"
 #include "stdio.h"
+#include <inttypes.h>
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_heap_caps.h"
 #include "esp_heap_task_info.h"
+#include "esp_cpu.h"
 
 // This test only apply when task tracking is enabled
 #if defined(CONFIG_HEAP_TASK_TRACKING)
@@ -105,4 +107,221 @@ TEST_CASE("heap task tracking reports created task", "[heap]")
     vTaskDelete(test_task_handle);
 }
 
+static heap_task_stat_t *find_task_stat(heap_task_stat_t *stats, size_t count, TaskHandle_t task)
+{
+    for (size_t i = 0; i < count; i++) {
+        if (stats[i].task == task) {
+            return &stats[i];
+        }
+    }
+    return NULL;
+}
+
+static void test_stats_task(void *args)
+{
+    void *ptr[3];
+    for (int i = 0; i < 3; i++) {
+        ptr[i] = heap_caps_malloc(ALLOC_BYTES, MALLOC_CAP_32BIT);
+        if (ptr[i] == NULL) {
+            abort();
+        }
+    }
+    heap_caps_free(ptr[1]);
+    // the block now belongs to this task, with the new size
+    ptr[0] = heap_caps_realloc(ptr[0], 2 * ALLOC_BYTES, MALLOC_CAP_32BIT);
+
+    xTaskNotifyGive((TaskHandle_t)args);
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    heap_caps_free(ptr[0]);
+    heap_caps_free(ptr[2]);
+    xTaskNotifyGive((TaskHandle_t)args);
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+}
+
+TEST_CASE("heap task stats follow allocations and frees", "[heap]")
+{
+    TaskHandle_t test_task_handle;
+    heap_task_stat_t stats[CONFIG_HEAP_TASK_TRACKING_MAX_TASKS + 1];
+
+    xTaskCreate(&test_stats_task, "test_task", 3072, (void *)xTaskGetCurrentTaskHandle(), 5, &test_task_handle);
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    size_t count = heap_caps_get_task_stats(stats, CONFIG_HEAP_TASK_TRACKING_MAX_TASKS + 1);
+    heap_task_stat_t *stat = find_task_stat(stats, count, test_task_handle);
+    TEST_ASSERT_NOT_NULL(stat);
+    TEST_ASSERT_EQUAL(2, stat->count);
+    // the sizes include the block owner (4 bytes)
+    TEST_ASSERT_EQUAL(2 * ALLOC_BYTES + 4 + ALLOC_BYTES + 4, stat->size);
+    TEST_ASSERT_EQUAL(3 * (ALLOC_BYTES + 4), stat->peak_size);
+
+    xTaskNotifyGive(test_task_handle);
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    count = heap_caps_get_task_stats(stats, CONFIG_HEAP_TASK_TRACKING_MAX_TASKS + 1);
+    stat = find_task_stat(stats, count, test_task_handle);
+    TEST_ASSERT_NOT_NULL(stat);
+    TEST_ASSERT_EQUAL(0, stat->count);
+    TEST_ASSERT_EQUAL(0, stat->size);
+    TEST_ASSERT_EQUAL(3 * (ALLOC_BYTES + 4), stat->peak_size);
+
+    xTaskNotifyGive(test_task_handle);
+    vTaskDelete(test_task_handle);
+}
+
+TEST_CASE("heap task stats match the heap walk", "[heap]")
+{
+    size_t num_totals = 0;
+    heap_task_totals_t totals[CONFIG_HEAP_TASK_TRACKING_MAX_TASKS];
+    heap_task_stat_t stats[CONFIG_HEAP_TASK_TRACKING_MAX_TASKS + 1];
+    heap_task_info_params_t heap_info = {0};
+    heap_info.totals = totals;
+    heap_info.num_totals = &num_totals;
+    heap_info.max_totals = CONFIG_HEAP_TASK_TRACKING_MAX_TASKS;
+
+    // no other task of the test may allocate or free meanwhile
+    vTaskSuspendAll();
+    heap_caps_get_per_task_info(&heap_info);
+    size_t count = heap_caps_get_task_stats(stats, CONFIG_HEAP_TASK_TRACKING_MAX_TASKS + 1);
+    xTaskResumeAll();
+
+    for (size_t i = 0; i < num_totals; i++) {
+        heap_task_stat_t *stat = find_task_stat(stats, count, totals[i].task);
+        TEST_ASSERT_NOT_NULL(stat);
+        TEST_ASSERT_EQUAL(totals[i].size[0], stat->size);
+        TEST_ASSERT_EQUAL(totals[i].count[0], stat->count);
+    }
+}
+
+#define STATS_CMD_ALLOC 1
+#define STATS_CMD_FREE_FIRST 2
+#define STATS_CMD_FREE_ALL 3
+
+static void test_stats_cmd_task(void *args)
+{
+    void *ptr[2] = { NULL };
+    size_t num_ptrs = 0;
+    uint32_t cmd = STATS_CMD_ALLOC;
+    while (true) {
+        if (cmd == STATS_CMD_ALLOC && num_ptrs < 2) {
+            ptr[num_ptrs] = heap_caps_malloc(ALLOC_BYTES, MALLOC_CAP_32BIT);
+            if (ptr[num_ptrs] == NULL) {
+                abort();
+            }
+            num_ptrs++;
+        } else if (cmd == STATS_CMD_FREE_FIRST) {
+            heap_caps_free(ptr[0]);
+            ptr[0] = NULL;
+        } else if (cmd == STATS_CMD_FREE_ALL) {
+            heap_caps_free(ptr[0]);
+            heap_caps_free(ptr[1]);
+            ptr[0] = ptr[1] = NULL;
+        }
+        xTaskNotifyGive((TaskHandle_t)args);
+        xTaskNotifyWait(0, UINT32_MAX, &cmd, portMAX_DELAY);
+    }
+}
+
+static void stats_task_cmd(TaskHandle_t task, uint32_t cmd)
+{
+    xTaskNotify(task, cmd, eSetValueWithOverwrite);
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+}
+
+TEST_CASE("heap task stats subtract a block from the totals it was added to", "[heap]")
+{
+    static TaskHandle_t tasks[CONFIG_HEAP_TASK_TRACKING_MAX_TASKS];
+    static heap_task_stat_t stats[CONFIG_HEAP_TASK_TRACKING_MAX_TASKS + 1];
+    size_t num_tasks = 0;
+    TaskHandle_t overflow_task = NULL;
+    size_t count;
+
+    // add tasks with a block each until the table is full, the block of the last one
+    // is added to the totals of the other tasks
+    while (overflow_task == NULL) {
+        TaskHandle_t task;
+        TEST_ASSERT_LESS_THAN(CONFIG_HEAP_TASK_TRACKING_MAX_TASKS, num_tasks);
+        TEST_ASSERT_EQUAL(pdPASS, xTaskCreate(&test_stats_cmd_task, "stats_task", 2048,
+                                              (void *)xTaskGetCurrentTaskHandle(), 5, &task));
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        count = heap_caps_get_task_stats(stats, CONFIG_HEAP_TASK_TRACKING_MAX_TASKS + 1);
+        if (find_task_stat(stats, count, task) == NULL) {
+            overflow_task = task;
+        } else {
+            tasks[num_tasks++] = task;
+        }
+    }
+
+    // the other tasks free their blocks, so the next block of the last task purges
+    // the table and adds the task to it
+    for (size_t i = 0; i < num_tasks; i++) {
+        stats_task_cmd(tasks[i], STATS_CMD_FREE_ALL);
+    }
+    stats_task_cmd(overflow_task, STATS_CMD_ALLOC);
+    count = heap_caps_get_task_stats(stats, CONFIG_HEAP_TASK_TRACKING_MAX_TASKS + 1);
+    heap_task_stat_t *stat = find_task_stat(stats, count, overflow_task);
+    TEST_ASSERT_NOT_NULL(stat);
+    TEST_ASSERT_EQUAL(1, stat->count);
+    TEST_ASSERT_EQUAL(ALLOC_BYTES + 4, stat->size);
+    heap_task_stat_t *other = find_task_stat(stats, count, NULL);
+    TEST_ASSERT_NOT_NULL(other);
+    size_t other_count = other->count;
+    size_t other_size = other->size;
+
+    // the first block is subtracted from the totals of the other tasks
+    stats_task_cmd(overflow_task, STATS_CMD_FREE_FIRST);
+    count = heap_caps_get_task_stats(stats, CONFIG_HEAP_TASK_TRACKING_MAX_TASKS + 1);
+    stat = find_task_stat(stats, count, overflow_task);
+    TEST_ASSERT_NOT_NULL(stat);
+    TEST_ASSERT_EQUAL(1, stat->count);
+    TEST_ASSERT_EQUAL(ALLOC_BYTES + 4, stat->size);
+    other = find_task_stat(stats, count, NULL);
+    TEST_ASSERT_NOT_NULL(other);
+    TEST_ASSERT_EQUAL(other_count - 1, other->count);
+    TEST_ASSERT_EQUAL(other_size - (ALLOC_BYTES + 4), other->size);
+
+    stats_task_cmd(overflow_task, STATS_CMD_FREE_ALL);
+    vTaskDelete(overflow_task);
+    for (size_t i = 0; i < num_tasks; i++) {
+        vTaskDelete(tasks[i]);
+    }
+}
+
+#define BENCH_ITERATIONS 10000
+#define BENCH_POINTERS 16
+
+TEST_CASE("heap task stats timings", "[heap]")
+{
+    void *p[BENCH_POINTERS] = { 0 };
+    uint32_t start = esp_cpu_get_cycle_count();
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        int n = i % BENCH_POINTERS;
+        heap_caps_free(p[n]);
+        p[n] = heap_caps_malloc(16 + (i % 7) * 12, MALLOC_CAP_DEFAULT);
+    }
+    uint32_t malloc_cycles = (esp_cpu_get_cycle_count() - start) / BENCH_ITERATIONS;
+    for (int n = 0; n < BENCH_POINTERS; n++) {
+        heap_caps_free(p[n]);
+    }
+
+    size_t num_totals = 0;
+    heap_task_totals_t totals[CONFIG_HEAP_TASK_TRACKING_MAX_TASKS];
+    heap_task_info_params_t heap_info = {0};
+    heap_info.totals = totals;
+    heap_info.num_totals = &num_totals;
+    heap_info.max_totals = CONFIG_HEAP_TASK_TRACKING_MAX_TASKS;
+    start = esp_cpu_get_cycle_count();
+    heap_caps_get_per_task_info(&heap_info);
+    uint32_t walk_cycles = esp_cpu_get_cycle_count() - start;
+
+    heap_task_stat_t stats[CONFIG_HEAP_TASK_TRACKING_MAX_TASKS + 1];
+    start = esp_cpu_get_cycle_count();
+    heap_caps_get_task_stats(stats, CONFIG_HEAP_TASK_TRACKING_MAX_TASKS + 1);
+    uint32_t stats_cycles = esp_cpu_get_cycle_count() - start;
+
+    printf("malloc + free: %"PRIu32" cycles\n", malloc_cycles);
+    printf("heap_caps_get_per_task_info: %"PRIu32" cycles\n", walk_cycles);
+    printf("heap_caps_get_task_stats: %"PRIu32" cycles\n", stats_cycles);
+    TEST_ASSERT_LESS_THAN(walk_cycles, stats_cycles);
+}
+
 #endif // CONFIG_HEAP_TASK_TRACKING
@@ -0,0 +1,218 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <time.h>
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_heap_caps.h"
+#include "esp_heap_caps_pool.h"
+#include "unity.h"
+
+#define POOL_OBJ_SIZE 20
+#define POOL_COUNT 32
+
+TEST_CASE("Pool alloc and free", "[heap][pool]")
+{
+    heap_caps_pool_handle_t pool = heap_caps_pool_create(POOL_OBJ_SIZE, POOL_COUNT, MALLOC_CAP_DEFAULT);
+    TEST_ASSERT_NOT_NULL(pool);
+
+    uint8_t *objs[POOL_COUNT];
+    for (int i = 0; i < POOL_COUNT; i++) {
+        objs[i] = heap_caps_pool_alloc(pool);
+        TEST_ASSERT_NOT_NULL(objs[i]);
+        TEST_ASSERT_EQUAL(0, (intptr_t)objs[i] % sizeof(void *));
+        memset(objs[i], i, POOL_OBJ_SIZE);
+    }
+    TEST_ASSERT_NULL(heap_caps_pool_alloc(pool));
+
+    for (int i = 0; i < POOL_COUNT; i++) {
+        TEST_ASSERT_EACH_EQUAL_HEX8(i, objs[i], POOL_OBJ_SIZE);
+        for (int j = 0; j < i; j++) {
+            TEST_ASSERT(objs[i] >= objs[j] + POOL_OBJ_SIZE || objs[j] >= objs[i] + POOL_OBJ_SIZE);
+        }
+    }
+
+    heap_caps_pool_free(pool, objs[5]);
+    heap_caps_pool_free(pool, NULL);
+    TEST_ASSERT_EQUAL_PTR(objs[5], heap_caps_pool_alloc(pool));
+
+    for (int i = 0; i < POOL_COUNT; i++) {
+        heap_caps_pool_free(pool, objs[i]);
+    }
+    heap_caps_pool_delete(pool);
+}
+
+TEST_CASE("Pool invalid arguments", "[heap][pool]")
+{
+    TEST_ASSERT_NULL(heap_caps_pool_create(0, POOL_COUNT, MALLOC_CAP_DEFAULT));
+    TEST_ASSERT_NULL(heap_caps_pool_create(POOL_OBJ_SIZE, 0, MALLOC_CAP_DEFAULT));
+    TEST_ASSERT_NULL(heap_caps_pool_create(SIZE_MAX / 2, 4, MALLOC_CAP_DEFAULT));
+#if CONFIG_HEAP_POOL_LOCK_FREE
+    TEST_ASSERT_NULL(heap_caps_pool_create(POOL_OBJ_SIZE, 0x10000, MALLOC_CAP_DEFAULT));
+#endif
+    heap_caps_pool_delete(NULL);
+}
+
+typedef struct {
+    size_t used;
+    size_t free;
+    size_t bytes;
+} walk_totals_t;
+
+static bool pool_walker(walker_heap_into_t heap_info, walker_block_info_t block_info, void *user_data)
+{
+    walk_totals_t *totals = (walk_totals_t *)user_data;
+    TEST_ASSERT((intptr_t)block_info.ptr >= heap_info.start);
+    TEST_ASSERT((intptr_t)block_info.ptr + block_info.size <= heap_info.end);
+    if (block_info.used) {
+        totals->used++;
+    } else {
+        totals->free++;
+    }
+    totals->bytes += block_info.size;
+    return true;
+}
+
+TEST_CASE("Pool info and walk", "[heap][pool]")
+{
+    heap_caps_pool_handle_t pool = heap_caps_pool_create(POOL_OBJ_SIZE, POOL_COUNT, MALLOC_CAP_DEFAULT);
+    TEST_ASSERT_NOT_NULL(pool);
+    void *objs[10];
+    for (int i = 0; i < 10; i++) {
+        objs[i] = heap_caps_pool_alloc(pool);
+    }
+    heap_caps_pool_free(pool, objs[9]);
+    heap_caps_pool_free(pool, objs[8]);
+
+    multi_heap_info_t info;
+    heap_caps_pool_get_info(pool, &info);
+    TEST_ASSERT_EQUAL(8, info.allocated_blocks);
+    TEST_ASSERT_EQUAL(POOL_COUNT - 8, info.free_blocks);
+    TEST_ASSERT_EQUAL(POOL_COUNT, info.total_blocks);
+    TEST_ASSERT_EQUAL(info.total_allocated_bytes / 8, info.largest_free_block);
+    TEST_ASSERT(info.largest_free_block >= POOL_OBJ_SIZE);
+    TEST_ASSERT_EQUAL((POOL_COUNT - 8) * info.largest_free_block, info.total_free_bytes);
+    TEST_ASSERT_EQUAL((POOL_COUNT - 10) * info.largest_free_block, info.minimum_free_bytes);
+
+    walk_totals_t totals = { 0 };
+    heap_caps_pool_walk(pool, pool_walker, &totals);
+    TEST_ASSERT_EQUAL(8, totals.used);
+    TEST_ASSERT_EQUAL(POOL_COUNT - 8, totals.free);
+    TEST_ASSERT_EQUAL(info.total_allocated_bytes + info.total_free_bytes, totals.bytes);
+
+    heap_caps_pool_delete(pool);
+}
+
+#define STRESS_ITERATIONS 20000
+#define STRESS_OBJS 8
+
+typedef struct {
+    heap_caps_pool_handle_t pool;
+    SemaphoreHandle_t done;
+    uint32_t id;
+    int errors;
+} stress_arg_t;
+
+static void pool_stress_task(void *arg)
+{
+    stress_arg_t *stress = (stress_arg_t *)arg;
+    uint32_t *objs[STRESS_OBJS] = { 0 };
+    for (int i = 0; i < STRESS_ITERATIONS; i++) {
+        int n = i % STRESS_OBJS;
+        if (objs[n] != NULL) {
+            // the object must not have been given to the other task meanwhile
+            stress->errors += (objs[n][0] != stress->id || objs[n][1] != (uint32_t)i);
+            heap_caps_pool_free(stress->pool, objs[n]);
+        }
+        objs[n] = heap_caps_pool_alloc(stress->pool);
+        if (objs[n] != NULL) {
+            objs[n][0] = stress->id;
+            objs[n][1] = i + STRESS_OBJS;
+        }
+        if (i % 1000 == 0) {
+            taskYIELD();
+        }
+    }
+    for (int n = 0; n < STRESS_OBJS; n++) {
+        heap_caps_pool_free(stress->pool, objs[n]);
+    }
+    xSemaphoreGive(stress->done);
+    vTaskDelete(NULL);
+}
+
+TEST_CASE("Pool used by two tasks", "[heap][pool]")
+{
+    // fewer objects than the tasks want, so some allocations fail
+    heap_caps_pool_handle_t pool = heap_caps_pool_create(2 * sizeof(uint32_t), STRESS_OBJS + STRESS_OBJS / 2, MALLOC_CAP_DEFAULT);
+    TEST_ASSERT_NOT_NULL(pool);
+    SemaphoreHandle_t done = xSemaphoreCreateCounting(2, 0);
+    stress_arg_t args[2];
+    for (int i = 0; i < 2; i++) {
+        args[i] = (stress_arg_t) {
+            .pool = pool, .done = done, .id = 0xA0 + i, .errors = 0
+        };
+        TEST_ASSERT_EQUAL(pdPASS, xTaskCreate(pool_stress_task, "pool_stress", 4096, &args[i], 5, NULL));
+    }
+    xSemaphoreTake(done, portMAX_DELAY);
+    xSemaphoreTake(done, portMAX_DELAY);
+    TEST_ASSERT_EQUAL(0, args[0].errors);
+    TEST_ASSERT_EQUAL(0, args[1].errors);
+
+    multi_heap_info_t info;
+    heap_caps_pool_get_info(pool, &info);
+    TEST_ASSERT_EQUAL(0, info.allocated_blocks);
+    vSemaphoreDelete(done);
+    heap_caps_pool_delete(pool);
+}
+
+static uint64_t get_time_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+#define BENCH_ITERATIONS 1000000
+#define BENCH_OBJS 64
+
+TEST_CASE("Pool alloc and free timings", "[heap][pool]")
+{
+    void *objs[BENCH_OBJS] = { 0 };
+    heap_caps_pool_handle_t pool = heap_caps_pool_create(48, BENCH_OBJS, MALLOC_CAP_DEFAULT);
+    TEST_ASSERT_NOT_NULL(pool);
+
+    uint64_t start = get_time_ns();
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        int n = (i * 7) % BENCH_OBJS;
+        heap_caps_pool_free(pool, objs[n]);
+        objs[n] = heap_caps_pool_alloc(pool);
+    }
+    uint64_t pool_ns = get_time_ns() - start;
+    for (int n = 0; n < BENCH_OBJS; n++) {
+        heap_caps_pool_free(pool, objs[n]);
+        objs[n] = NULL;
+    }
+
+    start = get_time_ns();
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        int n = (i * 7) % BENCH_OBJS;
+        heap_caps_free(objs[n]);
+        objs[n] = heap_caps_malloc(48, MALLOC_CAP_DEFAULT);
+    }
+    uint64_t malloc_ns = get_time_ns() - start;
+    for (int n = 0; n < BENCH_OBJS; n++) {
+        heap_caps_free(objs[n]);
+    }
+
+    printf("heap_caps_pool_alloc + free: %" PRIu64 " ns\n", pool_ns / BENCH_ITERATIONS);
+    printf("heap_caps_malloc + free: %" PRIu64 " ns\n", malloc_ns / BENCH_ITERATIONS);
+    heap_caps_pool_delete(pool);
+}
@@ -7,8 +7,16 @@
    CONDITIONS OF ANY KIND, either express or implied.
 */
 #include <cstdio>
+#include <cinttypes>
+#include <cstring>
+#include <ctime>
 #include <regex>
+#include <string>
+#include <vector>
+#include <unistd.h>
 #include <iostream>
+#include <atomic>
+#include <pthread.h>
 #include "esp_rom_sys.h"
 #include "esp_log.h"
 #include "esp_private/log_util.h"
@@ -147,6 +155,7 @@ private:
 PrintFixture *PrintFixture::instance = nullptr;
 PutcFixture *PutcFixture::instance = nullptr;
 
+#if !CONFIG_LOG_BINARY
 TEST_CASE("verbose log level")
 {
     PrintFixture fix(ESP_LOG_VERBOSE);
@@ -265,6 +274,8 @@ TEST_CASE("log buffer dump")
     CHECK(regex_search(fix.get_print_buffer_string(), buffer_regex));
 }
 
+#endif // !CONFIG_LOG_BINARY
+
 TEST_CASE("rom printf")
 {
     PutcFixture fix;
@@ -405,3 +416,432 @@ TEST_CASE("esp_log_timestamp_str")
     const std::regex test_print2(TIMESTAMP, std::regex::ECMAScript);
     CHECK(regex_search(string(buffer), test_print2) == true);
 }
+
+#if CONFIG_LOG_ASYNC || CONFIG_LOG_BINARY || !CONFIG_LOG_TAG_LEVEL_IMPL_NONE
+static uint64_t get_time_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+#endif // CONFIG_LOG_ASYNC || CONFIG_LOG_BINARY || !CONFIG_LOG_TAG_LEVEL_IMPL_NONE
+
+#if CONFIG_LOG_ASYNC
+TEST_CASE("async log formats the copied arguments")
+{
+    PrintFixture fix(ESP_LOG_INFO);
+    REQUIRE(esp_log_set_async(true));
+    char str[] = "before";
+    char expected[128];
+    snprintf(expected, sizeof(expected), "test: %s %d %ld %lld %.2f %p %08x %zu %c %.3s %% end",
+             str, -5, 123456789L, 1234567890123LL, 3.14159, (void *) 0x1234, 0xabcdU, (size_t) 77, 'Z', "abcdef");
+    ESP_LOGI(TEST_TAG, "%s %d %ld %lld %.2f %p %08x %zu %c %.3s %% end",
+             str, -5, 123456789L, 1234567890123LL, 3.14159, (void *) 0x1234, 0xabcdU, (size_t) 77, 'Z', "abcdef");
+    // String arguments are copied when the message is queued
+    strcpy(str, "after");
+
+    // Outputs the queued messages and waits for the log thread, which writes to the fixture's buffer
+    CHECK(esp_log_set_async(false));
+    CHECK(fix.get_print_buffer_string().find(expected) != string::npos);
+}
+
+static char s_thread_print_buffer[64];
+static pthread_t s_print_thread;
+
+static int thread_recording_print(const char *format, va_list args)
+{
+    s_print_thread = pthread_self();
+    return vsnprintf(s_thread_print_buffer, sizeof(s_thread_print_buffer), format, args);
+}
+
+TEST_CASE("async log outputs messages with a format string built at runtime synchronously")
+{
+    vprintf_like_t old_vprintf = esp_log_set_vprintf(thread_recording_print);
+    esp_log_level_set("*", ESP_LOG_INFO);
+    REQUIRE(esp_log_set_async(true));
+
+    // The format string is on the stack, the message must not be queued
+    char format[32];
+    snprintf(format, sizeof(format), "%s %%d|", "runtime");
+    esp_log_write(ESP_LOG_INFO, TEST_TAG, format, 42);
+    memset(format, 0, sizeof(format));
+
+    CHECK(esp_log_set_async(false));
+    CHECK(pthread_equal(s_print_thread, pthread_self()));
+    CHECK(string(s_thread_print_buffer) == "runtime 42|");
+    esp_log_set_vprintf(old_vprintf);
+}
+
+TEST_CASE("async log outputs messages which can not be deferred synchronously")
+{
+    PrintFixture fix(ESP_LOG_INFO);
+    REQUIRE(esp_log_set_async(true));
+
+    ESP_LOGI(TEST_TAG, "%*d|", 5, 42);
+    CHECK(fix.get_print_buffer_string().find("test:    42|") != string::npos);
+
+    fix.reset_buffer();
+    ESP_LOGI(TEST_TAG, "%.*s|", 3, "abcdef");
+    CHECK(fix.get_print_buffer_string().find("test: abc|") != string::npos);
+
+    fix.reset_buffer();
+    ESP_LOGI(TEST_TAG, "%.1Lf|", 2.5L);
+    CHECK(fix.get_print_buffer_string().find("test: 2.5|") != string::npos);
+
+    CHECK(esp_log_set_async(false));
+}
+
+static std::atomic<bool> s_block_output;
+
+static int blocking_print(const char *format, va_list args)
+{
+    while (s_block_output) {
+        usleep(100);
+    }
+    return 0;
+}
+
+TEST_CASE("async log drops messages when the queue is full")
+{
+    const int QUEUE_SIZE = 1 << (32 - __builtin_clz(CONFIG_LOG_ASYNC_QUEUE_SIZE - 1));
+    vprintf_like_t old_vprintf = esp_log_set_vprintf(blocking_print);
+    REQUIRE(esp_log_set_async(true));
+    uint32_t dropped = esp_log_async_get_dropped();
+
+    // The log thread takes at most one message and blocks in the output function
+    s_block_output = true;
+    for (int i = 0; i < QUEUE_SIZE * 2; i++) {
+        ESP_LOGI(TEST_TAG, "message %d", i);
+    }
+    dropped = esp_log_async_get_dropped() - dropped;
+    CHECK(dropped >= QUEUE_SIZE - 1);
+    CHECK(dropped <= QUEUE_SIZE);
+
+    s_block_output = false;
+    CHECK(esp_log_set_async(false));
+    esp_log_set_vprintf(old_vprintf);
+}
+
+static pthread_mutex_t s_order_mutex = PTHREAD_MUTEX_INITIALIZER;
+static string s_order_output;
+
+// Records the messages in the order their output starts, then blocks like blocking_print()
+static int recording_blocking_print(const char *format, va_list args)
+{
+    char buf[64];
+    vsnprintf(buf, sizeof(buf), format, args);
+    pthread_mutex_lock(&s_order_mutex);
+    s_order_output += buf;
+    pthread_mutex_unlock(&s_order_mutex);
+    while (s_block_output) {
+        usleep(100);
+    }
+    return 0;
+}
+
+static void *log_runtime_format(void *arg)
+{
+    // The format string is on the stack, the message is output synchronously
+    char format[16];
+    snprintf(format, sizeof(format), "%s|", "sync");
+    esp_log_write(ESP_LOG_INFO, TEST_TAG, format);
+    return nullptr;
+}
+
+TEST_CASE("async log outputs synchronous messages after the queued ones")
+{
+    vprintf_like_t old_vprintf = esp_log_set_vprintf(recording_blocking_print);
+    esp_log_level_set("*", ESP_LOG_INFO);
+    REQUIRE(esp_log_set_async(true));
+    s_order_output.clear();
+
+    // The log thread blocks in the output of the first message, the second one stays queued
+    s_block_output = true;
+    esp_log_write(ESP_LOG_INFO, TEST_TAG, "queued 1|");
+    usleep(10000);
+    esp_log_write(ESP_LOG_INFO, TEST_TAG, "queued 2|");
+    pthread_t thread;
+    REQUIRE(pthread_create(&thread, nullptr, log_runtime_format, nullptr) == 0);
+    usleep(10000);
+    s_block_output = false;
+    pthread_join(thread, nullptr);
+
+    CHECK(esp_log_set_async(false));
+    CHECK(s_order_output == "queued 1|queued 2|sync|");
+    esp_log_set_vprintf(old_vprintf);
+}
+
+static FILE *s_null_file;
+
+static int null_print(const char *format, va_list args)
+{
+    int ret = vfprintf(s_null_file, format, args);
+    fflush(s_null_file);
+    return ret;
+}
+
+TEST_CASE("async log call latency")
+{
+    const int BURSTS = 200;
+    const int BURST_SIZE = 8;
+    s_null_file = fopen("/dev/null", "w");
+    REQUIRE(s_null_file != nullptr);
+    vprintf_like_t old_vprintf = esp_log_set_vprintf(null_print);
+    esp_log_level_set("*", ESP_LOG_INFO);
+
+    for (int async = 0; async <= 1; async++) {
+        REQUIRE(esp_log_set_async(async));
+        uint32_t dropped = esp_log_async_get_dropped();
+        uint64_t total_ns = 0;
+        for (int i = 0; i < BURSTS; i++) {
+            for (int j = 0; j < BURST_SIZE; j++) {
+                uint64_t start = get_time_ns();
+                ESP_LOGI(TEST_TAG, "value %d of %s: %.3f", j, "burst", 0.5 * j);
+                total_ns += get_time_ns() - start;
+            }
+            // Let the log thread catch up, as the output would over a slow UART
+            usleep(200);
+        }
+        printf("%s: %" PRIu64 " ns per call, %" PRIu32 " dropped\n", async ? "async" : "sync",
+               total_ns / (BURSTS * BURST_SIZE), esp_log_async_get_dropped() - dropped);
+    }
+
+    CHECK(esp_log_set_async(false));
+    esp_log_set_vprintf(old_vprintf);
+    fclose(s_null_file);
+}
+#endif // CONFIG_LOG_ASYNC
+
+#if CONFIG_LOG_BINARY
+static string s_binary_output;
+
+static int binary_write_to_string(const void *data, size_t size)
+{
+    s_binary_output.append(static_cast<const char *>(data), size);
+    return size;
+}
+
+// Removes the header record written before the first message
+static string get_binary_output()
+{
+    if (!s_binary_output.empty() && (uint8_t) s_binary_output[0] == 0xFC) {
+        s_binary_output.erase(0, 2 + s_binary_output[1]);
+    }
+    return s_binary_output;
+}
+
+TEST_CASE("binary log encodes the arguments")
+{
+    static const char format[] = "value %d %s %.1f %p\n";
+    esp_log_binary_write_t old_write = esp_log_set_binary_write(binary_write_to_string);
+    s_binary_output.clear();
+    esp_log_level_set("*", ESP_LOG_INFO);
+
+    esp_log_write(ESP_LOG_INFO, TEST_TAG, format, -2, "abc", 1.5, (void *) 0x1234);
+
+    const void *format_ptr = format;
+    const double value = 1.5;
+    string expected;
+    expected.append(reinterpret_cast<const char *>(&format_ptr), sizeof(format_ptr));
+    expected += '\x03';                   // zigzag -2
+    expected += "\x04" "abc";             // length + 1, string
+    expected.append(reinterpret_cast<const char *>(&value), sizeof(value));
+    expected += "\xb4\x24";               // varint 0x1234
+    expected.insert(0, 1, (char) expected.size());
+    expected.insert(0, 1, '\xfe');
+    CHECK(get_binary_output() == expected);
+
+    esp_log_set_binary_write(old_write);
+}
+
+TEST_CASE("binary log outputs messages which can not be encoded as text")
+{
+    esp_log_binary_write_t old_write = esp_log_set_binary_write(binary_write_to_string);
+    s_binary_output.clear();
+    esp_log_level_set("*", ESP_LOG_INFO);
+
+    ESP_LOGI(TEST_TAG, "%*d|", 5, 42);
+    CHECK(get_binary_output().find("test:    42|") != string::npos);
+
+    esp_log_set_binary_write(old_write);
+}
+
+TEST_CASE("binary log outputs messages with a format string built at runtime as text")
+{
+    esp_log_binary_write_t old_write = esp_log_set_binary_write(binary_write_to_string);
+    s_binary_output.clear();
+    esp_log_level_set("*", ESP_LOG_INFO);
+
+    // The decoder can not find a format string on the stack in the ELF file
+    char format[32];
+    snprintf(format, sizeof(format), "%s %%d|", "runtime");
+    esp_log_write(ESP_LOG_INFO, TEST_TAG, format, 42);
+    CHECK(get_binary_output() == "runtime 42|");
+
+    esp_log_set_binary_write(old_write);
+}
+
+static pthread_mutex_t s_binary_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// Outputs the header slowly, so that the other threads log while it is written
+static int slow_header_write_to_string(const void *data, size_t size)
+{
+    if (*static_cast<const uint8_t *>(data) == 0xFC) {
+        usleep(10000);
+    }
+    pthread_mutex_lock(&s_binary_mutex);
+    binary_write_to_string(data, size);
+    pthread_mutex_unlock(&s_binary_mutex);
+    return size;
+}
+
+static void *log_binary_messages(void *arg)
+{
+    for (int i = 0; i < 10; i++) {
+        esp_log_write(ESP_LOG_INFO, TEST_TAG, "message %d\n", i);
+    }
+    return nullptr;
+}
+
+TEST_CASE("binary log outputs the header before the messages of all threads")
+{
+    const int THREADS = 4;
+    esp_log_level_set("*", ESP_LOG_INFO);
+    // The header is output again by each new write function
+    esp_log_binary_write_t old_write = esp_log_set_binary_write(slow_header_write_to_string);
+    s_binary_output.clear();
+
+    pthread_t threads[THREADS];
+    for (int i = 0; i < THREADS; i++) {
+        REQUIRE(pthread_create(&threads[i], nullptr, log_binary_messages, nullptr) == 0);
+    }
+    for (int i = 0; i < THREADS; i++) {
+        pthread_join(threads[i], nullptr);
+    }
+
+    // Markers of the records, the lengths are less than 0x80
+    string markers;
+    for (size_t pos = 0; pos + 1 < s_binary_output.size(); pos += 2 + (uint8_t) s_binary_output[pos + 1]) {
+        markers += s_binary_output[pos];
+    }
+    CHECK(markers == "\xfc" + string(THREADS * 10, '\xfe'));
+
+    esp_log_set_binary_write(old_write);
+}
+
+// The output is not written anywhere, to compare the time spent in the log call
+static char s_text_output[256];
+static size_t s_binary_size;
+
+// What esp_log_write() does without CONFIG_LOG_BINARY
+static int text_write(const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    int ret = vsnprintf(s_text_output, sizeof(s_text_output), format, args);
+    va_end(args);
+    return ret;
+}
+
+static int count_binary_write(const void *data, size_t size)
+{
+    s_binary_size += size;
+    return size;
+}
+
+TEST_CASE("binary log size and call latency")
+{
+    const int COUNT = 2000;
+    esp_log_binary_write_t old_write = esp_log_set_binary_write(count_binary_write);
+    esp_log_level_set("*", ESP_LOG_INFO);
+
+    size_t text_size = 0;
+    uint64_t start = get_time_ns();
+    for (int i = 0; i < COUNT; i++) {
+        text_size += text_write(LOG_FORMAT(I, "connected to %s, channel %d, rssi %d dBm, %" PRIu32 " bytes received"),
+                                esp_log_timestamp(), TEST_TAG, "ap", i % 13, -40 - i % 50, (uint32_t) i * 1000);
+    }
+    uint64_t text_ns = get_time_ns() - start;
+
+    s_binary_size = 0;
+    start = get_time_ns();
+    for (int i = 0; i < COUNT; i++) {
+        ESP_LOGI(TEST_TAG, "connected to %s, channel %d, rssi %d dBm, %" PRIu32 " bytes received",
+                 "ap", i % 13, -40 - i % 50, (uint32_t) i * 1000);
+    }
+    uint64_t binary_ns = get_time_ns() - start;
+
+    printf("text: %zu bytes, %" PRIu64 " ns per message\n", text_size / COUNT, text_ns / COUNT);
+    printf("binary: %zu bytes, %" PRIu64 " ns per message\n", s_binary_size / COUNT, binary_ns / COUNT);
+    CHECK(s_binary_size < text_size);
+
+    esp_log_set_binary_write(old_write);
+}
+#endif // CONFIG_LOG_BINARY
+
+#if !CONFIG_LOG_TAG_LEVEL_IMPL_NONE
+static vector<string> make_tags(size_t count)
+{
+    vector<string> tags;
+    for (size_t i = 0; i < count; i++) {
+        tags.push_back("tag_" + to_string(i));
+    }
+    return tags;
+}
+
+TEST_CASE("tag log levels of many tags")
+{
+    const size_t COUNT = 100;
+    vector<string> tags = make_tags(COUNT);
+    // the same tags at different addresses
+    vector<string> copies = make_tags(COUNT);
+    esp_log_level_set("*", ESP_LOG_INFO);
+    for (size_t i = 0; i < COUNT; i += 2) {
+        esp_log_level_set(tags[i].c_str(), (i % 4) ? ESP_LOG_WARN : ESP_LOG_DEBUG);
+    }
+
+    for (int pass = 0; pass < 2; pass++) {
+        for (size_t i = 0; i < COUNT; i++) {
+            esp_log_level_t expected = (i % 2) ? ESP_LOG_INFO : (i % 4) ? ESP_LOG_WARN : ESP_LOG_DEBUG;
+            CHECK(esp_log_level_get(tags[i].c_str()) == expected);
+            CHECK(esp_log_level_get(copies[i].c_str()) == expected);
+        }
+    }
+
+    // a tag which was already looked up with the default level
+    esp_log_level_set(tags[1].c_str(), ESP_LOG_ERROR);
+    CHECK(esp_log_level_get(tags[1].c_str()) == ESP_LOG_ERROR);
+    esp_log_level_set(tags[0].c_str(), ESP_LOG_VERBOSE);
+    CHECK(esp_log_level_get(tags[0].c_str()) == ESP_LOG_VERBOSE);
+
+    esp_log_level_set("*", ESP_LOG_WARN);
+    for (size_t i = 0; i < COUNT; i++) {
+        CHECK(esp_log_level_get(tags[i].c_str()) == ESP_LOG_WARN);
+    }
+    esp_log_level_set("*", ESP_LOG_INFO);
+}
+
+TEST_CASE("tag log level lookup rate")
+{
+    const size_t LOOKUPS = 200000;
+    for (size_t count : {8, 32, 128}) {
+        vector<string> tags = make_tags(count);
+        esp_log_level_set("*", ESP_LOG_INFO);
+        for (size_t i = 0; i < count; i += 2) {
+            esp_log_level_set(tags[i].c_str(), ESP_LOG_WARN);
+        }
+
+        // lookups of the tags in turn, as from different modules
+        unsigned levels = 0;
+        uint64_t start = get_time_ns();
+        for (size_t i = 0; i < LOOKUPS; i++) {
+            levels += esp_log_level_get(tags[i % count].c_str());
+        }
+        uint64_t elapsed_ns = get_time_ns() - start;
+        CHECK(levels == LOOKUPS / 2 * (ESP_LOG_INFO + ESP_LOG_WARN));
+
+        printf("%zu tags: %" PRIu64 " lookups/s\n", count, (uint64_t) LOOKUPS * 1000000000 / (elapsed_ns + 1));
+    }
+    esp_log_level_set("*", ESP_LOG_INFO);
+}
+#endif // !CONFIG_LOG_TAG_LEVEL_IMPL_NONE
@@ -1,4 +1,4 @@
-# SPDX-FileCopyrightText: 2023-2024 Espressif Systems (Shanghai) CO LTD
+# SPDX-FileCopyrightText: 2023-2025 Espressif Systems (Shanghai) CO LTD
 # SPDX-License-Identifier: Unlicense OR CC0-1.0
 import pytest
 from pytest_embedded import Dut
@@ -12,6 +12,9 @@ from pytest_embedded import Dut
     'tag_level_linked_list',
     'tag_level_linked_list_and_array_cache',
     'tag_level_none',
+    'tag_level_hash_table',
+    'async',
+    'binary',
 ], indirect=True)
 def test_log_linux(dut: Dut) -> None:
     dut.expect_exact('All tests passed', timeout=5)
@@ -1,14 +1,17 @@
 /*
- * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
 
 #pragma once
 
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdarg.h>
 #include "esp_log_level.h"
+#include "sdkconfig.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -67,6 +70,68 @@ void esp_log_write(esp_log_level_t level, const char* tag, const char* format, .
  */
 void esp_log_writev(esp_log_level_t level, const char* tag, const char* format, va_list args);
 
+#if CONFIG_LOG_ASYNC || __DOXYGEN__
+
+/**
+ * @brief Enable or disable asynchronous log output
+ *
+ * In asynchronous mode, esp_log_write() and esp_log_writev() do not format the message. They queue the format
+ * string pointer, the timestamp and a copy of the arguments in a lock-free queue of the calling CPU and return.
+ * A low-priority task formats the queued messages in timestamp order and outputs them through the function set
+ * by esp_log_set_vprintf(). Messages which can not be deferred (see CONFIG_LOG_ASYNC) are output synchronously.
+ *
+ * The queues and the log task are created when asynchronous mode is enabled for the first time.
+ * Disabling it outputs the queued messages with esp_log_async_flush() and waits until the log task has
+ * finished outputting the message it was processing, so all messages logged before are output on return.
+ *
+ * @note Messages from different CPUs logged within the same timestamp period may be output out of order.
+ *
+ * @param enable true to enable asynchronous output, false to return to synchronous output.
+ *
+ * @return true on success, false if the queues or the log task could not be created.
+ */
+bool esp_log_set_async(bool enable);
+
+/**
+ * @brief Output all queued log messages from the calling context
+ *
+ * It does not block nor use any RTOS functions, so it can be used in panic and shutdown handlers
+ * (e.g. registered with esp_register_shutdown_handler()) to output the messages before the system stops.
+ * A message being output by the log task at the same time may appear after the flushed messages.
+ */
+void esp_log_async_flush(void);
+
+/**
+ * @brief Get the number of log messages dropped because a queue was full
+ *
+ * @return Number of dropped messages since startup.
+ */
+uint32_t esp_log_async_get_dropped(void);
+
+#endif // CONFIG_LOG_ASYNC || __DOXYGEN__
+
+#if CONFIG_LOG_BINARY || __DOXYGEN__
+
+typedef int (*esp_log_binary_write_t)(const void *data, size_t size);
+
+/**
+ * @brief Set function used to output binary log records
+ *
+ * With CONFIG_LOG_BINARY, esp_log_write() and esp_log_writev() output binary records instead of text.
+ * By default, they are written to stdout. This function can be used to redirect them to some other
+ * destination, such as file or network. The output has to be decoded with tools/esp_log_decode.py.
+ *
+ * @note The function can be invoked in parallel from multiple tasks context. Each call contains a complete record.
+ *       The first record written by a new function is the header the decoder needs, no message is output before it.
+ *
+ * @param func new Function used for output.
+ *
+ * @return func old Function used for output.
+ */
+esp_log_binary_write_t esp_log_set_binary_write(esp_log_binary_write_t func);
+
+#endif // CONFIG_LOG_BINARY || __DOXYGEN__
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,64 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdarg.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Queue a message for asynchronous output.
+ *
+ * @param format Format string of the message. It has to stay valid until the message is output.
+ * @param args   Arguments of the message. They are not consumed.
+ *
+ * @return true if the message was queued or dropped, false if it has to be output synchronously.
+ */
+bool esp_log_async_write(const char *format, va_list args);
+
+/**
+ * @brief Prepare the synchronous output of a message which was not queued.
+ *
+ * Outputs the queued messages and keeps the log task from outputting others until esp_log_async_sync_end()
+ * is called, so that the message is output after the messages logged before it. Does nothing if asynchronous
+ * output is disabled or the caller can not block, e.g. in an ISR.
+ *
+ * @return true if esp_log_async_sync_end() has to be called once the message is output.
+ */
+bool esp_log_async_sync_begin(void);
+
+/**
+ * @brief Let the log task output the queued messages again, see esp_log_async_sync_begin().
+ */
+void esp_log_async_sync_end(void);
+
+/**
+ * @brief Format and output queued messages until the queues are empty. Never returns.
+ *
+ * It is run by the log task created by esp_log_async_impl_start_worker().
+ */
+void esp_log_async_worker_loop(void);
+
+/**
+ * @brief Output a formatted message through the function set by esp_log_set_vprintf().
+ */
+void esp_log_write_str(const char *str);
+
+/* Implemented per system target */
+bool esp_log_async_impl_start_worker(void);
+void esp_log_async_impl_wait(void);
+void esp_log_async_impl_notify(void);
+void esp_log_async_impl_delay(void);
+bool esp_log_async_impl_can_block(void);
+unsigned esp_log_async_impl_core_id(void);
+
+#ifdef __cplusplus
+}
+#endif
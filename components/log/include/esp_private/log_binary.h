@@ -0,0 +1,25 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdarg.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Output a message as a binary record, or as text if it can not be encoded.
+ *
+ * @param format Format string of the message.
+ * @param args   Arguments of the message.
+ */
+void esp_log_binary_writev(const char *format, va_list args);
+
+#ifdef __cplusplus
+}
+#endif
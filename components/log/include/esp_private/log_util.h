@@ -1,11 +1,13 @@
 /*
- * SPDX-FileCopyrightText: 2023-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2023-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
 
 #pragma once
 
+#include <stdbool.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -64,6 +66,49 @@ int esp_log_util_cvt_hex(unsigned long long val, int pad, char *buf);
  */
 int esp_log_util_cvt_dec(unsigned long long val, int pad, char *buf);
 
+/**
+ * @brief Type of the argument of a printf conversion specification.
+ */
+typedef enum {
+    ESP_LOG_UTIL_ARG_NONE,      /*!< Conversion without argument, i.e. "%%" */
+    ESP_LOG_UTIL_ARG_INT,       /*!< int, also for the promoted char and short types */
+    ESP_LOG_UTIL_ARG_LONG,      /*!< long */
+    ESP_LOG_UTIL_ARG_LLONG,     /*!< long long */
+    ESP_LOG_UTIL_ARG_INTMAX,    /*!< intmax_t */
+    ESP_LOG_UTIL_ARG_SIZE,      /*!< size_t */
+    ESP_LOG_UTIL_ARG_PTRDIFF,   /*!< ptrdiff_t */
+    ESP_LOG_UTIL_ARG_DOUBLE,    /*!< double */
+    ESP_LOG_UTIL_ARG_PTR,       /*!< void pointer */
+    ESP_LOG_UTIL_ARG_STR,       /*!< char pointer */
+} esp_log_util_arg_type_t;
+
+/**
+ * @brief Parse a printf conversion specification.
+ *
+ * It is used to process the arguments of a log message without formatting it.
+ *
+ * @param[in]  p         Pointer to the character after the '%'.
+ * @param[out] type      Type of the argument of the conversion.
+ * @param[out] precision The precision, or -1 if it is not given.
+ *
+ * @return Pointer to the character after the conversion specification, or NULL if it is not supported.
+ *         Not supported are '*' width or precision, "%n", long double and wide character conversions.
+ */
+const char *esp_log_util_parse_spec(const char *p, esp_log_util_arg_type_t *type, int *precision);
+
+/**
+ * @brief Check if a pointer points to a read-only segment of the executable (linux target only).
+ *
+ * It replaces esp_ptr_in_drom() on the linux target: string literals are in read-only segments, while strings
+ * built at runtime are on the stack, in the heap or in writable data, and may be gone when a deferred message
+ * is output.
+ *
+ * @param[in] ptr Pointer to check.
+ *
+ * @return true if ptr points to read-only data or code of the executable.
+ */
+bool esp_log_util_ptr_in_rodata(const void *ptr);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,490 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/param.h>
+#include "esp_log_write.h"
+#include "esp_log_timestamp.h"
+#include "esp_private/log_async.h"
+#include "esp_private/log_lock.h"
+#include "esp_private/log_util.h"
+#include "sdkconfig.h"
+
+#if CONFIG_IDF_TARGET_LINUX
+#define LOG_ASYNC_NUM_QUEUES    1
+#else
+#define LOG_ASYNC_NUM_QUEUES    CONFIG_FREERTOS_NUMBER_OF_CORES
+#endif
+
+/* CONFIG_LOG_ASYNC_QUEUE_SIZE rounded up to a power of two */
+#define LOG_ASYNC_QUEUE_SIZE    (1U << (32 - __builtin_clz(CONFIG_LOG_ASYNC_QUEUE_SIZE - 1)))
+#define LOG_ASYNC_QUEUE_MASK    (LOG_ASYNC_QUEUE_SIZE - 1)
+
+/* Maximum length of a single conversion specification, e.g. "%-08.3lld" */
+#define LOG_ASYNC_SPEC_SIZE     16
+
+/* Size of the buffer a message is formatted into. Longer messages are output in several pieces. */
+#define LOG_ASYNC_LINE_SIZE     256
+
+/* String argument offset representing a NULL pointer */
+#define LOG_ASYNC_NULL_STR      SIZE_MAX
+
+typedef union {
+    int i;
+    long l;
+    long long ll;
+    intmax_t j;
+    size_t z;                   /* also the offset of an ESP_LOG_UTIL_ARG_STR */
+    ptrdiff_t t;
+    double d;
+    const void *p;
+} log_async_arg_t;
+
+typedef struct {
+    const char *format;
+    uint32_t timestamp;
+    uint8_t arg_count;
+    uint8_t types[CONFIG_LOG_ASYNC_MAX_ARGS];
+    log_async_arg_t args[CONFIG_LOG_ASYNC_MAX_ARGS];
+    char strings[CONFIG_LOG_ASYNC_STRING_SIZE];     /* only the used part is copied */
+} log_async_msg_t;
+
+/* A cell is free for the producer at position pos when seq == pos, and holds a message for the consumer
+ * when seq == pos + 1. Producers and consumers claim positions with a CAS on enqueue_pos and dequeue_pos. */
+typedef struct {
+    uint32_t seq;
+    log_async_msg_t msg;
+} log_async_cell_t;
+
+typedef struct {
+    uint32_t enqueue_pos;
+    uint32_t dequeue_pos;
+    log_async_cell_t *cells;
+} log_async_queue_t;
+
+static log_async_queue_t s_queues[LOG_ASYNC_NUM_QUEUES];
+static bool s_initialized;
+static bool s_enabled;
+static bool s_worker_waiting;
+static bool s_output_taken;     /* set while messages are taken from the queues and output */
+static uint32_t s_dropped;
+
+typedef struct {
+    char buf[LOG_ASYNC_LINE_SIZE];
+    size_t len;
+} log_async_line_t;
+
+/* Copies the arguments of a message. Returns the number of bytes of msg to queue, or 0 if it can not be deferred. */
+static size_t log_async_capture(log_async_msg_t *msg, const char *format, va_list args)
+{
+    size_t strings_len = 0;
+    msg->format = format;
+    msg->arg_count = 0;
+    for (const char *p = format; (p = strchr(p, '%')) != NULL;) {
+        const char *spec = p;
+        esp_log_util_arg_type_t type;
+        int precision;
+        p = esp_log_util_parse_spec(p + 1, &type, &precision);
+        if (p == NULL || p - spec >= LOG_ASYNC_SPEC_SIZE) {
+            return 0;
+        }
+        if (type == ESP_LOG_UTIL_ARG_NONE) {
+            continue;
+        }
+        if (msg->arg_count == CONFIG_LOG_ASYNC_MAX_ARGS) {
+            return 0;
+        }
+        log_async_arg_t *arg = &msg->args[msg->arg_count];
+        msg->types[msg->arg_count++] = type;
+        switch (type) {
+        case ESP_LOG_UTIL_ARG_INT:
+            arg->i = va_arg(args, int);
+            break;
+        case ESP_LOG_UTIL_ARG_LONG:
+            arg->l = va_arg(args, long);
+            break;
+        case ESP_LOG_UTIL_ARG_LLONG:
+            arg->ll = va_arg(args, long long);
+            break;
+        case ESP_LOG_UTIL_ARG_INTMAX:
+            arg->j = va_arg(args, intmax_t);
+            break;
+        case ESP_LOG_UTIL_ARG_SIZE:
+            arg->z = va_arg(args, size_t);
+            break;
+        case ESP_LOG_UTIL_ARG_PTRDIFF:
+            arg->t = va_arg(args, ptrdiff_t);
+            break;
+        case ESP_LOG_UTIL_ARG_DOUBLE:
+            arg->d = va_arg(args, double);
+            break;
+        case ESP_LOG_UTIL_ARG_PTR:
+            arg->p = va_arg(args, const void *);
+            break;
+        case ESP_LOG_UTIL_ARG_STR: {
+            const char *str = va_arg(args, const char *);
+            if (str == NULL) {
+                arg->z = LOG_ASYNC_NULL_STR;
+                break;
+            }
+            size_t len = strnlen(str, (precision < 0) ? SIZE_MAX : (size_t)precision);
+            if (len >= sizeof(msg->strings) - strings_len) {
+                return 0;
+            }
+            memcpy(msg->strings + strings_len, str, len);
+            msg->strings[strings_len + len] = '\0';
+            arg->z = strings_len;
+            strings_len += len + 1;
+            break;
+        }
+        default:
+            break;
+        }
+    }
+    return offsetof(log_async_msg_t, strings) + strings_len;
+}
+
+static bool log_async_push(log_async_queue_t *queue, const log_async_msg_t *msg, size_t size)
+{
+    uint32_t pos = __atomic_load_n(&queue->enqueue_pos, __ATOMIC_RELAXED);
+    while (true) {
+        log_async_cell_t *cell = &queue->cells[pos & LOG_ASYNC_QUEUE_MASK];
+        int32_t diff = (int32_t)(__atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE) - pos);
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&queue->enqueue_pos, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                memcpy(&cell->msg, msg, size);
+                __atomic_store_n(&cell->seq, pos + 1, __ATOMIC_RELEASE);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false; // full
+        } else {
+            pos = __atomic_load_n(&queue->enqueue_pos, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+static bool log_async_pop(log_async_queue_t *queue, log_async_msg_t *msg)
+{
+    uint32_t pos = __atomic_load_n(&queue->dequeue_pos, __ATOMIC_RELAXED);
+    while (true) {
+        log_async_cell_t *cell = &queue->cells[pos & LOG_ASYNC_QUEUE_MASK];
+        int32_t diff = (int32_t)(__atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE) - (pos + 1));
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&queue->dequeue_pos, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                *msg = cell->msg;
+                __atomic_store_n(&cell->seq, pos + LOG_ASYNC_QUEUE_SIZE, __ATOMIC_RELEASE);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false; // empty
+        } else {
+            pos = __atomic_load_n(&queue->dequeue_pos, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+/* Gets the timestamp of the first message of the queue, returns false if the queue is empty. */
+static bool log_async_peek(log_async_queue_t *queue, uint32_t *timestamp)
+{
+    uint32_t pos = __atomic_load_n(&queue->dequeue_pos, __ATOMIC_RELAXED);
+    log_async_cell_t *cell = &queue->cells[pos & LOG_ASYNC_QUEUE_MASK];
+    if (__atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE) != pos + 1) {
+        return false;
+    }
+    // It may be overwritten if another consumer takes the message, then log_async_pop() gets the next one.
+    *timestamp = __atomic_load_n(&cell->msg.timestamp, __ATOMIC_RELAXED);
+    return true;
+}
+
+/* Takes the oldest message of all queues */
+static bool log_async_pop_oldest(log_async_msg_t *msg)
+{
+    while (true) {
+        log_async_queue_t *oldest = NULL;
+        uint32_t oldest_timestamp = 0;
+        for (int i = 0; i < LOG_ASYNC_NUM_QUEUES; i++) {
+            uint32_t timestamp;
+            if (log_async_peek(&s_queues[i], &timestamp) &&
+                    (oldest == NULL || (int32_t)(timestamp - oldest_timestamp) < 0)) {
+                oldest = &s_queues[i];
+                oldest_timestamp = timestamp;
+            }
+        }
+        if (oldest == NULL) {
+            return false;
+        }
+        if (log_async_pop(oldest, msg)) {
+            return true;
+        }
+    }
+}
+
+static bool log_async_queues_empty(void)
+{
+    uint32_t timestamp;
+    for (int i = 0; i < LOG_ASYNC_NUM_QUEUES; i++) {
+        if (log_async_peek(&s_queues[i], &timestamp)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void log_async_line_flush(log_async_line_t *line)
+{
+    if (line->len > 0) {
+        line->buf[line->len] = '\0';
+        esp_log_write_str(line->buf);
+        line->len = 0;
+    }
+}
+
+static void log_async_line_append(log_async_line_t *line, const char *str, size_t len)
+{
+    while (len > 0) {
+        if (line->len == sizeof(line->buf) - 1) {
+            log_async_line_flush(line);
+        }
+        size_t n = MIN(len, sizeof(line->buf) - 1 - line->len);
+        memcpy(line->buf + line->len, str, n);
+        line->len += n;
+        str += n;
+        len -= n;
+    }
+}
+
+static int log_async_format_arg(char *buf, size_t size, const char *spec, esp_log_util_arg_type_t type,
+                                const log_async_arg_t *arg, const char *strings)
+{
+    switch (type) {
+    case ESP_LOG_UTIL_ARG_INT:
+        return snprintf(buf, size, spec, arg->i);
+    case ESP_LOG_UTIL_ARG_LONG:
+        return snprintf(buf, size, spec, arg->l);
+    case ESP_LOG_UTIL_ARG_LLONG:
+        return snprintf(buf, size, spec, arg->ll);
+    case ESP_LOG_UTIL_ARG_INTMAX:
+        return snprintf(buf, size, spec, arg->j);
+    case ESP_LOG_UTIL_ARG_SIZE:
+        return snprintf(buf, size, spec, arg->z);
+    case ESP_LOG_UTIL_ARG_PTRDIFF:
+        return snprintf(buf, size, spec, arg->t);
+    case ESP_LOG_UTIL_ARG_DOUBLE:
+        return snprintf(buf, size, spec, arg->d);
+    case ESP_LOG_UTIL_ARG_PTR:
+        return snprintf(buf, size, spec, arg->p);
+    case ESP_LOG_UTIL_ARG_STR:
+        return snprintf(buf, size, spec, (arg->z == LOG_ASYNC_NULL_STR) ? NULL : strings + arg->z);
+    default:
+        return snprintf(buf, size, "%%");
+    }
+}
+
+static void log_async_output(const log_async_msg_t *msg)
+{
+    log_async_line_t line;
+    line.len = 0;
+    int arg_idx = 0;
+    const char *p = msg->format;
+    while (*p != '\0') {
+        size_t literal_len = strcspn(p, "%");
+        log_async_line_append(&line, p, literal_len);
+        p += literal_len;
+        if (*p == '\0') {
+            break;
+        }
+
+        // The format was checked by log_async_capture()
+        char spec[LOG_ASYNC_SPEC_SIZE];
+        esp_log_util_arg_type_t type;
+        int precision;
+        const char *end = esp_log_util_parse_spec(p + 1, &type, &precision);
+        memcpy(spec, p, end - p);
+        spec[end - p] = '\0';
+        p = end;
+        const log_async_arg_t *arg = NULL;
+        if (type != ESP_LOG_UTIL_ARG_NONE) {
+            arg = &msg->args[arg_idx++];
+        }
+
+        size_t space = sizeof(line.buf) - line.len;
+        int len = log_async_format_arg(line.buf + line.len, space, spec, type, arg, msg->strings);
+        if (len >= (int)space) {
+            log_async_line_flush(&line);
+            // A single conversion longer than the line buffer is truncated
+            len = MIN(log_async_format_arg(line.buf, sizeof(line.buf), spec, type, arg, msg->strings),
+                      (int)sizeof(line.buf) - 1);
+        }
+        if (len > 0) {
+            line.len += len;
+        }
+    }
+    log_async_line_flush(&line);
+}
+
+/* Gets the right to take messages from the queues and output them, so that they are output in order.
+ * Returns false if it is held by another task and wait is false. */
+static bool log_async_output_take(bool wait)
+{
+    while (__atomic_exchange_n(&s_output_taken, true, __ATOMIC_ACQUIRE)) {
+        if (!wait) {
+            return false;
+        }
+        esp_log_async_impl_delay();
+    }
+    return true;
+}
+
+static void log_async_output_give(void)
+{
+    __atomic_store_n(&s_output_taken, false, __ATOMIC_RELEASE);
+}
+
+static void log_async_drain(void)
+{
+    log_async_msg_t msg;
+    while (log_async_pop_oldest(&msg)) {
+        log_async_output(&msg);
+    }
+}
+
+bool esp_log_async_write(const char *format, va_list args)
+{
+    if (!__atomic_load_n(&s_enabled, __ATOMIC_ACQUIRE)) {
+        return false;
+    }
+    log_async_msg_t msg;
+    va_list args_copy;
+    va_copy(args_copy, args);
+    size_t size = log_async_capture(&msg, format, args_copy);
+    va_end(args_copy);
+    if (size == 0) {
+        return false;
+    }
+    msg.timestamp = esp_log_timestamp();
+
+    if (!log_async_push(&s_queues[esp_log_async_impl_core_id()], &msg, size)) {
+        __atomic_fetch_add(&s_dropped, 1, __ATOMIC_RELAXED);
+        return true;
+    }
+    // Pairs with the fence in esp_log_async_worker_loop(): either the worker sees the message before it waits,
+    // or it is seen waiting here.
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&s_worker_waiting, __ATOMIC_RELAXED) &&
+            __atomic_exchange_n(&s_worker_waiting, false, __ATOMIC_RELAXED)) {
+        esp_log_async_impl_notify();
+    }
+    return true;
+}
+
+void esp_log_async_worker_loop(void)
+{
+    while (true) {
+        // Given back after each message, so that a synchronous message waits for one message at most
+        log_async_msg_t msg;
+        while (true) {
+            log_async_output_take(true);
+            bool popped = log_async_pop_oldest(&msg);
+            if (popped) {
+                log_async_output(&msg);
+            }
+            log_async_output_give();
+            if (!popped) {
+                break;
+            }
+        }
+        __atomic_store_n(&s_worker_waiting, true, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if (log_async_queues_empty()) {
+            esp_log_async_impl_wait();
+        }
+        __atomic_store_n(&s_worker_waiting, false, __ATOMIC_RELAXED);
+    }
+}
+
+static bool log_async_init(void)
+{
+    log_async_cell_t *cells = calloc(LOG_ASYNC_NUM_QUEUES * LOG_ASYNC_QUEUE_SIZE, sizeof(log_async_cell_t));
+    if (cells == NULL) {
+        return false;
+    }
+    for (int i = 0; i < LOG_ASYNC_NUM_QUEUES; i++) {
+        s_queues[i].cells = &cells[i * LOG_ASYNC_QUEUE_SIZE];
+        for (uint32_t pos = 0; pos < LOG_ASYNC_QUEUE_SIZE; pos++) {
+            s_queues[i].cells[pos].seq = pos;
+        }
+    }
+    if (!esp_log_async_impl_start_worker()) {
+        for (int i = 0; i < LOG_ASYNC_NUM_QUEUES; i++) {
+            s_queues[i].cells = NULL;
+        }
+        free(cells);
+        return false;
+    }
+    __atomic_store_n(&s_initialized, true, __ATOMIC_RELEASE);
+    return true;
+}
+
+static void log_async_flush(bool wait)
+{
+    if (__atomic_load_n(&s_initialized, __ATOMIC_ACQUIRE)) {
+        bool taken = log_async_output_take(wait);
+        log_async_drain();
+        if (taken) {
+            log_async_output_give();
+        }
+    }
+}
+
+bool esp_log_set_async(bool enable)
+{
+    bool ret = true;
+    esp_log_impl_lock();
+    if (enable && !s_initialized) {
+        ret = log_async_init();
+    }
+    if (ret) {
+        __atomic_store_n(&s_enabled, enable, __ATOMIC_RELEASE);
+    }
+    esp_log_impl_unlock();
+    if (!enable) {
+        // Also waits for the message the log task may be outputting
+        log_async_flush(true);
+    }
+    return ret;
+}
+
+void esp_log_async_flush(void)
+{
+    // Without waiting, the messages are output even if the log task is outputting one
+    log_async_flush(false);
+}
+
+bool esp_log_async_sync_begin(void)
+{
+    if (!__atomic_load_n(&s_enabled, __ATOMIC_ACQUIRE) || !esp_log_async_impl_can_block()) {
+        return false;
+    }
+    log_async_output_take(true);
+    log_async_drain();
+    return true;
+}
+
+void esp_log_async_sync_end(void)
+{
+    log_async_output_give();
+}
+
+uint32_t esp_log_async_get_dropped(void)
+{
+    return __atomic_load_n(&s_dropped, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,282 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Binary log records, decoded by tools/esp_log_decode.py
+ *
+ * A record starts with a marker byte, which does not occur in UTF-8 text, followed by the length of the
+ * rest of the record as varint:
+ *
+ * - LOG_BINARY_MARKER_HEADER: version (1 byte), pointer size (1 byte), address of esp_log_writev() (pointer).
+ *   Output before the first record written by each write function. The decoder uses it to relocate addresses of
+ *   position-independent executables.
+ * - LOG_BINARY_MARKER_MESSAGE: address of the format string (pointer), followed by the arguments:
+ *   integers as zigzag varint, pointers as varint, doubles as 8 bytes, strings as varint N followed by
+ *   either N - 1 bytes of the string or, if N is 0, the address of a string in flash (varint, 0 for NULL).
+ *
+ * Pointers and doubles are little endian. Messages which can not be encoded are output as text.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log_write.h"
+#include "esp_private/log_binary.h"
+#include "esp_private/log_lock.h"
+#include "esp_private/log_util.h"
+#include "sdkconfig.h"
+
+#ifndef CONFIG_IDF_TARGET_LINUX
+#include "esp_memory_utils.h"  // for esp_ptr_in_drom
+
+static inline bool log_binary_format_in_elf(const char *format)
+{
+    return esp_ptr_in_drom(format);
+}
+
+static inline bool log_binary_str_in_elf(const char *str)
+{
+    return esp_ptr_in_drom(str);
+}
+#else // !CONFIG_IDF_TARGET_LINUX
+// The decoder only finds strings in the read-only segments of the executable. Format strings built at runtime
+// are output as text. String arguments are always copied.
+static inline bool log_binary_format_in_elf(const char *format)
+{
+    return esp_log_util_ptr_in_rodata(format);
+}
+
+static inline bool log_binary_str_in_elf(const char *str)
+{
+    (void) str;
+    return false;
+}
+#endif // !CONFIG_IDF_TARGET_LINUX
+
+#define LOG_BINARY_VERSION          1
+#define LOG_BINARY_MARKER_HEADER    0xFC
+#define LOG_BINARY_MARKER_MESSAGE   0xFE
+
+/* Maximum size of a record, longer messages are output as text */
+#define LOG_BINARY_RECORD_SIZE      128
+/* Space for the marker and the length */
+#define LOG_BINARY_PREFIX_SIZE      3
+/* Size of the stack buffer for messages output as text, longer ones are formatted into a heap buffer */
+#define LOG_BINARY_TEXT_SIZE        128
+
+typedef struct {
+    uint8_t buf[LOG_BINARY_RECORD_SIZE];
+    size_t len;
+    bool overflow;
+} log_binary_record_t;
+
+static int log_binary_write_stdout(const void *data, size_t size);
+
+static esp_log_binary_write_t s_log_binary_write = &log_binary_write_stdout;
+/* Set once the header is output by s_log_binary_write, cleared when the write function changes */
+static bool s_header_written;
+
+static int log_binary_write_stdout(const void *data, size_t size)
+{
+    size_t ret = fwrite(data, 1, size, stdout);
+    fflush(stdout);
+    return ret;
+}
+
+esp_log_binary_write_t esp_log_set_binary_write(esp_log_binary_write_t func)
+{
+    esp_log_impl_lock();
+    esp_log_binary_write_t orig_func = s_log_binary_write;
+    // A writer which sees the new function also sees the header as not written
+    __atomic_store_n(&s_header_written, false, __ATOMIC_RELAXED);
+    __atomic_store_n(&s_log_binary_write, func, __ATOMIC_RELEASE);
+    esp_log_impl_unlock();
+    return orig_func;
+}
+
+static void log_binary_put(log_binary_record_t *record, const void *data, size_t size)
+{
+    if (size > sizeof(record->buf) - record->len) {
+        record->overflow = true;
+        return;
+    }
+    memcpy(record->buf + record->len, data, size);
+    record->len += size;
+}
+
+static void log_binary_put_varint(log_binary_record_t *record, uint64_t value)
+{
+    uint8_t bytes[10];
+    size_t len = 0;
+    while (value >= 0x80) {
+        bytes[len++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    bytes[len++] = (uint8_t) value;
+    log_binary_put(record, bytes, len);
+}
+
+static void log_binary_put_int(log_binary_record_t *record, int64_t value)
+{
+    log_binary_put_varint(record, ((uint64_t) value << 1) ^ (uint64_t)(value >> 63));
+}
+
+static void log_binary_put_ptr(log_binary_record_t *record, const void *ptr)
+{
+    // Little endian on all targets
+    log_binary_put(record, &ptr, sizeof(ptr));
+}
+
+static void log_binary_begin(log_binary_record_t *record)
+{
+    record->len = LOG_BINARY_PREFIX_SIZE;
+    record->overflow = false;
+}
+
+/* Adds marker and length in front of the data and outputs the record */
+static void log_binary_end(log_binary_record_t *record, uint8_t marker, esp_log_binary_write_t write)
+{
+    size_t size = record->len - LOG_BINARY_PREFIX_SIZE;
+    size_t start = (size < 0x80) ? 1 : 0;
+    record->buf[start] = marker;
+    if (size < 0x80) {
+        record->buf[start + 1] = (uint8_t) size;
+    } else {
+        record->buf[start + 1] = (uint8_t)(size | 0x80);
+        record->buf[start + 2] = (uint8_t)(size >> 7);
+    }
+    (*write)(record->buf + start, record->len - start);
+}
+
+/* Outputs the header if the current write function has not output it yet.
+ * The other writers wait on the lock, so that none of them outputs a message before the header.
+ * Only a write function which logs itself times out on the lock, its message is output without waiting. */
+static void log_binary_write_header(void)
+{
+    if (__atomic_load_n(&s_header_written, __ATOMIC_ACQUIRE)) {
+        return;
+    }
+    if (!esp_log_impl_lock_timeout()) {
+        return;
+    }
+    if (!__atomic_load_n(&s_header_written, __ATOMIC_RELAXED)) {
+        log_binary_record_t record;
+        log_binary_begin(&record);
+        const uint8_t version[2] = { LOG_BINARY_VERSION, sizeof(void *) };
+        log_binary_put(&record, version, sizeof(version));
+        log_binary_put_ptr(&record, (const void *) &esp_log_writev);
+        log_binary_end(&record, LOG_BINARY_MARKER_HEADER, s_log_binary_write);
+        __atomic_store_n(&s_header_written, true, __ATOMIC_RELEASE);
+    }
+    esp_log_impl_unlock();
+}
+
+/* Returns false if the message can not be encoded */
+static bool log_binary_encode(log_binary_record_t *record, const char *format, va_list args)
+{
+    log_binary_put_ptr(record, format);
+    for (const char *p = format; (p = strchr(p, '%')) != NULL;) {
+        esp_log_util_arg_type_t type;
+        int precision;
+        p = esp_log_util_parse_spec(p + 1, &type, &precision);
+        if (p == NULL) {
+            return false;
+        }
+        switch (type) {
+        case ESP_LOG_UTIL_ARG_INT:
+            log_binary_put_int(record, va_arg(args, int));
+            break;
+        case ESP_LOG_UTIL_ARG_LONG:
+            log_binary_put_int(record, va_arg(args, long));
+            break;
+        case ESP_LOG_UTIL_ARG_LLONG:
+            log_binary_put_int(record, va_arg(args, long long));
+            break;
+        case ESP_LOG_UTIL_ARG_INTMAX:
+            log_binary_put_int(record, va_arg(args, intmax_t));
+            break;
+        case ESP_LOG_UTIL_ARG_SIZE:
+            log_binary_put_int(record, va_arg(args, size_t));
+            break;
+        case ESP_LOG_UTIL_ARG_PTRDIFF:
+            log_binary_put_int(record, va_arg(args, ptrdiff_t));
+            break;
+        case ESP_LOG_UTIL_ARG_DOUBLE: {
+            double value = va_arg(args, double);
+            log_binary_put(record, &value, sizeof(value));
+            break;
+        }
+        case ESP_LOG_UTIL_ARG_PTR:
+            log_binary_put_varint(record, (uintptr_t) va_arg(args, void *));
+            break;
+        case ESP_LOG_UTIL_ARG_STR: {
+            const char *str = va_arg(args, const char *);
+            if (str == NULL || log_binary_str_in_elf(str)) {
+                log_binary_put_varint(record, 0);
+                log_binary_put_varint(record, (uintptr_t) str);
+                break;
+            }
+            size_t len = strnlen(str, (precision < 0) ? SIZE_MAX : (size_t) precision);
+            log_binary_put_varint(record, len + 1);
+            log_binary_put(record, str, len);
+            break;
+        }
+        default:
+            break;
+        }
+        if (record->overflow) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void log_binary_write_text(esp_log_binary_write_t write, const char *format, va_list args)
+{
+    char buf[LOG_BINARY_TEXT_SIZE];
+    va_list args_copy;
+    va_copy(args_copy, args);
+    int len = vsnprintf(buf, sizeof(buf), format, args_copy);
+    va_end(args_copy);
+    if (len < (int) sizeof(buf)) {
+        if (len > 0) {
+            (*write)(buf, len);
+        }
+        return;
+    }
+    char *heap_buf = malloc(len + 1);
+    if (heap_buf == NULL) {
+        (*write)(buf, sizeof(buf) - 1);
+        return;
+    }
+    vsnprintf(heap_buf, len + 1, format, args);
+    (*write)(heap_buf, len);
+    free(heap_buf);
+}
+
+void esp_log_binary_writev(const char *format, va_list args)
+{
+    // Loaded before the header check: if the function changes in between, the message goes to the old one,
+    // which has already output the header
+    esp_log_binary_write_t write = __atomic_load_n(&s_log_binary_write, __ATOMIC_ACQUIRE);
+    log_binary_write_header();
+
+    // The decoder reads the format string from the ELF file
+    if (log_binary_format_in_elf(format)) {
+        log_binary_record_t record;
+        log_binary_begin(&record);
+        va_list args_copy;
+        va_copy(args_copy, args);
+        bool encoded = log_binary_encode(&record, format, args_copy);
+        va_end(args_copy);
+        if (encoded) {
+            log_binary_end(&record, LOG_BINARY_MARKER_MESSAGE, write);
+            return;
+        }
+    }
+    log_binary_write_text(write, format, args);
+}
@@ -0,0 +1,63 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <pthread.h>
+#include <unistd.h>
+#include "esp_private/log_async.h"
+
+static pthread_mutex_t s_log_async_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t s_log_async_cond = PTHREAD_COND_INITIALIZER;
+static bool s_log_async_notified = false;
+
+static void *log_async_thread(void *arg)
+{
+    (void) arg;
+    esp_log_async_worker_loop();
+    return NULL;
+}
+
+bool esp_log_async_impl_start_worker(void)
+{
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, log_async_thread, NULL) != 0) {
+        return false;
+    }
+    pthread_detach(thread);
+    return true;
+}
+
+void esp_log_async_impl_wait(void)
+{
+    pthread_mutex_lock(&s_log_async_mutex);
+    while (!s_log_async_notified) {
+        pthread_cond_wait(&s_log_async_cond, &s_log_async_mutex);
+    }
+    s_log_async_notified = false;
+    pthread_mutex_unlock(&s_log_async_mutex);
+}
+
+void esp_log_async_impl_notify(void)
+{
+    pthread_mutex_lock(&s_log_async_mutex);
+    s_log_async_notified = true;
+    pthread_cond_signal(&s_log_async_cond);
+    pthread_mutex_unlock(&s_log_async_mutex);
+}
+
+void esp_log_async_impl_delay(void)
+{
+    usleep(1000);
+}
+
+bool esp_log_async_impl_can_block(void)
+{
+    return true;
+}
+
+unsigned esp_log_async_impl_core_id(void)
+{
+    return 0;
+}
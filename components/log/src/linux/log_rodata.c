@@ -0,0 +1,79 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_private/log_util.h"
+
+#if __APPLE__
+#include <mach-o/getsect.h>
+#include <mach-o/ldsyms.h>
+#else
+#include <link.h>
+#endif
+
+/* The executable has one or two read-only segments (code and read-only data), a few more are tolerated */
+#define LOG_RODATA_MAX_RANGES   4
+
+typedef struct {
+    uintptr_t start;
+    uintptr_t end;
+} log_rodata_range_t;
+
+static log_rodata_range_t s_ranges[LOG_RODATA_MAX_RANGES];
+static size_t s_range_count;
+static pthread_once_t s_ranges_once = PTHREAD_ONCE_INIT;
+
+static void log_rodata_add_range(uintptr_t start, size_t size)
+{
+    if (s_range_count < LOG_RODATA_MAX_RANGES && size > 0) {
+        s_ranges[s_range_count].start = start;
+        s_ranges[s_range_count].end = start + size;
+        s_range_count++;
+    }
+}
+
+#if __APPLE__
+static void log_rodata_find_ranges(void)
+{
+    // String literals are in the __TEXT segment, which is mapped read-only
+    unsigned long size = 0;
+    uint8_t *start = getsegmentdata(&_mh_execute_header, "__TEXT", &size);
+    log_rodata_add_range((uintptr_t) start, size);
+}
+#else
+static int log_rodata_add_object(struct dl_phdr_info *info, size_t size, void *data)
+{
+    (void) size;
+    (void) data;
+    for (int i = 0; i < info->dlpi_phnum; i++) {
+        const ElfW(Phdr) *phdr = &info->dlpi_phdr[i];
+        if (phdr->p_type == PT_LOAD && !(phdr->p_flags & PF_W)) {
+            log_rodata_add_range(info->dlpi_addr + phdr->p_vaddr, phdr->p_memsz);
+        }
+    }
+    // The first object is the executable, shared libraries are not checked
+    return 1;
+}
+
+static void log_rodata_find_ranges(void)
+{
+    dl_iterate_phdr(log_rodata_add_object, NULL);
+}
+#endif // __APPLE__
+
+bool esp_log_util_ptr_in_rodata(const void *ptr)
+{
+    pthread_once(&s_ranges_once, log_rodata_find_ranges);
+    uintptr_t addr = (uintptr_t) ptr;
+    for (size_t i = 0; i < s_range_count; i++) {
+        if (addr >= s_ranges[i].start && addr < s_ranges[i].end) {
+            return true;
+        }
+    }
+    return false;
+}
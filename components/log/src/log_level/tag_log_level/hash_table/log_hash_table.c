@@ -0,0 +1,152 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * This file implements a hash table-based approach for storing and retrieving
+ * log tag levels in the ESP-IDF log library.
+ *
+ * Tags set with esp_log_level_set() are stored in a chained hash table keyed by
+ * the hash of the tag string. Log calls usually pass the same string literal for
+ * a tag, so the result of every string lookup is also remembered in an open
+ * addressing table keyed by the tag address. Most lookups then take a single
+ * pointer comparison, regardless of the number of tags, and tags which were not
+ * set (using the default level) are found as quickly as the others.
+ *
+ * An entry of the address table refers to the entry of the string table, so updating
+ * the level of a tag does not need to update the address table. It is cleared when a
+ * new tag is added, as it may have remembered the default level for it. When the address
+ * table is filled up to 3/4, new addresses are not added any more, their lookups use the
+ * string table.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+#include "sys/queue.h"
+#include "log_hash_table.h"
+#include "esp_assert.h"
+#include "sdkconfig.h"
+
+ESP_STATIC_ASSERT((CONFIG_LOG_TAG_LEVEL_HASH_TABLE_SIZE & (CONFIG_LOG_TAG_LEVEL_HASH_TABLE_SIZE - 1)) == 0, "Hash table size must be a power of 2");
+#define TABLE_SIZE      (CONFIG_LOG_TAG_LEVEL_HASH_TABLE_SIZE)
+#define TABLE_MASK      (TABLE_SIZE - 1)
+#define ADDR_TABLE_MAX  (TABLE_SIZE * 3 / 4)
+
+typedef struct tag_entry_ {
+    SLIST_ENTRY(tag_entry_) entries;
+    uint32_t hash;
+    uint8_t level;          // esp_log_level_t as uint8_t
+    char tag[0];            // beginning of a zero-terminated string
+} tag_entry_t;
+
+typedef struct {
+    const char *tag;        // NULL if the slot is free
+    const tag_entry_t *entry;   // NULL if the level of the tag was not set
+} tag_addr_entry_t;
+
+static SLIST_HEAD(tag_bucket_head, tag_entry_) s_tag_buckets[TABLE_SIZE];
+static tag_addr_entry_t s_tag_addrs[TABLE_SIZE];
+static uint32_t s_tag_addr_count;
+
+static inline uint32_t hash_str(const char *str)
+{
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    while (*str != '\0') {
+        hash = (hash ^ (uint8_t) *str++) * 16777619u;
+    }
+    return hash;
+}
+
+static inline uint32_t hash_addr(const char *addr)
+{
+    // Fibonacci hashing, takes the upper bits of the product
+    return (uint32_t)((uintptr_t) addr * 2654435769u) >> (32 - __builtin_ctz(TABLE_SIZE));
+}
+
+static tag_entry_t *find_str(const char *tag, uint32_t hash)
+{
+    tag_entry_t *it;
+    SLIST_FOREACH(it, &s_tag_buckets[hash & TABLE_MASK], entries) {
+        if (it->hash == hash && strcmp(it->tag, tag) == 0) {
+            return it;
+        }
+    }
+    return NULL;
+}
+
+static void clean_addrs(void)
+{
+    memset(s_tag_addrs, 0, sizeof(s_tag_addrs));
+    s_tag_addr_count = 0;
+}
+
+bool esp_log_hash_table_set_level(const char *tag, esp_log_level_t level)
+{
+    uint32_t hash = hash_str(tag);
+    tag_entry_t *entry = find_str(tag, hash);
+    if (entry != NULL) {
+        entry->level = (uint8_t) level;
+        return true;
+    }
+    size_t tag_len = strlen(tag) + 1;
+    entry = (tag_entry_t *) malloc(offsetof(tag_entry_t, tag) + tag_len);
+    if (entry == NULL) {
+        return false;
+    }
+    entry->hash = hash;
+    entry->level = (uint8_t) level;
+    memcpy(entry->tag, tag, tag_len);
+    SLIST_INSERT_HEAD(&s_tag_buckets[hash & TABLE_MASK], entry, entries);
+    // Addresses of this tag may have been remembered without an entry
+    clean_addrs();
+    return true;
+}
+
+bool esp_log_hash_table_get_level(const char *tag, esp_log_level_t *level)
+{
+    uint32_t i = hash_addr(tag);
+    while (s_tag_addrs[i].tag != NULL) {
+        if (s_tag_addrs[i].tag == tag) {
+            const tag_entry_t *entry = s_tag_addrs[i].entry;
+            if (entry == NULL) {
+                return false;
+            }
+            *level = (esp_log_level_t) entry->level;
+            return true;
+        }
+        i = (i + 1) & TABLE_MASK;
+    }
+
+    // First lookup of this address, i is the free slot for it
+    const tag_entry_t *entry = find_str(tag, hash_str(tag));
+    if (s_tag_addr_count < ADDR_TABLE_MAX) {
+        s_tag_addrs[i] = (tag_addr_entry_t) {
+            .tag = tag,
+            .entry = entry,
+        };
+        ++s_tag_addr_count;
+    }
+    if (entry == NULL) {
+        return false;
+    }
+    *level = (esp_log_level_t) entry->level;
+    return true;
+}
+
+void esp_log_hash_table_clean(void)
+{
+    clean_addrs();
+    for (int i = 0; i < TABLE_SIZE; i++) {
+        tag_entry_t *it;
+        while ((it = SLIST_FIRST(&s_tag_buckets[i])) != NULL) {
+            SLIST_REMOVE_HEAD(&s_tag_buckets[i], entries);
+            free(it);
+        }
+    }
+}
@@ -0,0 +1,39 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+#include <stdbool.h>
+#include "esp_log_level.h"
+
+/**
+ * @brief Set the log level for a specific log tag in the hash table.
+ *
+ * If the tag already exists in the table, its log level will be updated
+ * with the new value. Otherwise, a new entry is added.
+ *
+ * @param tag   The log tag for which to set the log level.
+ * @param level The log level to be set for the specified log tag.
+ * @return true   If the log level was successfully set or updated,
+ *         false  Otherwise.
+ */
+bool esp_log_hash_table_set_level(const char *tag, esp_log_level_t level);
+
+/**
+ * @brief Get the log level for a specific log tag from the hash table.
+ *
+ * The tag is first looked up by its address, and only if it was not seen before, by its string.
+ *
+ * @param tag   The log tag for which to retrieve the log level.
+ * @param level Pointer to a variable where the retrieved log level will be stored.
+ * @return true  if the log level was set for the tag,
+ *         false if the tag was not found, the level remains unchanged.
+ */
+bool esp_log_hash_table_get_level(const char *tag, esp_log_level_t *level);
+
+/**
+ * @brief Clears the hash table of all tags and frees the allocated memory.
+ */
+void esp_log_hash_table_clean(void);
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2015-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2015-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -16,6 +16,8 @@
 
 #if CONFIG_LOG_TAG_LEVEL_IMPL_LINKED_LIST || CONFIG_LOG_TAG_LEVEL_IMPL_CACHE_AND_LINKED_LIST
 #include "linked_list/log_linked_list.h"
+#elif CONFIG_LOG_TAG_LEVEL_IMPL_HASH_TABLE
+#include "hash_table/log_hash_table.h"
 #endif
 
 #if CONFIG_LOG_TAG_LEVEL_CACHE_ARRAY || CONFIG_LOG_TAG_LEVEL_CACHE_BINARY_MIN_HEAP
@@ -40,12 +42,20 @@ static inline void log_level_set(const char *tag, esp_log_level_t level)
     // for wildcard tag, remove all linked list items and clear the cache
     if (strcmp(tag, "*") == 0) {
         esp_log_set_default_level(level);
+#if CONFIG_LOG_TAG_LEVEL_IMPL_HASH_TABLE
+        esp_log_hash_table_clean();
+#else
         esp_log_linked_list_clean();
+#endif
 #if CACHE_ENABLED
         esp_log_cache_clean();
 #endif
     } else {
+#if CONFIG_LOG_TAG_LEVEL_IMPL_HASH_TABLE
+        __attribute__((unused)) bool success = esp_log_hash_table_set_level(tag, level);
+#else
         __attribute__((unused)) bool success = esp_log_linked_list_set_level(tag, level);
+#endif
 #if CACHE_ENABLED
         if (success) {
             esp_log_cache_set_level(tag, level);
@@ -74,6 +84,8 @@ static esp_log_level_t log_level_get(const char *tag, bool timeout)
         esp_log_linked_list_get_level(tag, &level_for_tag);
         esp_log_cache_add(tag, level_for_tag);
     }
+#elif CONFIG_LOG_TAG_LEVEL_IMPL_HASH_TABLE
+    esp_log_hash_table_get_level(tag, &level_for_tag);
 #else
     esp_log_linked_list_get_level(tag, &level_for_tag);
 #endif
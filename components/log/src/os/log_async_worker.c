@@ -0,0 +1,54 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_cpu.h"
+#include "esp_private/log_async.h"
+#include "sdkconfig.h"
+
+static TaskHandle_t s_log_async_task = NULL;
+
+static void log_async_task(void *arg)
+{
+    (void) arg;
+    esp_log_async_worker_loop();
+}
+
+bool esp_log_async_impl_start_worker(void)
+{
+    return xTaskCreatePinnedToCore(log_async_task, "log_async", CONFIG_LOG_ASYNC_TASK_STACK_SIZE, NULL,
+                                   CONFIG_LOG_ASYNC_TASK_PRIORITY, &s_log_async_task, tskNO_AFFINITY) == pdPASS;
+}
+
+void esp_log_async_impl_wait(void)
+{
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+}
+
+void esp_log_async_impl_notify(void)
+{
+    if (xPortInIsrContext()) {
+        vTaskNotifyGiveFromISR(s_log_async_task, NULL);
+    } else {
+        xTaskNotifyGive(s_log_async_task);
+    }
+}
+
+void esp_log_async_impl_delay(void)
+{
+    vTaskDelay(1);
+}
+
+bool esp_log_async_impl_can_block(void)
+{
+    return !xPortInIsrContext() && xTaskGetSchedulerState() == taskSCHEDULER_RUNNING;
+}
+
+unsigned esp_log_async_impl_core_id(void)
+{
+    return esp_cpu_get_core_id();
+}
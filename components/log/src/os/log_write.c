@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2015-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2015-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -13,6 +13,24 @@
 #include "esp_private/log_level.h"
 #include "sdkconfig.h"
 
+#if CONFIG_LOG_ASYNC
+#include "esp_private/log_async.h"
+#ifndef CONFIG_IDF_TARGET_LINUX
+#include "esp_memory_utils.h"  // for esp_ptr_in_drom
+#else // !CONFIG_IDF_TARGET_LINUX
+#include "esp_private/log_util.h"
+
+static inline bool esp_ptr_in_drom(const void *ptr)
+{
+    return esp_log_util_ptr_in_rodata(ptr);
+}
+#endif // !CONFIG_IDF_TARGET_LINUX
+#endif // CONFIG_LOG_ASYNC
+
+#if CONFIG_LOG_BINARY
+#include "esp_private/log_binary.h"
+#endif
+
 static vprintf_like_t s_log_print_func = &vprintf;
 
 vprintf_like_t esp_log_set_vprintf(vprintf_like_t func)
@@ -24,6 +42,22 @@ vprintf_like_t esp_log_set_vprintf(vprintf_like_t func)
     return orig_func;
 }
 
+#if CONFIG_LOG_ASYNC
+static int log_print(const char *format, ...)
+{
+    va_list list;
+    va_start(list, format);
+    int ret = (*s_log_print_func)(format, list);
+    va_end(list);
+    return ret;
+}
+
+void esp_log_write_str(const char *str)
+{
+    log_print("%s", str);
+}
+#endif // CONFIG_LOG_ASYNC
+
 void esp_log_writev(esp_log_level_t level,
                     const char *tag,
                     const char *format,
@@ -31,7 +65,25 @@ void esp_log_writev(esp_log_level_t level,
 {
     esp_log_level_t level_for_tag = esp_log_level_get_timeout(tag);
     if (ESP_LOG_NONE != level_for_tag && level <= level_for_tag) {
+#if CONFIG_LOG_BINARY
+        esp_log_binary_writev(format, args);
+#else
+#if CONFIG_LOG_ASYNC
+        // Only messages with a format string in flash (in a read-only segment of the executable on the linux target)
+        // are deferred, as it has to stay valid until the message is output. This also means that the cache is
+        // enabled, esp_log_async_write() is not in IRAM.
+        if (esp_ptr_in_drom(format) && esp_log_async_write(format, args)) {
+            return;
+        }
+        bool async_sync = esp_log_async_sync_begin();
+#endif
         (*s_log_print_func)(format, args);
+#if CONFIG_LOG_ASYNC
+        if (async_sync) {
+            esp_log_async_sync_end();
+        }
+#endif
+#endif // CONFIG_LOG_BINARY
     }
 }
 
@@ -1,11 +1,14 @@
 /*
- * SPDX-FileCopyrightText: 2023-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2023-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 #include "esp_rom_sys.h"
+#include "esp_private/log_util.h"
 
 int esp_log_util_cvt(unsigned long long val, long radix, int pad, const char *digits, char *buf)
 {
@@ -21,3 +24,87 @@ int esp_log_util_cvt_dec(unsigned long long val, int pad, char *buf)
 {
     return esp_rom_cvt(val, 10, pad, "0123456789", buf);
 }
+
+const char *esp_log_util_parse_spec(const char *p, esp_log_util_arg_type_t *type, int *precision)
+{
+    while (*p != '\0' && strchr("-+ #0", *p) != NULL) {
+        p++;
+    }
+    if (*p == '*') {
+        return NULL;
+    }
+    while (*p >= '0' && *p <= '9') {
+        p++;
+    }
+    *precision = -1;
+    if (*p == '.') {
+        p++;
+        if (*p == '*') {
+            return NULL;
+        }
+        *precision = 0;
+        while (*p >= '0' && *p <= '9') {
+            *precision = *precision * 10 + (*p++ - '0');
+        }
+    }
+
+    esp_log_util_arg_type_t int_type = ESP_LOG_UTIL_ARG_INT;
+    bool has_length = true;
+    switch (*p) {
+    case 'h':
+        p += (p[1] == 'h') ? 2 : 1; // promoted to int
+        break;
+    case 'l':
+        int_type = (p[1] == 'l') ? ESP_LOG_UTIL_ARG_LLONG : ESP_LOG_UTIL_ARG_LONG;
+        p += (p[1] == 'l') ? 2 : 1;
+        break;
+    case 'j':
+        int_type = ESP_LOG_UTIL_ARG_INTMAX;
+        p++;
+        break;
+    case 'z':
+        int_type = ESP_LOG_UTIL_ARG_SIZE;
+        p++;
+        break;
+    case 't':
+        int_type = ESP_LOG_UTIL_ARG_PTRDIFF;
+        p++;
+        break;
+    default:
+        has_length = false;
+        break;
+    }
+
+    switch (*p) {
+    case 'd': case 'i': case 'o': case 'u': case 'x': case 'X':
+        *type = int_type;
+        break;
+    case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A':
+        if (has_length && int_type != ESP_LOG_UTIL_ARG_LONG) {
+            return NULL;
+        }
+        *type = ESP_LOG_UTIL_ARG_DOUBLE;
+        break;
+    case 'c':
+        if (has_length) {
+            return NULL; // wint_t
+        }
+        *type = ESP_LOG_UTIL_ARG_INT;
+        break;
+    case 's':
+        if (has_length) {
+            return NULL; // wide string
+        }
+        *type = ESP_LOG_UTIL_ARG_STR;
+        break;
+    case 'p':
+        *type = ESP_LOG_UTIL_ARG_PTR;
+        break;
+    case '%':
+        *type = ESP_LOG_UTIL_ARG_NONE;
+        break;
+    default:
+        return NULL; // %n, long double, unknown conversions or the end of the string
+    }
+    return p + 1;
+}
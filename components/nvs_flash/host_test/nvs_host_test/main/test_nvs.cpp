@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2015-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2015-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -17,6 +17,7 @@
 #include <string.h>
 #include <string>
 #include <random>
+#include <chrono>
 #include "test_fixtures.hpp"
 #include "spi_flash_mmap.h"
 
@@ -260,47 +261,240 @@ TEST_CASE("Page validates blob size", "[nvs]")
     TEST_ESP_OK(page.writeItem(1, nvs::ItemType::BLOB, "2", buf, nvs::Page::CHUNK_MAX_SIZE));
 }
 
-class HashListTestHelper : public nvs::HashList {
-public:
-    size_t getBlockCount()
-    {
-        return mBlockList.size();
+/* malloc() and free() are wrapped by the linker (see CMakeLists.txt), so that the tests can count the heap
+ * allocations made by NVS */
+extern "C" {
+void *__real_malloc(size_t size);
+void __real_free(void *ptr);
+
+static bool s_count_allocations;
+static size_t s_malloc_count;
+static size_t s_malloc_bytes;
+static size_t s_free_count;
+
+void *__wrap_malloc(size_t size)
+{
+    if (s_count_allocations) {
+        s_malloc_count++;
+        s_malloc_bytes += size;
     }
-};
+    return __real_malloc(size);
+}
+
+void __wrap_free(void *ptr)
+{
+    if (s_count_allocations && ptr) {
+        s_free_count++;
+    }
+    __real_free(ptr);
+}
+}
+
+static void start_counting_allocations()
+{
+    s_malloc_count = 0;
+    s_malloc_bytes = 0;
+    s_free_count = 0;
+    s_count_allocations = true;
+}
+
+static void stop_counting_allocations()
+{
+    s_count_allocations = false;
+}
 
 TEST_CASE("HashList is cleaned up as soon as items are erased", "[nvs]")
 {
-    HashListTestHelper hashlist;
+    nvs::HashList hashlist;
     // Add items
-    const size_t count = 128;
+    const size_t count = nvs::HashList::ENTRY_COUNT;
     for (size_t i = 0; i < count; ++i) {
         char key[16];
         snprintf(key, sizeof(key), "i%ld", (long int)i);
         nvs::Item item(1, nvs::ItemType::U32, 1, key);
-        hashlist.insert(item, i);
+        TEST_ESP_OK(hashlist.insert(item, i));
     }
-    INFO("Added " << count << " items, " << hashlist.getBlockCount() << " blocks");
+    CHECK(hashlist.size() == count);
     // Remove them in reverse order
     for (size_t i = count; i > 0; --i) {
         // Make sure that the element existed before it's erased
         CHECK(hashlist.erase(i - 1) == true);
     }
-    CHECK(hashlist.getBlockCount() == 0);
+    CHECK(hashlist.size() == 0);
     // Add again
     for (size_t i = 0; i < count; ++i) {
         char key[16];
         snprintf(key, sizeof(key), "i%ld", (long int)i);
         nvs::Item item(1, nvs::ItemType::U32, 1, key);
-        hashlist.insert(item, i);
+        TEST_ESP_OK(hashlist.insert(item, i));
     }
-    INFO("Added " << count << " items, " << hashlist.getBlockCount() << " blocks");
     // Remove them in the same order
     for (size_t i = 0; i < count; ++i) {
         CHECK(hashlist.erase(i) == true);
+        CHECK(hashlist.erase(i) == false);
+    }
+    CHECK(hashlist.size() == 0);
+}
+
+TEST_CASE("HashList returns the first matching entry at or after the start index", "[nvs]")
+{
+    nvs::HashList hashlist;
+    nvs::Item item(1, nvs::ItemType::U32, 1, "key");
+    nvs::Item other(1, nvs::ItemType::U32, 1, "other");
+
+    // insert out of order, the list is expected to keep the entries sorted
+    TEST_ESP_OK(hashlist.insert(item, 40));
+    TEST_ESP_OK(hashlist.insert(other, 20));
+    TEST_ESP_OK(hashlist.insert(item, 7));
+    TEST_ESP_OK(hashlist.insert(item, 100));
+
+    CHECK(hashlist.find(0, item) == 7);
+    CHECK(hashlist.find(8, item) == 40);
+    CHECK(hashlist.find(41, item) == 100);
+    CHECK(hashlist.find(101, item) == SIZE_MAX);
+    CHECK(hashlist.find(0, other) == 20);
+
+    CHECK(hashlist.erase(40) == true);
+    CHECK(hashlist.find(8, item) == 100);
+
+    // writing another item to an entry replaces its node
+    TEST_ESP_OK(hashlist.insert(other, 7));
+    CHECK(hashlist.find(0, item) == 100);
+    CHECK(hashlist.find(0, other) == 7);
+    CHECK(hashlist.size() == 3);
+
+    hashlist.clear();
+    CHECK(hashlist.size() == 0);
+    CHECK(hashlist.find(0, other) == SIZE_MAX);
+}
+
+TEST_CASE("HashList finds the entries whose hash is in another list", "[nvs]")
+{
+    nvs::HashList hashlist;
+    nvs::HashList newer;
+    nvs::Item item(1, nvs::ItemType::U32, 1, "key");
+    nvs::Item other(1, nvs::ItemType::U32, 1, "other");
+    nvs::Item blob(1, nvs::ItemType::BLOB, nvs::Page::CHUNK_ANY, "blob");
+    nvs::Item blobIndex(1, nvs::ItemType::BLOB_IDX, nvs::Page::CHUNK_ANY, "blob");
+
+    TEST_ESP_OK(hashlist.insert(other, 3));
+    TEST_ESP_OK(hashlist.insert(item, 10));
+    TEST_ESP_OK(hashlist.insert(blob, 90));
+    TEST_ESP_OK(hashlist.insert(item, 100));
+    TEST_ESP_OK(newer.insert(item, 0));
+    TEST_ESP_OK(newer.insert(blobIndex, 5));
+
+    CHECK(hashlist.findCommon(0, newer) == 10);
+    // the hash doesn't include the type, an old format blob matches its blob index
+    CHECK(hashlist.findCommon(11, newer) == 90);
+    CHECK(hashlist.findCommon(91, newer) == 100);
+    CHECK(hashlist.findCommon(101, newer) == SIZE_MAX);
+
+    CHECK(newer.erase(0) == true);
+    CHECK(hashlist.findCommon(0, newer) == 90);
+    newer.clear();
+    CHECK(hashlist.findCommon(0, newer) == SIZE_MAX);
+}
+
+TEST_CASE("HashList allocates node blocks only for the used entries", "[nvs]")
+{
+    nvs::HashList hashlist;
+    nvs::Item item(1, nvs::ItemType::U32, 1, "key");
+
+    start_counting_allocations();
+    for (size_t i = 0; i < 3; ++i) {
+        hashlist.insert(item, i);
+    }
+    stop_counting_allocations();
+    // a page with a few items needs one block, like the first block of the former block chain
+    CHECK(s_malloc_count == 1);
+    CHECK(s_malloc_bytes == 128);
+    CHECK(hashlist.getBlockCount() == 1);
+
+    start_counting_allocations();
+    for (size_t i = 3; i < nvs::HashList::ENTRY_COUNT; ++i) {
+        hashlist.insert(item, i);
     }
+    stop_counting_allocations();
+    // a full page needs 4 blocks, the block chain used to allocate 5 blocks of 128 bytes
+    CHECK(s_malloc_count == 3);
+    CHECK(s_malloc_bytes == 3 * 128);
+    CHECK(hashlist.getBlockCount() == 4);
+
+    // erasing the last entry of a block releases it
+    start_counting_allocations();
+    for (size_t i = 0; i < 32; ++i) {
+        hashlist.erase(i);
+    }
+    stop_counting_allocations();
+    CHECK(s_malloc_count == 0);
+    CHECK(s_free_count == 1);
+    CHECK(hashlist.getBlockCount() == 3);
+
+    start_counting_allocations();
+    hashlist.clear();
+    stop_counting_allocations();
+    CHECK(s_free_count == 3);
     CHECK(hashlist.getBlockCount() == 0);
 }
 
+TEST_CASE("Free and erased pages don't allocate hash list memory", "[nvs]")
+{
+    PartitionEmulationFixture f(0, 4);
+
+    start_counting_allocations();
+    {
+        nvs::Page page;
+        TEST_ESP_OK(page.load(f.part(), 0));
+        CHECK(page.state() == nvs::Page::PageState::UNINITIALIZED);
+    }
+    stop_counting_allocations();
+    CHECK(s_malloc_count == 0);
+
+    nvs::Page page;
+    TEST_ESP_OK(page.load(f.part(), 0));
+    start_counting_allocations();
+    TEST_ESP_OK(page.writeItem(1, "key", 1));
+    stop_counting_allocations();
+    CHECK(s_malloc_count == 1);
+    CHECK(s_malloc_bytes == 128);
+
+    start_counting_allocations();
+    TEST_ESP_OK(page.erase());
+    stop_counting_allocations();
+    CHECK(s_free_count == 1);
+    CHECK(page.state() == nvs::Page::PageState::UNINITIALIZED);
+}
+
+TEST_CASE("KeyIndex finds all nodes with a hash and switches off when over budget", "[nvs]")
+{
+    nvs::KeyIndex index(64 * 8);
+    nvs::KeyIndex::Location locations[4];
+
+    index.insert(0x123456, 3, 10);
+    index.insert(0x123456, 1, 20);
+    index.insert(0x654321, 1, 21);
+    CHECK(index.size() == 3);
+    CHECK(index.find(0x123456, locations, 4) == 2);
+    CHECK(index.find(0x111111, locations, 4) == 0);
+
+    index.erase(0x123456, 3, 10);
+    REQUIRE(index.find(0x123456, locations, 4) == 1);
+    CHECK(locations[0].mPage == 1);
+    CHECK(locations[0].mEntry == 20);
+
+    // 64 slots fit into the budget, filling them beyond the load factor has to switch the index off
+    for (size_t i = 0; i < 64; ++i) {
+        index.insert(i, 0, i);
+    }
+    CHECK_FALSE(index.isValid());
+    CHECK(index.find(0x654321, locations, 4) == 0);
+
+    index.clear();
+    CHECK(index.isValid());
+    CHECK(index.size() == 0);
+}
+
 TEST_CASE("can init PageManager in empty flash", "[nvs]")
 {
     PartitionEmulationFixture f(0, 4);
@@ -334,6 +528,44 @@ TEST_CASE("PageManager adds page in the correct order", "[nvs]")
     }
 }
 
+TEST_CASE("PageManager defers loading the items of full pages", "[nvs]")
+{
+    PartitionEmulationFixture f(0, 4);
+    {
+        // a full page holding "dup", and a newer page holding another copy of it, as if power went out
+        // after the new value was written but before the old one was erased
+        nvs::Page p;
+        TEST_ESP_OK(p.load(f.part(), 0));
+        TEST_ESP_OK(p.setSeqNumber(0));
+        TEST_ESP_OK(p.writeItem(1, "dup", 1U));
+        TEST_ESP_OK(p.writeItem(1, "other", 2U));
+        TEST_ESP_OK(p.markFull());
+        nvs::Page p2;
+        TEST_ESP_OK(p2.load(f.part(), 1));
+        TEST_ESP_OK(p2.setSeqNumber(1));
+        TEST_ESP_OK(p2.writeItem(1, "dup", 3U));
+    }
+
+    nvs::PageManager pm;
+    TEST_ESP_OK(pm.load(f.part(), 0, 4, true));
+    nvs::Page& fullPage = *pm.begin();
+    CHECK_FALSE(fullPage.itemsLoaded());
+    CHECK(pm.back().itemsLoaded());
+    CHECK_FALSE(pm.itemsLoaded());
+    CHECK(fullPage.getUsedEntryCount() == 2);
+
+    // the first access checks the items, and removes the stale duplicate
+    uint32_t value;
+    TEST_ESP_OK(fullPage.readItem(1, "other", value));
+    CHECK(value == 2);
+    CHECK(fullPage.itemsLoaded());
+    CHECK(pm.itemsLoaded());
+    TEST_ESP_ERR(fullPage.readItem(1, "dup", value), ESP_ERR_NVS_NOT_FOUND);
+    CHECK(fullPage.getUsedEntryCount() == 1);
+    TEST_ESP_OK(pm.back().readItem(1, "dup", value));
+    CHECK(value == 3);
+}
+
 TEST_CASE("can init storage in empty flash", "[nvs]")
 {
     PartitionEmulationFixture f(0, 8);
@@ -671,6 +903,322 @@ TEST_CASE("deinit partition doesn't affect other partition's open handles", "[nv
     TEST_ESP_OK(nvs_flash_deinit_partition(OTHER_PARTITION_NAME));
 }
 
+TEST_CASE("nvs batch writes staged values on commit", "[nvs]")
+{
+    PartitionEmulationFixture f(0, 10);
+    const uint32_t NVS_FLASH_SECTOR = 6;
+    const uint32_t NVS_FLASH_SECTOR_COUNT_MIN = 3;
+    TEST_ESP_OK(nvs::NVSPartitionManager::get_instance()->init_custom(f.part(),
+                                                                      NVS_FLASH_SECTOR,
+                                                                      NVS_FLASH_SECTOR_COUNT_MIN));
+
+    nvs_handle_t handle;
+    TEST_ESP_OK(nvs_open("namespace1", NVS_READWRITE, &handle));
+    TEST_ESP_OK(nvs_set_i32(handle, "old", 1));
+    TEST_ESP_OK(nvs_set_i32(handle, "erased", 2));
+
+    TEST_ESP_ERR(nvs_batch_commit(handle), ESP_ERR_NVS_INVALID_STATE);
+    TEST_ESP_ERR(nvs_batch_abort(handle), ESP_ERR_NVS_INVALID_STATE);
+    TEST_ESP_OK(nvs_batch_begin(handle));
+    TEST_ESP_ERR(nvs_batch_begin(handle), ESP_ERR_NVS_INVALID_STATE);
+
+    const char *str = "value 0123456789abcdef0123456789abcdef";
+    const uint8_t blob[] = {1, 2, 3, 4, 5};
+    TEST_ESP_OK(nvs_set_i32(handle, "old", 3));
+    TEST_ESP_OK(nvs_set_u8(handle, "new", 4));
+    TEST_ESP_OK(nvs_set_u8(handle, "new", 5));
+    TEST_ESP_OK(nvs_set_str(handle, "str", str));
+    TEST_ESP_OK(nvs_set_blob(handle, "blob", blob, sizeof(blob)));
+    TEST_ESP_OK(nvs_set_u8(handle, "dropped", 6));
+    TEST_ESP_OK(nvs_erase_key(handle, "dropped"));
+    TEST_ESP_OK(nvs_erase_key(handle, "erased"));
+    TEST_ESP_ERR(nvs_set_u8(handle, "key_that_is_too_long", 7), ESP_ERR_NVS_KEY_TOO_LONG);
+
+    // nothing is written before the commit
+    int32_t v32;
+    uint8_t v8;
+    TEST_ESP_OK(nvs_get_i32(handle, "old", &v32));
+    CHECK(v32 == 1);
+    TEST_ESP_ERR(nvs_get_u8(handle, "new", &v8), ESP_ERR_NVS_NOT_FOUND);
+    TEST_ESP_ERR(nvs_get_i32(handle, "erased", &v32), ESP_ERR_NVS_NOT_FOUND);
+
+    TEST_ESP_OK(nvs_batch_commit(handle));
+    TEST_ESP_ERR(nvs_batch_commit(handle), ESP_ERR_NVS_INVALID_STATE);
+
+    // an aborted batch doesn't write anything
+    TEST_ESP_OK(nvs_batch_begin(handle));
+    TEST_ESP_OK(nvs_set_u8(handle, "new", 8));
+    TEST_ESP_OK(nvs_batch_abort(handle));
+
+    // nvs_commit commits a batch as well
+    TEST_ESP_OK(nvs_batch_begin(handle));
+    TEST_ESP_OK(nvs_set_i32(handle, "commit", 9));
+    TEST_ESP_OK(nvs_commit(handle));
+    nvs_close(handle);
+
+    // values can be read back after reloading the storage, and the previous values are gone
+    TEST_ESP_OK(nvs_flash_deinit_partition(NVS_DEFAULT_PART_NAME));
+    TEST_ESP_OK(nvs::NVSPartitionManager::get_instance()->init_custom(f.part(),
+                                                                      NVS_FLASH_SECTOR,
+                                                                      NVS_FLASH_SECTOR_COUNT_MIN));
+    TEST_ESP_OK(nvs_open("namespace1", NVS_READONLY, &handle));
+    TEST_ESP_ERR(nvs_batch_begin(handle), ESP_ERR_NVS_READ_ONLY);
+    TEST_ESP_OK(nvs_get_i32(handle, "old", &v32));
+    CHECK(v32 == 3);
+    TEST_ESP_OK(nvs_get_u8(handle, "new", &v8));
+    CHECK(v8 == 5);
+    TEST_ESP_OK(nvs_get_i32(handle, "commit", &v32));
+    CHECK(v32 == 9);
+    TEST_ESP_ERR(nvs_get_u8(handle, "dropped", &v8), ESP_ERR_NVS_NOT_FOUND);
+    TEST_ESP_ERR(nvs_get_i32(handle, "erased", &v32), ESP_ERR_NVS_NOT_FOUND);
+
+    char buf[64];
+    size_t buf_len = sizeof(buf);
+    TEST_ESP_OK(nvs_get_str(handle, "str", buf, &buf_len));
+    CHECK(0 == strcmp(buf, str));
+    uint8_t blob_buf[sizeof(blob)];
+    buf_len = sizeof(blob_buf);
+    TEST_ESP_OK(nvs_get_blob(handle, "blob", blob_buf, &buf_len));
+    CHECK(0 == memcmp(blob_buf, blob, sizeof(blob)));
+
+    size_t used_entries;
+    TEST_ESP_OK(nvs_get_used_entry_count(handle, &used_entries));
+    // old, new and commit, str (header and two data entries), blob (index, and a chunk of two entries)
+    CHECK(used_entries == 9);
+    nvs_close(handle);
+
+    TEST_ESP_OK(nvs_flash_deinit_partition(NVS_DEFAULT_PART_NAME));
+}
+
+TEST_CASE("nvs batch spanning several pages replaces all previous values", "[nvs]")
+{
+    PartitionEmulationFixture f(0, 10);
+    const uint32_t NVS_FLASH_SECTOR = 2;
+    const uint32_t NVS_FLASH_SECTOR_COUNT_MIN = 5;
+    const size_t KEY_COUNT = 150;
+    TEST_ESP_OK(nvs::NVSPartitionManager::get_instance()->init_custom(f.part(),
+                                                                      NVS_FLASH_SECTOR,
+                                                                      NVS_FLASH_SECTOR_COUNT_MIN));
+
+    nvs_handle_t handle;
+    TEST_ESP_OK(nvs_open("namespace1", NVS_READWRITE, &handle));
+    for (uint32_t round = 0; round < 4; ++round) {
+        TEST_ESP_OK(nvs_batch_begin(handle));
+        for (size_t i = 0; i < KEY_COUNT; ++i) {
+            char key[16];
+            snprintf(key, sizeof(key), "key_%d", static_cast<int>(i));
+            if (i % 10 == 0) {
+                char str[40];
+                snprintf(str, sizeof(str), "string value %d %d", static_cast<int>(round), static_cast<int>(i));
+                TEST_ESP_OK(nvs_set_str(handle, key, str));
+            } else {
+                TEST_ESP_OK(nvs_set_u32(handle, key, round * 1000 + i));
+            }
+        }
+        TEST_ESP_OK(nvs_batch_commit(handle));
+
+        size_t used_entries;
+        TEST_ESP_OK(nvs_get_used_entry_count(handle, &used_entries));
+        CHECK(used_entries == KEY_COUNT + KEY_COUNT / 10);
+    }
+    nvs_close(handle);
+
+    TEST_ESP_OK(nvs_flash_deinit_partition(NVS_DEFAULT_PART_NAME));
+    TEST_ESP_OK(nvs::NVSPartitionManager::get_instance()->init_custom(f.part(),
+                                                                      NVS_FLASH_SECTOR,
+                                                                      NVS_FLASH_SECTOR_COUNT_MIN));
+    TEST_ESP_OK(nvs_open("namespace1", NVS_READONLY, &handle));
+    for (size_t i = 0; i < KEY_COUNT; ++i) {
+        char key[16];
+        snprintf(key, sizeof(key), "key_%d", static_cast<int>(i));
+        if (i % 10 == 0) {
+            char expected[40];
+            char str[40];
+            size_t len = sizeof(str);
+            snprintf(expected, sizeof(expected), "string value %d %d", 3, static_cast<int>(i));
+            TEST_ESP_OK(nvs_get_str(handle, key, str, &len));
+            CHECK(std::string(str) == expected);
+        } else {
+            uint32_t value;
+            TEST_ESP_OK(nvs_get_u32(handle, key, &value));
+            CHECK(value == 3000 + i);
+        }
+    }
+    nvs_close(handle);
+
+    TEST_ESP_OK(nvs_flash_deinit_partition(NVS_DEFAULT_PART_NAME));
+}
+
+TEST_CASE("recovery from power-off during nvs batch commit", "[nvs]")
+{
+    const uint32_t NVS_FLASH_SECTOR = 0;
+    const uint32_t NVS_FLASH_SECTOR_COUNT_MIN = 4;
+    const size_t KEY_COUNT = 40;
+
+    for (size_t errDelay = 0; ; errDelay += 3) {
+        INFO(errDelay);
+        PartitionEmulationFixture f(0, 4);
+        TEST_ESP_OK(nvs::NVSPartitionManager::get_instance()->init_custom(f.part(),
+                                                                          NVS_FLASH_SECTOR,
+                                                                          NVS_FLASH_SECTOR_COUNT_MIN));
+        nvs_handle_t handle;
+        TEST_ESP_OK(nvs_open("namespace1", NVS_READWRITE, &handle));
+        // fill most of the first page, so that the batch has to continue on the next one
+        for (size_t i = 0; i < KEY_COUNT; ++i) {
+            char key[16];
+            snprintf(key, sizeof(key), "key_%d", static_cast<int>(i));
+            TEST_ESP_OK(nvs_set_u32(handle, key, i));
+        }
+        TEST_ESP_OK(nvs_set_str(handle, "filler", std::string(60 * nvs::Page::ENTRY_SIZE - 1, 'x').c_str()));
+
+        TEST_ESP_OK(nvs_batch_begin(handle));
+        for (size_t i = 0; i < KEY_COUNT; ++i) {
+            char key[16];
+            snprintf(key, sizeof(key), "key_%d", static_cast<int>(i));
+            TEST_ESP_OK(nvs_set_u32(handle, key, 1000 + i));
+        }
+        esp_partition_clear_stats();
+        esp_partition_fail_after(errDelay, ESP_PARTITION_FAIL_AFTER_MODE_BOTH);
+        esp_err_t commit_err = nvs_batch_commit(handle);
+        esp_partition_fail_after(SIZE_MAX, ESP_PARTITION_FAIL_AFTER_MODE_BOTH);
+        nvs_close(handle);
+        TEST_ESP_OK(nvs_flash_deinit_partition(NVS_DEFAULT_PART_NAME));
+
+        // each key holds either the old or the new value, and there is only one of them
+        TEST_ESP_OK(nvs::NVSPartitionManager::get_instance()->init_custom(f.part(),
+                                                                          NVS_FLASH_SECTOR,
+                                                                          NVS_FLASH_SECTOR_COUNT_MIN));
+        TEST_ESP_OK(nvs_open("namespace1", NVS_READWRITE, &handle));
+        size_t used_entries;
+        TEST_ESP_OK(nvs_get_used_entry_count(handle, &used_entries));
+        CHECK(used_entries == KEY_COUNT + 61);
+        for (size_t i = 0; i < KEY_COUNT; ++i) {
+            char key[16];
+            snprintf(key, sizeof(key), "key_%d", static_cast<int>(i));
+            uint32_t value;
+            TEST_ESP_OK(nvs_get_u32(handle, key, &value));
+            if (commit_err == ESP_OK) {
+                CHECK(value == 1000 + i);
+            } else {
+                CHECK((value == i || value == 1000 + i));
+            }
+            TEST_ESP_OK(nvs_erase_key(handle, key));
+            TEST_ESP_ERR(nvs_get_u32(handle, key, &value), ESP_ERR_NVS_NOT_FOUND);
+        }
+        nvs_close(handle);
+        TEST_ESP_OK(nvs_flash_deinit_partition(NVS_DEFAULT_PART_NAME));
+
+        if (commit_err == ESP_OK) {
+            break;
+        }
+    }
+}
+
+static void fill_for_compaction(nvs_handle_t handle, size_t key_count, size_t updates_per_key)
+{
+    // interleave long-lived keys with frequent updates of one counter, so that each page ends up with
+    // a few live items between many erased entries
+    uint32_t counter = 0;
+    for (size_t i = 0; i < key_count; ++i) {
+        char key[16];
+        snprintf(key, sizeof(key), "static_%d", static_cast<int>(i));
+        TEST_ESP_OK(nvs_set_str(handle, key, (std::string(key) + std::string(40, 'x')).c_str()));
+        for (size_t j = 0; j < updates_per_key; ++j) {
+            TEST_ESP_OK(nvs_set_u32(handle, "counter", counter++));
+        }
+    }
+}
+
+static void check_compacted_values(nvs_handle_t handle, size_t key_count, uint32_t counter)
+{
+    for (size_t i = 0; i < key_count; ++i) {
+        char key[16];
+        snprintf(key, sizeof(key), "static_%d", static_cast<int>(i));
+        char buf[64];
+        size_t len = sizeof(buf);
+        TEST_ESP_OK(nvs_get_str(handle, key, buf, &len));
+        CHECK(std::string(buf) == std::string(key) + std::string(40, 'x'));
+    }
+    uint32_t value;
+    TEST_ESP_OK(nvs_get_u32(handle, "counter", &value));
+    CHECK(value == counter);
+}
+
+TEST_CASE("nvs compaction step frees pages ahead of writes", "[nvs]")
+{
+    const size_t KEY_COUNT = 40;
+    const size_t UPDATES_PER_KEY = 8;
+    PartitionEmulationFixture f(0, 6);
+    TEST_ESP_ERR(nvs_flash_compact_step(NVS_DEFAULT_PART_NAME, 16), ESP_ERR_NVS_NOT_INITIALIZED);
+    TEST_ESP_OK(nvs::NVSPartitionManager::get_instance()->init_custom(f.part(), 0, 6));
+    TEST_ESP_ERR(nvs_flash_compact_step(NVS_DEFAULT_PART_NAME, 0), ESP_ERR_INVALID_ARG);
+
+    nvs_handle_t handle;
+    TEST_ESP_OK(nvs_open("namespace1", NVS_READWRITE, &handle));
+    fill_for_compaction(handle, KEY_COUNT, UPDATES_PER_KEY);
+
+    esp_err_t err;
+    size_t steps = 0;
+    while ((err = nvs_flash_compact_step(NVS_DEFAULT_PART_NAME, 16)) == ESP_ERR_NOT_FINISHED) {
+        ++steps;
+        REQUIRE(steps < 100);
+    }
+    TEST_ESP_OK(err);
+    CHECK(steps > 0);
+    nvs_stats_t stats;
+    TEST_ESP_OK(nvs_get_stats(NVS_DEFAULT_PART_NAME, &stats));
+    CHECK(stats.used_entries == KEY_COUNT * 3 + 2);
+    check_compacted_values(handle, KEY_COUNT, KEY_COUNT * UPDATES_PER_KEY - 1);
+
+    // nothing left to do, and the next page worth of writes doesn't have to erase anything
+    TEST_ESP_OK(nvs_flash_compact_step(NVS_DEFAULT_PART_NAME, 16));
+    esp_partition_clear_stats();
+    for (size_t i = 0; i < nvs::Page::ENTRY_COUNT; ++i) {
+        TEST_ESP_OK(nvs_set_u32(handle, "counter", i));
+    }
+    CHECK(esp_partition_get_erase_ops() == 0);
+
+    nvs_close(handle);
+    TEST_ESP_OK(nvs_flash_deinit_partition(NVS_DEFAULT_PART_NAME));
+}
+
+TEST_CASE("recovery from power-off during nvs compaction", "[nvs]")
+{
+    const size_t KEY_COUNT = 40;
+    const size_t UPDATES_PER_KEY = 8;
+
+    for (size_t errDelay = 0; ; errDelay += 5) {
+        INFO(errDelay);
+        PartitionEmulationFixture f(0, 6);
+        TEST_ESP_OK(nvs::NVSPartitionManager::get_instance()->init_custom(f.part(), 0, 6));
+        nvs_handle_t handle;
+        TEST_ESP_OK(nvs_open("namespace1", NVS_READWRITE, &handle));
+        fill_for_compaction(handle, KEY_COUNT, UPDATES_PER_KEY);
+
+        esp_partition_fail_after(errDelay, ESP_PARTITION_FAIL_AFTER_MODE_BOTH);
+        esp_err_t err;
+        while ((err = nvs_flash_compact_step(NVS_DEFAULT_PART_NAME, 16)) == ESP_ERR_NOT_FINISHED) {
+        }
+        esp_partition_fail_after(SIZE_MAX, ESP_PARTITION_FAIL_AFTER_MODE_BOTH);
+        nvs_close(handle);
+        TEST_ESP_OK(nvs_flash_deinit_partition(NVS_DEFAULT_PART_NAME));
+
+        // all items survive exactly once
+        TEST_ESP_OK(nvs::NVSPartitionManager::get_instance()->init_custom(f.part(), 0, 6));
+        TEST_ESP_OK(nvs_open("namespace1", NVS_READWRITE, &handle));
+        size_t used_entries;
+        TEST_ESP_OK(nvs_get_used_entry_count(handle, &used_entries));
+        CHECK(used_entries == KEY_COUNT * 3 + 1);
+        check_compacted_values(handle, KEY_COUNT, KEY_COUNT * UPDATES_PER_KEY - 1);
+        nvs_close(handle);
+        TEST_ESP_OK(nvs_flash_deinit_partition(NVS_DEFAULT_PART_NAME));
+
+        if (err == ESP_OK) {
+            break;
+        }
+    }
+}
+
 TEST_CASE("nvs iterator nvs_entry_find invalid parameter test", "[nvs]")
 {
     nvs_iterator_t it = reinterpret_cast<nvs_iterator_t>(0xbeef);
@@ -1804,6 +2352,112 @@ TEST_CASE("Reading multi-page blobs", "[nvs]")
     TEST_ESP_OK(nvs_flash_deinit_partition(f.part()->get_partition_name()));
 }
 
+TEST_CASE("Multi-page blobs can be read with a blob reader", "[nvs]")
+{
+    const size_t blob_size = nvs::Page::CHUNK_MAX_SIZE * 3 + 100;
+    static uint8_t blob[blob_size];
+    static uint8_t blob_read[blob_size];
+    PartitionEmulationFixture f(0, 10);
+    TEST_ESP_OK(nvs::NVSPartitionManager::get_instance()->init_custom(f.part(), 0, 10));
+    nvs_handle_t handle;
+    for (size_t i = 0; i < blob_size; ++i) {
+        blob[i] = static_cast<uint8_t>(i * 7);
+    }
+    TEST_ESP_OK(nvs_open("readTest", NVS_READWRITE, &handle));
+    TEST_ESP_OK(nvs_set_blob(handle, "abc", blob, blob_size));
+
+    nvs_blob_reader_t reader;
+    size_t size;
+    TEST_ESP_ERR(nvs_blob_reader_open(handle, "xyz", &reader, &size), ESP_ERR_NVS_NOT_FOUND);
+
+    // slices of an odd size cross the entry and chunk boundaries at every possible offset
+    TEST_ESP_OK(nvs_blob_reader_open(handle, "abc", &reader, &size));
+    CHECK(size == blob_size);
+    size_t offset = 0;
+    size_t read_size;
+    do {
+        size_t slice = std::min<size_t>(61, blob_size - offset + 3);
+        TEST_ESP_OK(nvs_blob_reader_read(reader, blob_read + offset, slice, &read_size));
+        offset += read_size;
+    } while (read_size > 0);
+    CHECK(offset == blob_size);
+    CHECK(memcmp(blob, blob_read, blob_size) == 0);
+    nvs_blob_reader_close(reader);
+
+    // pointers into the mapped partition end at the chunk boundaries
+    memset(blob_read, 0xee, blob_size);
+    TEST_ESP_OK(nvs_blob_reader_open(handle, "abc", &reader, nullptr));
+    offset = 0;
+    size_t slices = 0;
+    const void* ptr;
+    while (true) {
+        TEST_ESP_OK(nvs_blob_reader_read_ptr(reader, &ptr, blob_size, &read_size));
+        if (read_size == 0) {
+            break;
+        }
+        memcpy(blob_read + offset, ptr, read_size);
+        offset += read_size;
+        ++slices;
+    }
+    CHECK(offset == blob_size);
+    CHECK(slices == 4);
+    CHECK(memcmp(blob, blob_read, blob_size) == 0);
+    nvs_blob_reader_close(reader);
+
+    // a reader fails instead of mixing the data of two versions of the blob
+    TEST_ESP_OK(nvs_blob_reader_open(handle, "abc", &reader, nullptr));
+    TEST_ESP_OK(nvs_blob_reader_read(reader, blob_read, 100, &read_size));
+    blob[0] ^= 0xff;
+    TEST_ESP_OK(nvs_set_blob(handle, "abc", blob, blob_size));
+    TEST_ESP_ERR(nvs_blob_reader_read(reader, blob_read, 100, &read_size), ESP_ERR_NVS_NOT_FOUND);
+    TEST_ESP_ERR(nvs_blob_reader_read(reader, blob_read, 100, &read_size), ESP_ERR_NVS_NOT_FOUND);
+    nvs_blob_reader_close(reader);
+
+    nvs_close(handle);
+    TEST_ESP_OK(nvs_flash_deinit_partition(f.part()->get_partition_name()));
+}
+
+TEST_CASE("blob reader checks the crc of each chunk", "[nvs]")
+{
+    PartitionEmulationFixture f(0, 3);
+    TEST_ESP_OK(nvs::NVSPartitionManager::get_instance()->init_custom(f.part(), 0, 3));
+    nvs_handle_t handle;
+    uint8_t blob[64];
+    memset(blob, 0x5a, sizeof(blob));
+    TEST_ESP_OK(nvs_open("test", NVS_READWRITE, &handle));
+    TEST_ESP_OK(nvs_set_blob(handle, "abc", blob, sizeof(blob)));
+
+    // entry 0 holds the namespace, entry 1 the header of the chunk and entries 2 and 3 its data
+    nvs::Page page;
+    size_t index = 0;
+    nvs::Item item;
+    for (uint32_t sector = 0; sector < 3; ++sector) {
+        TEST_ESP_OK(page.load(f.part(), sector));
+        if (page.findItem(1, nvs::ItemType::BLOB_DATA, "abc", index, item) == ESP_OK) {
+            break;
+        }
+    }
+    CHECK(index == 1);
+    uint32_t address;
+    TEST_ESP_OK(page.getItemDataAddress(index, &address));
+    address += nvs::Page::ENTRY_SIZE;
+    const uint32_t zero = 0;
+    TEST_ESP_OK(esp_partition_write_raw(&f.esp_partition, address, &zero, sizeof(zero)));
+
+    nvs_blob_reader_t reader;
+    TEST_ESP_OK(nvs_blob_reader_open(handle, "abc", &reader, nullptr));
+    uint8_t blob_read[64];
+    size_t read_size;
+    TEST_ESP_OK(nvs_blob_reader_read(reader, blob_read, 32, &read_size));
+    CHECK(read_size == 32);
+    TEST_ESP_ERR(nvs_blob_reader_read(reader, blob_read, 32, &read_size), ESP_ERR_INVALID_CRC);
+    TEST_ESP_ERR(nvs_blob_reader_read(reader, blob_read, 32, &read_size), ESP_ERR_INVALID_CRC);
+    nvs_blob_reader_close(reader);
+
+    nvs_close(handle);
+    TEST_ESP_OK(nvs_flash_deinit_partition(f.part()->get_partition_name()));
+}
+
 TEST_CASE("Modification of values for Multi-page blobs are supported", "[nvs]")
 {
     const size_t blob_size = nvs::Page::CHUNK_MAX_SIZE * 2;
@@ -3233,6 +3887,16 @@ TEST_CASE("Check that NVS supports old blob format without blob index", "[nvs]")
     /* Check that item is stored in old format without blob index*/
     TEST_ESP_OK(p.findItem(1, nvs::ItemType::BLOB, "dummyHex2BinKey"));
 
+    /* Check that a blob reader reads the old format too*/
+    nvs_blob_reader_t reader;
+    size_t size;
+    TEST_ESP_OK(nvs_blob_reader_open(handle, "dummyHex2BinKey", &reader, &size));
+    CHECK(size == sizeof(hexdata));
+    TEST_ESP_OK(nvs_blob_reader_read(reader, buf, sizeof(buf), &buflen));
+    CHECK(buflen == sizeof(hexdata));
+    CHECK(memcmp(buf, hexdata, sizeof(hexdata)) == 0);
+    nvs_blob_reader_close(reader);
+
     /* Modify the blob so that it is stored in the new format*/
     hexdata[0] = hexdata[1] = hexdata[2] = 0x99;
     TEST_ESP_OK(nvs_set_blob(handle, "dummyHex2BinKey", hexdata, sizeof(hexdata)));
@@ -3895,6 +4559,238 @@ TEST_CASE("nvs find key tests", "[nvs]")
     nvs_close(handle_2);
     TEST_ESP_OK(nvs_flash_deinit_partition(NVS_DEFAULT_PART_NAME));
 }
+TEST_CASE("key lookups on a partition with many pages", "[nvs]")
+{
+    const size_t PAGE_COUNT = 64;
+    PartitionEmulationFixture f(0, PAGE_COUNT);
+    nvs::Storage storage(f.part());
+    TEST_ESP_OK(storage.init(0, PAGE_COUNT));
+
+    // fill most of the pages with a few strings each
+    char str[1000];
+    fill_n(str, sizeof(str) - 1, 'x');
+    str[sizeof(str) - 1] = 0;
+    const size_t keyCount = (PAGE_COUNT - 8) * 3;
+    char key[16];
+    for (size_t i = 0; i < keyCount; ++i) {
+        snprintf(key, sizeof(key), "key%d", (int) i);
+        TEST_ESP_OK(storage.writeItem(1, nvs::ItemType::SZ, key, str, sizeof(str)));
+    }
+
+    const size_t iterations = 10000;
+    size_t dataSize;
+    snprintf(key, sizeof(key), "key%d", (int) keyCount - 1);
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        TEST_ESP_OK(storage.getItemDataSize(1, nvs::ItemType::SZ, key, dataSize));
+    }
+    auto hit_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        TEST_ESP_ERR(storage.getItemDataSize(1, nvs::ItemType::SZ, "missing", dataSize), ESP_ERR_NVS_NOT_FOUND);
+    }
+    auto miss_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+    s_perf << "CPU time for " << iterations << " lookups on " << PAGE_COUNT << " pages (key index "
+#ifdef CONFIG_NVS_KEY_INDEX
+           << "enabled"
+#else
+           << "disabled"
+#endif
+           << "): last key " << hit_us << " us, missing key " << miss_us << " us" << std::endl;
+}
+
+TEST_CASE("batch writes need fewer flash operations than single writes", "[nvs]")
+{
+    const size_t KEY_COUNT = 40;
+    size_t write_ops[2];
+    size_t write_bytes[2];
+
+    for (int batch = 0; batch < 2; ++batch) {
+        PartitionEmulationFixture f(0, 8);
+        TEST_ESP_OK(nvs::NVSPartitionManager::get_instance()->init_custom(f.part(), 0, 8));
+        nvs_handle_t handle;
+        TEST_ESP_OK(nvs_open("factory", NVS_READWRITE, &handle));
+        // write all keys once, so that the measured round also has to erase the previous values
+        for (size_t i = 0; i < KEY_COUNT; ++i) {
+            char key[16];
+            snprintf(key, sizeof(key), "prov_%d", static_cast<int>(i));
+            TEST_ESP_OK(nvs_set_u32(handle, key, i));
+        }
+
+        esp_partition_clear_stats();
+        if (batch) {
+            TEST_ESP_OK(nvs_batch_begin(handle));
+        }
+        for (size_t i = 0; i < KEY_COUNT; ++i) {
+            char key[16];
+            snprintf(key, sizeof(key), "prov_%d", static_cast<int>(i));
+            if (i % 4 == 0) {
+                TEST_ESP_OK(nvs_set_str(handle, key, "provisioning string value"));
+            } else {
+                TEST_ESP_OK(nvs_set_u32(handle, key, 1000 + i));
+            }
+        }
+        if (batch) {
+            TEST_ESP_OK(nvs_batch_commit(handle));
+        }
+        write_ops[batch] = esp_partition_get_write_ops();
+        write_bytes[batch] = esp_partition_get_write_bytes();
+
+        nvs_close(handle);
+        TEST_ESP_OK(nvs_flash_deinit_partition(NVS_DEFAULT_PART_NAME));
+    }
+
+    CHECK(write_ops[1] * 4 < write_ops[0]);
+    s_perf << "Flash writes to update " << KEY_COUNT << " keys: one by one " << write_ops[0] << " ops (" << write_bytes[0]
+           << " bytes), batch " << write_ops[1] << " ops (" << write_bytes[1] << " bytes)" << std::endl;
+}
+
+TEST_CASE("background compaction keeps erases off the write path", "[nvs]")
+{
+    const size_t KEY_COUNT = 20;
+    const size_t WRITE_COUNT = 2000;
+    size_t erasing_writes[2];
+    size_t max_write_us[2];
+
+    for (int compact = 0; compact < 2; ++compact) {
+        PartitionEmulationFixture f(0, 6);
+        TEST_ESP_OK(nvs::NVSPartitionManager::get_instance()->init_custom(f.part(), 0, 6));
+        nvs_handle_t handle;
+        TEST_ESP_OK(nvs_open("namespace1", NVS_READWRITE, &handle));
+        for (size_t i = 0; i < KEY_COUNT; ++i) {
+            char key[16];
+            snprintf(key, sizeof(key), "static_%d", static_cast<int>(i));
+            TEST_ESP_OK(nvs_set_u32(handle, key, i));
+        }
+
+        erasing_writes[compact] = 0;
+        max_write_us[compact] = 0;
+        for (size_t i = 0; i < WRITE_COUNT; ++i) {
+            esp_partition_clear_stats();
+            TEST_ESP_OK(nvs_set_u32(handle, "counter", i));
+            if (esp_partition_get_erase_ops() > 0) {
+                ++erasing_writes[compact];
+            }
+            max_write_us[compact] = std::max(max_write_us[compact], esp_partition_get_total_time());
+            // idle time between the writes
+            if (compact) {
+                esp_err_t err = nvs_flash_compact_step(NVS_DEFAULT_PART_NAME, 32);
+                CHECK((err == ESP_OK || err == ESP_ERR_NOT_FINISHED));
+            }
+        }
+
+        nvs_close(handle);
+        TEST_ESP_OK(nvs_flash_deinit_partition(NVS_DEFAULT_PART_NAME));
+    }
+
+    CHECK(erasing_writes[0] > 0);
+    CHECK(erasing_writes[1] == 0);
+    s_perf << "Writes which erased a page out of " << WRITE_COUNT << ": without compaction " << erasing_writes[0]
+           << " (max " << max_write_us[0] << " us), with compaction steps " << erasing_writes[1]
+           << " (max " << max_write_us[1] << " us)" << std::endl;
+}
+
+TEST_CASE("mount time of a large partition", "[nvs]")
+{
+    const size_t PAGE_COUNT = 64;
+    PartitionEmulationFixture f(0, PAGE_COUNT);
+    {
+        nvs::Storage storage(f.part());
+        TEST_ESP_OK(storage.init(0, PAGE_COUNT));
+        uint8_t nsIndex;
+        TEST_ESP_OK(storage.createOrOpenNamespace("config", true, nsIndex));
+        char key[16];
+        for (size_t i = 0; i < (PAGE_COUNT - 4) * 100; ++i) {
+            snprintf(key, sizeof(key), "key%d", (int) i);
+            TEST_ESP_OK(storage.writeItem(nsIndex, key, static_cast<uint32_t>(i)));
+        }
+    }
+
+    nvs::Storage storage(f.part());
+    esp_partition_clear_stats();
+    TEST_ESP_OK(storage.init(0, PAGE_COUNT));
+    size_t mount_us = esp_partition_get_total_time();
+    size_t mount_reads = esp_partition_get_read_ops();
+
+    // open the namespace and read one of the first keys, as an application would do right after boot
+    esp_partition_clear_stats();
+    uint8_t nsIndex;
+    TEST_ESP_OK(storage.createOrOpenNamespace("config", false, nsIndex));
+    uint32_t value;
+    TEST_ESP_OK(storage.readItem(nsIndex, "key1", value));
+    CHECK(value == 1);
+    size_t first_read_us = esp_partition_get_total_time();
+
+    s_perf << "Time to mount " << PAGE_COUNT << " full pages (lazy mount "
+#ifdef CONFIG_NVS_LAZY_MOUNT
+           << "enabled"
+#else
+           << "disabled"
+#endif
+           << "): " << mount_us << " us (" << mount_reads << " reads), first read " << first_read_us << " us" << std::endl;
+}
+
+TEST_CASE("reading a large blob through a blob reader", "[nvs]")
+{
+    const size_t PAGE_COUNT = 8;
+    const size_t blob_size = nvs::Page::CHUNK_MAX_SIZE * 4;
+    const size_t slice_size = 256;
+    PartitionEmulationFixture f(0, PAGE_COUNT);
+    TEST_ESP_OK(nvs::NVSPartitionManager::get_instance()->init_custom(f.part(), 0, PAGE_COUNT));
+    nvs_handle_t handle;
+    TEST_ESP_OK(nvs_open("test", NVS_READWRITE, &handle));
+    std::vector<uint8_t> blob(blob_size);
+    for (size_t i = 0; i < blob_size; ++i) {
+        blob[i] = static_cast<uint8_t>(i);
+    }
+    TEST_ESP_OK(nvs_set_blob(handle, "cert", blob.data(), blob_size));
+
+    std::vector<uint8_t> blob_read(blob_size);
+    size_t read_size = blob_size;
+    esp_partition_clear_stats();
+    TEST_ESP_OK(nvs_get_blob(handle, "cert", blob_read.data(), &read_size));
+    size_t get_us = esp_partition_get_total_time();
+    size_t get_reads = esp_partition_get_read_ops();
+    CHECK(blob_read == blob);
+
+    nvs_blob_reader_t reader;
+    uint8_t slice[slice_size];
+    uint32_t crc = nvs::Item::calculateCrc32(nullptr, 0);
+    esp_partition_clear_stats();
+    TEST_ESP_OK(nvs_blob_reader_open(handle, "cert", &reader, nullptr));
+    do {
+        TEST_ESP_OK(nvs_blob_reader_read(reader, slice, slice_size, &read_size));
+        crc = nvs::Item::updateCrc32(crc, slice, read_size);
+    } while (read_size > 0);
+    nvs_blob_reader_close(reader);
+    size_t stream_us = esp_partition_get_total_time();
+    size_t stream_reads = esp_partition_get_read_ops();
+    CHECK(crc == nvs::Item::calculateCrc32(blob.data(), blob_size));
+
+    const void* ptr;
+    crc = nvs::Item::calculateCrc32(nullptr, 0);
+    esp_partition_clear_stats();
+    TEST_ESP_OK(nvs_blob_reader_open(handle, "cert", &reader, nullptr));
+    do {
+        TEST_ESP_OK(nvs_blob_reader_read_ptr(reader, &ptr, blob_size, &read_size));
+        crc = nvs::Item::updateCrc32(crc, static_cast<const uint8_t*>(ptr), read_size);
+    } while (read_size > 0);
+    nvs_blob_reader_close(reader);
+    size_t mmap_us = esp_partition_get_total_time();
+    size_t mmap_reads = esp_partition_get_read_ops();
+    CHECK(crc == nvs::Item::calculateCrc32(blob.data(), blob_size));
+
+    s_perf << "Time to read a " << blob_size << " byte blob: nvs_get_blob " << get_us << " us (" << get_reads
+           << " reads, " << blob_size << " byte buffer), blob reader " << stream_us << " us (" << stream_reads
+           << " reads, " << slice_size << " byte buffer), mapped blob reader " << mmap_us << " us (" << mmap_reads
+           << " reads, no buffer)" << std::endl;
+
+    nvs_close(handle);
+    TEST_ESP_OK(nvs_flash_deinit_partition(f.part()->get_partition_name()));
+}
+
 /* Add new tests above */
 /* This test has to be the final one */
 
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2015-2022 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2015-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -179,3 +179,78 @@ TEST_CASE("NVSHandleSimple CXX api read/write blob", "[nvs cxx]")
 
     nvs::NVSPartitionManager::get_instance()->deinit_partition("nvs");
 }
+
+TEST_CASE("NVSHandleSimple CXX api read blob stream", "[nvs cxx]")
+{
+    const uint32_t NVS_FLASH_SECTOR = 6;
+    const uint32_t NVS_FLASH_SECTOR_COUNT_MIN = 3;
+    PartitionEmulationFixture f(0, 10);
+    const char blob [6] = {15, 16, 17, 18, 19};
+    char read_blob[6] = {0};
+    size_t read_len;
+    esp_err_t result;
+    shared_ptr<nvs::NVSHandle> handle;
+    unique_ptr<nvs::NVSBlobStream> stream;
+
+    REQUIRE(nvs::NVSPartitionManager::get_instance()->init_custom(f.part(), NVS_FLASH_SECTOR, NVS_FLASH_SECTOR_COUNT_MIN)
+            == ESP_OK);
+
+    handle = nvs::open_nvs_handle("test_ns", NVS_READWRITE, &result);
+    CHECK(result == ESP_OK);
+    REQUIRE(handle);
+
+    CHECK(handle->get_blob_stream("test", stream) == ESP_ERR_NVS_NOT_FOUND);
+    CHECK(!stream);
+
+    CHECK(handle->set_blob("test", blob, sizeof(blob)) == ESP_OK);
+    REQUIRE(handle->get_blob_stream("test", stream) == ESP_OK);
+    CHECK(stream->get_size() == sizeof(blob));
+
+    CHECK(stream->read(read_blob, 4, read_len) == ESP_OK);
+    CHECK(read_len == 4);
+    CHECK(stream->read(read_blob + 4, 4, read_len) == ESP_OK);
+    CHECK(read_len == 2);
+    CHECK(stream->read(read_blob, 4, read_len) == ESP_OK);
+    CHECK(read_len == 0);
+    CHECK(vector<char>(blob, blob + sizeof(blob)) == vector<char>(read_blob, read_blob + sizeof(read_blob)));
+    stream.reset();
+
+    nvs::NVSPartitionManager::get_instance()->deinit_partition("nvs");
+}
+
+TEST_CASE("NVSHandleSimple CXX api batch write", "[nvs cxx]")
+{
+    const uint32_t NVS_FLASH_SECTOR = 6;
+    const uint32_t NVS_FLASH_SECTOR_COUNT_MIN = 3;
+    PartitionEmulationFixture f(0, 10);
+    char read_buffer [256];
+    uint32_t value = 0;
+    esp_err_t result;
+    shared_ptr<nvs::NVSHandle> handle;
+
+    REQUIRE(nvs::NVSPartitionManager::get_instance()->init_custom(f.part(), NVS_FLASH_SECTOR, NVS_FLASH_SECTOR_COUNT_MIN)
+            == ESP_OK);
+
+    handle = nvs::open_nvs_handle("test_ns", NVS_READWRITE, &result);
+    CHECK(result == ESP_OK);
+    REQUIRE(handle);
+
+    CHECK(handle->batch_begin() == ESP_OK);
+    CHECK(handle->set_item("value", 47u) == ESP_OK);
+    CHECK(handle->set_string("test", "test string") == ESP_OK);
+    CHECK(handle->get_item("value", value) == ESP_ERR_NVS_NOT_FOUND);
+    CHECK(handle->batch_commit() == ESP_OK);
+
+    CHECK(handle->get_item("value", value) == ESP_OK);
+    CHECK(value == 47u);
+    CHECK(handle->get_string("test", read_buffer, sizeof(read_buffer)) == ESP_OK);
+    CHECK(string(read_buffer) == "test string");
+
+    CHECK(handle->batch_begin() == ESP_OK);
+    CHECK(handle->set_item("value", 48u) == ESP_OK);
+    CHECK(handle->batch_abort() == ESP_OK);
+    CHECK(handle->get_item("value", value) == ESP_OK);
+    CHECK(value == 47u);
+
+    nvs::NVSPartitionManager::get_instance()->deinit_partition("nvs");
+}
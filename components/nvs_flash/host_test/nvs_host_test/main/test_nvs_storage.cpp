@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2015-2022 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2015-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -43,3 +43,40 @@ TEST_CASE("Storage iterator recognizes blob with VerOffset::VER_1_OFFSET", "[nvs
 
     REQUIRE(nvs::NVSPartitionManager::get_instance()->deinit_partition("test") == ESP_OK);
 }
+
+TEST_CASE("Storage finds the latest value of each key after pages were reclaimed", "[nvs_storage]")
+{
+    PartitionEmulationFixture f(0, 5);
+    nvs::Storage storage(f.part());
+    REQUIRE(storage.init(0, 5) == ESP_OK);
+
+    const int key_count = 100;
+    char key[16];
+    // rewriting all keys several times makes the page manager reclaim pages
+    for (int round = 0; round < 10; ++round) {
+        for (int i = 0; i < key_count; ++i) {
+            snprintf(key, sizeof(key), "key%d", i);
+            REQUIRE(storage.writeItem(1, key, round * key_count + i) == ESP_OK);
+        }
+    }
+    for (int i = 0; i < key_count; i += 2) {
+        snprintf(key, sizeof(key), "key%d", i);
+        REQUIRE(storage.eraseItem(1, key) == ESP_OK);
+    }
+
+    // check the storage which did all the modifications, and one loaded from flash
+    nvs::Storage reloaded(f.part());
+    REQUIRE(reloaded.init(0, 5) == ESP_OK);
+    for (nvs::Storage *s : {&storage, &reloaded}) {
+        for (int i = 0; i < key_count; ++i) {
+            snprintf(key, sizeof(key), "key%d", i);
+            int value = -1;
+            if (i % 2 == 0) {
+                CHECK(s->readItem(1, key, value) == ESP_ERR_NVS_NOT_FOUND);
+            } else {
+                CHECK(s->readItem(1, key, value) == ESP_OK);
+                CHECK(value == 9 * key_count + i);
+            }
+        }
+    }
+}
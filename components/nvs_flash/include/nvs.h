@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2015-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2015-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -127,6 +127,11 @@ typedef struct {
  */
 typedef struct nvs_opaque_iterator_t *nvs_iterator_t;
 
+/**
+ * Opaque pointer type representing a sequential reader of a blob
+ */
+typedef struct nvs_opaque_blob_reader_t *nvs_blob_reader_t;
+
 /**
  * @brief      Open non-volatile storage with a given namespace from the default NVS partition
  *
@@ -501,6 +506,81 @@ esp_err_t nvs_get_str (nvs_handle_t handle, const char* key, char* out_value, si
 esp_err_t nvs_get_blob(nvs_handle_t handle, const char* key, void* out_value, size_t* length);
 /**@}*/
 
+/**
+ * @brief      Open a reader which reads a blob sequentially, chunk by chunk
+ *
+ * Unlike \c nvs_get_blob, the blob doesn't have to fit into a single buffer: \c nvs_blob_reader_read
+ * copies the data slice by slice, and \c nvs_blob_reader_read_ptr hands out pointers into the memory mapped
+ * partition without copying it at all.
+ *
+ * The data of each chunk is checked against its checksum once the end of the chunk has been read. If the check
+ * fails, the read returns ESP_ERR_INVALID_CRC and the data returned since the beginning of the chunk must be
+ * discarded. Once a read has failed, all further reads of the reader fail with the same error.
+ *
+ * The reader stays usable if the handle is closed, but it must be closed before the partition is de-initialized.
+ *
+ * @param[in]  handle      Storage handle obtained with nvs_open.
+ * @param[in]  key         Key name. Maximum length is (NVS_KEY_NAME_MAX_SIZE-1) characters. Shouldn't be empty.
+ * @param[out] out_reader  Pointer to the output variable populated with the reader.
+ * @param[out] out_size    Pointer to the output variable populated with the size of the blob. May be NULL.
+ *
+ * @return
+ *             - ESP_OK if the reader has been opened
+ *             - ESP_ERR_INVALID_ARG if key or out_reader is NULL
+ *             - ESP_ERR_NVS_NOT_FOUND if the requested blob doesn't exist
+ *             - ESP_ERR_NVS_INVALID_HANDLE if handle has been closed or is NULL
+ *             - ESP_ERR_NO_MEM if memory for the reader could not be allocated
+ *             - other error codes from the underlying storage driver
+ */
+esp_err_t nvs_blob_reader_open(nvs_handle_t handle, const char* key, nvs_blob_reader_t* out_reader, size_t* out_size);
+
+/**
+ * @brief      Read the next bytes of a blob
+ *
+ * @param[in]  reader      Reader obtained with nvs_blob_reader_open.
+ * @param[out] out_value   Buffer of at least length bytes.
+ * @param[in]  length      Number of bytes to read.
+ * @param[out] out_length  Pointer to the output variable populated with the number of bytes read.
+ *                         It is less than length only at the end of the blob.
+ *
+ * @return
+ *             - ESP_OK if the data has been read
+ *             - ESP_ERR_INVALID_ARG if one of the pointers is NULL
+ *             - ESP_ERR_NVS_NOT_FOUND if a chunk is missing, e.g. because the blob has been written again
+ *               or erased while it was read
+ *             - ESP_ERR_NVS_INVALID_LENGTH if the sizes of the chunks don't match the size of the blob
+ *             - ESP_ERR_INVALID_CRC if the data of a chunk doesn't match its checksum
+ *             - other error codes from the underlying storage driver
+ */
+esp_err_t nvs_blob_reader_read(nvs_blob_reader_t reader, void* out_value, size_t length, size_t* out_length);
+
+/**
+ * @brief      Get a pointer to the next bytes of a blob without copying them
+ *
+ * The data is read through a memory mapping of the partition, see \c esp_partition_mmap.
+ * A slice ends at the end of a chunk, so out_length may be less than length before the end of the blob.
+ * The pointer is valid until the next read or until the reader is closed.
+ *
+ * @param[in]  reader      Reader obtained with nvs_blob_reader_open.
+ * @param[out] out_ptr     Pointer to the output variable populated with the pointer to the data.
+ * @param[in]  length      Maximum number of bytes to return.
+ * @param[out] out_length  Pointer to the output variable populated with the number of bytes returned.
+ *                         It is 0 at the end of the blob.
+ *
+ * @return
+ *             - the same codes as \c nvs_blob_reader_read
+ *             - ESP_ERR_NOT_SUPPORTED if the partition can't be mapped, e.g. because it uses NVS encryption.
+ *               The reader is not advanced and \c nvs_blob_reader_read can be used instead.
+ */
+esp_err_t nvs_blob_reader_read_ptr(nvs_blob_reader_t reader, const void** out_ptr, size_t length, size_t* out_length);
+
+/**
+ * @brief      Close a blob reader and release its resources
+ *
+ * @param[in]  reader      Reader obtained with nvs_blob_reader_open. NULL argument is allowed.
+ */
+void nvs_blob_reader_close(nvs_blob_reader_t reader);
+
 /**
  * @brief      Lookup key-value pair with given key name.
  *
@@ -576,6 +656,67 @@ esp_err_t nvs_erase_all(nvs_handle_t handle);
  */
 esp_err_t nvs_commit(nvs_handle_t handle);
 
+/**
+ * @brief      Start staging writes done through the handle in RAM
+ *
+ * After this call, the nvs_set_* functions only record the new value for the key in RAM.
+ * The staged values are written by \c nvs_batch_commit (or \c nvs_commit), which packs consecutive
+ * items into a single flash write per page and erases the previous values with as few updates of the
+ * page entry tables as possible. This is much faster than writing the values one by one when many keys
+ * are written at once, for example during provisioning.
+ *
+ * While a batch is open:
+ * - the nvs_get_* functions return the values stored in flash, not the staged ones;
+ * - setting a key again replaces its staged value;
+ * - \c nvs_erase_key drops the staged value of the key and \c nvs_erase_all drops all staged values,
+ *   in addition to erasing the stored ones;
+ * - closing the handle drops the staged values.
+ *
+ * The values of a batch are not committed atomically: if power is lost during \c nvs_batch_commit,
+ * each key holds either its previous or its new value.
+ *
+ * @param[in]  handle  Storage handle obtained with nvs_open.
+ *                     Handles that were opened read only cannot be used.
+ *
+ * @return
+ *             - ESP_OK if the batch has been started
+ *             - ESP_ERR_NVS_INVALID_HANDLE if handle has been closed or is NULL
+ *             - ESP_ERR_NVS_READ_ONLY if storage handle was opened as read only
+ *             - ESP_ERR_NVS_INVALID_STATE if a batch has already been started on this handle
+ */
+esp_err_t nvs_batch_begin(nvs_handle_t handle);
+
+/**
+ * @brief      Write all values staged since \c nvs_batch_begin and end the batch
+ *
+ * The batch ends even if writing fails; values which have not been written by then are dropped.
+ * Blobs are written one by one, like \c nvs_set_blob would write them.
+ *
+ * @param[in]  handle  Storage handle obtained with nvs_open.
+ *
+ * @return
+ *             - ESP_OK if all staged values have been written successfully
+ *             - ESP_ERR_NVS_INVALID_HANDLE if handle has been closed or is NULL
+ *             - ESP_ERR_NVS_INVALID_STATE if no batch has been started on this handle
+ *             - ESP_ERR_NVS_NOT_ENOUGH_SPACE if there is not enough space to save the values
+ *             - ESP_ERR_NVS_REMOVE_FAILED if a value was written, but its previous value could not be erased
+ *             - ESP_ERR_NO_MEM if memory for packing the values could not be allocated
+ *             - other error codes from the underlying storage driver
+ */
+esp_err_t nvs_batch_commit(nvs_handle_t handle);
+
+/**
+ * @brief      Drop all values staged since \c nvs_batch_begin and end the batch
+ *
+ * @param[in]  handle  Storage handle obtained with nvs_open.
+ *
+ * @return
+ *             - ESP_OK if the batch has been dropped
+ *             - ESP_ERR_NVS_INVALID_HANDLE if handle has been closed or is NULL
+ *             - ESP_ERR_NVS_INVALID_STATE if no batch has been started on this handle
+ */
+esp_err_t nvs_batch_abort(nvs_handle_t handle);
+
 /**
  * @brief      Close the storage handle and free any allocated resources
  *
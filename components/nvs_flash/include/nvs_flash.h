@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2015-2023 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2015-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -130,6 +130,28 @@ esp_err_t nvs_flash_deinit(void);
  */
 esp_err_t nvs_flash_deinit_partition(const char* partition_label);
 
+/**
+ * @brief Perform one step of background compaction of the given NVS partition
+ *
+ * When a write doesn't fit into the active page and the partition is short of free pages,
+ * NVS moves the items of another page and erases it before the write can continue.
+ * Calling this function periodically, e.g. from a low priority task, does this work ahead of time in small
+ * steps, so that writes find a free page and don't have to wait for the erase.
+ * Each call moves approximately ``budget`` entries (at least one item) and erases at most one page.
+ * Compaction only runs while fewer than three pages are free and the erased entries add up to at least a page.
+ *
+ * @param[in]  partition_label   Label of the partition
+ * @param[in]  budget            Number of 32-byte entries which may be moved in this step
+ *
+ * @return
+ *      - ESP_OK if there is nothing (more) to compact
+ *      - ESP_ERR_NOT_FINISHED if the step completed and further steps are needed
+ *      - ESP_ERR_INVALID_ARG if budget is 0
+ *      - ESP_ERR_NVS_NOT_INITIALIZED if the storage for given partition is not initialized
+ *      - one of the error codes from the underlying flash storage driver
+ */
+esp_err_t nvs_flash_compact_step(const char* partition_label, size_t budget);
+
 /**
  * @brief Erase the default NVS partition
  *
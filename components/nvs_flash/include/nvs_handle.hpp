@@ -44,6 +44,55 @@ enum class ItemType : uint8_t {
 NVS_GUARD_SYSVIEW_MACRO_EXPANSION_POP();
 #endif
 
+/**
+ * @brief A stream reading a blob sequentially, obtained with NVSHandle::get_blob_stream.
+ *
+ * The blob is read chunk by chunk, without a buffer for the whole blob. The data of a chunk is checked against
+ * its checksum once the end of the chunk has been read; if the check fails, ESP_ERR_INVALID_CRC is returned and
+ * the data returned since the beginning of the chunk must be discarded.
+ *
+ * Once a read has failed, all further reads fail with the same error.
+ * The stream must be destroyed before the partition is de-initialized.
+ */
+class NVSBlobStream {
+public:
+    virtual ~NVSBlobStream() { }
+
+    /**
+     * @brief Returns the size of the blob in bytes.
+     */
+    virtual size_t get_size() const = 0;
+
+    /**
+     * @brief Reads up to len bytes from the current position of the stream.
+     *
+     * @param[out]    out_data   Buffer of at least len bytes.
+     * @param[in]     len        Number of bytes to read.
+     * @param[out]    read_len   Number of bytes read. Less than len only at the end of the blob.
+     *
+     * @return      - ESP_OK if the data has been read.
+     *              - ESP_ERR_NVS_NOT_FOUND if a chunk is missing, e.g. because the blob has been written again
+     *                or erased while it was read.
+     *              - ESP_ERR_NVS_INVALID_LENGTH if the sizes of the chunks don't match the size of the blob.
+     *              - ESP_ERR_INVALID_CRC if the data of a chunk doesn't match its checksum.
+     *              - other error codes from the underlying storage driver.
+     */
+    virtual esp_err_t read(void* out_data, size_t len, size_t &read_len) = 0;
+
+    /**
+     * @brief Returns a pointer to up to len bytes at the current position of the stream instead of copying them.
+     *
+     * The data is read through a memory mapping of the partition. A slice ends at the end of a chunk,
+     * so read_len may be less than len before the end of the blob. The pointer is valid until the next read
+     * or the destruction of the stream.
+     *
+     * @return      - the same codes as read().
+     *              - ESP_ERR_NOT_SUPPORTED if the partition can't be mapped, e.g. because it is encrypted.
+     *                The position of the stream is not changed, read() can be used instead.
+     */
+    virtual esp_err_t read_ptr(const void* &out_ptr, size_t len, size_t &read_len) = 0;
+};
+
 /**
  * @brief A handle allowing nvs-entry related operations on the NVS.
  *
@@ -165,6 +214,20 @@ public:
     virtual esp_err_t get_string(const char *key, char* out_str, size_t len) = 0;
     virtual esp_err_t get_blob(const char *key, void* out_blob, size_t len) = 0;
 
+    /**
+     * @brief Opens a stream reading the blob with the given key, see NVSBlobStream.
+     *
+     * @param[in]     key        Key name. Maximum length is (NVS_KEY_NAME_MAX_SIZE-1) characters. Shouldn't be empty.
+     * @param[out]    stream     The stream, if it has been opened.
+     *
+     * @return      - ESP_OK if the stream has been opened.
+     *              - ESP_ERR_NVS_NOT_FOUND if the requested blob doesn't exist.
+     *              - ESP_ERR_NVS_INVALID_HANDLE if handle has been closed or is NULL.
+     *              - ESP_ERR_NO_MEM if memory for the stream could not be allocated.
+     *              - other error codes from the underlying storage driver.
+     */
+    virtual esp_err_t get_blob_stream(const char *key, std::unique_ptr<NVSBlobStream> &stream) = 0;
+
     /**
      * @brief Look up the size of an entry's data.
      *
@@ -213,6 +276,40 @@ public:
      */
     virtual esp_err_t commit() = 0;
 
+    /**
+     * @brief Starts staging the writes done through this handle in RAM.
+     *
+     * Until batch_commit() is called, set_item(), set_string() and set_blob() only record the new values.
+     * Reads return the values stored in flash. See \c nvs_batch_begin for details.
+     *
+     * @return      - ESP_OK if the batch has been started.
+     *              - ESP_ERR_NVS_INVALID_HANDLE if handle has been closed or is NULL.
+     *              - ESP_ERR_NVS_READ_ONLY if handle was opened as read only.
+     *              - ESP_ERR_NVS_INVALID_STATE if a batch has already been started.
+     */
+    virtual esp_err_t batch_begin() = 0;
+
+    /**
+     * @brief Writes all values staged since batch_begin() and ends the batch.
+     *
+     * commit() also commits a started batch.
+     *
+     * @return      - ESP_OK if all values have been written.
+     *              - ESP_ERR_NVS_INVALID_HANDLE if handle has been closed or is NULL.
+     *              - ESP_ERR_NVS_INVALID_STATE if no batch has been started.
+     *              - other error codes from the underlying storage driver.
+     */
+    virtual esp_err_t batch_commit() = 0;
+
+    /**
+     * @brief Drops all values staged since batch_begin() and ends the batch.
+     *
+     * @return      - ESP_OK if the batch has been dropped.
+     *              - ESP_ERR_NVS_INVALID_HANDLE if handle has been closed or is NULL.
+     *              - ESP_ERR_NVS_INVALID_STATE if no batch has been started.
+     */
+    virtual esp_err_t batch_abort() = 0;
+
     /**
      * @brief      Calculate all entries in the scope of the handle.
      *
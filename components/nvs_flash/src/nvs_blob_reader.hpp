@@ -0,0 +1,67 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef NVS_BLOB_READER_HPP_
+#define NVS_BLOB_READER_HPP_
+
+#include "nvs_handle.hpp"
+#include "nvs_storage.hpp"
+#include "nvs_memory_management.hpp"
+
+namespace nvs {
+
+/**
+ * Implementation of NVSBlobStream on top of the storage's sequential blob reads.
+ *
+ * It is used by both the C API and the C++ API; locking is left to the caller.
+ */
+class NVSBlobReader : public NVSBlobStream, public ExceptionlessAllocatable {
+public:
+    NVSBlobReader() { }
+
+    virtual ~NVSBlobReader()
+    {
+        if (mStoragePtr != nullptr) {
+            mStoragePtr->closeBlob(mState);
+        }
+    }
+
+    esp_err_t open(Storage *storage, uint8_t nsIndex, const char *key)
+    {
+        mStoragePtr = storage;
+        return mStoragePtr->openBlob(nsIndex, key, mState);
+    }
+
+    size_t get_size() const override
+    {
+        return mState.dataSize;
+    }
+
+    esp_err_t read(void* out_data, size_t len, size_t &read_len) override
+    {
+        return mStoragePtr->readBlob(mState, out_data, len, read_len);
+    }
+
+    esp_err_t read_ptr(const void* &out_ptr, size_t len, size_t &read_len) override
+    {
+        return mStoragePtr->mapBlob(mState, out_ptr, len, read_len);
+    }
+
+private:
+    Storage *mStoragePtr = nullptr;
+
+    BlobReadState mState {};
+};
+
+} // namespace nvs
+
+/**
+ * The object behind nvs_blob_reader_t of the C API.
+ */
+struct nvs_opaque_blob_reader_t : public nvs::NVSBlobReader {
+};
+
+#endif // NVS_BLOB_READER_HPP_
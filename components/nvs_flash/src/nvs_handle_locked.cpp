@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2015-2023 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2015-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -7,6 +7,27 @@
 
 namespace nvs {
 
+NVSBlobStreamLocked::NVSBlobStreamLocked(std::unique_ptr<NVSBlobStream> stream) : stream(std::move(stream)) { }
+
+NVSBlobStreamLocked::~NVSBlobStreamLocked() {
+    Lock lock;
+    stream.reset();
+}
+
+size_t NVSBlobStreamLocked::get_size() const {
+    return stream->get_size();
+}
+
+esp_err_t NVSBlobStreamLocked::read(void* out_data, size_t len, size_t &read_len) {
+    Lock lock;
+    return stream->read(out_data, len, read_len);
+}
+
+esp_err_t NVSBlobStreamLocked::read_ptr(const void* &out_ptr, size_t len, size_t &read_len) {
+    Lock lock;
+    return stream->read_ptr(out_ptr, len, read_len);
+}
+
 NVSHandleLocked::NVSHandleLocked(NVSHandleSimple *handle) : handle(handle) { }
 
 NVSHandleLocked::~NVSHandleLocked() {
@@ -34,6 +55,23 @@ esp_err_t NVSHandleLocked::get_blob(const char *key, void* out_blob, size_t len)
     return handle->get_blob(key, out_blob, len);
 }
 
+esp_err_t NVSHandleLocked::get_blob_stream(const char *key, std::unique_ptr<NVSBlobStream> &stream) {
+    Lock lock;
+    std::unique_ptr<NVSBlobStream> unlocked_stream;
+    esp_err_t err = handle->get_blob_stream(key, unlocked_stream);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    NVSBlobStreamLocked *locked_stream = new (std::nothrow) NVSBlobStreamLocked(std::move(unlocked_stream));
+    if (!locked_stream) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    stream.reset(locked_stream);
+    return ESP_OK;
+}
+
 esp_err_t NVSHandleLocked::get_item_size(ItemType datatype, const char *key, size_t &size) {
     Lock lock;
     return handle->get_item_size(datatype, key, size);
@@ -60,6 +98,21 @@ esp_err_t NVSHandleLocked::commit() {
     return handle->commit();
 }
 
+esp_err_t NVSHandleLocked::batch_begin() {
+    Lock lock;
+    return handle->batch_begin();
+}
+
+esp_err_t NVSHandleLocked::batch_commit() {
+    Lock lock;
+    return handle->batch_commit();
+}
+
+esp_err_t NVSHandleLocked::batch_abort() {
+    Lock lock;
+    return handle->batch_abort();
+}
+
 esp_err_t NVSHandleLocked::get_used_entry_count(size_t& usedEntries) {
     Lock lock;
     return handle->get_used_entry_count(usedEntries);
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2015-2023 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2015-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -20,6 +20,25 @@ namespace nvs {
  * @note this class becomes responsible for its internal NVSHandleSimple object, i.e. it deletes the handle object on
  * destruction
  */
+/**
+ * Decorates a blob stream of NVSHandleSimple with the NVS lock, like NVSHandleLocked decorates the handle itself.
+ */
+class NVSBlobStreamLocked : public NVSBlobStream {
+public:
+    NVSBlobStreamLocked(std::unique_ptr<NVSBlobStream> stream);
+
+    virtual ~NVSBlobStreamLocked();
+
+    size_t get_size() const override;
+
+    esp_err_t read(void* out_data, size_t len, size_t &read_len) override;
+
+    esp_err_t read_ptr(const void* &out_ptr, size_t len, size_t &read_len) override;
+
+private:
+    std::unique_ptr<NVSBlobStream> stream;
+};
+
 class NVSHandleLocked : public NVSHandle {
 public:
     /**
@@ -39,6 +58,8 @@ public:
 
     esp_err_t get_blob(const char *key, void* out_blob, size_t len) override;
 
+    esp_err_t get_blob_stream(const char *key, std::unique_ptr<NVSBlobStream> &stream) override;
+
     esp_err_t get_item_size(ItemType datatype, const char *key, size_t &size) override;
 
     esp_err_t find_key(const char* key, nvs_type_t &nvstype) override;
@@ -49,6 +70,12 @@ public:
 
     esp_err_t commit() override;
 
+    esp_err_t batch_begin() override;
+
+    esp_err_t batch_commit() override;
+
+    esp_err_t batch_abort() override;
+
     esp_err_t get_used_entry_count(size_t& usedEntries) override;
 
 protected:
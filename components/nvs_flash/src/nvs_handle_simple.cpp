@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2015-2023 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2015-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -10,6 +10,7 @@
 namespace nvs {
 
 NVSHandleSimple::~NVSHandleSimple() {
+    mBatch.clearAndFreeNodes();
     NVSPartitionManager::get_instance()->close_handle(this);
 }
 
@@ -17,6 +18,7 @@ esp_err_t NVSHandleSimple::set_typed_item(ItemType datatype, const char *key, co
 {
     if (!valid) return ESP_ERR_NVS_INVALID_HANDLE;
     if (mReadOnly) return ESP_ERR_NVS_READ_ONLY;
+    if (mInBatch) return stage_item(datatype, key, data, dataSize);
 
     return mStoragePtr->writeItem(mNsIndex, datatype, key, data, dataSize);
 }
@@ -32,6 +34,7 @@ esp_err_t NVSHandleSimple::set_string(const char *key, const char* str)
 {
     if (!valid) return ESP_ERR_NVS_INVALID_HANDLE;
     if (mReadOnly) return ESP_ERR_NVS_READ_ONLY;
+    if (mInBatch) return stage_item(nvs::ItemType::SZ, key, str, strlen(str) + 1);
 
     return mStoragePtr->writeItem(mNsIndex, nvs::ItemType::SZ, key, str, strlen(str) + 1);
 }
@@ -40,6 +43,7 @@ esp_err_t NVSHandleSimple::set_blob(const char *key, const void* blob, size_t le
 {
     if (!valid) return ESP_ERR_NVS_INVALID_HANDLE;
     if (mReadOnly) return ESP_ERR_NVS_READ_ONLY;
+    if (mInBatch) return stage_item(nvs::ItemType::BLOB, key, blob, len);
 
     return mStoragePtr->writeItem(mNsIndex, nvs::ItemType::BLOB, key, blob, len);
 }
@@ -58,6 +62,30 @@ esp_err_t NVSHandleSimple::get_blob(const char *key, void* out_blob, size_t len)
     return mStoragePtr->readItem(mNsIndex, nvs::ItemType::BLOB, key, out_blob, len);
 }
 
+esp_err_t NVSHandleSimple::get_blob_stream(const char *key, std::unique_ptr<NVSBlobStream> &stream)
+{
+    if (!valid) return ESP_ERR_NVS_INVALID_HANDLE;
+
+    NVSBlobReader *reader = new (std::nothrow) NVSBlobReader();
+    if (!reader) return ESP_ERR_NO_MEM;
+
+    esp_err_t err = open_blob_reader(key, *reader);
+    if (err != ESP_OK) {
+        delete reader;
+        return err;
+    }
+
+    stream.reset(reader);
+    return ESP_OK;
+}
+
+esp_err_t NVSHandleSimple::open_blob_reader(const char *key, NVSBlobReader &reader)
+{
+    if (!valid) return ESP_ERR_NVS_INVALID_HANDLE;
+
+    return reader.open(mStoragePtr, mNsIndex, key);
+}
+
 esp_err_t NVSHandleSimple::get_item_size(ItemType datatype, const char *key, size_t &size)
 {
     if (!valid) return ESP_ERR_NVS_INVALID_HANDLE;
@@ -87,7 +115,14 @@ esp_err_t NVSHandleSimple::erase_item(const char* key)
     if (!valid) return ESP_ERR_NVS_INVALID_HANDLE;
     if (mReadOnly) return ESP_ERR_NVS_READ_ONLY;
 
-    return mStoragePtr->eraseItem(mNsIndex, key);
+    // a value staged before the erase must not be written by the batch
+    bool staged = unstage_item(key);
+
+    esp_err_t err = mStoragePtr->eraseItem(mNsIndex, key);
+    if (err == ESP_ERR_NVS_NOT_FOUND && staged) {
+        return ESP_OK;
+    }
+    return err;
 }
 
 esp_err_t NVSHandleSimple::erase_all()
@@ -95,16 +130,88 @@ esp_err_t NVSHandleSimple::erase_all()
     if (!valid) return ESP_ERR_NVS_INVALID_HANDLE;
     if (mReadOnly) return ESP_ERR_NVS_READ_ONLY;
 
+    mBatch.clearAndFreeNodes();
+
     return mStoragePtr->eraseNamespace(mNsIndex);
 }
 
 esp_err_t NVSHandleSimple::commit()
 {
     if (!valid) return ESP_ERR_NVS_INVALID_HANDLE;
+    if (mInBatch) return batch_commit();
+
+    return ESP_OK;
+}
+
+esp_err_t NVSHandleSimple::batch_begin()
+{
+    if (!valid) return ESP_ERR_NVS_INVALID_HANDLE;
+    if (mReadOnly) return ESP_ERR_NVS_READ_ONLY;
+    if (mInBatch) return ESP_ERR_NVS_INVALID_STATE;
 
+    mInBatch = true;
     return ESP_OK;
 }
 
+esp_err_t NVSHandleSimple::batch_commit()
+{
+    if (!valid) return ESP_ERR_NVS_INVALID_HANDLE;
+    if (!mInBatch) return ESP_ERR_NVS_INVALID_STATE;
+
+    mInBatch = false;
+    return mStoragePtr->writeBatch(mNsIndex, mBatch);
+}
+
+esp_err_t NVSHandleSimple::batch_abort()
+{
+    if (!valid) return ESP_ERR_NVS_INVALID_HANDLE;
+    if (!mInBatch) return ESP_ERR_NVS_INVALID_STATE;
+
+    mInBatch = false;
+    mBatch.clearAndFreeNodes();
+    return ESP_OK;
+}
+
+esp_err_t NVSHandleSimple::stage_item(ItemType datatype, const char *key, const void *data, size_t dataSize)
+{
+    // check the same limits as Page::writeItem, so that a batch only fails to commit if storage fails
+    if (strlen(key) > Item::MAX_KEY_LENGTH) return ESP_ERR_NVS_KEY_TOO_LONG;
+    if (datatype != ItemType::BLOB) {
+        if (dataSize > Page::CHUNK_MAX_SIZE) return ESP_ERR_NVS_VALUE_TOO_LONG;
+        if (!isVariableLengthType(datatype) && dataSize > 8) return ESP_ERR_INVALID_ARG;
+    }
+
+    BatchItem* item = new (std::nothrow) BatchItem;
+    if (!item) return ESP_ERR_NO_MEM;
+    item->mData = new (std::nothrow) uint8_t[dataSize];
+    if (!item->mData) {
+        delete item;
+        return ESP_ERR_NO_MEM;
+    }
+
+    strncpy(item->mKey, key, sizeof(item->mKey) - 1);
+    item->mKey[sizeof(item->mKey) - 1] = 0;
+    item->mDatatype = datatype;
+    item->mDataSize = dataSize;
+    memcpy(item->mData, data, dataSize);
+
+    unstage_item(key);
+    mBatch.push_back(item);
+    return ESP_OK;
+}
+
+bool NVSHandleSimple::unstage_item(const char *key)
+{
+    for (auto it = mBatch.begin(); it != mBatch.end(); ++it) {
+        if (strncmp(it->mKey, key, sizeof(it->mKey) - 1) == 0) {
+            mBatch.erase(it);
+            delete static_cast<BatchItem*>(it);
+            return true;
+        }
+    }
+    return false;
+}
+
 esp_err_t NVSHandleSimple::get_used_entry_count(size_t& used_entries)
 {
     used_entries = 0;
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2015-2022 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2015-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -8,6 +8,7 @@
 
 #include "intrusive_list.h"
 #include "nvs_storage.hpp"
+#include "nvs_blob_reader.hpp"
 #include "nvs_platform.hpp"
 
 #include "nvs_memory_management.hpp"
@@ -49,6 +50,10 @@ public:
 
     esp_err_t get_blob(const char *key, void *out_blob, size_t len) override;
 
+    esp_err_t get_blob_stream(const char *key, std::unique_ptr<NVSBlobStream> &stream) override;
+
+    esp_err_t open_blob_reader(const char *key, NVSBlobReader &reader);
+
     esp_err_t get_item_size(ItemType datatype, const char *key, size_t &size) override;
 
     esp_err_t find_key(const char *key, nvs_type_t &nvstype) override;
@@ -59,6 +64,12 @@ public:
 
     esp_err_t commit() override;
 
+    esp_err_t batch_begin() override;
+
+    esp_err_t batch_commit() override;
+
+    esp_err_t batch_abort() override;
+
     esp_err_t get_used_entry_count(size_t &usedEntries) override;
 
     esp_err_t getItemDataSize(ItemType datatype, const char *key, size_t &dataSize);
@@ -80,6 +91,10 @@ public:
     Storage *get_storage() const;
 
 private:
+    esp_err_t stage_item(ItemType datatype, const char *key, const void *data, size_t dataSize);
+
+    bool unstage_item(const char *key);
+
     /**
      * The underlying storage's object.
      */
@@ -101,6 +116,16 @@ private:
      * Upon opening, a handle is valid. It becomes invalid if the underlying storage is de-initialized.
      */
     uint8_t valid;
+
+    /**
+     * Indicates whether writes are staged in mBatch instead of being written to storage.
+     */
+    bool mInBatch = false;
+
+    /**
+     * Values written since batch_begin(), at most one per key.
+     */
+    TBatchItemList mBatch;
 };
 
 } // nvs
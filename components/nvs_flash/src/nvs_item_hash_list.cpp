@@ -13,22 +13,51 @@
 // limitations under the License.
 
 #include "nvs_item_hash_list.hpp"
+#include "nvs_internal.h"
 
 namespace nvs
 {
 
 HashList::HashList()
 {
+    static_assert(ENTRY_COUNT < NODE_FREE, "entry index does not fit into a node link");
+    static_assert((BUCKET_COUNT & (BUCKET_COUNT - 1)) == 0, "bucket count must be a power of two");
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+        mBuckets[i] = NODE_END;
+    }
+}
+
+HashList::HashListBlock::HashListBlock()
+{
+    static_assert(sizeof(HashListBlock) == HashListBlock::BYTE_SIZE,
+                  "cache block size calculation incorrect");
+    for (size_t i = 0; i < ENTRY_COUNT; ++i) {
+        mNodes[i].mHash = 0;
+        mNodes[i].mNext = NODE_FREE;
+    }
 }
 
 void HashList::clear()
 {
-    for (auto it = mBlockList.begin(); it != mBlockList.end();) {
-        auto tmp = it;
-        ++it;
-        mBlockList.erase(tmp);
-        delete static_cast<HashListBlock*>(tmp);
+    if (mCount == 0) {
+        return;
+    }
+    if (mKeyIndex) {
+        for (size_t index = 0; index < ENTRY_COUNT; ++index) {
+            if (isUsed(index)) {
+                mKeyIndex->erase(node(index).mHash, mPageIndex, index);
+            }
+        }
     }
+    for (size_t i = 0; i < BLOCK_COUNT; ++i) {
+        delete mBlocks[i];
+        mBlocks[i] = nullptr;
+        mBlockUsed[i] = 0;
+    }
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+        mBuckets[i] = NODE_END;
+    }
+    mCount = 0;
 }
 
 HashList::~HashList()
@@ -36,88 +65,144 @@ HashList::~HashList()
     clear();
 }
 
-HashList::HashListBlock::HashListBlock()
+void HashList::setKeyIndex(KeyIndex* keyIndex, size_t pageIndex)
 {
-    static_assert(sizeof(HashListBlock) == HashListBlock::BYTE_SIZE,
-                  "cache block size calculation incorrect");
+    for (size_t index = 0; index < ENTRY_COUNT; ++index) {
+        if (!isUsed(index)) {
+            continue;
+        }
+        const HashListNode& e = node(index);
+        if (mKeyIndex) {
+            mKeyIndex->erase(e.mHash, mPageIndex, index);
+        }
+        if (keyIndex) {
+            keyIndex->insert(e.mHash, pageIndex, index);
+        }
+    }
+    mKeyIndex = keyIndex;
+    mPageIndex = pageIndex;
 }
 
-esp_err_t HashList::insert(const Item& item, size_t index)
+size_t HashList::getBlockCount() const
 {
-    const uint32_t hash_24 = item.calculateCrc32WithoutValue() & 0xffffff;
-    // add entry to the end of last block if possible
-    if (mBlockList.size()) {
-        auto& block = mBlockList.back();
-        if (block.mCount < HashListBlock::ENTRY_COUNT) {
-            block.mNodes[block.mCount++] = HashListNode(hash_24, index);
-            return ESP_OK;
+    size_t count = 0;
+    for (size_t i = 0; i < BLOCK_COUNT; ++i) {
+        if (mBlocks[i]) {
+            ++count;
         }
     }
-    // if the above failed, create a new block and add entry to it
-    HashListBlock* newBlock = new (std::nothrow) HashListBlock;
+    return count;
+}
+
+esp_err_t HashList::insert(const Item& item, size_t index)
+{
+    NVS_ASSERT_OR_RETURN(index < ENTRY_COUNT, ESP_FAIL);
+
+    // an entry can only hold one item, replace the node if the entry was indexed before
+    erase(index);
 
-    if (!newBlock) return ESP_ERR_NO_MEM;
+    const size_t blockIndex = index / HashListBlock::ENTRY_COUNT;
+    if (!mBlocks[blockIndex]) {
+        mBlocks[blockIndex] = new (std::nothrow) HashListBlock;
+        if (!mBlocks[blockIndex]) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
 
-    mBlockList.push_back(newBlock);
-    newBlock->mNodes[0] = HashListNode(hash_24, index);
-    newBlock->mCount++;
+    const uint32_t hash_24 = hash(item);
+    // keep the chain sorted by entry index, so that find() can return the first match
+    const size_t b = bucket(hash_24);
+    size_t prev = NODE_END;
+    size_t next = mBuckets[b];
+    while (next != NODE_END && next < index) {
+        prev = next;
+        next = node(next).mNext;
+    }
+    node(index).mHash = hash_24;
+    node(index).mNext = next;
+    if (prev == NODE_END) {
+        mBuckets[b] = index;
+    } else {
+        node(prev).mNext = index;
+    }
+    ++mBlockUsed[blockIndex];
+    ++mCount;
 
+    if (mKeyIndex) {
+        mKeyIndex->insert(hash_24, mPageIndex, index);
+    }
     return ESP_OK;
 }
 
 bool HashList::erase(size_t index)
 {
-    for (auto it = mBlockList.begin(); it != mBlockList.end();) {
-        bool haveEntries = false;
-        bool foundIndex = false;
-        for (size_t i = 0; i < it->mCount; ++i) {
-            if (it->mNodes[i].mIndex == index) {
-                it->mNodes[i].mIndex = 0xff;
-                foundIndex = true;
-                /* found the item and removed it */
-            }
-            if (it->mNodes[i].mIndex != 0xff) {
-                haveEntries = true;
-            }
-            if (haveEntries && foundIndex) {
-                /* item was found, and HashListBlock still has some items */
-                return true;
-            }
+    if (index >= ENTRY_COUNT || !isUsed(index)) {
+        // item hasn't been present in cache
+        return false;
+    }
+
+    HashListNode& e = node(index);
+    const uint32_t hash_24 = e.mHash;
+    const size_t b = bucket(hash_24);
+    if (mBuckets[b] == index) {
+        mBuckets[b] = e.mNext;
+    } else {
+        size_t prev = mBuckets[b];
+        while (node(prev).mNext != index) {
+            prev = node(prev).mNext;
         }
-        /* no items left in HashListBlock, can remove */
-        if (!haveEntries) {
-            auto tmp = it;
-            ++it;
-            mBlockList.erase(tmp);
-            delete static_cast<HashListBlock*>(tmp);
-        } else {
-            ++it;
+        node(prev).mNext = e.mNext;
+    }
+    e.mNext = NODE_FREE;
+    --mCount;
+
+    // no entries left in the block, release it
+    const size_t blockIndex = index / HashListBlock::ENTRY_COUNT;
+    if (--mBlockUsed[blockIndex] == 0) {
+        delete mBlocks[blockIndex];
+        mBlocks[blockIndex] = nullptr;
+    }
+
+    if (mKeyIndex) {
+        mKeyIndex->erase(hash_24, mPageIndex, index);
+    }
+    return true;
+}
+
+size_t HashList::find(size_t start, const Item& item)
+{
+    const uint32_t hash_24 = hash(item);
+    for (size_t index = mBuckets[bucket(hash_24)]; index != NODE_END; index = node(index).mNext) {
+        if (index >= start && node(index).mHash == hash_24) {
+            return index;
         }
-        if (foundIndex) {
-            /* item was found and empty HashListBlock was removed */
+    }
+    return SIZE_MAX;
+}
+
+bool HashList::contains(uint32_t hash_24) const
+{
+    for (size_t index = mBuckets[bucket(hash_24)]; index != NODE_END; index = node(index).mNext) {
+        if (node(index).mHash == hash_24) {
             return true;
         }
     }
-
-    // item hasn't been present in cache");
     return false;
 }
 
-size_t HashList::find(size_t start, const Item& item)
+size_t HashList::findCommon(size_t start, const HashList& other) const
 {
-    const uint32_t hash_24 = item.calculateCrc32WithoutValue() & 0xffffff;
-    for (auto it = mBlockList.begin(); it != mBlockList.end(); ++it) {
-        for (size_t index = 0; index < it->mCount; ++index) {
-            HashListNode& e = it->mNodes[index];
-            if (e.mIndex >= start &&
-                    e.mHash == hash_24 &&
-                    e.mIndex != 0xff) {
-                return e.mIndex;
-            }
+    for (size_t index = start; index < ENTRY_COUNT; ++index) {
+        if (!mBlocks[index / HashListBlock::ENTRY_COUNT]) {
+            // skip the rest of the block, none of its entries is indexed
+            index |= HashListBlock::ENTRY_COUNT - 1;
+            continue;
+        }
+        if (isUsed(index) && other.contains(node(index).mHash)) {
+            return index;
         }
     }
     return SIZE_MAX;
 }
 
-
 } // namespace nvs
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2015-2022 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2015-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -9,12 +9,22 @@
 
 #include "nvs.h"
 #include "nvs_types.hpp"
+#include "nvs_constants.h"
 #include "nvs_memory_management.hpp"
-#include "intrusive_list.h"
+#include "nvs_key_index.hpp"
 
 namespace nvs
 {
 
+/**
+ * Per-page index of item hashes.
+ *
+ * Each entry of the page owns one node, which stores the 24-bit hash of namespace index, key and chunk index
+ * of the item starting at that entry. Nodes with the same bucket (lower bits of the hash) are chained in
+ * ascending entry order, so find() only visits the nodes of one bucket.
+ * The nodes are allocated in blocks of 32 consecutive entries when the first of these entries is inserted, and
+ * freed when the last one is erased, so free and erased pages don't use any heap memory.
+ */
 class HashList
 {
 public:
@@ -26,39 +36,90 @@ public:
     size_t find(size_t start, const Item& item);
     void clear();
 
+    /**
+     * Returns the index of the first node at or after start whose hash is also in other, or SIZE_MAX.
+     * Each node is checked against one bucket of other, so a scan of the whole list is linear.
+     */
+    size_t findCommon(size_t start, const HashList& other) const;
+
+    size_t size() const
+    {
+        return mCount;
+    }
+
+    /**
+     * Number of node blocks currently allocated on the heap.
+     */
+    size_t getBlockCount() const;
+
+    /**
+     * Mirrors all current and future nodes of this list into a storage-wide index,
+     * or detaches the list from its index if keyIndex is nullptr.
+     */
+    void setKeyIndex(KeyIndex* keyIndex, size_t pageIndex);
+
+    static uint32_t hash(const Item& item)
+    {
+        return item.calculateCrc32WithoutValue() & 0xffffff;
+    }
+
+    static const size_t ENTRY_COUNT = NVS_CONST_ENTRY_COUNT;
+    static const size_t BUCKET_COUNT = 32;
+
 private:
     HashList(const HashList& other);
     const HashList& operator= (const HashList& rhs);
 
 protected:
 
+    static const uint8_t NODE_END = 0xff;
+    static const uint8_t NODE_FREE = 0xfe;
+
     struct HashListNode {
-        HashListNode() :
-            mIndex(0xff), mHash(0)
-        {
-        }
-
-        HashListNode(uint32_t hash, size_t index) :
-            mIndex((uint32_t) index), mHash(hash)
-        {
-        }
-
-        uint32_t mIndex : 8;
-        uint32_t mHash  : 24;
+        uint32_t mHash : 24;
+        uint32_t mNext : 8;
     };
 
-    struct HashListBlock : public intrusive_list_node<HashList::HashListBlock>, public ExceptionlessAllocatable {
+    struct HashListBlock : public ExceptionlessAllocatable {
         HashListBlock();
 
-        static const size_t BYTE_SIZE = 128;
-        static const size_t ENTRY_COUNT = (BYTE_SIZE - sizeof(intrusive_list_node<HashListBlock>) - sizeof(size_t)) / 4;
+        static const size_t ENTRY_COUNT = 32;
+        static const size_t BYTE_SIZE = ENTRY_COUNT * sizeof(HashListNode);
 
-        size_t mCount = 0;
         HashListNode mNodes[ENTRY_COUNT];
     };
 
-    typedef intrusive_list<HashListBlock> TBlockList;
-    TBlockList mBlockList;
+    static const size_t BLOCK_COUNT = (ENTRY_COUNT + HashListBlock::ENTRY_COUNT - 1) / HashListBlock::ENTRY_COUNT;
+
+    static size_t bucket(uint32_t hash)
+    {
+        return hash & (BUCKET_COUNT - 1);
+    }
+
+    HashListNode& node(size_t index)
+    {
+        return mBlocks[index / HashListBlock::ENTRY_COUNT]->mNodes[index % HashListBlock::ENTRY_COUNT];
+    }
+
+    const HashListNode& node(size_t index) const
+    {
+        return mBlocks[index / HashListBlock::ENTRY_COUNT]->mNodes[index % HashListBlock::ENTRY_COUNT];
+    }
+
+    bool contains(uint32_t hash_24) const;
+
+    bool isUsed(size_t index) const
+    {
+        const HashListBlock* block = mBlocks[index / HashListBlock::ENTRY_COUNT];
+        return block && block->mNodes[index % HashListBlock::ENTRY_COUNT].mNext != NODE_FREE;
+    }
+
+    HashListBlock* mBlocks[BLOCK_COUNT] = {};
+    uint8_t mBlockUsed[BLOCK_COUNT] = {};
+    uint8_t mBuckets[BUCKET_COUNT];
+    size_t mCount = 0;
+    KeyIndex* mKeyIndex = nullptr;
+    size_t mPageIndex = 0;
 }; // class HashList
 
 } // namespace nvs
@@ -0,0 +1,151 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <new>
+#include "nvs_key_index.hpp"
+
+namespace nvs
+{
+
+KeyIndex::KeyIndex(size_t maxBytes) : mMaxBytes(maxBytes)
+{
+    static_assert(sizeof(Slot) == 8, "key index slot size calculation incorrect");
+}
+
+KeyIndex::~KeyIndex()
+{
+    delete [] mTable;
+}
+
+void KeyIndex::clear()
+{
+    delete [] mTable;
+    mTable = nullptr;
+    mCapacity = 0;
+    mUsed = 0;
+    mDeleted = 0;
+    mOverflow = false;
+}
+
+void KeyIndex::setOverflow()
+{
+    clear();
+    mOverflow = true;
+}
+
+void KeyIndex::put(Slot* table, size_t capacity, const Slot& slot)
+{
+    for (size_t i = slot.mHash & (capacity - 1); ; i = (i + 1) & (capacity - 1)) {
+        if (table[i].mPage == SLOT_EMPTY || table[i].mPage == SLOT_DELETED) {
+            table[i] = slot;
+            return;
+        }
+    }
+}
+
+bool KeyIndex::grow()
+{
+    size_t newCapacity = (mCapacity == 0) ? MIN_CAPACITY : mCapacity;
+    // only double the table if it is really filled with live nodes, otherwise rehashing drops the tombstones
+    if ((mUsed + 1) * 2 > newCapacity) {
+        newCapacity *= 2;
+    }
+    if (newCapacity * sizeof(Slot) > mMaxBytes) {
+        return false;
+    }
+
+    Slot* newTable = new (std::nothrow) Slot[newCapacity];
+    if (!newTable) {
+        return false;
+    }
+    for (size_t i = 0; i < newCapacity; ++i) {
+        newTable[i].mPage = SLOT_EMPTY;
+    }
+    for (size_t i = 0; i < mCapacity; ++i) {
+        if (mTable[i].mPage != SLOT_EMPTY && mTable[i].mPage != SLOT_DELETED) {
+            put(newTable, newCapacity, mTable[i]);
+        }
+    }
+
+    delete [] mTable;
+    mTable = newTable;
+    mCapacity = newCapacity;
+    mDeleted = 0;
+    return true;
+}
+
+void KeyIndex::insert(uint32_t hash, size_t pageIndex, size_t entryIndex)
+{
+    if (!isValid()) {
+        return;
+    }
+    if (pageIndex > PAGE_MAX) {
+        setOverflow();
+        return;
+    }
+
+    // keep the load factor (including tombstones) below 3/4 so that probe sequences stay short
+    if ((mUsed + mDeleted + 1) * 4 > mCapacity * 3) {
+        if (!grow()) {
+            setOverflow();
+            return;
+        }
+    }
+
+    Slot slot;
+    slot.mHash = hash;
+    slot.mEntry = entryIndex;
+    slot.mPage = pageIndex;
+    for (size_t i = slot.mHash & (mCapacity - 1); ; i = (i + 1) & (mCapacity - 1)) {
+        if (mTable[i].mPage == SLOT_DELETED) {
+            --mDeleted;
+        } else if (mTable[i].mPage != SLOT_EMPTY) {
+            continue;
+        }
+        mTable[i] = slot;
+        break;
+    }
+    ++mUsed;
+}
+
+void KeyIndex::erase(uint32_t hash, size_t pageIndex, size_t entryIndex)
+{
+    if (!isValid() || mCapacity == 0) {
+        return;
+    }
+
+    hash &= 0xffffff;
+    for (size_t i = hash & (mCapacity - 1); mTable[i].mPage != SLOT_EMPTY; i = (i + 1) & (mCapacity - 1)) {
+        if (mTable[i].mPage == pageIndex && mTable[i].mEntry == entryIndex && mTable[i].mHash == hash) {
+            mTable[i].mPage = SLOT_DELETED;
+            --mUsed;
+            ++mDeleted;
+            return;
+        }
+    }
+}
+
+size_t KeyIndex::find(uint32_t hash, Location* locations, size_t maxCount) const
+{
+    if (!isValid() || mCapacity == 0) {
+        return 0;
+    }
+
+    size_t count = 0;
+    hash &= 0xffffff;
+    for (size_t i = hash & (mCapacity - 1); mTable[i].mPage != SLOT_EMPTY; i = (i + 1) & (mCapacity - 1)) {
+        if (mTable[i].mPage != SLOT_DELETED && mTable[i].mHash == hash) {
+            if (count < maxCount) {
+                locations[count].mPage = mTable[i].mPage;
+                locations[count].mEntry = mTable[i].mEntry;
+            }
+            ++count;
+        }
+    }
+    return count;
+}
+
+} // namespace nvs
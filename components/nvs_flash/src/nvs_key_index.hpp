@@ -0,0 +1,105 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef nvs_key_index_hpp
+#define nvs_key_index_hpp
+
+#include <cstdint>
+#include <cstddef>
+#include "nvs_memory_management.hpp"
+
+namespace nvs
+{
+
+/**
+ * Storage-wide index of item hashes.
+ *
+ * Maps the 24-bit hash of namespace index, key and chunk index (the same hash HashList keeps for each page)
+ * to the page and entry which hold the item. The index is kept in sync by the per-page hash lists and therefore
+ * always contains a superset of their nodes: a hit is only a candidate which has to be confirmed by Page::findItem,
+ * but a miss means that no page holds the item.
+ *
+ * The table uses open addressing with linear probing and grows up to the memory budget given to the constructor.
+ * If the budget is exceeded or an allocation fails, the index switches itself off (isValid() returns false)
+ * and callers have to fall back to searching all pages until the next clear().
+ */
+class KeyIndex
+{
+public:
+    /**
+     * Location of an index node, as reported by find()
+     */
+    struct Location {
+        uint16_t mPage;
+        uint8_t mEntry;
+    };
+
+    explicit KeyIndex(size_t maxBytes);
+    ~KeyIndex();
+
+    void insert(uint32_t hash, size_t pageIndex, size_t entryIndex);
+
+    void erase(uint32_t hash, size_t pageIndex, size_t entryIndex);
+
+    /**
+     * Copies up to maxCount locations with the given hash to locations.
+     * Returns the total number of matching nodes, which may be larger than maxCount.
+     */
+    size_t find(uint32_t hash, Location* locations, size_t maxCount) const;
+
+    /**
+     * Drops all nodes and re-enables the index if it was switched off.
+     */
+    void clear();
+
+    bool isValid() const
+    {
+        return mMaxBytes != 0 && !mOverflow;
+    }
+
+    size_t size() const
+    {
+        return mUsed;
+    }
+
+    size_t byteSize() const
+    {
+        return mCapacity * sizeof(Slot);
+    }
+
+    static const size_t PAGE_MAX = 0xfffd;
+
+private:
+    KeyIndex(const KeyIndex& other);
+    const KeyIndex& operator= (const KeyIndex& rhs);
+
+    struct Slot : public ExceptionlessAllocatable {
+        uint32_t mHash  : 24;
+        uint32_t mEntry : 8;
+        uint16_t mPage;
+    };
+
+    static const uint16_t SLOT_EMPTY = 0xffff;
+    static const uint16_t SLOT_DELETED = 0xfffe;
+    static const size_t MIN_CAPACITY = 64;
+
+    bool grow();
+
+    void setOverflow();
+
+    static void put(Slot* table, size_t capacity, const Slot& slot);
+
+    Slot* mTable = nullptr;
+    size_t mCapacity = 0;
+    size_t mUsed = 0;
+    size_t mDeleted = 0;
+    size_t mMaxBytes;
+    bool mOverflow = false;
+}; // class KeyIndex
+
+} // namespace nvs
+
+#endif /* nvs_key_index_hpp */
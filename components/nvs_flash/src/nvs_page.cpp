@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2015-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2015-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -24,7 +24,7 @@ uint32_t Page::Header::calculateCrc32()
                             offsetof(Header, mCrc32) - offsetof(Header, mSeqNumber));
 }
 
-esp_err_t Page::load(Partition *partition, uint32_t sectorNumber)
+esp_err_t Page::load(Partition *partition, uint32_t sectorNumber, bool deferItems)
 {
     if (partition == nullptr) {
         return ESP_ERR_INVALID_ARG;
@@ -34,6 +34,8 @@ esp_err_t Page::load(Partition *partition, uint32_t sectorNumber)
     mBaseAddress = sectorNumber * SEC_SIZE;
     mUsedEntryCount = 0;
     mErasedEntryCount = 0;
+    mItemsLoaded = true;
+    mNewerPage = nullptr;
 
     Header header;
     auto rc = mPartition->read_raw(mBaseAddress, &header, sizeof(header));
@@ -85,7 +87,7 @@ esp_err_t Page::load(Partition *partition, uint32_t sectorNumber)
     case PageState::FULL:
     case PageState::ACTIVE:
     case PageState::FREEING:
-        return mLoadEntryTable();
+        return mLoadEntryTable(deferItems);
         break;
 
     default:
@@ -250,6 +252,112 @@ esp_err_t Page::writeItem(uint8_t nsIndex, ItemType datatype, const char* key, c
     return ESP_OK;
 }
 
+esp_err_t Page::writeItems(uint8_t nsIndex, TBatchItemList& items, size_t& count)
+{
+    esp_err_t err;
+    count = 0;
+
+    if (mState == PageState::INVALID) {
+        return ESP_ERR_NVS_INVALID_STATE;
+    }
+
+    if (mState == PageState::UNINITIALIZED) {
+        err = initialize();
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+
+    if (mState == PageState::FULL || mNextFreeEntry == INVALID_ENTRY) {
+        return ESP_ERR_NVS_PAGE_FULL;
+    }
+
+    // count the items which fit into the remaining entries
+    size_t entriesCount = 0;
+    for (auto it = items.begin(); it != items.end(); ++it) {
+        NVS_ASSERT_OR_RETURN(it->mDatatype != ItemType::BLOB && it->mDatatype != ItemType::BLOB_DATA, ESP_ERR_INVALID_ARG);
+        NVS_ASSERT_OR_RETURN(it->mDataSize <= CHUNK_MAX_SIZE, ESP_ERR_NVS_VALUE_TOO_LONG);
+        size_t span = 1;
+        if (isVariableLengthType(it->mDatatype)) {
+            span += (it->mDataSize + ENTRY_SIZE - 1) / ENTRY_SIZE;
+        }
+        if (mNextFreeEntry + entriesCount + span > ENTRY_COUNT) {
+            break;
+        }
+        entriesCount += span;
+        ++count;
+    }
+
+    if (count == 0) {
+        return ESP_ERR_NVS_PAGE_FULL;
+    }
+
+    Item* entries = new (std::nothrow) Item[entriesCount];
+    if (!entries) {
+        count = 0;
+        return ESP_ERR_NO_MEM;
+    }
+
+    // lay out all items in RAM, exactly as writeItem would write them one by one
+    size_t pos = 0;
+    auto it = items.begin();
+    for (size_t i = 0; i < count; ++i, ++it) {
+        size_t span = 1;
+        if (isVariableLengthType(it->mDatatype)) {
+            span += (it->mDataSize + ENTRY_SIZE - 1) / ENTRY_SIZE;
+        }
+        Item& item = entries[pos];
+        item = Item(nsIndex, it->mDatatype, span, it->mKey);
+        if (!isVariableLengthType(it->mDatatype)) {
+            memcpy(item.data, it->mData, it->mDataSize);
+        } else {
+            item.varLength.dataCrc32 = Item::calculateCrc32(it->mData, it->mDataSize);
+            item.varLength.dataSize = it->mDataSize;
+            item.varLength.reserved = 0xffff;
+            uint8_t* dst = entries[pos + 1].rawData;
+            std::fill_n(dst, (span - 1) * ENTRY_SIZE, 0xff);
+            memcpy(dst, it->mData, it->mDataSize);
+        }
+        item.crc32 = item.calculateCrc32();
+        pos += span;
+    }
+
+    uint32_t phyAddr;
+    err = getEntryAddress(mNextFreeEntry, &phyAddr);
+    if (err == ESP_OK) {
+        err = mPartition->write(phyAddr, entries, entriesCount * ENTRY_SIZE);
+    }
+    if (err != ESP_OK) {
+        mState = PageState::INVALID;
+        delete [] entries;
+        count = 0;
+        return err;
+    }
+
+    err = alterEntryRangeState(mNextFreeEntry, mNextFreeEntry + entriesCount, EntryState::WRITTEN);
+    if (err != ESP_OK) {
+        mState = PageState::INVALID;
+        delete [] entries;
+        count = 0;
+        return err;
+    }
+
+    for (pos = 0; pos < entriesCount; pos += entries[pos].span) {
+        err = mHashList.insert(entries[pos], mNextFreeEntry + pos);
+        if (err != ESP_OK) {
+            break;
+        }
+    }
+    delete [] entries;
+
+    if (mFirstUsedEntry == INVALID_ENTRY) {
+        mFirstUsedEntry = mNextFreeEntry;
+    }
+    mUsedEntryCount += entriesCount;
+    mNextFreeEntry += entriesCount;
+    return err;
+}
+
 esp_err_t Page::readItem(uint8_t nsIndex, ItemType datatype, const char* key, void* data, size_t dataSize, uint8_t chunkIdx, VerOffset chunkStart)
 {
     size_t index = 0;
@@ -301,6 +409,51 @@ esp_err_t Page::readItem(uint8_t nsIndex, ItemType datatype, const char* key, vo
     return ESP_OK;
 }
 
+esp_err_t Page::readItemData(size_t itemIndex, size_t offset, void* data, size_t size)
+{
+    if (mState == PageState::INVALID) {
+        return ESP_ERR_NVS_INVALID_STATE;
+    }
+
+    uint8_t* dst = reinterpret_cast<uint8_t*>(data);
+    size_t entry = itemIndex + 1 + offset / ENTRY_SIZE;
+    size_t skip = offset % ENTRY_SIZE;
+    while (size > 0) {
+        if (skip == 0 && size >= ENTRY_SIZE) {
+            // whole entries are read straight into the destination
+            size_t count = size / ENTRY_SIZE;
+            NVS_ASSERT_OR_RETURN(entry + count <= ENTRY_COUNT, ESP_FAIL);
+            uint32_t phyAddr;
+            esp_err_t rc = getEntryAddress(entry, &phyAddr);
+            if (rc != ESP_OK) {
+                return rc;
+            }
+            rc = mPartition->read(phyAddr, dst, count * ENTRY_SIZE);
+            if (rc != ESP_OK) {
+                return rc;
+            }
+            entry += count;
+            dst += count * ENTRY_SIZE;
+            size -= count * ENTRY_SIZE;
+            continue;
+        }
+
+        Item ditem;
+        esp_err_t rc = readEntry(entry, ditem);
+        if (rc != ESP_OK) {
+            return rc;
+        }
+        size_t willCopy = ENTRY_SIZE - skip;
+        willCopy = (size < willCopy) ? size : willCopy;
+        memcpy(dst, ditem.rawData + skip, willCopy);
+        ++entry;
+        skip = 0;
+        dst += willCopy;
+        size -= willCopy;
+    }
+    return ESP_OK;
+}
+
 esp_err_t Page::cmpItem(uint8_t nsIndex, ItemType datatype, const char* key, const void* data, size_t dataSize, uint8_t chunkIdx, VerOffset chunkStart)
 {
     size_t index = 0;
@@ -440,6 +593,77 @@ esp_err_t Page::eraseEntryAndSpan(size_t index)
     return ESP_OK;
 }
 
+esp_err_t Page::eraseEntries(const uint8_t* indices, size_t count)
+{
+    size_t firstWord = SIZE_MAX;
+    size_t lastWord = 0;
+    bool firstUsedEntryErased = false;
+    EntryState state;
+    esp_err_t err;
+
+    for (size_t i = 0; i < count; ++i) {
+        const size_t index = indices[i];
+        NVS_ASSERT_OR_RETURN(index < ENTRY_COUNT, ESP_FAIL);
+
+        err = mEntryTable.get(index, &state);
+        if (err != ESP_OK) {
+            return err;
+        }
+        if (state != EntryState::WRITTEN) {
+            continue;
+        }
+
+        Item item;
+        err = readEntry(index, item);
+        if (err != ESP_OK) {
+            return err;
+        }
+        size_t span = item.checkHeaderConsistency(index) ? item.span : 1;
+
+        mHashList.erase(index);
+        for (size_t j = index; j < index + span; ++j) {
+            err = mEntryTable.get(j, &state);
+            if (err != ESP_OK) {
+                return err;
+            }
+            if (state == EntryState::WRITTEN) {
+                --mUsedEntryCount;
+            }
+            ++mErasedEntryCount;
+            err = mEntryTable.set(j, EntryState::ERASED);
+            if (err != ESP_OK) {
+                return err;
+            }
+        }
+
+        firstWord = std::min(firstWord, mEntryTable.getWordIndex(index));
+        lastWord = std::max(lastWord, mEntryTable.getWordIndex(index + span - 1));
+        if (index == mFirstUsedEntry) {
+            firstUsedEntryErased = true;
+        }
+        if (index + span > mNextFreeEntry) {
+            mNextFreeEntry = index + span;
+        }
+    }
+
+    if (firstWord == SIZE_MAX) {
+        return ESP_OK;
+    }
+
+    // words between the changed ones are written with their current value, which leaves them unchanged
+    err = mPartition->write_raw(mBaseAddress + ENTRY_TABLE_OFFSET + static_cast<uint32_t>(firstWord) * 4,
+                                mEntryTable.data() + firstWord, (lastWord - firstWord + 1) * 4);
+    if (err != ESP_OK) {
+        mState = PageState::INVALID;
+        return err;
+    }
+
+    if (firstUsedEntryErased) {
+        return updateFirstUsedEntry(mFirstUsedEntry, 1);
+    }
+    return ESP_OK;
+}
+
 esp_err_t Page::updateFirstUsedEntry(size_t index, size_t span)
 {
     NVS_ASSERT_OR_RETURN(index == mFirstUsedEntry, ESP_FAIL);
@@ -465,12 +689,17 @@ esp_err_t Page::updateFirstUsedEntry(size_t index, size_t span)
 
 esp_err_t Page::copyItems(Page &other)
 {
+    auto err = loadItems();
+    if (err != ESP_OK) {
+        return err;
+    }
+
     if (mFirstUsedEntry == INVALID_ENTRY) {
         return ESP_ERR_NVS_NOT_FOUND;
     }
 
     if (other.mState == PageState::UNINITIALIZED) {
-        auto err = other.initialize();
+        err = other.initialize();
         if (err != ESP_OK) {
             return err;
         }
@@ -479,7 +708,6 @@ esp_err_t Page::copyItems(Page &other)
     Item entry;
     size_t readEntryIndex = mFirstUsedEntry;
     EntryState state;
-    esp_err_t err;
 
     while (readEntryIndex < ENTRY_COUNT) {
         err = mEntryTable.get(readEntryIndex, &state);
@@ -526,7 +754,86 @@ esp_err_t Page::copyItems(Page &other)
     return ESP_OK;
 }
 
-esp_err_t Page::mLoadEntryTable()
+esp_err_t Page::moveItems(Page& other, size_t maxEntries, size_t& movedEntries)
+{
+    movedEntries = 0;
+
+    esp_err_t err = loadItems();
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    if (other.mState == PageState::UNINITIALIZED) {
+        err = other.initialize();
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+
+    if (other.mState != PageState::ACTIVE) {
+        return (other.mState == PageState::FULL) ? ESP_ERR_NVS_PAGE_FULL : ESP_ERR_NVS_INVALID_STATE;
+    }
+
+    Item entry;
+
+    while (mFirstUsedEntry != INVALID_ENTRY) {
+        if (movedEntries >= maxEntries) {
+            return ESP_OK;
+        }
+
+        const size_t index = mFirstUsedEntry;
+        err = readEntry(index, entry);
+        if (err != ESP_OK) {
+            return err;
+        }
+
+        // items with a broken header can't be moved, drop them as eraseEntryAndSpan would
+        if (!entry.checkHeaderConsistency(index)) {
+            err = eraseEntryAndSpan(index);
+            if (err != ESP_OK) {
+                return err;
+            }
+            continue;
+        }
+
+        const size_t span = entry.span;
+        NVS_ASSERT_OR_RETURN(index + span <= ENTRY_COUNT, ESP_FAIL);
+
+        if (other.mNextFreeEntry == INVALID_ENTRY || other.mNextFreeEntry + span > ENTRY_COUNT) {
+            return ESP_ERR_NVS_PAGE_FULL;
+        }
+
+        err = other.mHashList.insert(entry, other.mNextFreeEntry);
+        if (err != ESP_OK) {
+            return err;
+        }
+
+        err = other.writeEntry(entry);
+        if (err != ESP_OK) {
+            return err;
+        }
+
+        for (size_t i = index + 1; i < index + span; ++i) {
+            err = readEntry(i, entry);
+            if (err != ESP_OK) {
+                return err;
+            }
+            err = other.writeEntry(entry);
+            if (err != ESP_OK) {
+                return err;
+            }
+        }
+
+        err = eraseEntryAndSpan(index);
+        if (err != ESP_OK) {
+            return err;
+        }
+        movedEntries += span;
+    }
+    return ESP_ERR_NVS_NOT_FOUND;
+}
+
+esp_err_t Page::mLoadEntryTable(bool deferItems)
 {
     // for states where we actually care about data in the page, read entry state table
     if (mState == PageState::ACTIVE ||
@@ -710,60 +1017,123 @@ esp_err_t Page::mLoadEntryTable()
         }
     } else if (mState == PageState::FULL || mState == PageState::FREEING) {
         // We have already filled mHashList for page in active state.
-        // Do the same for the case when page is in full or freeing state.
-        Item item;
-        for (size_t i = mFirstUsedEntry; i < ENTRY_COUNT; ++i) {
-            auto err = mEntryTable.get(i, &state);
-            if (err != ESP_OK) {
-                return err;
-            }
-            if (state != EntryState::WRITTEN) {
-                continue;
-            }
+        // Do the same for the case when page is in full or freeing state, unless this is deferred
+        // until the first access to the page.
+        if (mState == PageState::FULL && deferItems) {
+            mItemsLoaded = false;
+            return ESP_OK;
+        }
+        return mLoadItems();
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t Page::mLoadItems()
+{
+    EntryState state;
+    Item item;
+    for (size_t i = mFirstUsedEntry; i < ENTRY_COUNT; ++i) {
+        auto err = mEntryTable.get(i, &state);
+        if (err != ESP_OK) {
+            return err;
+        }
+        if (state != EntryState::WRITTEN) {
+            continue;
+        }
 
-            err = readEntry(i, item);
+        err = readEntry(i, item);
+        if (err != ESP_OK) {
+            mState = PageState::INVALID;
+            return err;
+        }
+
+        if (!item.checkHeaderConsistency(i)) {
+            err = eraseEntryAndSpan(i);
             if (err != ESP_OK) {
                 mState = PageState::INVALID;
                 return err;
             }
+            continue;
+        }
 
-            if (!item.checkHeaderConsistency(i)) {
-                err = eraseEntryAndSpan(i);
+        NVS_ASSERT_OR_RETURN(item.span > 0, ESP_FAIL);
+
+        err = mHashList.insert(item, i);
+        if (err != ESP_OK) {
+            mState = PageState::INVALID;
+            return err;
+        }
+
+        size_t span = item.span;
+
+        if (isVariableLengthType(item.datatype)) {
+            for (size_t j = i + 1; j < i + span; ++j) {
+                err = mEntryTable.get(j, &state);
                 if (err != ESP_OK) {
-                    mState = PageState::INVALID;
                     return err;
                 }
-                continue;
+                if (state != EntryState::WRITTEN) {
+                    eraseEntryAndSpan(i);
+                    break;
+                }
             }
+        }
 
-            NVS_ASSERT_OR_RETURN(item.span > 0, ESP_FAIL);
+        i += span - 1;
+    }
 
-            err = mHashList.insert(item, i);
-            if (err != ESP_OK) {
-                mState = PageState::INVALID;
-                return err;
-            }
+    return ESP_OK;
+}
+
+esp_err_t Page::loadItems()
+{
+    if (mItemsLoaded) {
+        return ESP_OK;
+    }
+    // set before checking the items, findItem and eraseEntryAndSpan are used below
+    mItemsLoaded = true;
 
-            size_t span = item.span;
+    auto err = mLoadItems();
+    if (err != ESP_OK) {
+        return err;
+    }
 
-            if (isVariableLengthType(item.datatype)) {
-                for (size_t j = i + 1; j < i + span; ++j) {
-                    err = mEntryTable.get(j, &state);
-                    if (err != ESP_OK) {
-                        return err;
-                    }
-                    if (state != EntryState::WRITTEN) {
-                        eraseEntryAndSpan(i);
-                        break;
-                    }
-                }
-            }
+    Page* newerPage = mNewerPage;
+    mNewerPage = nullptr;
+    if (newerPage == nullptr) {
+        return ESP_OK;
+    }
+
+    // if power went out after a new item was written to the last page, but before the old one was erased,
+    // the old one may be on this page
+    return eraseDuplicates(*newerPage);
+}
 
-            i += span - 1;
+esp_err_t Page::eraseDuplicates(Page& newerPage)
+{
+    // the hashes don't include the type, so an old format blob matches the blob index which replaced it
+    size_t index = 0;
+    while ((index = mHashList.findCommon(index, newerPage.mHashList)) != SIZE_MAX) {
+        Item item;
+        auto err = readEntry(index, item);
+        if (err != ESP_OK) {
+            return err;
         }
 
+        bool duplicate = newerPage.findItem(item.nsIndex, item.datatype, item.key, item.chunkIndex) == ESP_OK;
+        if (!duplicate && item.datatype == ItemType::BLOB) {
+            // old format blob, replaced by a blob index
+            duplicate = newerPage.findItem(item.nsIndex, ItemType::BLOB_IDX, item.key) == ESP_OK;
+        }
+        if (duplicate) {
+            err = eraseEntryAndSpan(index);
+            if (err != ESP_OK) {
+                return err;
+            }
+        }
+        ++index;
     }
-
     return ESP_OK;
 }
 
@@ -868,6 +1238,13 @@ esp_err_t Page::findItem(uint8_t nsIndex, ItemType datatype, const char* key, si
         return ESP_ERR_NVS_NOT_FOUND;
     }
 
+    if (!mItemsLoaded) {
+        auto err = loadItems();
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+
     size_t findBeginIndex = itemIndex;
     if (findBeginIndex >= ENTRY_COUNT) {
         return ESP_ERR_NVS_NOT_FOUND;
@@ -1034,6 +1411,9 @@ esp_err_t Page::erase()
     mNextFreeEntry = INVALID_ENTRY;
     mState = PageState::UNINITIALIZED;
     mHashList.clear();
+    mItemsLoaded = true;
+    mNewerPage = nullptr;
+    ++mEraseCount;
     return ESP_OK;
 }
 
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2015-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2015-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -22,6 +22,29 @@
 namespace nvs
 {
 
+class Page;
+
+/**
+ * Item staged by a write batch (see nvs_batch_begin). Storage::writeBatch writes the staged items of a batch
+ * to flash with Page::writeItems, and erases their previous versions with Page::eraseEntries.
+ */
+struct BatchItem : public intrusive_list_node<BatchItem>, public ExceptionlessAllocatable {
+    ~BatchItem()
+    {
+        delete [] mData;
+    }
+
+    char mKey[Item::MAX_KEY_LENGTH + 1];
+    ItemType mDatatype;
+    uint8_t* mData = nullptr;
+    size_t mDataSize = 0;
+
+    // location of the previous version of the item, looked up right before the item is written
+    Page* mOldPage = nullptr;
+    size_t mOldIndex = 0;
+};
+
+typedef intrusive_list<BatchItem> TBatchItemList;
 
 class Page : public intrusive_list_node<Page>, public ExceptionlessAllocatable
 {
@@ -78,7 +101,27 @@ public:
         return mState;
     }
 
-    esp_err_t load(Partition *partition, uint32_t sectorNumber);
+    /**
+     * Loads the page header and the entry state table. Unless deferItems is set, the items of full pages are
+     * checked and added to the hash list as well; otherwise this is done by loadItems() on first access.
+     */
+    esp_err_t load(Partition *partition, uint32_t sectorNumber, bool deferItems = false);
+
+    /**
+     * Checks and indexes the items of a page loaded with deferItems set. Items which also exist on the page
+     * passed to setNewerPage() are duplicates left by a power loss and get erased.
+     */
+    esp_err_t loadItems();
+
+    bool itemsLoaded() const
+    {
+        return mItemsLoaded;
+    }
+
+    void setNewerPage(Page* page)
+    {
+        mNewerPage = page;
+    }
 
     esp_err_t getSeqNumber(uint32_t& seqNumber) const;
 
@@ -90,6 +133,20 @@ public:
 
     esp_err_t readItem(uint8_t nsIndex, ItemType datatype, const char* key, void* data, size_t dataSize, uint8_t chunkIdx = CHUNK_ANY, VerOffset chunkStart = VerOffset::VER_ANY);
 
+    /**
+     * Reads size bytes, starting at offset, of the data of the variable length item found at itemIndex.
+     * Unlike readItem, this doesn't check the crc of the data.
+     */
+    esp_err_t readItemData(size_t itemIndex, size_t offset, void* data, size_t size);
+
+    /**
+     * Returns the partition offset of the data of the variable length item found at itemIndex.
+     */
+    esp_err_t getItemDataAddress(size_t itemIndex, uint32_t* address) const
+    {
+        return getEntryAddress(itemIndex + 1, address);
+    }
+
     esp_err_t cmpItem(uint8_t nsIndex, ItemType datatype, const char* key, const void* data, size_t dataSize, uint8_t chunkIdx = CHUNK_ANY, VerOffset chunkStart = VerOffset::VER_ANY);
 
     esp_err_t eraseItem(uint8_t nsIndex, ItemType datatype, const char* key, uint8_t chunkIdx = CHUNK_ANY, VerOffset chunkStart = VerOffset::VER_ANY);
@@ -100,6 +157,26 @@ public:
 
     esp_err_t eraseEntryAndSpan(size_t index);
 
+    /**
+     * Erases the items which also exist on newerPage. These are duplicates left by a power loss after the new
+     * version was written to newerPage but before the old one was erased. Only the entries whose hash is in the
+     * hash list of newerPage are read from flash.
+     */
+    esp_err_t eraseDuplicates(Page& newerPage);
+
+    /**
+     * Writes the leading items of the list which fit into this page with a single flash write,
+     * and marks them as written with a single update of the entry state table.
+     * The number of items written is returned in count; ESP_ERR_NVS_PAGE_FULL is returned if not even the
+     * first item fits. Only primitive types and strings can be written this way.
+     */
+    esp_err_t writeItems(uint8_t nsIndex, TBatchItemList& items, size_t& count);
+
+    /**
+     * Erases the items starting at the given entries, writing the changed part of the entry state table at once.
+     */
+    esp_err_t eraseEntries(const uint8_t* indices, size_t count);
+
     template<typename T>
     esp_err_t writeItem(uint8_t nsIndex, const char* key, const T& value)
     {
@@ -141,12 +218,34 @@ public:
 
     esp_err_t copyItems(Page& other);
 
+    /**
+     * Moves whole items, oldest first, to the other page until at least maxEntries entries have been moved.
+     * Every item is written to the other page before it is erased from this one, so power loss leaves at most
+     * a duplicate on the other page, which has to be the last page for PageManager::load to resolve it.
+     * The number of moved entries is returned in movedEntries. Returns ESP_ERR_NVS_PAGE_FULL if the other page
+     * has no room for the next item and ESP_ERR_NVS_NOT_FOUND once this page holds no more items.
+     */
+    esp_err_t moveItems(Page& other, size_t maxEntries, size_t& movedEntries);
+
     esp_err_t erase();
 
+    /**
+     * Number of times this page has been erased since the partition was loaded.
+     */
+    uint32_t getEraseCount() const
+    {
+        return mEraseCount;
+    }
+
     void debugDump() const;
 
     esp_err_t calcEntries(nvs_stats_t &nvsStats);
 
+    void setKeyIndex(KeyIndex* keyIndex, size_t pageIndex)
+    {
+        mHashList.setKeyIndex(keyIndex, pageIndex);
+    }
+
 protected:
 
     class Header
@@ -174,7 +273,9 @@ protected:
         INVALID = NVS_CONST_ENTRY_STATE_INVALID // entry is in inconsistent state (write started but ESB_WRITTEN has not been set yet)
     };
 
-    esp_err_t mLoadEntryTable();
+    esp_err_t mLoadEntryTable(bool deferItems);
+
+    esp_err_t mLoadItems();
 
     esp_err_t initialize();
 
@@ -218,6 +319,9 @@ protected:
     size_t mFirstUsedEntry = INVALID_ENTRY;
     uint16_t mUsedEntryCount = 0;
     uint16_t mErasedEntryCount = 0;
+    uint32_t mEraseCount = 0;
+    bool mItemsLoaded = true;
+    Page* mNewerPage = nullptr;
 
     /**
      * This hash list stores hashes of namespace index, key, and ChunkIndex for quick lookup when searching items.
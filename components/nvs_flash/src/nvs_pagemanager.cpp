@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2015-2023 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2015-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -7,7 +7,7 @@
 
 namespace nvs
 {
-esp_err_t PageManager::load(Partition *partition, uint32_t baseSector, uint32_t sectorCount)
+esp_err_t PageManager::load(Partition *partition, uint32_t baseSector, uint32_t sectorCount, bool deferItems)
 {
     if (partition == nullptr) {
         return ESP_ERR_INVALID_ARG;
@@ -15,6 +15,7 @@ esp_err_t PageManager::load(Partition *partition, uint32_t baseSector, uint32_t
 
     mBaseSector = baseSector;
     mPageCount = sectorCount;
+    mCompactPage = nullptr;
     mPageList.clear();
     mFreePageList.clear();
     mPages.reset(new (nothrow) Page[sectorCount]);
@@ -22,7 +23,7 @@ esp_err_t PageManager::load(Partition *partition, uint32_t baseSector, uint32_t
     if (!mPages) return ESP_ERR_NO_MEM;
 
     for (uint32_t i = 0; i < sectorCount; ++i) {
-        auto err = mPages[i].load(partition, baseSector + i);
+        auto err = mPages[i].load(partition, baseSector + i, deferItems);
         if (err != ESP_OK) {
             return err;
         }
@@ -55,36 +56,19 @@ esp_err_t PageManager::load(Partition *partition, uint32_t baseSector, uint32_t
     }
 
     // if power went out after a new item for the given key was written,
-    // but before the old one was erased, we end up with a duplicate item
+    // but before the old one was erased, we end up with a duplicate item.
+    // A write batch may leave such duplicates for any of the items on the last page.
+    // Each page is checked in one pass over its hash list, against the hash list of the last page.
+    // Pages which haven't been loaded yet do this check against the last page when they are loaded.
     Page& lastPage = back();
-    size_t lastItemIndex = SIZE_MAX;
-    Item item;
-    size_t itemIndex = 0;
-    while (lastPage.findItem(Page::NS_ANY, ItemType::ANY, nullptr, itemIndex, item) == ESP_OK) {
-        itemIndex += item.span;
-        lastItemIndex = itemIndex;
-    }
-
-    if (lastItemIndex != SIZE_MAX) {
-        auto last = PageManager::TPageListIterator(&lastPage);
-        TPageListIterator it;
-
-        for (it = begin(); it != last; ++it) {
-
-            if ((it->state() != Page::PageState::FREEING) &&
-                    (it->eraseItem(item.nsIndex, item.datatype, item.key, item.chunkIndex) == ESP_OK)) {
-                break;
-            }
-        }
-        if ((it == last) && (item.datatype == ItemType::BLOB_IDX)) {
-            /* Rare case in which the blob was stored using old format, but power went just after writing
-             * blob index during modification. Loop again and delete the old version blob*/
-            for (it = begin(); it != last; ++it) {
-
-                if ((it->state() != Page::PageState::FREEING) &&
-                        (it->eraseItem(item.nsIndex, ItemType::BLOB, item.key, item.chunkIndex) == ESP_OK)) {
-                    break;
-                }
+    auto last = PageManager::TPageListIterator(&lastPage);
+    for (auto it = begin(); it != last; ++it) {
+        if (!it->itemsLoaded()) {
+            it->setNewerPage(&lastPage);
+        } else if (it->state() != Page::PageState::FREEING) {
+            auto err = it->eraseDuplicates(lastPage);
+            if (err != ESP_OK) {
+                return err;
             }
         }
     }
@@ -92,6 +76,12 @@ esp_err_t PageManager::load(Partition *partition, uint32_t baseSector, uint32_t
     // check if power went out while page was being freed
     for (auto it = begin(); it!= end(); ++it) {
         if (it->state() == Page::PageState::FREEING) {
+            // the last page is about to change
+            auto err = loadItems();
+            if (err != ESP_OK) {
+                return err;
+            }
+
             Page* newPage = &mPageList.back();
             if (newPage->state() == Page::PageState::ACTIVE) {
                 auto err = newPage->erase();
@@ -101,7 +91,7 @@ esp_err_t PageManager::load(Partition *partition, uint32_t baseSector, uint32_t
                 mPageList.erase(newPage);
                 mFreePageList.push_back(newPage);
             }
-            auto err = activatePage();
+            err = activatePage();
             if (err != ESP_OK) {
                 return err;
             }
@@ -138,35 +128,30 @@ esp_err_t PageManager::requestNewPage()
         return ESP_ERR_NVS_INVALID_STATE;
     }
 
+    // pages which haven't been loaded yet check their items against the last page, which is about to change
+    esp_err_t err = loadItems();
+    if (err != ESP_OK) {
+        return err;
+    }
+
     // do we have at least two free pages? in that case no erasing is required
     if (mFreePageList.size() >= 2) {
         return activatePage();
     }
 
-    // find the page with the highest number of erased items
-    TPageListIterator maxUnusedItemsPageIt;
-    size_t maxUnusedItems = 0;
-    for (auto it = begin(); it != end(); ++it) {
-
-        auto unused =  Page::ENTRY_COUNT - it->getUsedEntryCount();
-        if (unused > maxUnusedItems) {
-            maxUnusedItemsPageIt = it;
-            maxUnusedItems = unused;
-        }
-    }
-
-    if (maxUnusedItems == 0) {
+    auto victimIt = findVictim(end());
+    if (victimIt == end()) {
         return ESP_ERR_NVS_NOT_ENOUGH_SPACE;
     }
 
-    esp_err_t err = activatePage();
+    err = activatePage();
     if (err != ESP_OK) {
         return err;
     }
 
     Page* newPage = &mPageList.back();
 
-    Page* erasedPage = maxUnusedItemsPageIt;
+    Page* erasedPage = victimIt;
 
 #ifndef NDEBUG
     size_t usedEntries = erasedPage->getUsedEntryCount();
@@ -189,12 +174,137 @@ esp_err_t PageManager::requestNewPage()
     NVS_ASSERT_OR_RETURN(usedEntries == newPage->getUsedEntryCount(), ESP_FAIL);
 #endif
 
-    mPageList.erase(maxUnusedItemsPageIt);
+    mPageList.erase(victimIt);
     mFreePageList.push_back(erasedPage);
+    if (erasedPage == mCompactPage) {
+        mCompactPage = nullptr;
+    }
 
     return ESP_OK;
 }
 
+PageManager::TPageListIterator PageManager::findVictim(TPageListIterator last)
+{
+    // Only pages which reclaim at least half as many entries as the best page are candidates,
+    // so that the choice never costs much of the space the caller is waiting for.
+    size_t maxUnusedItems = 0;
+    for (auto it = begin(); it != last; ++it) {
+        auto unused = Page::ENTRY_COUNT - it->getUsedEntryCount();
+        if (unused > maxUnusedItems) {
+            maxUnusedItems = unused;
+        }
+    }
+
+    if (maxUnusedItems == 0) {
+        return end();
+    }
+
+    // Among the candidates, pick the best cost-benefit ratio: reclaimed entries times page age, divided by the
+    // cost of copying the used entries. Old pages hold cold data, which is unlikely to be erased by an update soon,
+    // so reclaiming them lasts longer. Pages which have been erased more often are penalized to spread the wear.
+    TPageListIterator victimIt = end();
+    uint64_t maxScore = 0;
+    for (auto it = begin(); it != last; ++it) {
+        auto used = it->getUsedEntryCount();
+        auto unused = Page::ENTRY_COUNT - used;
+        if (unused == 0 || unused * 2 < maxUnusedItems) {
+            continue;
+        }
+
+        uint32_t seqNumber = mSeqNumber;
+        it->getSeqNumber(seqNumber);
+        uint64_t age = mSeqNumber - seqNumber;
+        uint64_t score = (uint64_t) unused * (age + 1) * 1024 / ((Page::ENTRY_COUNT + used) * (it->getEraseCount() + 1));
+        if (victimIt == end() || score > maxScore) {
+            victimIt = it;
+            maxScore = score;
+        }
+    }
+
+    return victimIt;
+}
+
+size_t PageManager::getReclaimableEntryCount()
+{
+    size_t reclaimable = 0;
+    for (auto it = begin(); it != end(); ++it) {
+        if (&*it != &back()) {
+            reclaimable += Page::ENTRY_COUNT - it->getUsedEntryCount();
+        }
+    }
+    return reclaimable;
+}
+
+bool PageManager::isCompactionPending()
+{
+    if (mCompactPage != nullptr) {
+        return true;
+    }
+    // compacting only pays off if the erased entries add up to at least one more free page
+    return mFreePageList.size() < COMPACT_FREE_PAGES && getReclaimableEntryCount() >= Page::ENTRY_COUNT;
+}
+
+esp_err_t PageManager::compactStep(size_t budget)
+{
+    if (!isCompactionPending()) {
+        return ESP_OK;
+    }
+
+    if (mCompactPage == nullptr) {
+        auto victimIt = findVictim(TPageListIterator(&back()));
+        if (victimIt == end()) {
+            return ESP_OK;
+        }
+        mCompactPage = victimIt;
+    }
+
+    size_t movedEntries = 0;
+    bool pageRequested = false;
+    while (mCompactPage != nullptr && movedEntries < budget) {
+        size_t moved;
+        esp_err_t err = mCompactPage->moveItems(back(), budget - movedEntries, moved);
+        movedEntries += moved;
+        if (moved > 0) {
+            pageRequested = false;
+        }
+
+        if (err == ESP_ERR_NVS_NOT_FOUND) {
+            // all items have been moved, the page can be erased without marking it as freeing first
+            Page* erasedPage = mCompactPage;
+            mCompactPage = nullptr;
+            err = erasedPage->erase();
+            if (err != ESP_OK) {
+                return err;
+            }
+            mPageList.erase(erasedPage);
+            mFreePageList.push_back(erasedPage);
+            break;
+        } else if (err == ESP_ERR_NVS_PAGE_FULL) {
+            // a fresh page which can't take the next item means that the remaining items don't fit anywhere
+            if (pageRequested) {
+                return ESP_ERR_NVS_NOT_ENOUGH_SPACE;
+            }
+            pageRequested = true;
+            Page& page = back();
+            if (page.state() != Page::PageState::FULL) {
+                err = page.markFull();
+                if (err != ESP_OK) {
+                    return err;
+                }
+            }
+            // may reclaim a page on the spot (possibly the one being compacted) if only the reserved page is left
+            err = requestNewPage();
+            if (err != ESP_OK) {
+                return err;
+            }
+        } else if (err != ESP_OK) {
+            return err;
+        }
+    }
+
+    return isCompactionPending() ? ESP_ERR_NOT_FINISHED : ESP_OK;
+}
+
 esp_err_t PageManager::activatePage()
 {
     if (mFreePageList.empty()) {
@@ -214,6 +324,31 @@ esp_err_t PageManager::activatePage()
     return ESP_OK;
 }
 
+esp_err_t PageManager::loadItems()
+{
+    for (auto it = begin(); it != end(); ++it) {
+        auto err = it->loadItems();
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+    return ESP_OK;
+}
+
+bool PageManager::itemsLoaded()
+{
+    return std::all_of(begin(), end(), [](const Page& page) -> bool {
+        return page.itemsLoaded();
+    });
+}
+
+void PageManager::setKeyIndex(KeyIndex* keyIndex)
+{
+    for (uint32_t i = 0; i < mPageCount; ++i) {
+        mPages[i].setKeyIndex(keyIndex, i);
+    }
+}
+
 esp_err_t PageManager::fillStats(nvs_stats_t& nvsStats)
 {
     nvsStats.used_entries      = 0;
@@ -31,7 +31,15 @@ public:
 
     PageManager() {}
 
-    esp_err_t load(Partition *partition, uint32_t baseSector, uint32_t sectorCount);
+    /**
+     * Loads all pages. If deferItems is set, the items of full pages are only checked and indexed
+     * on first access (see Page::loadItems), or by loadItems().
+     */
+    esp_err_t load(Partition *partition, uint32_t baseSector, uint32_t sectorCount, bool deferItems = false);
+
+    esp_err_t loadItems();
+
+    bool itemsLoaded();
 
     TPageListIterator begin()
     {
@@ -52,8 +60,24 @@ public:
         return mPageCount;
     }
 
+    Page& getPage(size_t index)
+    {
+        return mPages[index];
+    }
+
+    void setKeyIndex(KeyIndex* keyIndex);
+
     esp_err_t requestNewPage();
 
+    /**
+     * Performs one bounded step of background compaction: moves up to budget entries (at least one item) out of
+     * the page selected for reclaiming into the active page, and erases the page once it is empty.
+     * Compaction keeps COMPACT_FREE_PAGES pages free, so that requestNewPage doesn't have to move items and erase
+     * a page while a write is waiting.
+     * Returns ESP_OK if there is nothing left to do, ESP_ERR_NOT_FINISHED if further steps are needed.
+     */
+    esp_err_t compactStep(size_t budget);
+
     esp_err_t fillStats(nvs_stats_t& nvsStats);
 
     uint32_t getBaseSector()
@@ -66,12 +90,21 @@ protected:
 
     esp_err_t activatePage();
 
+    TPageListIterator findVictim(TPageListIterator last);
+
+    size_t getReclaimableEntryCount();
+
+    bool isCompactionPending();
+
+    static const size_t COMPACT_FREE_PAGES = 3;
+
     TPageList mPageList;
     TPageList mFreePageList;
     std::unique_ptr<Page[]> mPages;
     uint32_t mBaseSector;
     uint32_t mPageCount;
     uint32_t mSeqNumber;
+    Page* mCompactPage = nullptr;
 }; // class PageManager
 
 
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2019-2023 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2019-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -56,6 +56,16 @@ esp_err_t NVSPartition::erase_range(size_t dst_offset, size_t size)
     return esp_partition_erase_range(mESPPartition, dst_offset, size);
 }
 
+esp_err_t NVSPartition::mmap(size_t src_offset, size_t size, const void** out_ptr, esp_partition_mmap_handle_t* out_handle)
+{
+    return esp_partition_mmap(mESPPartition, src_offset, size, ESP_PARTITION_MMAP_DATA, out_ptr, out_handle);
+}
+
+void NVSPartition::munmap(esp_partition_mmap_handle_t handle)
+{
+    esp_partition_munmap(handle);
+}
+
 uint32_t NVSPartition::get_address()
 {
     return mESPPartition->address;
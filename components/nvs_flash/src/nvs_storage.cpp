@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2015-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2015-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -182,53 +182,110 @@ void Storage::eraseOrphanDataBlobs(TBlobIndexList& blobIdxList)
 
 esp_err_t Storage::init(uint32_t baseSector, uint32_t sectorCount)
 {
-    auto err = mPageManager.load(mPartition, baseSector, sectorCount);
+    mKeyIndex.clear();
+    auto err = mPageManager.load(mPartition, baseSector, sectorCount, LAZY_MOUNT);
     if (err != ESP_OK) {
         mState = StorageState::INVALID;
         return err;
     }
+    mPageManager.setKeyIndex(&mKeyIndex);
+    mAllItemsLoaded = false;
+    mNamespacesLoaded = false;
+    mBlobIndicesChecked = false;
 
-    // load namespaces list
     clearNamespaces();
     std::fill_n(mNamespaceUsage.data(), mNamespaceUsage.byteSize() / 4, 0);
+    if (mNamespaceUsage.set(0, true) != ESP_OK) {
+        return ESP_FAIL;
+    }
+    if (mNamespaceUsage.set(255, true) != ESP_OK) {
+        return ESP_FAIL;
+    }
+
+    // with lazy mount, the namespaces are looked up and the blob indices are checked on first use
+    if (!LAZY_MOUNT) {
+        err = loadNamespaces();
+        if (err != ESP_OK) {
+            mState = StorageState::INVALID;
+            return err;
+        }
+
+        err = checkBlobIndices();
+        if (err != ESP_OK) {
+            mState = StorageState::INVALID;
+            return err;
+        }
+    }
+
+    mState = StorageState::ACTIVE;
+
+#ifdef DEBUG_STORAGE
+    debugCheck();
+#endif
+    return ESP_OK;
+}
+
+esp_err_t Storage::addNamespace(const char* nsName, uint8_t nsIndex)
+{
+    NamespaceEntry* entry = new (std::nothrow) NamespaceEntry;
+    if (!entry) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    entry->mIndex = nsIndex;
+    strncpy(entry->mName, nsName, sizeof(entry->mName) - 1);
+    entry->mName[sizeof(entry->mName) - 1] = 0;
+    if (mNamespaceUsage.set(nsIndex, true) != ESP_OK) {
+        delete entry;
+        return ESP_FAIL;
+    }
+    mNamespaces.push_back(entry);
+    return ESP_OK;
+}
+
+esp_err_t Storage::loadNamespaces()
+{
+    if (mNamespacesLoaded) {
+        return ESP_OK;
+    }
+
+    // namespaces looked up by name so far are found again
+    clearNamespaces();
     for (auto it = mPageManager.begin(); it != mPageManager.end(); ++it) {
         Page& p = *it;
         size_t itemIndex = 0;
         Item item;
         while (p.findItem(Page::NS_INDEX, ItemType::U8, nullptr, itemIndex, item) == ESP_OK) {
-            NamespaceEntry* entry = new (std::nothrow) NamespaceEntry;
-
-            if (!entry) {
-                mState = StorageState::INVALID;
-                return ESP_ERR_NO_MEM;
-            }
-
-            item.getKey(entry->mName, sizeof(entry->mName));
-            err = item.getValue(entry->mIndex);
+            char name[Item::MAX_KEY_LENGTH + 1];
+            uint8_t nsIndex;
+            item.getKey(name, sizeof(name));
+            auto err = item.getValue(nsIndex);
             if (err != ESP_OK) {
-                delete entry;
                 return err;
             }
-            if (mNamespaceUsage.set(entry->mIndex, true) != ESP_OK) {
-                delete entry;
-                return ESP_FAIL;
+            err = addNamespace(name, nsIndex);
+            if (err != ESP_OK) {
+                return err;
             }
-            mNamespaces.push_back(entry);
             itemIndex += item.span;
         }
     }
-    if (mNamespaceUsage.set(0, true) != ESP_OK) {
-        return ESP_FAIL;
-    }
-    if (mNamespaceUsage.set(255, true) != ESP_OK) {
-        return ESP_FAIL;
+
+    mNamespacesLoaded = true;
+    return ESP_OK;
+}
+
+esp_err_t Storage::checkBlobIndices()
+{
+    if (mBlobIndicesChecked) {
+        return ESP_OK;
     }
 
     // Populate list of multi-page index entries.
     TBlobIndexList blobIdxList;
-    err = populateBlobIndices(blobIdxList);
+    auto err = populateBlobIndices(blobIdxList);
     if (err != ESP_OK) {
-        mState = StorageState::INVALID;
+        blobIdxList.clearAndFreeNodes();
         return ESP_ERR_NO_MEM;
     }
 
@@ -241,14 +298,18 @@ esp_err_t Storage::init(uint32_t baseSector, uint32_t sectorCount)
     // Purge the blob index list
     blobIdxList.clearAndFreeNodes();
 
-    mState = StorageState::ACTIVE;
-
-#ifdef DEBUG_STORAGE
-    debugCheck();
-#endif
+    mBlobIndicesChecked = true;
     return ESP_OK;
 }
 
+bool Storage::allItemsLoaded()
+{
+    if (!mAllItemsLoaded) {
+        mAllItemsLoaded = mPageManager.itemsLoaded();
+    }
+    return mAllItemsLoaded;
+}
+
 bool Storage::isValid() const
 {
     return mState == StorageState::ACTIVE;
@@ -256,8 +317,24 @@ bool Storage::isValid() const
 
 esp_err_t Storage::findItem(uint8_t nsIndex, ItemType datatype, const char* key, Page* &page, Item& item, uint8_t chunkIdx, VerOffset chunkStart)
 {
+    size_t itemIndex;
+    return findItem(nsIndex, datatype, key, page, itemIndex, item, chunkIdx, chunkStart);
+}
+
+esp_err_t Storage::findItem(uint8_t nsIndex, ItemType datatype, const char* key, Page* &page, size_t& itemIndex, Item& item, uint8_t chunkIdx, VerOffset chunkStart)
+{
+    // Same condition under which Page::findItem can use its hash list. Pages which haven't been loaded yet
+    // are missing from the index.
+    if (mKeyIndex.isValid() && allItemsLoaded() && nsIndex != Page::NS_ANY && key != nullptr
+            && (datatype != ItemType::BLOB_DATA || chunkIdx != Page::CHUNK_ANY)) {
+        auto err = findIndexedItem(nsIndex, datatype, key, page, itemIndex, item, chunkIdx, chunkStart);
+        if (err != ESP_ERR_NVS_INVALID_STATE) {
+            return err;
+        }
+    }
+
     for (auto it = std::begin(mPageManager); it != std::end(mPageManager); ++it) {
-        size_t itemIndex = 0;
+        itemIndex = 0;
         auto err = it->findItem(nsIndex, datatype, key, itemIndex, item, chunkIdx, chunkStart);
         if (err == ESP_OK) {
             page = it;
@@ -267,6 +344,53 @@ esp_err_t Storage::findItem(uint8_t nsIndex, ItemType datatype, const char* key,
     return ESP_ERR_NVS_NOT_FOUND;
 }
 
+// Looks up the item using the storage-wide key index. Only the pages holding a node with a matching hash are
+// searched, in the same order as the page list (ascending sequence numbers), so that the result is identical
+// to a search over all pages. Returns ESP_ERR_NVS_INVALID_STATE if the lookup has to be done the slow way.
+esp_err_t Storage::findIndexedItem(uint8_t nsIndex, ItemType datatype, const char* key, Page* &page, size_t& itemIndex, Item& item, uint8_t chunkIdx, VerOffset chunkStart)
+{
+    KeyIndex::Location candidates[KEY_INDEX_MAX_CANDIDATES];
+    size_t count = mKeyIndex.find(HashList::hash(Item(nsIndex, datatype, 0, key, chunkIdx)), candidates, KEY_INDEX_MAX_CANDIDATES);
+    if (count > KEY_INDEX_MAX_CANDIDATES) {
+        return ESP_ERR_NVS_INVALID_STATE;
+    }
+
+    while (count > 0) {
+        // pick the page which comes first in the page list, and the lowest entry on it
+        size_t best = 0;
+        uint32_t bestSeqNumber = UINT32_MAX;
+        for (size_t i = 0; i < count; ++i) {
+            uint32_t seqNumber = UINT32_MAX;
+            mPageManager.getPage(candidates[i].mPage).getSeqNumber(seqNumber);
+            if (seqNumber < bestSeqNumber
+                    || (seqNumber == bestSeqNumber && candidates[i].mPage == candidates[best].mPage
+                        && candidates[i].mEntry < candidates[best].mEntry)) {
+                best = i;
+                bestSeqNumber = seqNumber;
+            }
+        }
+
+        const uint16_t pageIndex = candidates[best].mPage;
+        Page& candidatePage = mPageManager.getPage(pageIndex);
+        itemIndex = candidates[best].mEntry;
+        auto err = candidatePage.findItem(nsIndex, datatype, key, itemIndex, item, chunkIdx, chunkStart);
+        if (err == ESP_OK) {
+            page = &candidatePage;
+            return ESP_OK;
+        }
+
+        // the rest of this page has been searched, drop its remaining candidates
+        size_t kept = 0;
+        for (size_t i = 0; i < count; ++i) {
+            if (candidates[i].mPage != pageIndex) {
+                candidates[kept++] = candidates[i];
+            }
+        }
+        count = kept;
+    }
+    return ESP_ERR_NVS_NOT_FOUND;
+}
+
 esp_err_t Storage::writeMultiPageBlob(uint8_t nsIndex, const char* key, const void* data, size_t dataSize, VerOffset chunkStart)
 {
     uint8_t chunkCount = 0;
@@ -382,7 +506,11 @@ esp_err_t Storage::writeItem(uint8_t nsIndex, ItemType datatype, const char* key
     bool matchedTypePageFound = false;
     Item item;
 
-    esp_err_t err;
+    esp_err_t err = checkBlobIndices(datatype);
+    if (err != ESP_OK) {
+        return err;
+    }
+
     if (datatype == ItemType::BLOB) {
         err = findItem(nsIndex, ItemType::BLOB_IDX, key, findPage, item);
         if(err == ESP_OK) {
@@ -527,6 +655,131 @@ esp_err_t Storage::writeItem(uint8_t nsIndex, ItemType datatype, const char* key
     return ESP_OK;
 }
 
+// Looks up the current version of each batch item. Items which would not change are dropped from the list,
+// the same way writeItem skips them.
+esp_err_t Storage::findBatchPredecessors(uint8_t nsIndex, TBatchItemList& items)
+{
+    for (auto it = items.begin(); it != items.end();) {
+        Page* findPage = nullptr;
+        size_t itemIndex = 0;
+        Item item;
+#ifdef CONFIG_NVS_LEGACY_DUP_KEYS_COMPATIBILITY
+        esp_err_t err = findItem(nsIndex, it->mDatatype, it->mKey, findPage, itemIndex, item);
+#else
+        esp_err_t err = findItem(nsIndex, ItemType::ANY, it->mKey, findPage, itemIndex, item);
+#endif
+        if (err == ESP_ERR_NVS_NOT_FOUND) {
+            findPage = nullptr;
+        } else if (err != ESP_OK) {
+            return err;
+        }
+
+        if (findPage && item.datatype == it->mDatatype &&
+                findPage->cmpItem(nsIndex, it->mDatatype, it->mKey, it->mData, it->mDataSize) == ESP_OK) {
+            auto tmp = it;
+            ++it;
+            items.erase(tmp);
+            delete static_cast<BatchItem*>(tmp);
+            continue;
+        }
+
+        it->mOldPage = findPage;
+        it->mOldIndex = itemIndex;
+        ++it;
+    }
+    return ESP_OK;
+}
+
+esp_err_t Storage::writeBatch(uint8_t nsIndex, TBatchItemList& items)
+{
+    if (mState != StorageState::ACTIVE) {
+        items.clearAndFreeNodes();
+        return ESP_ERR_NVS_NOT_INITIALIZED;
+    }
+
+    esp_err_t err = ESP_OK;
+
+    // blobs may span several pages, write them the usual way
+    for (auto it = items.begin(); it != items.end() && err == ESP_OK;) {
+        auto tmp = it;
+        ++it;
+        if (tmp->mDatatype == ItemType::BLOB) {
+            err = writeItem(nsIndex, ItemType::BLOB, tmp->mKey, tmp->mData, tmp->mDataSize);
+            items.erase(tmp);
+            delete static_cast<BatchItem*>(tmp);
+        }
+    }
+
+    bool pageRequested = false;
+    while (err == ESP_OK && !items.empty()) {
+        // Previous versions are looked up for each page, as requesting a new page may move items around.
+        // Writing a page worth of items and erasing their previous versions before moving on to the next page
+        // ensures that after a power loss, duplicates can only exist for items on the last page, which are
+        // removed when the storage is loaded.
+        err = findBatchPredecessors(nsIndex, items);
+        if (err != ESP_OK || items.empty()) {
+            break;
+        }
+
+        Page& page = getCurrentPage();
+        size_t count;
+        err = page.writeItems(nsIndex, items, count);
+        if (err == ESP_ERR_NVS_PAGE_FULL) {
+            if (pageRequested) {
+                err = ESP_ERR_NVS_NOT_ENOUGH_SPACE;
+                break;
+            }
+            if (page.state() != Page::PageState::FULL) {
+                err = page.markFull();
+                if (err != ESP_OK) {
+                    break;
+                }
+            }
+            err = mPageManager.requestNewPage();
+            pageRequested = true;
+            continue;
+        }
+        if (err != ESP_OK) {
+            break;
+        }
+        pageRequested = false;
+
+        // erase the previous versions of the written items, with one entry table update per page
+        auto it = items.begin();
+        for (size_t i = 0; i < count && err == ESP_OK; ++i, ++it) {
+            Page* oldPage = it->mOldPage;
+            if (!oldPage) {
+                continue;
+            }
+            uint8_t indices[Page::ENTRY_COUNT];
+            size_t indexCount = 0;
+            auto jt = it;
+            for (size_t j = i; j < count; ++j, ++jt) {
+                if (jt->mOldPage == oldPage) {
+                    indices[indexCount++] = static_cast<uint8_t>(jt->mOldIndex);
+                    jt->mOldPage = nullptr;
+                }
+            }
+            err = oldPage->eraseEntries(indices, indexCount);
+            if (err == ESP_ERR_FLASH_OP_FAIL) {
+                err = ESP_ERR_NVS_REMOVE_FAILED;
+            }
+        }
+
+        for (size_t i = 0; i < count; ++i) {
+            auto tmp = items.begin();
+            items.erase(tmp);
+            delete static_cast<BatchItem*>(tmp);
+        }
+    }
+
+    items.clearAndFreeNodes();
+#ifdef DEBUG_STORAGE
+    debugCheck();
+#endif
+    return err;
+}
+
 esp_err_t Storage::createOrOpenNamespace(const char* nsName, bool canCreate, uint8_t& nsIndex)
 {
     if (mState != StorageState::ACTIVE) {
@@ -535,6 +788,29 @@ esp_err_t Storage::createOrOpenNamespace(const char* nsName, bool canCreate, uin
     auto it = std::find_if(mNamespaces.begin(), mNamespaces.end(), [=] (const NamespaceEntry& e) -> bool {
         return strncmp(nsName, e.mName, sizeof(e.mName) - 1) == 0;
     });
+    if (it == std::end(mNamespaces) && !mNamespacesLoaded) {
+        // look the namespace up by its name, which only loads the pages up to the one holding it
+        Item item;
+        Page* findPage = nullptr;
+        auto err = findItem(Page::NS_INDEX, ItemType::U8, nsName, findPage, item);
+        if (err == ESP_OK) {
+            err = item.getValue(nsIndex);
+            if (err != ESP_OK) {
+                return err;
+            }
+            return addNamespace(nsName, nsIndex);
+        }
+        if (err != ESP_ERR_NVS_NOT_FOUND) {
+            return err;
+        }
+        // a free namespace index can only be picked once all namespaces are known
+        if (canCreate) {
+            err = loadNamespaces();
+            if (err != ESP_OK) {
+                return err;
+            }
+        }
+    }
     if (it == std::end(mNamespaces)) {
         if (!canCreate) {
             return ESP_ERR_NVS_NOT_FOUND;
@@ -559,21 +835,12 @@ esp_err_t Storage::createOrOpenNamespace(const char* nsName, bool canCreate, uin
         if (err != ESP_OK) {
             return err;
         }
-        if (mNamespaceUsage.set(ns, true) != ESP_OK) {
-            return ESP_FAIL;
-        }
         nsIndex = ns;
 
-        NamespaceEntry* entry = new (std::nothrow) NamespaceEntry;
-        if (!entry) {
-            return ESP_ERR_NO_MEM;
+        err = addNamespace(nsName, ns);
+        if (err != ESP_OK) {
+            return err;
         }
-
-        entry->mIndex = ns;
-        strncpy(entry->mName, nsName, sizeof(entry->mName) - 1);
-        entry->mName[sizeof(entry->mName) - 1] = 0;
-        mNamespaces.push_back(entry);
-
     } else {
         nsIndex = it->mIndex;
     }
@@ -630,6 +897,187 @@ esp_err_t Storage::readMultiPageBlob(uint8_t nsIndex, const char* key, void* dat
     return err;
 }
 
+esp_err_t Storage::openBlob(uint8_t nsIndex, const char* key, BlobReadState& state)
+{
+    if (mState != StorageState::ACTIVE) {
+        return ESP_ERR_NVS_NOT_INITIALIZED;
+    }
+
+    esp_err_t err = checkBlobIndices(ItemType::BLOB);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    closeBlob(state);
+    state = BlobReadState();
+    strncpy(state.key, key, sizeof(state.key) - 1);
+    state.nsIndex = nsIndex;
+
+    Item item;
+    Page* findPage = nullptr;
+    err = findItem(nsIndex, ItemType::BLOB_IDX, key, findPage, item);
+    if (err == ESP_OK) {
+        state.chunkType = ItemType::BLOB_DATA;
+        state.chunkStart = item.blobIndex.chunkStart;
+        state.chunkCount = item.blobIndex.chunkCount;
+        state.dataSize = item.blobIndex.dataSize;
+        return ESP_OK;
+    } else if (err != ESP_ERR_NVS_NOT_FOUND) {
+        return err;
+    }
+
+    // the blob may be stored in the earlier version format without index
+    err = findItem(nsIndex, ItemType::BLOB, key, findPage, item);
+    if (err != ESP_OK) {
+        return err;
+    }
+    state.chunkType = ItemType::BLOB;
+    state.chunkStart = VerOffset::VER_ANY;
+    state.chunkCount = 1;
+    state.dataSize = item.varLength.dataSize;
+    return ESP_OK;
+}
+
+esp_err_t Storage::findBlobChunk(BlobReadState& state, Page* &page, size_t& itemIndex)
+{
+    while (true) {
+        if (state.chunkNum >= state.chunkCount) {
+            return ESP_ERR_NVS_NOT_FOUND;
+        }
+
+        Item item;
+        uint8_t chunkIdx = Page::CHUNK_ANY;
+        if (state.chunkType == ItemType::BLOB_DATA) {
+            chunkIdx = static_cast<uint8_t>(state.chunkStart) + state.chunkNum;
+        }
+        auto err = findItem(state.nsIndex, state.chunkType, state.key, page, itemIndex, item, chunkIdx);
+        if (err != ESP_OK) {
+            return err;
+        }
+
+        if (state.chunkOffset == 0) {
+            if (item.varLength.dataSize > state.dataSize - state.offset) {
+                /* The size of the entry in the index is inconsistent with the sum of the sizes of chunks */
+                return ESP_ERR_NVS_INVALID_LENGTH;
+            }
+            state.chunkSize = item.varLength.dataSize;
+            state.chunkCrc32 = item.varLength.dataCrc32;
+            state.crc32 = 0xffffffff; // initial value of Item::calculateCrc32
+        } else if (item.varLength.dataSize != state.chunkSize || item.varLength.dataCrc32 != state.chunkCrc32) {
+            // the blob has been written again since the read position entered the chunk
+            return ESP_ERR_NVS_NOT_FOUND;
+        }
+
+        if (state.chunkOffset < state.chunkSize) {
+            return ESP_OK;
+        }
+        // skip an empty chunk
+        ++state.chunkNum;
+        state.chunkOffset = 0;
+    }
+}
+
+esp_err_t Storage::advanceBlob(BlobReadState& state, const void* data, size_t size)
+{
+    state.crc32 = Item::updateCrc32(state.crc32, static_cast<const uint8_t*>(data), size);
+    state.offset += size;
+    state.chunkOffset += size;
+    if (state.chunkOffset < state.chunkSize) {
+        return ESP_OK;
+    }
+
+    if (state.crc32 != state.chunkCrc32) {
+        return ESP_ERR_INVALID_CRC;
+    }
+    ++state.chunkNum;
+    state.chunkOffset = 0;
+    return ESP_OK;
+}
+
+esp_err_t Storage::readBlob(BlobReadState& state, void* data, size_t size, size_t& readSize)
+{
+    if (mState != StorageState::ACTIVE) {
+        return ESP_ERR_NVS_NOT_INITIALIZED;
+    }
+
+    readSize = 0;
+    uint8_t* dst = static_cast<uint8_t*>(data);
+    while (state.error == ESP_OK && size > 0 && state.offset < state.dataSize) {
+        Page* findPage = nullptr;
+        size_t itemIndex;
+        state.error = findBlobChunk(state, findPage, itemIndex);
+        if (state.error != ESP_OK) {
+            break;
+        }
+
+        size_t willRead = state.chunkSize - state.chunkOffset;
+        willRead = (size < willRead) ? size : willRead;
+        state.error = findPage->readItemData(itemIndex, state.chunkOffset, dst, willRead);
+        if (state.error != ESP_OK) {
+            break;
+        }
+        state.error = advanceBlob(state, dst, willRead);
+
+        dst += willRead;
+        size -= willRead;
+        readSize += willRead;
+    }
+    return state.error;
+}
+
+esp_err_t Storage::mapBlob(BlobReadState& state, const void*& data, size_t size, size_t& readSize)
+{
+    if (mState != StorageState::ACTIVE) {
+        return ESP_ERR_NVS_NOT_INITIALIZED;
+    }
+
+    data = nullptr;
+    readSize = 0;
+    if (state.error != ESP_OK || size == 0 || state.offset >= state.dataSize) {
+        return state.error;
+    }
+
+    Page* findPage = nullptr;
+    size_t itemIndex;
+    state.error = findBlobChunk(state, findPage, itemIndex);
+    if (state.error != ESP_OK) {
+        return state.error;
+    }
+
+    uint32_t address;
+    auto err = findPage->getItemDataAddress(itemIndex, &address);
+    if (err != ESP_OK) {
+        return err;
+    }
+    if (state.mapPtr == nullptr || state.mapAddress != address) {
+        // the chunk is entered or has been moved to another page by garbage collection
+        closeBlob(state);
+        const void* ptr;
+        err = mPartition->mmap(address, state.chunkSize, &ptr, &state.mapHandle);
+        if (err != ESP_OK) {
+            // not sticky, the caller may fall back to readBlob
+            return err;
+        }
+        state.mapPtr = static_cast<const uint8_t*>(ptr);
+        state.mapAddress = address;
+    }
+
+    size_t willRead = state.chunkSize - state.chunkOffset;
+    willRead = (size < willRead) ? size : willRead;
+    data = state.mapPtr + state.chunkOffset;
+    readSize = willRead;
+    state.error = advanceBlob(state, data, willRead);
+    return state.error;
+}
+
+void Storage::closeBlob(BlobReadState& state)
+{
+    if (state.mapPtr != nullptr) {
+        mPartition->munmap(state.mapHandle);
+        state.mapPtr = nullptr;
+    }
+}
+
 esp_err_t Storage::cmpMultiPageBlob(uint8_t nsIndex, const char* key, const void* data, size_t dataSize)
 {
     Item item;
@@ -678,16 +1126,21 @@ esp_err_t Storage::readItem(uint8_t nsIndex, ItemType datatype, const char* key,
         return ESP_ERR_NVS_NOT_INITIALIZED;
     }
 
+    esp_err_t err = checkBlobIndices(datatype);
+    if (err != ESP_OK) {
+        return err;
+    }
+
     Item item;
     Page* findPage = nullptr;
     if (datatype == ItemType::BLOB) {
-        auto err = readMultiPageBlob(nsIndex, key, data, dataSize);
+        err = readMultiPageBlob(nsIndex, key, data, dataSize);
         if (err != ESP_ERR_NVS_NOT_FOUND) {
             return err;
         } // else check if the blob is stored with earlier version format without index
     }
 
-    auto err = findItem(nsIndex, datatype, key, findPage, item);
+    err = findItem(nsIndex, datatype, key, findPage, item);
     if (err != ESP_OK) {
         return err;
     }
@@ -769,13 +1222,18 @@ esp_err_t Storage::eraseItem(uint8_t nsIndex, ItemType datatype, const char* key
         return ESP_ERR_NVS_NOT_INITIALIZED;
     }
 
+    auto err = checkBlobIndices(datatype);
+    if (err != ESP_OK) {
+        return err;
+    }
+
     if (datatype == ItemType::BLOB) {
         return eraseMultiPageBlob(nsIndex, key);
     }
 
     Item item;
     Page* findPage = nullptr;
-    auto err = findItem(nsIndex, datatype, key, findPage, item);
+    err = findItem(nsIndex, datatype, key, findPage, item);
     if (err != ESP_OK) {
         return err;
     }
@@ -814,9 +1272,14 @@ esp_err_t Storage::findKey(const uint8_t nsIndex, const char* key, ItemType* dat
         return ESP_ERR_NVS_NOT_INITIALIZED;
     }
 
+    auto err = checkBlobIndices(ItemType::ANY);
+    if (err != ESP_OK) {
+        return err;
+    }
+
     Item item;
     Page* findPage = nullptr;
-    auto err = findItem(nsIndex, ItemType::ANY, key, findPage, item);
+    err = findItem(nsIndex, ItemType::ANY, key, findPage, item);
     if (err != ESP_OK) {
         return err;
     }
@@ -834,9 +1297,14 @@ esp_err_t Storage::getItemDataSize(uint8_t nsIndex, ItemType datatype, const cha
         return ESP_ERR_NVS_NOT_INITIALIZED;
     }
 
+    auto err = checkBlobIndices(datatype);
+    if (err != ESP_OK) {
+        return err;
+    }
+
     Item item;
     Page* findPage = nullptr;
-    auto err = findItem(nsIndex, datatype, key, findPage, item);
+    err = findItem(nsIndex, datatype, key, findPage, item);
     if (err != ESP_OK) {
         if (datatype != ItemType::BLOB) {
             return err;
@@ -887,8 +1355,22 @@ void Storage::debugCheck()
 }
 #endif //DEBUG_STORAGE
 
+esp_err_t Storage::compactStep(size_t budget)
+{
+    if (mState != StorageState::ACTIVE) {
+        return ESP_ERR_NVS_NOT_INITIALIZED;
+    }
+
+    return mPageManager.compactStep(budget);
+}
+
 esp_err_t Storage::fillStats(nvs_stats_t& nvsStats)
 {
+    auto err = loadNamespaces();
+    if (err != ESP_OK) {
+        return err;
+    }
+
     nvsStats.namespace_count = mNamespaces.size();
     return mPageManager.fillStats(nvsStats);
 }
@@ -901,11 +1383,16 @@ esp_err_t Storage::calcEntriesInNamespace(uint8_t nsIndex, size_t& usedEntries)
         return ESP_ERR_NVS_NOT_INITIALIZED;
     }
 
+    auto err = checkBlobIndices();
+    if (err != ESP_OK) {
+        return err;
+    }
+
     for (auto it = std::begin(mPageManager); it != std::end(mPageManager); ++it) {
         size_t itemIndex = 0;
         Item item;
         while (true) {
-            auto err = it->findItem(nsIndex, ItemType::ANY, nullptr, itemIndex, item);
+            err = it->findItem(nsIndex, ItemType::ANY, nullptr, itemIndex, item);
             if (err == ESP_ERR_NVS_NOT_FOUND) {
                 break;
             }
@@ -936,6 +1423,10 @@ void Storage::fillEntryInfo(Item &item, nvs_entry_info_t &info)
 
 bool Storage::findEntry(nvs_opaque_iterator_t* it, const char* namespace_name)
 {
+    if (loadNamespaces() != ESP_OK || checkBlobIndices() != ESP_OK) {
+        return false;
+    }
+
     it->entryIndex = 0;
     it->nsIndex = Page::NS_ANY;
     it->page = mPageManager.begin();
@@ -951,6 +1442,10 @@ bool Storage::findEntry(nvs_opaque_iterator_t* it, const char* namespace_name)
 
 bool Storage::findEntryNs(nvs_opaque_iterator_t* it, uint8_t nsIndex)
 {
+    if (loadNamespaces() != ESP_OK || checkBlobIndices() != ESP_OK) {
+        return false;
+    }
+
     it->entryIndex = 0;
     it->nsIndex = nsIndex;
     it->page = mPageManager.begin();
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2015-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2015-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -21,6 +21,28 @@
 namespace nvs
 {
 
+/**
+ * Position of a sequential read of a blob, see Storage::openBlob.
+ */
+struct BlobReadState {
+    char key[Item::MAX_KEY_LENGTH + 1];
+    uint8_t nsIndex;
+    ItemType chunkType;     // BLOB_DATA, or BLOB for a blob written in the single page format
+    VerOffset chunkStart;
+    uint8_t chunkCount;
+    size_t dataSize;
+    size_t offset;          // read position in the blob
+    uint8_t chunkNum;       // chunk holding the read position
+    size_t chunkOffset;     // read position in the chunk
+    size_t chunkSize;
+    uint32_t chunkCrc32;    // crc of the chunk data, as recorded in the chunk header
+    uint32_t crc32;         // crc of the chunk data read so far
+    esp_err_t error;        // once a read fails, all further reads fail with the same error
+    uint32_t mapAddress;    // partition offset of the mapped chunk data
+    const uint8_t* mapPtr;  // nullptr if no chunk is mapped
+    esp_partition_mmap_handle_t mapHandle;
+};
+
 class Storage : public intrusive_list_node<Storage>, public ExceptionlessAllocatable
 {
     enum class StorageState : uint32_t {
@@ -55,10 +77,27 @@ class Storage : public intrusive_list_node<Storage>, public ExceptionlessAllocat
 
     typedef intrusive_list<BlobIndexNode> TBlobIndexList;
 
+#ifdef CONFIG_NVS_KEY_INDEX
+    static const size_t KEY_INDEX_MAX_SIZE = CONFIG_NVS_KEY_INDEX_MAX_SIZE;
+#else
+    static const size_t KEY_INDEX_MAX_SIZE = 0;
+#endif
+
+    /**
+     * Number of key index hits examined per lookup before falling back to searching all pages.
+     */
+    static const size_t KEY_INDEX_MAX_CANDIDATES = 8;
+
+#ifdef CONFIG_NVS_LAZY_MOUNT
+    static const bool LAZY_MOUNT = true;
+#else
+    static const bool LAZY_MOUNT = false;
+#endif
+
 public:
     ~Storage();
 
-    Storage(Partition *partition) : mPartition(partition) {
+    Storage(Partition *partition) : mPartition(partition), mKeyIndex(KEY_INDEX_MAX_SIZE) {
         if (partition == nullptr) {
             abort();
         }
@@ -80,6 +119,12 @@ public:
 
     esp_err_t eraseItem(uint8_t nsIndex, ItemType datatype, const char* key);
 
+    /**
+     * Writes all items of the list and erases their previous versions, consuming the list.
+     * Consecutive items are written to a page with a single flash write. Blobs are written one by one.
+     */
+    esp_err_t writeBatch(uint8_t nsIndex, TBatchItemList& items);
+
     template<typename T>
     esp_err_t writeItem(uint8_t nsIndex, const char* key, const T& value)
     {
@@ -99,6 +144,8 @@ public:
 
     esp_err_t eraseNamespace(uint8_t nsIndex);
 
+    esp_err_t compactStep(size_t budget);
+
     const Partition *getPart() const
     {
         return mPartition;
@@ -122,6 +169,25 @@ public:
 
     esp_err_t eraseMultiPageBlob(uint8_t nsIndex, const char* key, VerOffset chunkStart = VerOffset::VER_ANY);
 
+    /**
+     * Prepares state for reading the blob with the given key chunk by chunk. No data is read yet.
+     */
+    esp_err_t openBlob(uint8_t nsIndex, const char* key, BlobReadState& state);
+
+    /**
+     * Reads up to size bytes from the read position of state into data, without buffering the whole blob.
+     * readSize is less than size only at the end of the blob.
+     */
+    esp_err_t readBlob(BlobReadState& state, void* data, size_t size, size_t& readSize);
+
+    /**
+     * Like readBlob, but points data into a memory mapping of the current chunk instead of copying it.
+     * readSize doesn't extend past the end of the chunk. The mapping is kept until the next call or closeBlob.
+     */
+    esp_err_t mapBlob(BlobReadState& state, const void*& data, size_t size, size_t& readSize);
+
+    void closeBlob(BlobReadState& state);
+
     void debugDump();
 
     void debugCheck();
@@ -145,6 +211,29 @@ protected:
 
     void clearNamespaces();
 
+    esp_err_t addNamespace(const char* nsName, uint8_t nsIndex);
+
+    /**
+     * Reads all namespace entries. With lazy mount, namespaces are looked up by name until the complete list is needed.
+     */
+    esp_err_t loadNamespaces();
+
+    /**
+     * Erases incomplete blobs left by a power loss. With lazy mount, this is done before the first blob is accessed.
+     */
+    esp_err_t checkBlobIndices();
+
+    esp_err_t checkBlobIndices(ItemType datatype)
+    {
+        if (datatype != ItemType::ANY && datatype != ItemType::BLOB
+                && datatype != ItemType::BLOB_IDX && datatype != ItemType::BLOB_DATA) {
+            return ESP_OK;
+        }
+        return checkBlobIndices();
+    }
+
+    bool allItemsLoaded();
+
     esp_err_t populateBlobIndices(TBlobIndexList&);
 
     void eraseMismatchedBlobIndexes(TBlobIndexList&);
@@ -155,13 +244,35 @@ protected:
 
     esp_err_t findItem(uint8_t nsIndex, ItemType datatype, const char* key, Page* &page, Item& item, uint8_t chunkIdx = Page::CHUNK_ANY, VerOffset chunkStart = VerOffset::VER_ANY);
 
+    esp_err_t findItem(uint8_t nsIndex, ItemType datatype, const char* key, Page* &page, size_t& itemIndex, Item& item, uint8_t chunkIdx = Page::CHUNK_ANY, VerOffset chunkStart = VerOffset::VER_ANY);
+
+    esp_err_t findIndexedItem(uint8_t nsIndex, ItemType datatype, const char* key, Page* &page, size_t& itemIndex, Item& item, uint8_t chunkIdx, VerOffset chunkStart);
+
+    esp_err_t findBatchPredecessors(uint8_t nsIndex, TBatchItemList& items);
+
+    /**
+     * Finds the chunk holding the read position of state and checks that it hasn't been replaced since
+     * the read position entered it.
+     */
+    esp_err_t findBlobChunk(BlobReadState& state, Page* &page, size_t& itemIndex);
+
+    /**
+     * Moves the read position of state past the given data of the current chunk,
+     * checking the crc of the chunk once its end is reached.
+     */
+    esp_err_t advanceBlob(BlobReadState& state, const void* data, size_t size);
+
 protected:
     Partition *mPartition;
     size_t mPageCount;
+    KeyIndex mKeyIndex; // declared before mPageManager, the pages detach from it on destruction
     PageManager mPageManager;
     TNamespaces mNamespaces;
     CompressedEnumTable<bool, 1, 256> mNamespaceUsage;
     StorageState mState = StorageState::INVALID;
+    bool mAllItemsLoaded = false;
+    bool mNamespacesLoaded = false;
+    bool mBlobIndicesChecked = false;
 };
 
 } // namespace nvs
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2015-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2015-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -35,9 +35,12 @@ uint32_t Item::calculateCrc32WithoutValue() const
 
 uint32_t Item::calculateCrc32(const uint8_t* data, size_t size)
 {
-    uint32_t result = 0xffffffff;
-    result = esp_rom_crc32_le(result, data, size);
-    return result;
+    return updateCrc32(0xffffffff, data, size);
+}
+
+uint32_t Item::updateCrc32(uint32_t crc, const uint8_t* data, size_t size)
+{
+    return esp_rom_crc32_le(crc, data, size);
 }
 
 bool Item::checkHeaderConsistency(const uint8_t entryIndex) const
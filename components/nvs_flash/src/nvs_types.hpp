@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2015-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2015-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -95,6 +95,11 @@ public:
     uint32_t calculateCrc32WithoutValue() const;
     static uint32_t calculateCrc32(const uint8_t* data, size_t size);
 
+    /**
+     * Continues a crc calculated by calculateCrc32(data, size) over the following bytes of the data.
+     */
+    static uint32_t updateCrc32(uint32_t crc, const uint8_t* data, size_t size);
+
     void getKey(char* dst, size_t dstSize)
     {
         strncpy(dst, key, min(dstSize, sizeof(key)));
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2019-2023 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2019-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -8,6 +8,7 @@
 #define PARTITION_HPP_
 
 #include "esp_err.h"
+#include "esp_partition.h"
 
 namespace nvs {
 
@@ -35,6 +36,14 @@ public:
 
     virtual esp_err_t erase_range(size_t dst_offset, size_t size) = 0;
 
+    /**
+     * Map a region of the partition into the address space, see esp_partition_mmap.
+     * Return ESP_ERR_NOT_SUPPORTED if the data can't be read through a mapping, e.g. because it is encrypted.
+     */
+    virtual esp_err_t mmap(size_t src_offset, size_t size, const void** out_ptr, esp_partition_mmap_handle_t* out_handle) = 0;
+
+    virtual void munmap(esp_partition_mmap_handle_t handle) = 0;
+
     /**
      * Return the address of the beginning of the partition.
      */
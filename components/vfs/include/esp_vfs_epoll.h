@@ -0,0 +1,121 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ESP_VFS_EPOLLIN     (1 << 0)    /*!< The fd is readable */
+#define ESP_VFS_EPOLLOUT    (1 << 2)    /*!< The fd is writable */
+#define ESP_VFS_EPOLLERR    (1 << 3)    /*!< An error occurred on the fd, or it was closed. Always reported. */
+
+/**
+ * @brief Operations of esp_vfs_epoll_ctl()
+ */
+typedef enum {
+    ESP_VFS_EPOLL_CTL_ADD = 1,  /*!< Add the fd to the interest list */
+    ESP_VFS_EPOLL_CTL_DEL = 2,  /*!< Remove the fd from the interest list */
+    ESP_VFS_EPOLL_CTL_MOD = 3,  /*!< Change the events and the user data of the fd */
+} esp_vfs_epoll_op_t;
+
+/**
+ * @brief Event of an fd in the interest list
+ */
+typedef struct {
+    uint32_t events;    /*!< Bitwise OR of ESP_VFS_EPOLL* flags, requested by esp_vfs_epoll_ctl() or reported by esp_vfs_epoll_wait() */
+    int fd;             /*!< The fd, set by esp_vfs_epoll_wait() */
+    void *user_data;    /*!< Pointer given to esp_vfs_epoll_ctl(), returned by esp_vfs_epoll_wait() */
+} esp_vfs_epoll_event_t;
+
+/**
+ * @brief Handle of an epoll instance
+ */
+typedef struct esp_vfs_epoll *esp_vfs_epoll_handle_t;
+
+/**
+ * @brief Create an epoll instance
+ *
+ * An epoll instance keeps a list of fds and the events of interest, so that waiting for them doesn't require
+ * passing and scanning all of them as select() does. Drivers which implement start_select and end_select
+ * (eventfd, UART, USB Serial/JTAG, ...) notify the epoll instance of each fd separately, so esp_vfs_epoll_wait()
+ * only checks the fds which were signalled, and waiting for them costs O(ready fds). The socket driver has no such
+ * notifications: each esp_vfs_epoll_wait() passes all the sockets of the interest list to its socket_select, which
+ * checks all of them, so waiting for sockets costs O(sockets in the interest list), as with select().
+ *
+ * Readiness is level-triggered: an fd is reported by each call of esp_vfs_epoll_wait() as long as it is ready.
+ *
+ * @param[out] ret_epoll Handle of the created epoll instance
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if ret_epoll is NULL
+ *      - ESP_ERR_NO_MEM if out of memory
+ */
+esp_err_t esp_vfs_epoll_create(esp_vfs_epoll_handle_t *ret_epoll);
+
+/**
+ * @brief Delete an epoll instance
+ *
+ * All the fds are removed from the interest list. No task may wait on the instance.
+ *
+ * @param epoll Handle of the epoll instance
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if epoll is NULL
+ */
+esp_err_t esp_vfs_epoll_delete(esp_vfs_epoll_handle_t epoll);
+
+/**
+ * @brief Add, modify or remove an fd in the interest list of an epoll instance
+ *
+ * An fd should be removed from the interest list before it is closed. If an fd of a driver with start_select is
+ * closed or reused by another driver while it is in the list, esp_vfs_epoll_wait() reports it once with
+ * ESP_VFS_EPOLLERR and removes it. A socket must be removed before it is closed, otherwise esp_vfs_epoll_wait()
+ * fails with EBADF. An fd which its driver failed to arm again is reported with ESP_VFS_EPOLLERR and is not
+ * waited for until it is modified with ESP_VFS_EPOLL_CTL_MOD.
+ *
+ * @param epoll Handle of the epoll instance
+ * @param op Operation
+ * @param fd File descriptor
+ * @param event Events of interest and user data of the fd. Not used by ESP_VFS_EPOLL_CTL_DEL, can be NULL then.
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if an argument is invalid or the fd is not open
+ *      - ESP_ERR_INVALID_STATE if the fd is already in the interest list (ADD) or it is not there (MOD, DEL)
+ *      - ESP_ERR_NOT_SUPPORTED if the VFS of the fd doesn't support select()
+ *      - ESP_ERR_NO_MEM if out of memory
+ *      - Other errors returned by the start_select function of the VFS driver
+ */
+esp_err_t esp_vfs_epoll_ctl(esp_vfs_epoll_handle_t epoll, esp_vfs_epoll_op_t op, int fd, const esp_vfs_epoll_event_t *event);
+
+/**
+ * @brief Wait for events on the fds in the interest list of an epoll instance
+ *
+ * Only one task can wait on an epoll instance at a time.
+ *
+ * @param epoll Handle of the epoll instance
+ * @param[out] events Array which receives the events of the ready fds
+ * @param max_events Size of the events array, greater than 0
+ * @param timeout_ms Maximum time to wait in milliseconds, 0 to return immediately, -1 to wait indefinitely
+ *
+ * @return Number of ready fds, 0 if the timeout expired, -1 on error with errno set:
+ *      - EINVAL if an argument is invalid
+ *      - EBUSY if another task is waiting on the epoll instance
+ *      - EBADF if a socket of the interest list was closed
+ *      - ENOMEM if out of memory
+ */
+int esp_vfs_epoll_wait(esp_vfs_epoll_handle_t epoll, esp_vfs_epoll_event_t *events, int max_events, int timeout_ms);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2024-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -48,6 +48,7 @@ typedef struct
 {
     bool is_sem_local;      /*!< type of "sem" is SemaphoreHandle_t when true, defined by socket driver otherwise */
     void *sem;              /*!< semaphore instance */
+    bool is_epoll;          /*!< "sem" is an entry of the interest list of an epoll instance, see esp_vfs_epoll.h */
 } esp_vfs_select_sem_t;
 
 
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2015-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2015-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -73,6 +73,34 @@ const vfs_entry_t *get_vfs_for_path(const char *path);
  */
 const vfs_entry_t *get_vfs_for_index(int index);
 
+/**
+ * Get vfs entry and local fd with given global fd.
+ *
+ * @param fd global file descriptor.
+ * @param local_fd receives the file descriptor within the VFS.
+ * @param permanent receives true if the fd was registered by esp_vfs_register_fd_range, as socket fds are.
+ *
+ * @return Pointer to the `vfs_entry_t` of the fd, or NULL if the fd is not open.
+ */
+const vfs_entry_t *get_vfs_for_fd_with_local_fd(int fd, int *local_fd, bool *permanent);
+
+#ifdef CONFIG_VFS_SUPPORT_SELECT
+/**
+ * Called by esp_vfs_select_triggered for a semaphore with is_epoll set.
+ *
+ * @param item entry of the interest list of an epoll instance.
+ */
+void esp_vfs_epoll_triggered(void *item);
+
+/**
+ * Called by esp_vfs_select_triggered_isr for a semaphore with is_epoll set.
+ *
+ * @param item entry of the interest list of an epoll instance.
+ * @param woken set to pdTRUE if a task was woken and a context switch is needed.
+ */
+void esp_vfs_epoll_triggered_isr(void *item, BaseType_t *woken);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,195 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <unistd.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "unity.h"
+#include "esp_vfs.h"
+#include "esp_vfs_epoll.h"
+#include "esp_vfs_eventfd.h"
+#include "lwip/sockets.h"
+#include "test_utils.h"
+
+#define EPOLL_TEST_FDS 8
+
+static void signal_eventfd(int fd)
+{
+    uint64_t val = 1;
+    TEST_ASSERT_EQUAL(sizeof(val), write(fd, &val, sizeof(val)));
+}
+
+static void clear_eventfd(int fd)
+{
+    uint64_t val;
+    TEST_ASSERT_EQUAL(sizeof(val), read(fd, &val, sizeof(val)));
+}
+
+TEST_CASE("epoll reports only the ready eventfds", "[vfs][epoll]")
+{
+    esp_vfs_eventfd_config_t config = ESP_VFS_EVENTD_CONFIG_DEFAULT();
+    config.max_fds = EPOLL_TEST_FDS;
+    TEST_ESP_OK(esp_vfs_eventfd_register(&config));
+
+    esp_vfs_epoll_handle_t epoll;
+    TEST_ESP_OK(esp_vfs_epoll_create(&epoll));
+
+    int fds[EPOLL_TEST_FDS];
+    for (int i = 0; i < EPOLL_TEST_FDS; i++) {
+        fds[i] = eventfd(0, 0);
+        TEST_ASSERT_GREATER_OR_EQUAL(0, fds[i]);
+        esp_vfs_epoll_event_t event = { .events = ESP_VFS_EPOLLIN, .user_data = &fds[i] };
+        TEST_ESP_OK(esp_vfs_epoll_ctl(epoll, ESP_VFS_EPOLL_CTL_ADD, fds[i], &event));
+    }
+    esp_vfs_epoll_event_t event = { .events = ESP_VFS_EPOLLIN };
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, esp_vfs_epoll_ctl(epoll, ESP_VFS_EPOLL_CTL_ADD, fds[0], &event));
+
+    esp_vfs_epoll_event_t events[EPOLL_TEST_FDS];
+    TEST_ASSERT_EQUAL(0, esp_vfs_epoll_wait(epoll, events, EPOLL_TEST_FDS, 0));
+    TEST_ASSERT_EQUAL(0, esp_vfs_epoll_wait(epoll, events, EPOLL_TEST_FDS, 20));
+
+    signal_eventfd(fds[2]);
+    signal_eventfd(fds[5]);
+    TEST_ASSERT_EQUAL(2, esp_vfs_epoll_wait(epoll, events, EPOLL_TEST_FDS, 100));
+    TEST_ASSERT_EQUAL(fds[2], events[0].fd);
+    TEST_ASSERT_EQUAL_PTR(&fds[2], events[0].user_data);
+    TEST_ASSERT_EQUAL(ESP_VFS_EPOLLIN, events[0].events);
+    TEST_ASSERT_EQUAL(fds[5], events[1].fd);
+
+    // level-triggered: reported until read, one at a time with max_events 1
+    TEST_ASSERT_EQUAL(1, esp_vfs_epoll_wait(epoll, events, 1, 0));
+    TEST_ASSERT_EQUAL(fds[2], events[0].fd);
+    TEST_ASSERT_EQUAL(1, esp_vfs_epoll_wait(epoll, events, 1, 0));
+    TEST_ASSERT_EQUAL(fds[5], events[0].fd);
+    clear_eventfd(fds[2]);
+    clear_eventfd(fds[5]);
+    TEST_ASSERT_EQUAL(0, esp_vfs_epoll_wait(epoll, events, EPOLL_TEST_FDS, 0));
+
+    // removed fds are not reported
+    TEST_ESP_OK(esp_vfs_epoll_ctl(epoll, ESP_VFS_EPOLL_CTL_DEL, fds[3], NULL));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, esp_vfs_epoll_ctl(epoll, ESP_VFS_EPOLL_CTL_DEL, fds[3], NULL));
+    signal_eventfd(fds[3]);
+    TEST_ASSERT_EQUAL(0, esp_vfs_epoll_wait(epoll, events, EPOLL_TEST_FDS, 0));
+
+    // a closed fd is reported once with an error and removed
+    TEST_ASSERT_EQUAL(0, close(fds[6]));
+    TEST_ASSERT_EQUAL(1, esp_vfs_epoll_wait(epoll, events, EPOLL_TEST_FDS, 100));
+    TEST_ASSERT_EQUAL(fds[6], events[0].fd);
+    TEST_ASSERT_TRUE(events[0].events & ESP_VFS_EPOLLERR);
+    TEST_ASSERT_EQUAL(0, esp_vfs_epoll_wait(epoll, events, EPOLL_TEST_FDS, 0));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, esp_vfs_epoll_ctl(epoll, ESP_VFS_EPOLL_CTL_DEL, fds[6], NULL));
+    fds[6] = eventfd(0, 0);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, fds[6]);
+
+    // eventfds are always writable
+    event.events = ESP_VFS_EPOLLOUT;
+    TEST_ESP_OK(esp_vfs_epoll_ctl(epoll, ESP_VFS_EPOLL_CTL_MOD, fds[4], &event));
+    TEST_ASSERT_EQUAL(1, esp_vfs_epoll_wait(epoll, events, EPOLL_TEST_FDS, 0));
+    TEST_ASSERT_EQUAL(fds[4], events[0].fd);
+    TEST_ASSERT_EQUAL(ESP_VFS_EPOLLOUT, events[0].events);
+    TEST_ASSERT_NULL(events[0].user_data);
+
+    TEST_ASSERT_EQUAL(-1, esp_vfs_epoll_wait(epoll, events, 0, 0));
+    TEST_ASSERT_EQUAL(EINVAL, errno);
+
+    TEST_ESP_OK(esp_vfs_epoll_delete(epoll));
+    for (int i = 0; i < EPOLL_TEST_FDS; i++) {
+        TEST_ASSERT_EQUAL(0, close(fds[i]));
+    }
+    TEST_ESP_OK(esp_vfs_eventfd_unregister());
+}
+
+typedef struct {
+    int fd;
+    int delay_ms;
+} epoll_signal_task_args_t;
+
+static void epoll_signal_task(void *arg)
+{
+    epoll_signal_task_args_t *args = (epoll_signal_task_args_t *)arg;
+    vTaskDelay(pdMS_TO_TICKS(args->delay_ms));
+    uint64_t val = 1;
+    write(args->fd, &val, sizeof(val));
+    vTaskDelete(NULL);
+}
+
+static int udp_socket_init(uint16_t port)
+{
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, fd);
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(port),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    TEST_ASSERT_EQUAL(0, bind(fd, (struct sockaddr *)&addr, sizeof(addr)));
+    return fd;
+}
+
+static void udp_send(int fd, uint16_t port)
+{
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(port),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    const char message[] = "epoll";
+    TEST_ASSERT_EQUAL(sizeof(message), sendto(fd, message, sizeof(message), 0, (struct sockaddr *)&addr, sizeof(addr)));
+}
+
+TEST_CASE("epoll waits for eventfds and loopback sockets", "[vfs][epoll]")
+{
+    test_case_uses_tcpip();
+
+    esp_vfs_eventfd_config_t config = ESP_VFS_EVENTD_CONFIG_DEFAULT();
+    TEST_ESP_OK(esp_vfs_eventfd_register(&config));
+    int event_fd = eventfd(0, 0);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, event_fd);
+    int rx_fd = udp_socket_init(5000);
+    int tx_fd = udp_socket_init(5001);
+
+    esp_vfs_epoll_handle_t epoll;
+    TEST_ESP_OK(esp_vfs_epoll_create(&epoll));
+    esp_vfs_epoll_event_t event = { .events = ESP_VFS_EPOLLIN };
+    TEST_ESP_OK(esp_vfs_epoll_ctl(epoll, ESP_VFS_EPOLL_CTL_ADD, event_fd, &event));
+    TEST_ESP_OK(esp_vfs_epoll_ctl(epoll, ESP_VFS_EPOLL_CTL_ADD, rx_fd, &event));
+
+    esp_vfs_epoll_event_t events[2];
+    TEST_ASSERT_EQUAL(0, esp_vfs_epoll_wait(epoll, events, 2, 50));
+
+    udp_send(tx_fd, 5000);
+    TEST_ASSERT_EQUAL(1, esp_vfs_epoll_wait(epoll, events, 2, 1000));
+    TEST_ASSERT_EQUAL(rx_fd, events[0].fd);
+    TEST_ASSERT_EQUAL(ESP_VFS_EPOLLIN, events[0].events);
+
+    signal_eventfd(event_fd);
+    TEST_ASSERT_EQUAL(2, esp_vfs_epoll_wait(epoll, events, 2, 0));
+    TEST_ASSERT_EQUAL(event_fd, events[0].fd);
+    TEST_ASSERT_EQUAL(rx_fd, events[1].fd);
+
+    char buf[16];
+    TEST_ASSERT_GREATER_THAN(0, recv(rx_fd, buf, sizeof(buf), 0));
+    clear_eventfd(event_fd);
+    TEST_ASSERT_EQUAL(0, esp_vfs_epoll_wait(epoll, events, 2, 0));
+
+    // the eventfd interrupts the waiting in socket_select
+    epoll_signal_task_args_t args = { .fd = event_fd, .delay_ms = 50 };
+    xTaskCreate(epoll_signal_task, "epoll_signal", 2048, &args, 5, NULL);
+    TickType_t start = xTaskGetTickCount();
+    TEST_ASSERT_EQUAL(1, esp_vfs_epoll_wait(epoll, events, 2, -1));
+    TEST_ASSERT_EQUAL(event_fd, events[0].fd);
+    TEST_ASSERT_LESS_THAN(pdMS_TO_TICKS(1000), xTaskGetTickCount() - start);
+    clear_eventfd(event_fd);
+
+    TEST_ESP_OK(esp_vfs_epoll_ctl(epoll, ESP_VFS_EPOLL_CTL_DEL, event_fd, NULL));
+    TEST_ESP_OK(esp_vfs_epoll_ctl(epoll, ESP_VFS_EPOLL_CTL_DEL, rx_fd, NULL));
+    TEST_ESP_OK(esp_vfs_epoll_delete(epoll));
+    close(rx_fd);
+    close(tx_fd);
+    TEST_ASSERT_EQUAL(0, close(event_fd));
+    TEST_ESP_OK(esp_vfs_eventfd_unregister());
+}
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2015-2023 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2015-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -8,8 +8,11 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <inttypes.h>
 #include <errno.h>
 #include <sys/fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #ifdef __clang__ // TODO LLVM-330
 #include <sys/dirent.h>
 #else
@@ -18,6 +21,7 @@
 #include "esp_vfs.h"
 #include "unity.h"
 #include "esp_log.h"
+#include "esp_cpu.h"
 
 /* Dummy VFS implementation to check if VFS is called or not with expected path
  */
@@ -277,3 +281,67 @@ TEST_CASE("vfs checks mount point path", "[vfs]")
     test_register_ok("/23456789012345");
     test_register_fail("/234567890123456");
 }
+
+static int bench_open(void* ctx, const char * path, int flags, int mode)
+{
+    return 0;
+}
+
+static int bench_close(void* ctx, int fd)
+{
+    return 0;
+}
+
+static int bench_stat(void* ctx, const char * path, struct stat * st)
+{
+    memset(st, 0, sizeof(*st));
+    return 0;
+}
+
+#define BENCH_MOUNTS_MAX 16
+#define BENCH_ITERATIONS 1000
+
+TEST_CASE("vfs open and stat timings with 1 to 16 mount points", "[vfs]")
+{
+    esp_vfs_t desc = {
+        .flags = ESP_VFS_FLAG_CONTEXT_PTR,
+        .open_p = bench_open,
+        .close_p = bench_close,
+        .stat_p = bench_stat,
+    };
+    char prefixes[BENCH_MOUNTS_MAX][ESP_VFS_PATH_MAX];
+    int mounts = 0;
+    for (int target = 1; target <= BENCH_MOUNTS_MAX; target *= 2) {
+        for (; mounts < target; mounts++) {
+            snprintf(prefixes[mounts], sizeof(prefixes[mounts]), "/bench%02d", mounts);
+            if (esp_vfs_register(prefixes[mounts], &desc, NULL) != ESP_OK) {
+                break;
+            }
+        }
+        if (mounts < target) {
+            break;  // CONFIG_VFS_MAX_COUNT reached
+        }
+        // the paths of the most recently registered mount point
+        char path[32];
+        snprintf(path, sizeof(path), "%s/dir/file.txt", prefixes[mounts - 1]);
+        struct stat st;
+
+        uint32_t start = esp_cpu_get_cycle_count();
+        for (int i = 0; i < BENCH_ITERATIONS; i++) {
+            TEST_ASSERT_EQUAL(0, stat(path, &st));
+        }
+        uint32_t stat_cycles = (esp_cpu_get_cycle_count() - start) / BENCH_ITERATIONS;
+
+        start = esp_cpu_get_cycle_count();
+        for (int i = 0; i < BENCH_ITERATIONS; i++) {
+            int fd = open(path, O_RDONLY);
+            TEST_ASSERT_GREATER_OR_EQUAL(0, fd);
+            close(fd);
+        }
+        uint32_t open_cycles = (esp_cpu_get_cycle_count() - start) / BENCH_ITERATIONS;
+        printf("%2d mount points: stat %"PRIu32" cycles, open + close %"PRIu32" cycles\n", mounts, stat_cycles, open_cycles);
+    }
+    for (int i = 0; i < mounts; i++) {
+        TEST_ESP_OK( esp_vfs_unregister(prefixes[i]) );
+    }
+}
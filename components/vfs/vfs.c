@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2015-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2015-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -73,6 +73,26 @@ typedef struct {
 static vfs_entry_t* s_vfs[VFS_MAX_COUNT] = { 0 };
 static size_t s_vfs_count = 0;
 
+/* Hash table of the path prefixes of registered VFSes, rebuilt when a VFS is registered or unregistered.
+ * A path can only be matched by its leading parts ending before a path separator or at the end of the path,
+ * so get_vfs_for_path looks up these, longest first, and only for the lengths which some prefix has.
+ * There are two tables so that a table being rebuilt is not used for lookups.
+ */
+#define VFS_PATH_TABLE_SIZE 64
+_Static_assert(VFS_PATH_TABLE_SIZE >= 2 * VFS_MAX_COUNT, "VFS path table too small");
+_Static_assert(ESP_VFS_PATH_MAX < 32, "VFS path prefix lengths don't fit the mask");
+
+typedef struct {
+    uint32_t len_mask;  // bit N is set if some prefix is N characters long
+    vfs_index_t slots[VFS_PATH_TABLE_SIZE];
+} vfs_path_table_t;
+
+static vfs_path_table_t s_path_tables[2] = {
+    { .len_mask = 0, .slots = { [0 ... VFS_PATH_TABLE_SIZE - 1] = -1 } },
+    { .len_mask = 0, .slots = { [0 ... VFS_PATH_TABLE_SIZE - 1] = -1 } },
+};
+static vfs_path_table_t *volatile s_path_table = &s_path_tables[0];
+
 static fd_table_t s_fd_table[MAX_FDS] = { [0 ... MAX_FDS-1] = FD_TABLE_ENTRY_UNUSED };
 static _lock_t s_fd_table_lock;
 
@@ -395,6 +415,63 @@ fail:
     return ESP_ERR_NO_MEM;
 }
 
+/* FNV-1a hash of the path prefix, updated one character at a time */
+#define VFS_PATH_HASH_INIT 2166136261u
+
+static inline uint32_t path_hash_update(uint32_t hash, char c)
+{
+    return (hash ^ (uint8_t) c) * 16777619u;
+}
+
+static uint32_t path_hash(const char *path, size_t len)
+{
+    uint32_t hash = VFS_PATH_HASH_INIT;
+    for (size_t i = 0; i < len; i++) {
+        hash = path_hash_update(hash, path[i]);
+    }
+    return hash;
+}
+
+static ssize_t path_table_find(const vfs_path_table_t *table, const char *prefix, size_t len, uint32_t hash)
+{
+    for (size_t n = 0; n < VFS_PATH_TABLE_SIZE; n++) {
+        vfs_index_t index = table->slots[(hash + n) % VFS_PATH_TABLE_SIZE];
+        if (index < 0) {
+            break;
+        }
+        const vfs_entry_t *vfs = s_vfs[index];
+        if (vfs != NULL && vfs->path_prefix_len == len && memcmp(vfs->path_prefix, prefix, len) == 0) {
+            return index;
+        }
+    }
+    return -1;
+}
+
+static void rebuild_path_table(void)
+{
+    vfs_path_table_t *table = (s_path_table == &s_path_tables[0]) ? &s_path_tables[1] : &s_path_tables[0];
+    table->len_mask = 0;
+    memset(table->slots, -1, sizeof(table->slots));
+    for (size_t i = 0; i < s_vfs_count; ++i) {
+        const vfs_entry_t *vfs = s_vfs[i];
+        if (vfs == NULL || vfs->path_prefix_len == LEN_PATH_PREFIX_IGNORED) {
+            continue;
+        }
+        uint32_t hash = path_hash(vfs->path_prefix, vfs->path_prefix_len);
+        // if several VFSes have the same prefix, the one with the lowest index is used
+        if (path_table_find(table, vfs->path_prefix, vfs->path_prefix_len, hash) >= 0) {
+            continue;
+        }
+        size_t n = 0;
+        while (table->slots[(hash + n) % VFS_PATH_TABLE_SIZE] >= 0) {
+            n++;
+        }
+        table->slots[(hash + n) % VFS_PATH_TABLE_SIZE] = i;
+        table->len_mask |= 1u << vfs->path_prefix_len;
+    }
+    s_path_table = table;
+}
+
 static esp_err_t esp_vfs_register_fs_common(const char* base_path, size_t len, const esp_vfs_fs_ops_t* vfs, int flags, void* ctx, int *vfs_index)
 {
     if (vfs == NULL) {
@@ -442,6 +519,9 @@ static esp_err_t esp_vfs_register_fs_common(const char* base_path, size_t len, c
     entry->ctx = ctx;
     entry->offset = index;
     entry->flags = flags;
+    if (len != LEN_PATH_PREFIX_IGNORED) {
+        rebuild_path_table();
+    }
 
     if (vfs_index) {
         *vfs_index = index;
@@ -570,8 +650,11 @@ esp_err_t esp_vfs_unregister_with_id(esp_vfs_id_t vfs_id)
         return ESP_ERR_INVALID_ARG;
     }
     vfs_entry_t* vfs = s_vfs[vfs_id];
-    esp_vfs_free_entry(vfs);
     s_vfs[vfs_id] = NULL;
+    if (vfs->path_prefix_len != LEN_PATH_PREFIX_IGNORED) {
+        rebuild_path_table();
+    }
+    esp_vfs_free_entry(vfs);
 
     _lock_acquire(&s_fd_table_lock);
     // Delete all references from the FD lookup-table
@@ -591,17 +674,11 @@ esp_err_t esp_vfs_unregister_fs_with_id(esp_vfs_id_t vfs_id) __attribute__((alia
 esp_err_t esp_vfs_unregister(const char* base_path)
 {
     const size_t base_path_len = strlen(base_path);
-    for (size_t i = 0; i < s_vfs_count; ++i) {
-        vfs_entry_t* vfs = s_vfs[i];
-        if (vfs == NULL) {
-            continue;
-        }
-        if (base_path_len == vfs->path_prefix_len &&
-                memcmp(base_path, vfs->path_prefix, vfs->path_prefix_len) == 0) {
-            return esp_vfs_unregister_with_id(i);
-        }
+    ssize_t index = path_table_find(s_path_table, base_path, base_path_len, path_hash(base_path, base_path_len));
+    if (index < 0) {
+        return ESP_ERR_INVALID_STATE;
     }
-    return ESP_ERR_INVALID_STATE;
+    return esp_vfs_unregister_with_id(index);
 }
 
 esp_err_t esp_vfs_unregister_fs(const char* base_path) __attribute__((alias("esp_vfs_unregister")));
@@ -710,18 +787,12 @@ void esp_vfs_dump_registered_paths(FILE *fp)
 esp_err_t esp_vfs_set_readonly_flag(const char* base_path)
 {
     const size_t base_path_len = strlen(base_path);
-    for (size_t i = 0; i < s_vfs_count; ++i) {
-        vfs_entry_t* vfs = s_vfs[i];
-        if (vfs == NULL) {
-            continue;
-        }
-        if (base_path_len == vfs->path_prefix_len &&
-                memcmp(base_path, vfs->path_prefix, vfs->path_prefix_len) == 0) {
-            vfs->flags |= ESP_VFS_FLAG_READONLY_FS;
-            return ESP_OK;
-        }
+    ssize_t index = path_table_find(s_path_table, base_path, base_path_len, path_hash(base_path, base_path_len));
+    if (index < 0) {
+        return ESP_ERR_INVALID_STATE;
     }
-    return ESP_ERR_INVALID_STATE;
+    s_vfs[index]->flags |= ESP_VFS_FLAG_READONLY_FS;
+    return ESP_OK;
 }
 
 const vfs_entry_t *get_vfs_for_index(int index)
@@ -748,6 +819,22 @@ static const vfs_entry_t *get_vfs_for_fd(int fd)
     return vfs;
 }
 
+const vfs_entry_t *get_vfs_for_fd_with_local_fd(int fd, int *local_fd, bool *permanent)
+{
+    if (!fd_valid(fd)) {
+        return NULL;
+    }
+    _lock_acquire(&s_fd_table_lock);
+    const fd_table_t entry = s_fd_table[fd];
+    _lock_release(&s_fd_table_lock);
+    if (entry.has_pending_close) {
+        return NULL;
+    }
+    *local_fd = entry.local_fd;
+    *permanent = entry.permanent;
+    return get_vfs_for_index(entry.vfs_index);
+}
+
 static inline int get_local_fd(const vfs_entry_t *vfs, int fd)
 {
     int local_fd = -1;
@@ -771,42 +858,39 @@ static const char* translate_path(const vfs_entry_t* vfs, const char* src_path)
 
 const vfs_entry_t* get_vfs_for_path(const char* path)
 {
-    const vfs_entry_t* best_match = NULL;
-    ssize_t best_match_prefix_len = -1;
-    size_t len = strlen(path);
-    for (size_t i = 0; i < s_vfs_count; ++i) {
-        const vfs_entry_t* vfs = s_vfs[i];
-        if (vfs == NULL || vfs->path_prefix_len == LEN_PATH_PREFIX_IGNORED) {
-            continue;
-        }
-        // match path prefix
-        if (len < vfs->path_prefix_len ||
-            memcmp(path, vfs->path_prefix, vfs->path_prefix_len) != 0) {
-            continue;
-        }
-        // this is the default VFS and we don't have a better match yet.
-        if (vfs->path_prefix_len == 0 && !best_match) {
-            best_match = vfs;
-            continue;
-        }
+    const vfs_path_table_t *table = s_path_table;
+    if (table->len_mask == 0) {
+        return NULL;
+    }
+    // hashes of the leading parts of the path, up to the length of the longest prefix
+    const size_t max_len = 31 - __builtin_clz(table->len_mask);
+    uint32_t hashes[ESP_VFS_PATH_MAX + 1];
+    uint32_t hash = VFS_PATH_HASH_INIT;
+    size_t len = 0;
+    hashes[0] = hash;
+    while (len < max_len && path[len] != '\0') {
+        hash = path_hash_update(hash, path[len]);
+        hashes[++len] = hash;
+    }
+    // Out of all matching path prefixes, select the longest one;
+    // i.e. if "/dev" and "/dev/uart" both match, for "/dev/uart/1" path,
+    // choose "/dev/uart"
+    uint32_t len_mask = table->len_mask & ((2u << len) - 1);
+    while (len_mask != 0) {
+        size_t prefix_len = 31 - __builtin_clz(len_mask);
+        len_mask &= ~(1u << prefix_len);
         // if path is not equal to the prefix, expect to see a path separator
-        // i.e. don't match "/data" prefix for "/data1/foo.txt" path
-        if (len > vfs->path_prefix_len &&
-                path[vfs->path_prefix_len] != '/') {
+        // i.e. don't match "/data" prefix for "/data1/foo.txt" path.
+        // The default VFS with the empty prefix matches any path.
+        if (prefix_len > 0 && path[prefix_len] != '\0' && path[prefix_len] != '/') {
             continue;
         }
-        // Out of all matching path prefixes, select the longest one;
-        // i.e. if "/dev" and "/dev/uart" both match, for "/dev/uart/1" path,
-        // choose "/dev/uart",
-        // This causes all s_vfs_count VFS entries to be scanned when opening
-        // a file by name. This can be optimized by introducing a table for
-        // FS search order, sorted so that longer prefixes are checked first.
-        if (best_match_prefix_len < (ssize_t) vfs->path_prefix_len) {
-            best_match_prefix_len = (ssize_t) vfs->path_prefix_len;
-            best_match = vfs;
+        ssize_t index = path_table_find(table, path, prefix_len, hashes[prefix_len]);
+        if (index >= 0) {
+            return s_vfs[index];
         }
     }
-    return best_match;
+    return NULL;
 }
 
 /*
@@ -1647,7 +1731,9 @@ int esp_vfs_select(int nfds, fd_set *readfds, fd_set *writefds, fd_set *errorfds
 
 void esp_vfs_select_triggered(esp_vfs_select_sem_t sem)
 {
-    if (sem.is_sem_local) {
+    if (sem.is_epoll) {
+        esp_vfs_epoll_triggered(sem.sem);
+    } else if (sem.is_sem_local) {
         xSemaphoreGive(sem.sem);
     } else {
         // Another way would be to go through s_fd_table and find the VFS
@@ -1670,7 +1756,9 @@ void esp_vfs_select_triggered(esp_vfs_select_sem_t sem)
 
 void esp_vfs_select_triggered_isr(esp_vfs_select_sem_t sem, BaseType_t *woken)
 {
-    if (sem.is_sem_local) {
+    if (sem.is_epoll) {
+        esp_vfs_epoll_triggered_isr(sem.sem, woken);
+    } else if (sem.is_sem_local) {
         xSemaphoreGiveFromISR(sem.sem, woken);
     } else {
         // Another way would be to go through s_fd_table and find the VFS
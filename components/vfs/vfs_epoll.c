@@ -0,0 +1,560 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/errno.h>
+#include <sys/lock.h>
+#include <sys/param.h>
+#include <sys/select.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "esp_heap_caps.h"
+#include "esp_vfs.h"
+#include "esp_vfs_epoll.h"
+#include "esp_vfs_private.h"
+#include "sdkconfig.h"
+
+#ifdef CONFIG_VFS_SUPPRESS_SELECT_DEBUG_OUTPUT
+#define LOG_LOCAL_LEVEL ESP_LOG_NONE
+#endif //CONFIG_VFS_SUPPRESS_SELECT_DEBUG_OUTPUT
+#include "esp_log.h"
+
+#ifdef CONFIG_VFS_SUPPORT_SELECT
+
+/*
+This file implements epoll instances on top of the select functions of the VFS drivers.
+
+Each fd of a driver with start_select is armed separately: start_select is called with fd_sets containing only the
+local fd of the item and a semaphore which points to the item (is_epoll is set). The driver calls
+esp_vfs_select_triggered with it when the fd becomes ready, which queues the item in the ready list of the epoll
+instance and wakes the waiting task. esp_vfs_epoll_wait then calls end_select only for the queued items, reports the
+events the driver set in the fd_sets of the item and arms the item again. As the drivers signal an armed fd which is
+already ready immediately, the readiness is level-triggered.
+
+The socket driver doesn't have per-fd notifications, so the sockets of the interest list are passed to its
+socket_select by esp_vfs_epoll_wait. Waiting for sockets therefore costs O(sockets in the interest list) on each
+call, as with select(). When an item of another driver is triggered meanwhile, socket_select is interrupted in the
+same way as by esp_vfs_select.
+
+An armed item whose fd was closed, or reused by another driver, is reported once with EPOLLERR when it is
+triggered (drivers signal the fds closed while selected) and removed from the interest list.
+*/
+
+static const char *TAG = "vfs_epoll";
+
+typedef struct epoll_item_ {
+    struct esp_vfs_epoll *epoll;
+    int fd;
+    int local_fd;
+    const vfs_entry_t *vfs;
+    uint32_t events;                // events requested by esp_vfs_epoll_ctl
+    void *user_data;
+    bool is_socket;
+    bool armed;                     // start_select was called and end_select was not yet
+    bool queued;                    // the item is in the ready list
+    void *driver_args;              // end_select_args of the driver
+    fd_set readfds;                 // set by the driver between start_select and end_select
+    fd_set writefds;
+    fd_set errorfds;
+    struct epoll_item_ *next;       // next item in the ready list or in the list of sockets
+} epoll_item_t;
+
+struct esp_vfs_epoll {
+    _lock_t lock;                   // protects the interest list and serializes the processing of events
+    bool waiting;                   // a task is in esp_vfs_epoll_wait
+    epoll_item_t *items[MAX_FDS];
+    epoll_item_t *sockets;          // items of socket fds
+    portMUX_TYPE ready_lock;        // protects the fields below, the items are queued by drivers, also from ISRs
+    epoll_item_t *ready_head;
+    epoll_item_t *ready_tail;
+    void *socket_sem;               // semaphore of socket_select while the waiting task is in it
+    SemaphoreHandle_t ready_sem;    // given when an item is queued
+};
+
+static inline bool fd_is_socket(const vfs_entry_t *vfs, bool permanent)
+{
+    return permanent && vfs->vfs->select->socket_select != NULL;
+}
+
+/* Must be called with ready_lock taken */
+static void wake_waiter(struct esp_vfs_epoll *epoll)
+{
+    if (epoll->socket_sem) {
+        esp_vfs_select_triggered((esp_vfs_select_sem_t) {
+            .is_sem_local = false, .sem = epoll->socket_sem,
+        });
+    }
+    xSemaphoreGive(epoll->ready_sem);
+}
+
+void esp_vfs_epoll_triggered(void *arg)
+{
+    epoll_item_t *item = (epoll_item_t *)arg;
+    struct esp_vfs_epoll *epoll = item->epoll;
+
+    portENTER_CRITICAL_SAFE(&epoll->ready_lock);
+    if (!item->queued) {
+        item->queued = true;
+        item->next = NULL;
+        if (epoll->ready_tail) {
+            epoll->ready_tail->next = item;
+        } else {
+            epoll->ready_head = item;
+        }
+        epoll->ready_tail = item;
+    }
+    wake_waiter(epoll);
+    portEXIT_CRITICAL_SAFE(&epoll->ready_lock);
+}
+
+void esp_vfs_epoll_triggered_isr(void *arg, BaseType_t *woken)
+{
+    // Note: everything called here has to be in IRAM with CONFIG_VFS_SELECT_IN_RAM, the same as for esp_vfs_select_triggered_isr
+    epoll_item_t *item = (epoll_item_t *)arg;
+    struct esp_vfs_epoll *epoll = item->epoll;
+
+    portENTER_CRITICAL_ISR(&epoll->ready_lock);
+    if (!item->queued) {
+        item->queued = true;
+        item->next = NULL;
+        if (epoll->ready_tail) {
+            epoll->ready_tail->next = item;
+        } else {
+            epoll->ready_head = item;
+        }
+        epoll->ready_tail = item;
+    }
+    if (epoll->socket_sem) {
+        esp_vfs_select_triggered_isr((esp_vfs_select_sem_t) {
+            .is_sem_local = false, .sem = epoll->socket_sem,
+        }, woken);
+    }
+    xSemaphoreGiveFromISR(epoll->ready_sem, woken);
+    portEXIT_CRITICAL_ISR(&epoll->ready_lock);
+}
+
+static esp_err_t arm_item(epoll_item_t *item)
+{
+    FD_ZERO(&item->readfds);
+    FD_ZERO(&item->writefds);
+    FD_ZERO(&item->errorfds);
+    if (item->events & ESP_VFS_EPOLLIN) {
+        FD_SET(item->local_fd, &item->readfds);
+    }
+    if (item->events & ESP_VFS_EPOLLOUT) {
+        FD_SET(item->local_fd, &item->writefds);
+    }
+    FD_SET(item->local_fd, &item->errorfds);
+
+    esp_vfs_select_sem_t sem = {
+        .is_sem_local = false,
+        .sem = item,
+        .is_epoll = true,
+    };
+    item->driver_args = NULL;
+    esp_err_t err = item->vfs->vfs->select->start_select(item->local_fd + 1, &item->readfds, &item->writefds,
+                                                         &item->errorfds, sem, &item->driver_args);
+    item->armed = (err == ESP_OK);
+    return err;
+}
+
+/* Returns the events the driver reported since the item was armed */
+static uint32_t disarm_item(epoll_item_t *item)
+{
+    uint32_t events = 0;
+    if (!item->armed) {
+        return events;
+    }
+    if (item->vfs->vfs->select->end_select) {
+        esp_err_t err = item->vfs->vfs->select->end_select(item->driver_args);
+        if (err != ESP_OK) {
+            ESP_LOGD(TAG, "end_select failed for fd %d: %s", item->fd, esp_err_to_name(err));
+        }
+    }
+    item->armed = false;
+    if (FD_ISSET(item->local_fd, &item->readfds)) {
+        events |= ESP_VFS_EPOLLIN;
+    }
+    if (FD_ISSET(item->local_fd, &item->writefds)) {
+        events |= ESP_VFS_EPOLLOUT;
+    }
+    if (FD_ISSET(item->local_fd, &item->errorfds)) {
+        events |= ESP_VFS_EPOLLERR;
+    }
+    return events & (item->events | ESP_VFS_EPOLLERR);
+}
+
+/* Must be called with epoll->lock taken */
+static void unqueue_item(struct esp_vfs_epoll *epoll, epoll_item_t *item)
+{
+    portENTER_CRITICAL(&epoll->ready_lock);
+    if (item->queued) {
+        epoll_item_t *prev = NULL;
+        for (epoll_item_t *it = epoll->ready_head; it != NULL; prev = it, it = it->next) {
+            if (it == item) {
+                if (prev) {
+                    prev->next = item->next;
+                } else {
+                    epoll->ready_head = item->next;
+                }
+                if (epoll->ready_tail == item) {
+                    epoll->ready_tail = prev;
+                }
+                break;
+            }
+        }
+        item->queued = false;
+    }
+    portEXIT_CRITICAL(&epoll->ready_lock);
+}
+
+static void remove_item(struct esp_vfs_epoll *epoll, epoll_item_t *item)
+{
+    if (item->is_socket) {
+        epoll_item_t **it = &epoll->sockets;
+        while (*it != item) {
+            it = &(*it)->next;
+        }
+        *it = item->next;
+    } else {
+        // no more triggers after end_select, so the item can be removed from the ready list for good
+        (void) disarm_item(item);
+        unqueue_item(epoll, item);
+    }
+    epoll->items[item->fd] = NULL;
+    free(item);
+}
+
+esp_err_t esp_vfs_epoll_create(esp_vfs_epoll_handle_t *ret_epoll)
+{
+    if (ret_epoll == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    struct esp_vfs_epoll *epoll = heap_caps_calloc(1, sizeof(struct esp_vfs_epoll), VFS_MALLOC_FLAGS);
+    if (epoll == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    epoll->ready_sem = xSemaphoreCreateBinary();
+    if (epoll->ready_sem == NULL) {
+        free(epoll);
+        return ESP_ERR_NO_MEM;
+    }
+    _lock_init(&epoll->lock);
+    portMUX_INITIALIZE(&epoll->ready_lock);
+    *ret_epoll = epoll;
+    return ESP_OK;
+}
+
+esp_err_t esp_vfs_epoll_delete(esp_vfs_epoll_handle_t epoll)
+{
+    if (epoll == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    _lock_acquire(&epoll->lock);
+    for (int fd = 0; fd < MAX_FDS; ++fd) {
+        if (epoll->items[fd]) {
+            remove_item(epoll, epoll->items[fd]);
+        }
+    }
+    _lock_release(&epoll->lock);
+    _lock_close(&epoll->lock);
+    vSemaphoreDelete(epoll->ready_sem);
+    free(epoll);
+    return ESP_OK;
+}
+
+static esp_err_t add_item(struct esp_vfs_epoll *epoll, int fd, const esp_vfs_epoll_event_t *event)
+{
+    int local_fd;
+    bool permanent;
+    const vfs_entry_t *vfs = get_vfs_for_fd_with_local_fd(fd, &local_fd, &permanent);
+    if (vfs == NULL || local_fd < 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (vfs->vfs->select == NULL
+            || (vfs->vfs->select->start_select == NULL && !fd_is_socket(vfs, permanent))) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    epoll_item_t *item = heap_caps_calloc(1, sizeof(epoll_item_t), VFS_MALLOC_FLAGS);
+    if (item == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    item->epoll = epoll;
+    item->fd = fd;
+    item->local_fd = local_fd;
+    item->vfs = vfs;
+    item->events = event->events;
+    item->user_data = event->user_data;
+    item->is_socket = fd_is_socket(vfs, permanent);
+
+    if (item->is_socket) {
+        item->next = epoll->sockets;
+        epoll->sockets = item;
+        // the waiting task has to call socket_select with the new socket
+        portENTER_CRITICAL(&epoll->ready_lock);
+        wake_waiter(epoll);
+        portEXIT_CRITICAL(&epoll->ready_lock);
+    } else {
+        esp_err_t err = arm_item(item);
+        if (err != ESP_OK) {
+            free(item);
+            return err;
+        }
+    }
+    epoll->items[fd] = item;
+    return ESP_OK;
+}
+
+esp_err_t esp_vfs_epoll_ctl(esp_vfs_epoll_handle_t epoll, esp_vfs_epoll_op_t op, int fd, const esp_vfs_epoll_event_t *event)
+{
+    if (epoll == NULL || fd < 0 || fd >= MAX_FDS || (op != ESP_VFS_EPOLL_CTL_DEL && event == NULL)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t ret = ESP_OK;
+    _lock_acquire(&epoll->lock);
+    epoll_item_t *item = epoll->items[fd];
+    switch (op) {
+    case ESP_VFS_EPOLL_CTL_ADD:
+        ret = item ? ESP_ERR_INVALID_STATE : add_item(epoll, fd, event);
+        break;
+    case ESP_VFS_EPOLL_CTL_MOD:
+        if (item == NULL) {
+            ret = ESP_ERR_INVALID_STATE;
+            break;
+        }
+        item->user_data = event->user_data;
+        if (item->events != event->events || (!item->is_socket && !item->armed)) {
+            item->events = event->events;
+            if (!item->is_socket) {
+                // arm again with the new fd_sets, or after arming failed in esp_vfs_epoll_wait
+                (void) disarm_item(item);
+                ret = arm_item(item);
+            }
+        }
+        break;
+    case ESP_VFS_EPOLL_CTL_DEL:
+        if (item == NULL) {
+            ret = ESP_ERR_INVALID_STATE;
+            break;
+        }
+        remove_item(epoll, item);
+        break;
+    default:
+        ret = ESP_ERR_INVALID_ARG;
+        break;
+    }
+    _lock_release(&epoll->lock);
+    ESP_LOGD(TAG, "ctl op %d fd %d: %s", op, fd, esp_err_to_name(ret));
+    return ret;
+}
+
+/* Reports the events of the items in the ready list. Must be called with epoll->lock taken. */
+static int process_ready_items(struct esp_vfs_epoll *epoll, esp_vfs_epoll_event_t *events, int max_events)
+{
+    // Take the whole list, so that the items triggered again while they are armed below are reported by the
+    // next call, not twice by this one. The taken items stay marked as queued until they are processed, so that
+    // a trigger doesn't link them into the new list meanwhile.
+    portENTER_CRITICAL(&epoll->ready_lock);
+    epoll_item_t *item = epoll->ready_head;
+    epoll->ready_head = NULL;
+    epoll->ready_tail = NULL;
+    portEXIT_CRITICAL(&epoll->ready_lock);
+
+    int n = 0;
+    while (item != NULL && n < max_events) {
+        portENTER_CRITICAL(&epoll->ready_lock);
+        epoll_item_t *next = item->next;
+        item->queued = false;
+        portEXIT_CRITICAL(&epoll->ready_lock);
+
+        uint32_t ready_events = disarm_item(item);
+
+        // the fd may have been closed or even reused by another file while it was armed
+        int local_fd;
+        bool permanent;
+        const vfs_entry_t *vfs = get_vfs_for_fd_with_local_fd(item->fd, &local_fd, &permanent);
+        bool closed = (vfs != item->vfs || local_fd != item->local_fd);
+        if (closed || arm_item(item) != ESP_OK) {
+            ready_events |= ESP_VFS_EPOLLERR;
+        }
+
+        if (ready_events) {
+            events[n++] = (esp_vfs_epoll_event_t) {
+                .events = ready_events, .fd = item->fd, .user_data = item->user_data,
+            };
+        }
+        if (closed) {
+            // it is disarmed and no longer queued, there won't be any trigger of the closed fd
+            remove_item(epoll, item);
+        }
+        item = next;
+    }
+
+    if (item != NULL) {
+        // the items which didn't fit into events are put back in front of the ones queued meanwhile
+        portENTER_CRITICAL(&epoll->ready_lock);
+        epoll_item_t *last = item;
+        while (last->next != NULL) {
+            last = last->next;
+        }
+        last->next = epoll->ready_head;
+        if (epoll->ready_head == NULL) {
+            epoll->ready_tail = last;
+        }
+        epoll->ready_head = item;
+        xSemaphoreGive(epoll->ready_sem);
+        portEXIT_CRITICAL(&epoll->ready_lock);
+    }
+    return n;
+}
+
+/* Calls socket_select for the sockets of the interest list. Must be called with epoll->lock taken, which is
+ * released while waiting. */
+static int wait_for_sockets(struct esp_vfs_epoll *epoll, esp_vfs_epoll_event_t *events, int max_events,
+                            struct timeval *timeout)
+{
+    fd_set readfds;
+    fd_set writefds;
+    fd_set errorfds;
+    FD_ZERO(&readfds);
+    FD_ZERO(&writefds);
+    FD_ZERO(&errorfds);
+    int nfds = 0;
+    const esp_vfs_select_ops_t *select = epoll->sockets->vfs->vfs->select;
+    for (epoll_item_t *item = epoll->sockets; item != NULL; item = item->next) {
+        if (item->events & ESP_VFS_EPOLLIN) {
+            FD_SET(item->fd, &readfds);
+        }
+        if (item->events & ESP_VFS_EPOLLOUT) {
+            FD_SET(item->fd, &writefds);
+        }
+        FD_SET(item->fd, &errorfds);
+        nfds = MAX(nfds, item->fd + 1);
+    }
+
+    struct timeval no_wait = { 0 };
+    portENTER_CRITICAL(&epoll->ready_lock);
+    if (epoll->ready_head) {
+        timeout = &no_wait;
+    } else {
+        epoll->socket_sem = select->get_socket_select_semaphore();
+    }
+    portEXIT_CRITICAL(&epoll->ready_lock);
+
+    _lock_release(&epoll->lock);
+    int ret = select->socket_select(nfds, &readfds, &writefds, &errorfds, timeout);
+    _lock_acquire(&epoll->lock);
+
+    portENTER_CRITICAL(&epoll->ready_lock);
+    SemaphoreHandle_t *sem = epoll->socket_sem;
+    epoll->socket_sem = NULL;
+    portEXIT_CRITICAL(&epoll->ready_lock);
+    if (sem) {
+        // socket_select might have been interrupted by a trigger after it returned, see esp_vfs_select
+        xSemaphoreTake(*sem, 0);
+    }
+    if (ret <= 0) {
+        return ret;
+    }
+
+    int n = 0;
+    for (int fd = 0; fd < nfds && n < max_events; ++fd) {
+        epoll_item_t *item = epoll->items[fd];
+        // the socket may have been removed from the interest list while waiting
+        if (item == NULL || !item->is_socket) {
+            continue;
+        }
+        uint32_t ready_events = 0;
+        if (FD_ISSET(fd, &readfds)) {
+            ready_events |= ESP_VFS_EPOLLIN;
+        }
+        if (FD_ISSET(fd, &writefds)) {
+            ready_events |= ESP_VFS_EPOLLOUT;
+        }
+        if (FD_ISSET(fd, &errorfds)) {
+            ready_events |= ESP_VFS_EPOLLERR;
+        }
+        ready_events &= item->events | ESP_VFS_EPOLLERR;
+        if (ready_events) {
+            events[n++] = (esp_vfs_epoll_event_t) {
+                .events = ready_events, .fd = fd, .user_data = item->user_data,
+            };
+        }
+    }
+    return n;
+}
+
+int esp_vfs_epoll_wait(esp_vfs_epoll_handle_t epoll, esp_vfs_epoll_event_t *events, int max_events, int timeout_ms)
+{
+    if (epoll == NULL || events == NULL || max_events <= 0 || timeout_ms < -1) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    TickType_t ticks_to_wait = portMAX_DELAY;
+    if (timeout_ms >= 0) {
+        // wait at least timeout_ms, see esp_vfs_select
+        ticks_to_wait = timeout_ms ? ((timeout_ms + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS) + 1 : 0;
+    }
+    const TickType_t start = xTaskGetTickCount();
+
+    _lock_acquire(&epoll->lock);
+    if (epoll->waiting) {
+        _lock_release(&epoll->lock);
+        errno = EBUSY;
+        return -1;
+    }
+    epoll->waiting = true;
+
+    int n = 0;
+    while (true) {
+        n = process_ready_items(epoll, events, max_events);
+
+        TickType_t remaining = 0;
+        if (ticks_to_wait == portMAX_DELAY) {
+            remaining = portMAX_DELAY;
+        } else if (n == 0 && xTaskGetTickCount() - start < ticks_to_wait) {
+            remaining = ticks_to_wait - (xTaskGetTickCount() - start);
+        }
+
+        if (epoll->sockets && n < max_events) {
+            struct timeval tv = { 0 };
+            if (n == 0 && remaining != 0) {
+                tv.tv_sec = remaining * portTICK_PERIOD_MS / 1000;
+                tv.tv_usec = (remaining * portTICK_PERIOD_MS % 1000) * 1000;
+            }
+            int ret = wait_for_sockets(epoll, events + n, max_events - n,
+                                       remaining == portMAX_DELAY && n == 0 ? NULL : &tv);
+            if (ret < 0) {
+                if (n == 0) {
+                    n = -1;
+                    break;
+                }
+            } else {
+                n += ret;
+            }
+        } else if (n == 0 && remaining != 0) {
+            _lock_release(&epoll->lock);
+            xSemaphoreTake(epoll->ready_sem, remaining);
+            _lock_acquire(&epoll->lock);
+        }
+
+        if (n != 0 || remaining == 0) {
+            break;
+        }
+    }
+
+    epoll->waiting = false;
+    _lock_release(&epoll->lock);
+    ESP_LOGD(TAG, "wait returns %d", n);
+    return n;
+}
+
+#endif // CONFIG_VFS_SUPPORT_SELECT
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2016-2023 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2016-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -99,6 +99,65 @@ TEST_CASE("write and read back data", "[wear_levelling]")
     free(read);
 }
 
+TEST_CASE("multi-page read and write use one partition operation per contiguous run", "[wear_levelling]")
+{
+    esp_err_t result;
+    wl_handle_t wl_handle;
+
+    const esp_partition_t *partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, "storage");
+
+    result = wl_mount(partition, &wl_handle);
+    REQUIRE(result == ESP_OK);
+
+    size_t size = wl_size(wl_handle);
+    uint32_t sector_size = wl_sector_size(wl_handle);
+    uint8_t* data = (uint8_t*) malloc(size);
+    uint8_t* read = (uint8_t*) malloc(size);
+    REQUIRE(data != NULL);
+    REQUIRE(read != NULL);
+
+    // Repeat with the dummy sector at different positions, erasing single sectors moves it
+    for (int round = 0; round < 3; round++) {
+        for (int i = 0; i < 20; i++) {
+            result = wl_erase_range(wl_handle, (i % 8) * sector_size, sector_size);
+            REQUIRE(result == ESP_OK);
+        }
+        result = wl_erase_range(wl_handle, 0, size);
+        REQUIRE(result == ESP_OK);
+
+        for (size_t i = 0; i < size / sizeof(uint32_t); i++) {
+            ((uint32_t*) data)[i] = i * 2654435761u + round;
+        }
+
+        // The pages are only split where the address wraps around the partition and at the dummy sector
+        esp_partition_clear_stats();
+        result = wl_write(wl_handle, 0, data, size);
+        REQUIRE(result == ESP_OK);
+        CHECK(esp_partition_get_write_ops() <= 3);
+        CHECK(esp_partition_get_write_bytes() == size);
+
+        esp_partition_clear_stats();
+        result = wl_read(wl_handle, 0, read, size);
+        REQUIRE(result == ESP_OK);
+        CHECK(esp_partition_get_read_ops() <= 3);
+        CHECK(esp_partition_get_read_bytes() == size);
+        REQUIRE(memcmp(data, read, size) == 0);
+
+        // Unaligned range crossing several page boundaries
+        size_t offset = sector_size * 5 + 100;
+        size_t length = sector_size * 7 + 200;
+        result = wl_read(wl_handle, offset, read, length);
+        REQUIRE(result == ESP_OK);
+        REQUIRE(memcmp(data + offset, read, length) == 0);
+    }
+
+    result = wl_unmount(wl_handle);
+    REQUIRE(result == ESP_OK);
+
+    free(data);
+    free(read);
+}
+
 TEST_CASE("power down test", "[wear_levelling]")
 {
     esp_err_t result;
@@ -0,0 +1,235 @@
+#!/usr/bin/env python
+#
+# SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+# Decodes the output of an application built with CONFIG_LOG_BINARY.
+# Binary log records are formatted with the format strings from the ELF file of the application,
+# other output is passed through. See components/log/src/binary/log_binary.c for the record format.
+#
+#   esp_log_decode.py build/app.elf < captured_output.bin
+#   idf.py monitor --no-reset --print_filter '' | esp_log_decode.py build/app.elf  (raw output is needed)
+
+import argparse
+import re
+import struct
+import sys
+from typing import BinaryIO
+from typing import Dict
+from typing import List
+from typing import Optional
+from typing import TextIO
+from typing import Tuple
+
+from elftools.elf.constants import SH_FLAGS
+from elftools.elf.elffile import ELFFile
+from elftools.elf.sections import SymbolTableSection
+
+MARKER_HEADER = 0xFC
+MARKER_MESSAGE = 0xFE
+VERSION = 1
+
+MARKER_RE = re.compile(b'[\xfc\xfe]')
+CONVERSION_RE = re.compile(r'%([-+ #0]*)(\d*)(?:\.(\d*))?(hh|h|ll|l|j|z|t|L)?([diouxXeEfFgGaAcsp%])')
+
+
+class DecodeError(RuntimeError):
+    pass
+
+
+class ElfStrings:
+    """
+        Reads strings from the allocated sections of an ELF file.
+    """
+    def __init__(self, elf_file: BinaryIO) -> None:
+        elf = ELFFile(elf_file)
+        self.pointer_size = elf.elfclass // 8
+        self.sections: List[Tuple[int, bytes]] = []
+        self.symbols: Dict[str, int] = {}
+        for section in elf.iter_sections():
+            if section['sh_addr'] != 0 and section['sh_flags'] & SH_FLAGS.SHF_ALLOC and section['sh_type'] != 'SHT_NOBITS':
+                self.sections.append((section['sh_addr'], section.data()))
+            if isinstance(section, SymbolTableSection):
+                for symbol in section.iter_symbols():
+                    if symbol.name:
+                        self.symbols[symbol.name] = symbol['st_value']
+        self.strings: Dict[int, Optional[str]] = {}
+
+    def get_str(self, addr: int) -> Optional[str]:
+        if addr not in self.strings:
+            self.strings[addr] = None
+            for start, data in self.sections:
+                if start <= addr < start + len(data):
+                    end = data.find(b'\0', addr - start)
+                    self.strings[addr] = data[addr - start:end if end >= 0 else len(data)].decode('utf-8', 'replace')
+                    break
+        return self.strings[addr]
+
+
+class Payload:
+    def __init__(self, data: bytes) -> None:
+        self.data = data
+        self.pos = 0
+
+    def bytes(self, size: int) -> bytes:
+        if self.pos + size > len(self.data):
+            raise DecodeError('truncated record')
+        self.pos += size
+        return self.data[self.pos - size:self.pos]
+
+    def varint(self) -> int:
+        value = 0
+        shift = 0
+        while True:
+            byte = self.bytes(1)[0]
+            value |= (byte & 0x7F) << shift
+            shift += 7
+            if byte < 0x80:
+                return value
+
+    def zigzag(self) -> int:
+        value = self.varint()
+        return (value >> 1) ^ -(value & 1)
+
+    def pointer(self, size: int) -> int:
+        return int.from_bytes(self.bytes(size), 'little')
+
+
+class LogDecoder:
+    def __init__(self, elf: ElfStrings, out: TextIO) -> None:
+        self.elf = elf
+        self.out = out
+        self.pointer_size = elf.pointer_size
+        self.offset = 0  # load address minus link address, for position-independent executables
+        self.pending = b''
+
+    def int_size(self, length: Optional[str]) -> int:
+        sizes = {'hh': 1, 'h': 2, 'l': 4 if self.pointer_size == 4 else 8, 'll': 8, 'j': 8,
+                 'z': self.pointer_size, 't': self.pointer_size}
+        return sizes.get(length or '', 4)
+
+    def format_arg(self, match: 're.Match[str]', payload: Payload) -> str:
+        flags, width, precision, length, conversion = match.groups()
+        spec = '%' + flags + width + ('.' + precision if precision is not None else '')
+        if conversion in 'diouxXc':
+            bits = self.int_size(length) * 8
+            value = payload.zigzag() & ((1 << bits) - 1)
+            if conversion in 'di':
+                if value >= 1 << (bits - 1):
+                    value -= 1 << bits
+                return (spec + 'd') % value
+            if conversion == 'c':
+                return (spec + 'c') % chr(value & 0xFF)
+            if conversion == 'o' and '#' in flags:
+                # C prefixes octal numbers with '0', Python with '0o'
+                return ((spec + 'o') % value).replace('0o', '0', 1) if value else (spec.replace('#', '') + 'o') % value
+            return (spec + ('d' if conversion == 'u' else conversion)) % value
+        if conversion in 'eEfFgGaA':
+            value = struct.unpack('<d', payload.bytes(8))[0]
+            if conversion in 'aA':
+                text = value.hex()
+                return text.upper() if conversion == 'A' else text
+            return (spec + conversion) % value
+        if conversion == 'p':
+            return (spec + 's') % hex(payload.varint())
+        # conversion == 's'
+        size = payload.varint()
+        if size > 0:
+            return (spec + 's') % payload.bytes(size - 1).decode('utf-8', 'replace')
+        addr = payload.varint()
+        text = '(null)' if addr == 0 else self.elf.get_str(addr - self.offset)
+        return (spec + 's') % (text if text is not None else '<string 0x%x>' % addr)
+
+    def format_message(self, payload: Payload) -> str:
+        fmt_addr = payload.pointer(self.pointer_size)
+        fmt = self.elf.get_str(fmt_addr - self.offset)
+        if fmt is None:
+            raise DecodeError('format string 0x%x not found in the ELF file' % fmt_addr)
+        text = ''
+        pos = 0
+        for match in CONVERSION_RE.finditer(fmt):
+            text += fmt[pos:match.start()]
+            text += '%' if match.group(5) == '%' else self.format_arg(match, payload)
+            pos = match.end()
+        return text + fmt[pos:]
+
+    def handle_header(self, payload: Payload) -> None:
+        version, self.pointer_size = payload.bytes(2)
+        if version != VERSION:
+            raise DecodeError('unsupported version %d' % version)
+        ref_addr = payload.pointer(self.pointer_size)
+        if 'esp_log_writev' in self.elf.symbols:
+            self.offset = ref_addr - self.elf.symbols['esp_log_writev']
+
+    def feed(self, data: bytes) -> None:
+        data = self.pending + data
+        pos = 0
+        while pos < len(data):
+            match = MARKER_RE.search(data, pos)
+            start = match.start() if match else len(data)
+            self.out.write(data[pos:start].decode('utf-8', 'replace'))
+            pos = start
+            if pos == len(data):
+                break
+            # marker, length (varint of up to 2 bytes), payload
+            length = parse_varint(data, pos + 1, 2)
+            if length is None:
+                break  # incomplete, wait for more data
+            size, payload_pos = length
+            if size < 0:
+                self.out.write(data[pos:pos + 1].decode('utf-8', 'replace'))
+                pos += 1
+                continue
+            if payload_pos + size > len(data):
+                break
+            payload = Payload(data[payload_pos:payload_pos + size])
+            try:
+                if data[pos] == MARKER_HEADER:
+                    self.handle_header(payload)
+                else:
+                    self.out.write(self.format_message(payload))
+            except DecodeError as e:
+                self.out.write('<binary log record: %s>\n' % e)
+            pos = payload_pos + size
+        self.pending = data[pos:]
+        self.out.flush()
+
+    def finish(self) -> None:
+        self.out.write(self.pending.decode('utf-8', 'replace'))
+        self.pending = b''
+        self.out.flush()
+
+
+def parse_varint(data: bytes, pos: int, max_size: int) -> Optional[Tuple[int, int]]:
+    """
+        Returns the value and the position after it, None if the data ends before it, or -1 as value if it is invalid.
+    """
+    value = 0
+    for i in range(max_size):
+        if pos + i >= len(data):
+            return None
+        value |= (data[pos + i] & 0x7F) << (7 * i)
+        if data[pos + i] < 0x80:
+            return value, pos + i + 1
+    return -1, pos
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description='Decoder of binary log output (CONFIG_LOG_BINARY)')
+    parser.add_argument('elf_file', help='Path to the ELF file of the application', type=argparse.FileType('rb'))
+    parser.add_argument('input', help='Path to the captured output, stdin by default', nargs='?',
+                        type=argparse.FileType('rb'), default=sys.stdin.buffer)
+    args = parser.parse_args()
+
+    decoder = LogDecoder(ElfStrings(args.elf_file), sys.stdout)
+    while True:
+        data = args.input.read1(4096) if hasattr(args.input, 'read1') else args.input.read(4096)
+        if not data:
+            break
+        decoder.feed(data)
+    decoder.finish()
+
+
+if __name__ == '__main__':
+    main()